@@ -0,0 +1,122 @@
+/*
+ * Copyright 2018 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "Benchmark.h"
+#include "Resources.h"
+#include "SkAnimCodecPlayer.h"
+#include "SkCodec.h"
+#include "SkData.h"
+#include "SkExecutor.h"
+#include "SkImage.h"
+#include "SkMakeUnique.h"
+#include "SkOSPath.h"
+#include "SkOpts.h"
+
+#include <vector>
+
+// Plays kPlayers copies of one animation, like a feed of stickers, advancing all of them by a
+// 60fps frame per step.  The time is what the playing thread spends in seek() and getFrame().
+// It also reports the dropped frame rate: how often getFrame() found its frame not decoded.
+class AnimCodecPlayerBench : public Benchmark {
+public:
+    AnimCodecPlayerBench(const char* filename, int threads, int frameBudget, bool shared)
+        : fFilename(filename)
+        , fThreads(threads)
+        , fFrameBudget(frameBudget)
+        , fShared(shared) {
+        fName.printf("anim_player_%s", SkOSPath::Basename(filename).c_str());
+        if (threads > 0) {
+            fName.appendf("_threads%d", threads);
+        }
+        if (frameBudget > 0) {
+            fName.appendf("_budget%d", frameBudget);
+        }
+        if (shared) {
+            fName.append("_shared");
+        }
+    }
+
+    bool isSuitableFor(Backend backend) override { return kNonRendering_Backend == backend; }
+
+protected:
+    const char* onGetName() override { return fName.c_str(); }
+
+    void onDelayedSetup() override {
+        fData = GetResourceAsData(fFilename);
+        if (fThreads > 0) {
+            fExecutor = SkExecutor::MakeFIFOThreadPool(fThreads);
+        }
+    }
+
+    void onPerCanvasPreDraw(SkCanvas*) override {
+        SkAnimCodecPlayer::Options options;
+        options.fExecutor = fExecutor.get();
+        options.fFrameBudget = fFrameBudget;
+        options.fSharedID = fShared ? SkOpts::hash(fData->data(), fData->size()) : 0;
+        for (int i = 0; i < kPlayers; i++) {
+            fPlayers.push_back(skstd::make_unique<SkAnimCodecPlayer>(
+                    SkCodec::MakeFromData(fData), options));
+        }
+        fTime = 0;
+        fFrames = 0;
+    }
+
+    void onDraw(int loops, SkCanvas*) override {
+        for (int i = 0; i < loops; i++) {
+            fTime += 16;
+            for (const auto& player : fPlayers) {
+                player->seek(fTime);
+                sk_sp<SkImage> frame = player->getFrame();
+                SkASSERT(frame);
+            }
+            fFrames += kPlayers;
+        }
+    }
+
+    void getMetrics(SkTArray<SkString>* keys, SkTArray<double>* values) override {
+        int late = 0;
+        for (const auto& player : fPlayers) {
+            late += player->lateFrames();
+        }
+        if (fFrames > 0) {
+            keys->push_back(SkString("dropped_frames_percent"));
+            values->push_back(100.0 * late / fFrames);
+        }
+    }
+
+    void onPerCanvasPostDraw(SkCanvas*) override {
+        fPlayers.clear();
+    }
+
+private:
+    static constexpr int kPlayers = 100;
+
+    const char*                                     fFilename;
+    const int                                       fThreads;
+    const int                                       fFrameBudget;
+    const bool                                      fShared;
+    SkString                                        fName;
+    sk_sp<SkData>                                   fData;
+    std::unique_ptr<SkExecutor>                     fExecutor;
+    std::vector<std::unique_ptr<SkAnimCodecPlayer>> fPlayers;
+    uint32_t                                        fTime;
+    int                                             fFrames;
+
+    typedef Benchmark INHERITED;
+};
+
+#define ANIM_PLAYER_BENCHES(FILE)                                                \
+    DEF_BENCH(return new AnimCodecPlayerBench(FILE, 0, 0, false);)               \
+    DEF_BENCH(return new AnimCodecPlayerBench(FILE, 4, 0, false);)               \
+    DEF_BENCH(return new AnimCodecPlayerBench(FILE, 4, 4, false);)               \
+    DEF_BENCH(return new AnimCodecPlayerBench(FILE, 4, 4, true);)
+
+ANIM_PLAYER_BENCHES("images/alphabetAnim.gif")
+ANIM_PLAYER_BENCHES("images/flightAnim.gif")
+ANIM_PLAYER_BENCHES("images/webp-animated.webp")
+
+#undef ANIM_PLAYER_BENCHES
@@ -79,6 +79,10 @@ public:
 
     virtual void getGpuStats(SkCanvas*, SkTArray<SkString>* keys, SkTArray<double>* values) {}
 
+    // Called after the timed draws, before perCanvasPostDraw().  Any metrics besides time the
+    // benchmark measured, to be logged with its results.
+    virtual void getMetrics(SkTArray<SkString>* keys, SkTArray<double>* values) {}
+
 protected:
     virtual void setupPaint(SkPaint* paint);
 
@@ -8,6 +8,7 @@
 #include "Benchmark.h"
 #include "SkCanvas.h"
 #include "SkPath.h"
+#include "SkRandom.h"
 #include "sk_tool_utils.h"
 
 enum Align {
@@ -84,3 +85,62 @@ DEF_BENCH( return new BigPathBench(kRight_Align,    false); )
 DEF_BENCH( return new BigPathBench(kLeft_Align,     true); )
 DEF_BENCH( return new BigPathBench(kMiddle_Align,   true); )
 DEF_BENCH( return new BigPathBench(kRight_Align,    true); )
+
+// A line chart with a very long polyline, filled down to its axis or stroked. Its rows are crowded
+// with edges that come in every order, which is the worst case for accumulating analytic coverage.
+// These paths have more points than rows, so pass --forceAnalyticAA to measure analytic AA.
+class BigPolylineBench : public Benchmark {
+    SkPath      fPath;
+    SkString    fName;
+    bool        fStroke;
+
+public:
+    BigPolylineBench(bool stroke) : fStroke(stroke) {
+        fName.printf("bigpath_polyline_%s", stroke ? "stroke" : "fill");
+    }
+
+protected:
+    const char* onGetName() override {
+        return fName.c_str();
+    }
+
+    SkIPoint onGetSize() override {
+        return SkIPoint::Make(1024, 512);
+    }
+
+    void onDelayedSetup() override {
+        static constexpr int kSegments = 100000;
+
+        SkRandom rand;
+        SkScalar y = 256;
+        fPath.moveTo(0, 512);
+        for (int i = 0; i <= kSegments; i++) {
+            y = SkTPin(y + rand.nextSScalar1() * 24, 16.0f, 496.0f);
+            fPath.lineTo(1024.0f * i / kSegments, y);
+        }
+        fPath.lineTo(1024, 512);
+        if (!fStroke) {
+            fPath.close();
+        }
+    }
+
+    void onDraw(int loops, SkCanvas* canvas) override {
+        SkPaint paint;
+        paint.setAntiAlias(true);
+        if (fStroke) {
+            paint.setStyle(SkPaint::kStroke_Style);
+            paint.setStrokeWidth(2);
+        }
+        this->setupPaint(&paint);
+
+        for (int i = 0; i < loops; i++) {
+            canvas->drawPath(fPath, paint);
+        }
+    }
+
+private:
+    typedef Benchmark INHERITED;
+};
+
+DEF_BENCH( return new BigPolylineBench(false); )
+DEF_BENCH( return new BigPolylineBench(true); )
@@ -9,14 +9,16 @@
 #include "CodecBenchPriv.h"
 #include "SkBitmap.h"
 #include "SkOSFile.h"
+#include "SkRandom.h"
 
 BitmapRegionDecoderBench::BitmapRegionDecoderBench(const char* baseName, SkData* encoded,
-        SkColorType colorType, uint32_t sampleSize, const SkIRect& subset)
+        SkColorType colorType, uint32_t sampleSize, const SkIRect& subset, bool randomSubsets)
     : fBRD(nullptr)
     , fData(SkRef(encoded))
     , fColorType(colorType)
     , fSampleSize(sampleSize)
     , fSubset(subset)
+    , fRandomSubsets(randomSubsets)
 {
     // Choose a useful name for the color type
     const char* colorName = color_type_to_str(colorType);
@@ -42,6 +44,21 @@ void BitmapRegionDecoderBench::onDelayedSetup() {
 void BitmapRegionDecoderBench::onDraw(int n, SkCanvas* canvas) {
     auto ct = fBRD->computeOutputColorType(fColorType);
     auto cs = fBRD->computeOutputColorSpace(ct, nullptr);
+    if (fRandomSubsets) {
+        const int maxX = fBRD->width() - fSubset.width();
+        const int maxY = fBRD->height() - fSubset.height();
+        SkRandom random;
+        for (int i = 0; i < n; i++) {
+            std::unique_ptr<SkBitmapRegionDecoder> brd(SkBitmapRegionDecoder::Create(fData,
+                    SkBitmapRegionDecoder::kAndroidCodec_Strategy));
+            const SkIRect subset = fSubset.makeOffset(random.nextRangeU(0, maxX),
+                                                      random.nextRangeU(0, maxY));
+            SkBitmap bm;
+            SkAssertResult(brd->decodeRegion(&bm, nullptr, subset, fSampleSize, ct, false, cs));
+        }
+        return;
+    }
+
     for (int i = 0; i < n; i++) {
         SkBitmap bm;
         SkAssertResult(fBRD->decodeRegion(&bm, nullptr, fSubset, fSampleSize, ct, false, cs));
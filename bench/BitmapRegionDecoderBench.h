@@ -20,12 +20,15 @@
  *
  *  nanobench.cpp handles creating benchmarks for interesting scaled subsets.  We strive to test
  *  on real use cases.
+ *
+ *  If randomSubsets is true, each decode creates a new SkBitmapRegionDecoder, and decodes a
+ *  subset of the size of subset from a random position, as when serving tiles of one image.
  */
 class BitmapRegionDecoderBench : public Benchmark {
 public:
     // Calls encoded->ref()
     BitmapRegionDecoderBench(const char* basename, SkData* encoded, SkColorType colorType,
-            uint32_t sampleSize, const SkIRect& subset);
+            uint32_t sampleSize, const SkIRect& subset, bool randomSubsets = false);
 
 protected:
     const char* onGetName() override;
@@ -40,6 +43,7 @@ private:
     const SkColorType                              fColorType;
     const uint32_t                                 fSampleSize;
     const SkIRect                                  fSubset;
+    const bool                                     fRandomSubsets;
     typedef Benchmark INHERITED;
 };
 #endif // BitmapRegionDecoderBench_DEFINED
@@ -0,0 +1,58 @@
+/*
+ * Copyright 2018 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "Benchmark.h"
+#include "SkBlitRow.h"
+#include "SkColorData.h"
+#include "SkRandom.h"
+#include "SkTemplates.h"
+
+// Measures SkBlitRow's S32A opaque proc (SkOpts::blit_row_s32a_opaque), the inner loop of
+// srcover sprite and bitmap draws onto N32 surfaces.
+class BlitRowS32ABench : public Benchmark {
+public:
+    enum Alpha { kTransparent, kOpaque, kMixed };
+
+    BlitRowS32ABench(Alpha alpha, int n) : fAlpha(alpha), fN(n), fSrc(n), fDst(n) {
+        static const char* kNames[] = { "transparent", "opaque", "mixed" };
+        fName.printf("blit_row_s32a_opaque_%s_%d", kNames[alpha], n);
+    }
+
+    bool isSuitableFor(Backend backend) override { return backend == kNonRendering_Backend; }
+    const char* onGetName() override { return fName.c_str(); }
+
+    void onDelayedSetup() override {
+        SkRandom rand;
+        for (int i = 0; i < fN; i++) {
+            U8CPU a = fAlpha == kTransparent ? 0x00
+                    : fAlpha == kOpaque      ? 0xFF
+                    : rand.nextULessThan(256);
+            fSrc[i] = SkPreMultiplyARGB(a, rand.nextULessThan(256), rand.nextULessThan(256),
+                                        rand.nextULessThan(256));
+            fDst[i] = rand.nextU() | 0xFF000000;
+        }
+    }
+
+    void onDraw(int loops, SkCanvas*) override {
+        auto proc = SkBlitRow::Factory32(SkBlitRow::kSrcPixelAlpha_Flag32);
+        for (int i = 0; i < 1000*loops; i++) {
+            proc(fDst.get(), fSrc.get(), fN, 0xFF);
+        }
+    }
+
+private:
+    Alpha                    fAlpha;
+    int                      fN;
+    SkAutoTMalloc<SkPMColor> fSrc,
+                             fDst;
+    SkString                 fName;
+};
+
+DEF_BENCH(return new BlitRowS32ABench(BlitRowS32ABench::kTransparent, 1000));
+DEF_BENCH(return new BlitRowS32ABench(BlitRowS32ABench::kOpaque,      1000));
+DEF_BENCH(return new BlitRowS32ABench(BlitRowS32ABench::kMixed,       15));
+DEF_BENCH(return new BlitRowS32ABench(BlitRowS32ABench::kMixed,       1000));
@@ -18,6 +18,7 @@
 #define REAL    0.5f
 #define BIG     SkIntToScalar(10)
 #define REALBIG 100.5f
+#define GIANT   SkIntToScalar(200)
 // The value that produces a sigma of just over 2.
 #define CUTOVER 2.6f
 
@@ -100,4 +101,8 @@ DEF_BENCH(return new BlurBench(REAL, kSolid_SkBlurStyle);)
 DEF_BENCH(return new BlurBench(REAL, kOuter_SkBlurStyle);)
 DEF_BENCH(return new BlurBench(REAL, kInner_SkBlurStyle);)
 
+// Large enough that the mask is blurred on a downscaled copy.
+DEF_BENCH(return new BlurBench(GIANT, kNormal_SkBlurStyle);)
+DEF_BENCH(return new BlurBench(GIANT, kOuter_SkBlurStyle);)
+
 DEF_BENCH(return new BlurBench(0, kNormal_SkBlurStyle);)
@@ -16,14 +16,22 @@
 DEFINE_bool(zero_init, false, "Pretend our destination is zero-intialized, simulating Android?");
 
 CodecBench::CodecBench(SkString baseName, SkData* encoded, SkColorType colorType,
-        SkAlphaType alphaType)
+        SkAlphaType alphaType, int threads, sk_sp<SkColorSpace> dstColorSpace)
     : fColorType(colorType)
     , fAlphaType(alphaType)
+    , fThreads(threads)
+    , fDstColorSpace(std::move(dstColorSpace))
     , fData(SkRef(encoded))
 {
     // Parse filename and the color type to give the benchmark a useful name
     fName.printf("Codec_%s_%s%s", baseName.c_str(), color_type_to_str(colorType),
             alpha_type_to_str(alphaType));
+    if (fDstColorSpace) {
+        fName.append("_xform");
+    }
+    if (threads > 0) {
+        fName.appendf("_threads%d", threads);
+    }
     // Ensure that we can create an SkCodec from this data.
     SkASSERT(SkCodec::MakeFromData(fData));
 }
@@ -41,9 +49,13 @@ void CodecBench::onDelayedSetup() {
 
     fInfo = codec->getInfo().makeColorType(fColorType)
                             .makeAlphaType(fAlphaType)
-                            .makeColorSpace(nullptr);
+                            .makeColorSpace(fDstColorSpace);
 
     fPixelStorage.reset(fInfo.computeMinByteSize());
+
+    if (fThreads > 0) {
+        fExecutor = SkExecutor::MakeFIFOThreadPool(fThreads);
+    }
 }
 
 void CodecBench::onDraw(int n, SkCanvas* canvas) {
@@ -52,6 +64,7 @@ void CodecBench::onDraw(int n, SkCanvas* canvas) {
     if (FLAGS_zero_init) {
         options.fZeroInitialized = SkCodec::kYes_ZeroInitialized;
     }
+    options.fExecutor = fExecutor.get();
     for (int i = 0; i < n; i++) {
         codec = SkCodec::MakeFromData(fData);
 #ifdef SK_DEBUG
@@ -10,7 +10,9 @@
 
 #include "Benchmark.h"
 #include "SkAutoMalloc.h"
+#include "SkColorSpace.h"
 #include "SkData.h"
+#include "SkExecutor.h"
 #include "SkImageInfo.h"
 #include "SkRefCnt.h"
 #include "SkString.h"
@@ -21,7 +23,10 @@
 class CodecBench : public Benchmark {
 public:
     // Calls encoded->ref()
-    CodecBench(SkString basename, SkData* encoded, SkColorType colorType, SkAlphaType alphaType);
+    // If threads > 0, decodes with an executor that has that many threads.
+    // If dstColorSpace is set, decodes to it, which usually needs a color xform.
+    CodecBench(SkString basename, SkData* encoded, SkColorType colorType, SkAlphaType alphaType,
+               int threads = 0, sk_sp<SkColorSpace> dstColorSpace = nullptr);
 
 protected:
     const char* onGetName() override;
@@ -30,12 +35,15 @@ protected:
     void onDelayedSetup() override;
 
 private:
-    SkString                fName;
-    const SkColorType       fColorType;
-    const SkAlphaType       fAlphaType;
-    sk_sp<SkData>           fData;
-    SkImageInfo             fInfo;          // Set in onDelayedSetup.
-    SkAutoMalloc            fPixelStorage;
+    SkString                    fName;
+    const SkColorType           fColorType;
+    const SkAlphaType           fAlphaType;
+    const int                   fThreads;
+    sk_sp<SkColorSpace>         fDstColorSpace;
+    sk_sp<SkData>               fData;
+    SkImageInfo                 fInfo;          // Set in onDelayedSetup.
+    SkAutoMalloc                fPixelStorage;
+    std::unique_ptr<SkExecutor> fExecutor;      // Set in onDelayedSetup.
     typedef Benchmark INHERITED;
 };
 #endif // CodecBench_DEFINED
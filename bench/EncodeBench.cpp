@@ -8,6 +8,7 @@
 #include "Benchmark.h"
 #include "Resources.h"
 #include "SkBitmap.h"
+#include "SkExecutor.h"
 #include "SkJpegEncoder.h"
 #include "SkPngEncoder.h"
 #include "SkWebpEncoder.h"
@@ -123,3 +124,61 @@ DEF_BENCH(return new EncodeBench(srcs[1], PNG(kNone, 3), "PNG_3n"));
 DEF_BENCH(return new EncodeBench(srcs[1], PNG(kNone, 1), "PNG_1n"));
 
 #undef PNG
+
+// Encodes a png with SkPngEncoder::Options::fExecutor set to a pool of fThreads threads.
+class PngThreadsBench : public Benchmark {
+public:
+    PngThreadsBench(const char* filename, SkPngEncoder::FilterFlag filters, int zlibLevel,
+                    int threads)
+        : fSourceFilename(filename)
+        , fFilters(filters)
+        , fZLibLevel(zlibLevel)
+        , fThreads(threads)
+        , fName(SkStringPrintf("Encode_%s_PNG_%d_threads%d", filename, zlibLevel, threads)) {}
+
+    bool isSuitableFor(Backend backend) override { return backend == kNonRendering_Backend; }
+
+    const char* onGetName() override { return fName.c_str(); }
+
+    void onDelayedSetup() override {
+        SkAssertResult(GetResourceAsBitmap(fSourceFilename, &fBitmap));
+        fExecutor = SkExecutor::MakeFIFOThreadPool(fThreads);
+    }
+
+    void onDraw(int loops, SkCanvas*) override {
+        SkPngEncoder::Options opts;
+        opts.fFilterFlags = fFilters;
+        opts.fZLibLevel = fZLibLevel;
+        opts.fExecutor = fExecutor.get();
+        while (loops-- > 0) {
+            SkNullWStream dst;
+            SkAssertResult(SkPngEncoder::Encode(&dst, fBitmap.pixmap(), opts));
+            SkASSERT(dst.bytesWritten() > 0);
+        }
+    }
+
+private:
+    const char*                 fSourceFilename;
+    SkPngEncoder::FilterFlag    fFilters;
+    int                         fZLibLevel;
+    int                         fThreads;
+    SkString                    fName;
+    SkBitmap                    fBitmap;
+    std::unique_ptr<SkExecutor> fExecutor;
+};
+
+// Compare with the serial Encode_*_PNG, Encode_*_PNG_3 and Encode_*_PNG_1 above.
+#define PNG_THREADS(SRC, LEVEL) \
+    DEF_BENCH(return new PngThreadsBench(SRC, SkPngEncoder::FilterFlag::kAll, LEVEL, 1)); \
+    DEF_BENCH(return new PngThreadsBench(SRC, SkPngEncoder::FilterFlag::kAll, LEVEL, 2)); \
+    DEF_BENCH(return new PngThreadsBench(SRC, SkPngEncoder::FilterFlag::kAll, LEVEL, 4)); \
+    DEF_BENCH(return new PngThreadsBench(SRC, SkPngEncoder::FilterFlag::kAll, LEVEL, 8));
+
+PNG_THREADS(srcs[0], 6)
+PNG_THREADS(srcs[0], 3)
+PNG_THREADS(srcs[0], 1)
+PNG_THREADS(srcs[1], 6)
+PNG_THREADS(srcs[1], 3)
+PNG_THREADS(srcs[1], 1)
+
+#undef PNG_THREADS
@@ -6,8 +6,11 @@
  */
 
 #include "Benchmark.h"
+#include "Resources.h"
 #include "SkCanvas.h"
+#include "SkData.h"
 #include "SkImage.h"
+#include "SkOSPath.h"
 #include "SkSurface.h"
 
 class Image2RasterBench : public Benchmark {
@@ -63,3 +66,60 @@ private:
     typedef Benchmark INHERITED;
 };
 DEF_BENCH( return new Image2RasterBench; )
+
+// Draws a grid of freshly decoded jpegs, each scaled into a cellSize x cellSize cell, the way an
+// image-heavy page of thumbnails would.  Lazy images decode at a reduced DCT scale when the cell
+// is small enough.
+class ThumbnailGridBench : public Benchmark {
+public:
+    ThumbnailGridBench(const char* filename, int cellSize)
+        : fFilename(filename)
+        , fCellSize(cellSize) {
+        fName.printf("thumbnail_grid_%s_%d", SkOSPath::Basename(filename).c_str(), cellSize);
+    }
+
+    bool isSuitableFor(Backend backend) override { return kNonRendering_Backend == backend; }
+
+protected:
+    const char* onGetName() override { return fName.c_str(); }
+
+    void onDelayedSetup() override {
+        fEncoded = GetResourceAsData(fFilename);
+        fSurface = SkSurface::MakeRasterN32Premul(kColumns * fCellSize, kRows * fCellSize);
+    }
+
+    void onDraw(int loops, SkCanvas*) override {
+        SkCanvas* canvas = fSurface->getCanvas();
+        SkPaint paint;
+        paint.setFilterQuality(kMedium_SkFilterQuality);
+        for (int i = 0; i < loops; i++) {
+            for (int y = 0; y < kRows; y++) {
+                for (int x = 0; x < kColumns; x++) {
+                    // A new image each time, so that nothing is found in the caches.
+                    sk_sp<SkImage> image = SkImage::MakeFromEncoded(fEncoded);
+                    SkRect dst = SkRect::MakeXYWH(x * fCellSize, y * fCellSize,
+                                                  fCellSize, fCellSize);
+                    canvas->drawImageRect(image, dst, &paint);
+                }
+            }
+        }
+    }
+
+private:
+    static constexpr int kColumns = 4;
+    static constexpr int kRows    = 4;
+
+    const char*      fFilename;
+    const int        fCellSize;
+    SkString         fName;
+    sk_sp<SkData>    fEncoded;
+    sk_sp<SkSurface> fSurface;
+
+    typedef Benchmark INHERITED;
+};
+DEF_BENCH( return new ThumbnailGridBench("images/mandrill_512_q075.jpg",  64); )
+DEF_BENCH( return new ThumbnailGridBench("images/mandrill_512_q075.jpg", 128); )
+DEF_BENCH( return new ThumbnailGridBench("images/mandrill_512_q075.jpg", 200); )
+DEF_BENCH( return new ThumbnailGridBench("images/mandrill_512_q075.jpg", 512); )
+DEF_BENCH( return new ThumbnailGridBench("images/dog.jpg",  64); )
+DEF_BENCH( return new ThumbnailGridBench("images/dog.jpg", 128); )
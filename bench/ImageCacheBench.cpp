@@ -6,7 +6,9 @@
  */
 
 #include "Benchmark.h"
+#include "SkExecutor.h"
 #include "SkResourceCache.h"
+#include "SkTaskGroup.h"
 
 namespace {
 static void* gGlobalAddress;
@@ -72,6 +74,66 @@ private:
     typedef Benchmark INHERITED;
 };
 
+// Splits a fixed mix of hits, misses and adds over a pool of threads sharing one cache, so the
+// time per loop across thread counts shows how throughput scales with contention.
+class ImageCacheThreadedBench : public Benchmark {
+    SkResourceCache fCache;
+
+    enum {
+        CACHE_COUNT = 500,
+        TASK_COUNT  = 64,
+        TASK_OPS    = 1000,
+    };
+public:
+    ImageCacheThreadedBench(int threads) : fCache(CACHE_COUNT * 100), fThreads(threads) {
+        fName.printf("imagecache_threaded_%d", threads);
+    }
+
+protected:
+    const char* onGetName() override {
+        return fName.c_str();
+    }
+
+    void onDelayedSetup() override {
+        fExecutor = SkExecutor::MakeFIFOThreadPool(fThreads);
+        for (int i = 0; i < CACHE_COUNT; ++i) {
+            fCache.add(new TestRec(TestKey(i), i));
+        }
+    }
+
+    void onDraw(int loops, SkCanvas*) override {
+        for (int loop = 0; loop < loops; ++loop) {
+            SkTaskGroup(*fExecutor).batch(TASK_COUNT, [this](int task) {
+                for (int i = 0; i < TASK_OPS; ++i) {
+                    // Mostly hits, with one miss and one add (replacing an existing rec) in 16.
+                    intptr_t value = (task * TASK_OPS + i) % CACHE_COUNT;
+                    switch (i & 15) {
+                        case 0:
+                            fCache.find(TestKey(-1), TestRec::Visitor, nullptr);
+                            break;
+                        case 1:
+                            fCache.add(new TestRec(TestKey(value), value));
+                            break;
+                        default:
+                            fCache.find(TestKey(value), TestRec::Visitor, nullptr);
+                            break;
+                    }
+                }
+            });
+        }
+    }
+
+private:
+    const int                   fThreads;
+    SkString                    fName;
+    std::unique_ptr<SkExecutor> fExecutor;
+
+    typedef Benchmark INHERITED;
+};
+
 ///////////////////////////////////////////////////////////////////////////////
 
 DEF_BENCH( return new ImageCacheBench(); )
+DEF_BENCH( return new ImageCacheThreadedBench(1); )
+DEF_BENCH( return new ImageCacheThreadedBench(4); )
+DEF_BENCH( return new ImageCacheThreadedBench(16); )
@@ -7,22 +7,38 @@
 
 #include "Benchmark.h"
 #include "SkBitmap.h"
+#include "SkExecutor.h"
 #include "SkMipMap.h"
 
 class MipMapBench: public Benchmark {
+public:
+    enum Mode {
+        kEager_Mode,      // build every level on this thread
+        kThreaded_Mode,   // build every level, splitting large levels across an executor
+        kLazy_Mode,       // build the first level, then leave the rest unbuilt
+    };
+
+private:
     SkBitmap fBitmap;
     SkString fName;
     const int fW, fH;
     bool fHalfFoat;
+    Mode fMode;
+    std::unique_ptr<SkExecutor> fExecutor;
 
 public:
-    MipMapBench(int w, int h, bool halfFloat = false)
-        : fW(w), fH(h), fHalfFoat(halfFloat)
+    MipMapBench(int w, int h, bool halfFloat = false, Mode mode = kEager_Mode)
+        : fW(w), fH(h), fHalfFoat(halfFloat), fMode(mode)
     {
         fName.printf("mipmap_build_%dx%d", w, h);
         if (halfFloat) {
             fName.append("_f16");
         }
+        if (kThreaded_Mode == mode) {
+            fName.append("_threaded");
+        } else if (kLazy_Mode == mode) {
+            fName.append("_lazy");
+        }
     }
 
 protected:
@@ -38,11 +54,18 @@ protected:
                                              SkColorSpace::MakeSRGB());
         fBitmap.allocPixels(info);
         fBitmap.eraseColor(SK_ColorWHITE);  // so we don't read uninitialized memory
+        if (kThreaded_Mode == fMode) {
+            fExecutor = SkExecutor::MakeFIFOThreadPool(4);
+        }
     }
 
     void onDraw(int loops, SkCanvas*) override {
         for (int i = 0; i < loops * 4; i++) {
-            SkMipMap::Build(fBitmap, nullptr)->unref();
+            if (kLazy_Mode == fMode) {
+                SkMipMap::BuildLazily(fBitmap, nullptr)->unref();
+            } else {
+                SkMipMap::Build(fBitmap, nullptr, fExecutor.get())->unref();
+            }
         }
     }
 
@@ -65,3 +88,10 @@ DEF_BENCH( return new MipMapBench(2048, 2048); )
 DEF_BENCH( return new MipMapBench(2047, 2047); )
 DEF_BENCH( return new MipMapBench(2048, 2047); )
 DEF_BENCH( return new MipMapBench(2047, 2048); )
+
+DEF_BENCH( return new MipMapBench(2048, 2048, false, MipMapBench::kThreaded_Mode); )
+DEF_BENCH( return new MipMapBench(2047, 2047, false, MipMapBench::kThreaded_Mode); )
+DEF_BENCH( return new MipMapBench(2048, 2048, true,  MipMapBench::kThreaded_Mode); )
+
+DEF_BENCH( return new MipMapBench(2048, 2048, false, MipMapBench::kLazy_Mode); )
+DEF_BENCH( return new MipMapBench(2048, 2048, true,  MipMapBench::kLazy_Mode); )
@@ -9,9 +9,11 @@
 
 #include "Resources.h"
 #include "SkAutoPixmapStorage.h"
+#include "SkColorPriv.h"
 #include "SkData.h"
 #include "SkExecutor.h"
 #include "SkFloatToDecimal.h"
+#include "SkFont.h"
 #include "SkGradientShader.h"
 #include "SkImage.h"
 #include "SkPDFUnion.h"
@@ -243,6 +245,65 @@ struct WritePDFTextBenchmark : public Benchmark {
     }
 };
 
+/** Writes a document whose pages each carry their own text and image, so that page content,
+    image and font streams all have work to hand to an executor with the given thread count. */
+class PDFThreadedDocBench : public Benchmark {
+public:
+    explicit PDFThreadedDocBench(int threads)
+        : fThreads(threads), fName(SkStringPrintf("PDFThreadedDoc_%d", threads)) {}
+
+protected:
+    const char* onGetName() override { return fName.c_str(); }
+    bool isSuitableFor(Backend backend) override { return backend == kNonRendering_Backend; }
+    void onDelayedSetup() override {
+        SkRandom rand;
+        for (int i = 0; i < kPageCount; ++i) {
+            SkBitmap bm;
+            bm.allocN32Pixels(256, 256, true);
+            for (int y = 0; y < 256; ++y) {
+                for (int x = 0; x < 256; ++x) {
+                    // Smooth enough to compress, noisy enough to make deflate work for it.
+                    U8CPU b = ((x ^ y) + (rand.nextU() & 7)) & 0xFF;
+                    *bm.getAddr32(x, y) = SkPackARGB32(0xFF, x, y, b);
+                }
+            }
+            bm.setImmutable();
+            fImages.push_back(SkImage::MakeFromBitmap(bm));
+        }
+        fExecutor = SkExecutor::MakeFIFOThreadPool(fThreads);
+    }
+    void onDraw(int loops, SkCanvas*) override {
+        SkFont font;
+        font.setSize(10);
+        SkPaint paint;
+        while (loops-- > 0) {
+            SkNullWStream wStream;
+            SkPDF::Metadata metadata;
+            metadata.fExecutor = fExecutor.get();
+            sk_sp<SkDocument> doc = SkPDF::MakeDocument(&wStream, metadata);
+            for (int i = 0; i < kPageCount; ++i) {
+                SkCanvas* canvas = doc->beginPage(612, 792);
+                canvas->drawImage(fImages[i], 36, 36);
+                for (int line = 0; line < 40; ++line) {
+                    SkString text = SkStringPrintf("Page %d, line %d: the quick brown fox "
+                                                   "jumps over the lazy dog.", i, line);
+                    canvas->drawString(text, 36, 320 + 11 * line, font, paint);
+                }
+                doc->endPage();
+            }
+            doc->close();
+        }
+    }
+
+private:
+    static constexpr int kPageCount = 16;
+
+    int fThreads;
+    SkString fName;
+    std::vector<sk_sp<SkImage>> fImages;
+    std::unique_ptr<SkExecutor> fExecutor;
+};
+
 }  // namespace
 DEF_BENCH(return new PDFImageBench;)
 DEF_BENCH(return new PDFJpegImageBench;)
@@ -250,6 +311,9 @@ DEF_BENCH(return new PDFCompressionBench;)
 DEF_BENCH(return new PDFColorComponentBench;)
 DEF_BENCH(return new PDFShaderBench;)
 DEF_BENCH(return new WritePDFTextBenchmark;)
+DEF_BENCH(return new PDFThreadedDocBench(1);)
+DEF_BENCH(return new PDFThreadedDocBench(4);)
+DEF_BENCH(return new PDFThreadedDocBench(8);)
 
 #ifdef SK_PDF_ENABLE_SLOW_TESTS
 #include "SkExecutor.h"
@@ -1242,3 +1242,159 @@ DEF_BENCH( return new CommonConvexBench(200, 16, false, false); )
 DEF_BENCH( return new CommonConvexBench(200, 16, true,  false); )
 DEF_BENCH( return new CommonConvexBench(200, 16, false, true); )
 DEF_BENCH( return new CommonConvexBench(200, 16, true,  true); )
+
+// Large vector scenes of the kind maps and charts draw: a few hundred antialiased paths, many with
+// thousands of points, that together cover the whole canvas. Run these with --deltaAA or
+// --forceDeltaAA, and in the 'threaded' config, to compare the path rasterizers on them.
+class VectorScenePathBench : public Benchmark {
+public:
+    enum Scene { kMap_Scene, kChart_Scene };
+
+    VectorScenePathBench(Scene scene, bool stroke) : fScene(scene), fStroke(stroke) {
+        fName.printf("path_scene_%s_%s", scene == kMap_Scene ? "map" : "chart",
+                     stroke ? "stroke" : "fill");
+    }
+
+protected:
+    static constexpr int kSize = 1024;
+
+    const char* onGetName() override { return fName.c_str(); }
+    SkIPoint onGetSize() override { return SkIPoint::Make(kSize, kSize); }
+
+    void onDelayedSetup() override {
+        SkRandom rand;
+        if (fScene == kMap_Scene) {
+            this->makeMap(&rand);
+        } else {
+            this->makeChart(&rand);
+        }
+        for (int i = 0; i < fPaths.count(); ++i) {
+            fColors.push_back(rand.nextU() | 0xFF000000);
+        }
+    }
+
+    void onDraw(int loops, SkCanvas* canvas) override {
+        SkPaint paint;
+        paint.setAntiAlias(true);
+        if (fStroke) {
+            paint.setStyle(SkPaint::kStroke_Style);
+            paint.setStrokeJoin(SkPaint::kRound_Join);
+        }
+        for (int i = 0; i < loops; ++i) {
+            for (int j = 0; j < fPaths.count(); ++j) {
+                paint.setColor(fColors[j]);
+                paint.setStrokeWidth(fStrokeWidths[j]);
+                canvas->drawPath(fPaths[j], paint);
+            }
+        }
+    }
+
+private:
+    // A grid of regions with ragged borders, each holding a few lakes. Stroking draws the borders
+    // and lake shores, and adds roads winding across the whole map.
+    void makeMap(SkRandom* rand) {
+        constexpr int kRegions = 12;
+        constexpr int kPointsPerSide = 64;
+        constexpr SkScalar kCell = SkIntToScalar(kSize) / kRegions;
+
+        // Corners are shared by neighboring regions, so the regions tile the map.
+        SkPoint corners[kRegions + 1][kRegions + 1];
+        for (int y = 0; y <= kRegions; ++y) {
+            for (int x = 0; x <= kRegions; ++x) {
+                corners[y][x] = {x * kCell + rand->nextRangeF(-0.3f, 0.3f) * kCell,
+                                 y * kCell + rand->nextRangeF(-0.3f, 0.3f) * kCell};
+            }
+        }
+        auto addBorder = [&](SkPath* path, SkPoint from, SkPoint to) {
+            const SkVector step = (to - from) * (1.0f / kPointsPerSide);
+            const SkVector normal = {-step.fY, step.fX};
+            for (int i = 1; i <= kPointsPerSide; ++i) {
+                const SkScalar wiggle = i < kPointsPerSide ? rand->nextRangeF(-1.5f, 1.5f) : 0;
+                path->lineTo(from + step * SkIntToScalar(i) + normal * wiggle);
+            }
+        };
+
+        for (int y = 0; y < kRegions; ++y) {
+            for (int x = 0; x < kRegions; ++x) {
+                SkPath region;
+                region.setFillType(SkPath::kEvenOdd_FillType);
+                region.moveTo(corners[y][x]);
+                addBorder(&region, corners[y][x],         corners[y][x + 1]);
+                addBorder(&region, corners[y][x + 1],     corners[y + 1][x + 1]);
+                addBorder(&region, corners[y + 1][x + 1], corners[y + 1][x]);
+                addBorder(&region, corners[y + 1][x],     corners[y][x]);
+                region.close();
+
+                const SkPoint center = (corners[y][x] + corners[y + 1][x + 1]) * 0.5f;
+                for (int lake = rand->nextULessThan(4); lake > 0; --lake) {
+                    const SkPoint c = center + SkVector{rand->nextRangeF(-0.2f, 0.2f) * kCell,
+                                                        rand->nextRangeF(-0.2f, 0.2f) * kCell};
+                    const SkScalar r = rand->nextRangeF(0.03f, 0.1f) * kCell;
+                    region.moveTo(c.fX + r, c.fY);
+                    for (int i = 1; i < 48; ++i) {
+                        const SkScalar angle = i * SK_ScalarPI * 2 / 48,
+                                       radius = r * rand->nextRangeF(0.8f, 1.2f);
+                        region.lineTo(c.fX + radius * SkScalarCos(angle),
+                                      c.fY + radius * SkScalarSin(angle));
+                    }
+                    region.close();
+                }
+                fPaths.push_back(region);
+                fStrokeWidths.push_back(1);
+            }
+        }
+
+        if (fStroke) {
+            for (int i = 0; i < 40; ++i) {
+                SkPath road;
+                SkPoint p = {rand->nextRangeF(0, kSize), rand->nextRangeF(0, kSize)};
+                road.moveTo(p);
+                for (int j = 0; j < 32; ++j) {
+                    SkPoint c0 = p + SkVector{rand->nextRangeF(-60, 60), rand->nextRangeF(-60, 60)},
+                            c1 = p + SkVector{rand->nextRangeF(-60, 60), rand->nextRangeF(-60, 60)};
+                    p += SkVector{rand->nextRangeF(-60, 60), rand->nextRangeF(-60, 60)};
+                    road.cubicTo(c0, c1, p);
+                }
+                fPaths.push_back(road);
+                fStrokeWidths.push_back(rand->nextRangeF(1, 6));
+            }
+        }
+    }
+
+    // Overlapping series of a few thousand samples each: areas down to the axis when filled,
+    // polylines when stroked.
+    void makeChart(SkRandom* rand) {
+        constexpr int kSeries = 16;
+        constexpr int kSamples = 4096;
+        for (int i = 0; i < kSeries; ++i) {
+            SkPath series;
+            SkScalar value = rand->nextRangeF(0.2f, 0.8f) * kSize;
+            series.moveTo(0, value);
+            for (int j = 1; j < kSamples; ++j) {
+                value = SkTPin(value + rand->nextRangeF(-8, 8), 0.0f, SkIntToScalar(kSize));
+                series.lineTo(j * SkIntToScalar(kSize) / (kSamples - 1), value);
+            }
+            if (!fStroke) {
+                series.lineTo(kSize, kSize);
+                series.lineTo(0, kSize);
+                series.close();
+            }
+            fPaths.push_back(series);
+            fStrokeWidths.push_back(rand->nextRangeF(1, 3));
+        }
+    }
+
+    const Scene       fScene;
+    const bool        fStroke;
+    SkString          fName;
+    SkTArray<SkPath>  fPaths;
+    SkTArray<SkColor> fColors;
+    SkTArray<float>   fStrokeWidths;
+
+    typedef Benchmark INHERITED;
+};
+
+DEF_BENCH( return new VectorScenePathBench(VectorScenePathBench::kMap_Scene,   false); )
+DEF_BENCH( return new VectorScenePathBench(VectorScenePathBench::kMap_Scene,   true); )
+DEF_BENCH( return new VectorScenePathBench(VectorScenePathBench::kChart_Scene, false); )
+DEF_BENCH( return new VectorScenePathBench(VectorScenePathBench::kChart_Scene, true); )
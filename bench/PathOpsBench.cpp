@@ -6,6 +6,7 @@
  */
 
 #include "Benchmark.h"
+#include "SkExecutor.h"
 #include "SkPath.h"
 #include "SkPathOps.h"
 #include "SkRandom.h"
@@ -96,3 +97,81 @@ static SkPath makerects() {
 }
 
 DEF_BENCH( return new PathOpsSimplifyBench("rects", makerects()); )
+
+// Unions many small polygons scattered over a square, like the buildings of a map tile.
+// The square grows with the count, so the polygons always overlap about as often.
+class PathOpsBuilderBench : public Benchmark {
+public:
+    enum Mode {
+        kSerial_Mode,     // SkOpBuilder::resolve(SkPath*)
+        kClustered_Mode,  // SkOpBuilder::resolve(SkPath*, nullptr)
+        kThreaded_Mode,   // SkOpBuilder::resolve(SkPath*, executor)
+    };
+
+    PathOpsBuilderBench(int count, Mode mode) : fCount(count), fMode(mode) {
+        static const char* kModeNames[] = { "serial", "clustered", "threaded" };
+        fName.printf("pathops_builder_%d_%s", count, kModeNames[mode]);
+    }
+
+    bool isSuitableFor(Backend backend) override {
+        return backend == kNonRendering_Backend;
+    }
+
+protected:
+    const char* onGetName() override {
+        return fName.c_str();
+    }
+
+    void onDelayedSetup() override {
+        SkRandom rand;
+        const SkScalar side = 30 * SkScalarSqrt(fCount);
+        for (int i = 0; i < fCount; ++i) {
+            SkScalar x = rand.nextRangeScalar(0, side),
+                     y = rand.nextRangeScalar(0, side),
+                     w = rand.nextRangeScalar(4, 20),
+                     h = rand.nextRangeScalar(4, 20);
+            SkPath& path = fPaths.push_back();
+            path.moveTo(x, y);
+            path.lineTo(x + w, y + h / 4);
+            path.lineTo(x + w * 3 / 4, y + h);
+            path.lineTo(x - w / 4, y + h * 3 / 4);
+            path.close();
+        }
+        if (kThreaded_Mode == fMode) {
+            fExecutor = SkExecutor::MakeFIFOThreadPool();
+        }
+    }
+
+    void onDraw(int loops, SkCanvas* canvas) override {
+        for (int i = 0; i < loops; i++) {
+            SkOpBuilder builder;
+            for (const SkPath& path : fPaths) {
+                builder.add(path, kUnion_SkPathOp);
+            }
+            SkPath result;
+            if (kSerial_Mode == fMode) {
+                builder.resolve(&result);
+            } else {
+                builder.resolve(&result, fExecutor.get());
+            }
+        }
+    }
+
+private:
+    SkString                    fName;
+    int                         fCount;
+    Mode                        fMode;
+    SkTArray<SkPath>            fPaths;
+    std::unique_ptr<SkExecutor> fExecutor;
+
+    typedef Benchmark INHERITED;
+};
+
+// Resolving everything at once is too slow to bother with past a thousand or so paths.
+DEF_BENCH( return new PathOpsBuilderBench(  1000, PathOpsBuilderBench::kSerial_Mode); )
+DEF_BENCH( return new PathOpsBuilderBench(  1000, PathOpsBuilderBench::kClustered_Mode); )
+DEF_BENCH( return new PathOpsBuilderBench(  1000, PathOpsBuilderBench::kThreaded_Mode); )
+DEF_BENCH( return new PathOpsBuilderBench( 10000, PathOpsBuilderBench::kClustered_Mode); )
+DEF_BENCH( return new PathOpsBuilderBench( 10000, PathOpsBuilderBench::kThreaded_Mode); )
+DEF_BENCH( return new PathOpsBuilderBench(100000, PathOpsBuilderBench::kClustered_Mode); )
+DEF_BENCH( return new PathOpsBuilderBench(100000, PathOpsBuilderBench::kThreaded_Mode); )
@@ -0,0 +1,90 @@
+/*
+ * Copyright 2018 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "Benchmark.h"
+
+#if defined(SK_HAS_PNG_LIBRARY) && defined(SK_HAS_WUFFS_PNG_LIBRARY)
+
+#include "CodecBenchPriv.h"
+#include "Resources.h"
+#include "SkAutoMalloc.h"
+#include "SkCodec.h"
+#include "SkColorSpace.h"
+#include "SkData.h"
+#include "SkOSPath.h"
+#include "SkPngCodec.h"
+#include "SkStream.h"
+#include "SkWuffsPngCodec.h"
+
+// Decodes the same PNG with SkPngCodec and SkWuffsPngCodec. CodecBench only
+// times whichever of the two SkCodec::MakeFromData picks.
+class PngCodecBench : public Benchmark {
+public:
+    PngCodecBench(const char* filename, bool wuffs, SkColorType colorType)
+        : fFilename(filename), fWuffs(wuffs), fColorType(colorType) {
+        fName.printf("PngCodec_%s_%s_%s", wuffs ? "wuffs" : "libpng",
+                     SkOSPath::Basename(filename).c_str(), color_type_to_str(colorType));
+    }
+
+    bool isSuitableFor(Backend backend) override { return kNonRendering_Backend == backend; }
+
+protected:
+    const char* onGetName() override { return fName.c_str(); }
+
+    void onDelayedSetup() override {
+        fData = GetResourceAsData(fFilename);
+        std::unique_ptr<SkCodec> codec = this->makeCodec();
+        fInfo = codec->getInfo().makeColorType(fColorType).makeAlphaType(kPremul_SkAlphaType);
+        if (kRGBA_F16_SkColorType == fColorType) {
+            fInfo = fInfo.makeColorSpace(SkColorSpace::MakeSRGBLinear());
+        }
+        fPixelStorage.reset(fInfo.computeMinByteSize());
+    }
+
+    void onDraw(int loops, SkCanvas*) override {
+        for (int i = 0; i < loops; i++) {
+            std::unique_ptr<SkCodec> codec = this->makeCodec();
+#ifdef SK_DEBUG
+            const SkCodec::Result result =
+#endif
+            codec->getPixels(fInfo, fPixelStorage.get(), fInfo.minRowBytes());
+            SkASSERT(result == SkCodec::kSuccess);
+        }
+    }
+
+private:
+    std::unique_ptr<SkCodec> makeCodec() const {
+        SkCodec::Result result;
+        auto stream = SkMemoryStream::Make(fData);
+        return fWuffs ? SkWuffsPngCodec_MakeFromStream(std::move(stream), &result)
+                      : SkPngCodec::MakeFromStream(std::move(stream), &result);
+    }
+
+    const char*       fFilename;
+    const bool        fWuffs;
+    const SkColorType fColorType;
+    SkString          fName;
+    sk_sp<SkData>     fData;
+    SkImageInfo       fInfo;
+    SkAutoMalloc      fPixelStorage;
+
+    typedef Benchmark INHERITED;
+};
+
+#define PNG_CODEC_BENCHES(FILE)                                                 \
+    DEF_BENCH(return new PngCodecBench(FILE, false, kN32_SkColorType);)         \
+    DEF_BENCH(return new PngCodecBench(FILE, true,  kN32_SkColorType);)         \
+    DEF_BENCH(return new PngCodecBench(FILE, false, kRGBA_F16_SkColorType);)    \
+    DEF_BENCH(return new PngCodecBench(FILE, true,  kRGBA_F16_SkColorType);)
+
+PNG_CODEC_BENCHES("images/mandrill_512.png")
+PNG_CODEC_BENCHES("images/yellow_rose.png")
+PNG_CODEC_BENCHES("images/plane_interlaced.png")
+PNG_CODEC_BENCHES("images/index8.png")
+PNG_CODEC_BENCHES("images/color_wheel.png")
+
+#endif
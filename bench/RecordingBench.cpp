@@ -67,11 +67,14 @@ void RecordingBench::onDraw(int loops, SkCanvas*) {
 }
 
 ///////////////////////////////////////////////////////////////////////////////////////////////////
+#include "SkPictureStreamReader.h"
 #include "SkSerialProcs.h"
 
-DeserializePictureBench::DeserializePictureBench(const char* name, sk_sp<SkData> data)
+DeserializePictureBench::DeserializePictureBench(const char* name, sk_sp<SkData> data,
+                                                 bool inPlace)
     : fName(name)
     , fEncodedPicture(std::move(data))
+    , fInPlace(inPlace)
 {}
 
 const char* DeserializePictureBench::onGetName() {
@@ -88,6 +91,60 @@ SkIPoint DeserializePictureBench::onGetSize() {
 
 void DeserializePictureBench::onDraw(int loops, SkCanvas*) {
     for (int i = 0; i < loops; ++i) {
-        SkPicture::MakeFromData(fEncodedPicture.get());
+        if (fInPlace) {
+            SkPictureStreamReader::MakeFromData(fEncodedPicture);
+        } else {
+            SkPicture::MakeFromData(fEncodedPicture.get());
+        }
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+#include "SkNoDrawCanvas.h"
+
+FirstPixelPictureBench::FirstPixelPictureBench(const char* name, sk_sp<SkData> data,
+                                               bool streaming)
+    : fName(name)
+    , fEncodedPicture(std::move(data))
+    , fStreaming(streaming) {
+    fName.append(streaming ? "_stream" : "_full");
+}
+
+const char* FirstPixelPictureBench::onGetName() {
+    return fName.c_str();
+}
+
+bool FirstPixelPictureBench::isSuitableFor(Backend backend) {
+    return backend == kNonRendering_Backend;
+}
+
+SkIPoint FirstPixelPictureBench::onGetSize() {
+    return SkIPoint::Make(128, 128);
+}
+
+void FirstPixelPictureBench::onDraw(int loops, SkCanvas*) {
+    // Roughly what a client receiving the picture over IPC in 64K chunks would see.
+    static const size_t kChunkSize = 64 * 1024;
+
+    for (int i = 0; i < loops; ++i) {
+        sk_sp<SkPicture> picture;
+        if (fStreaming) {
+            SkPictureStreamReader reader;
+            for (size_t offset = 0; offset < fEncodedPicture->size(); offset += kChunkSize) {
+                reader.append(fEncodedPicture->bytes() + offset,
+                              SkTMin(kChunkSize, fEncodedPicture->size() - offset));
+            }
+            picture = reader.finish();
+        } else {
+            picture = SkPicture::MakeFromData(fEncodedPicture.get());
+        }
+        if (!picture) {
+            continue;
+        }
+
+        // Rasterizing costs the same either way, so leave it out and just dispatch the ops.
+        SkIRect bounds = picture->cullRect().roundOut();
+        SkNoDrawCanvas canvas(bounds.width(), bounds.height());
+        picture->playback(&canvas);
     }
 }
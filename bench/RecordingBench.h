@@ -44,7 +44,9 @@ private:
 
 class DeserializePictureBench : public Benchmark {
 public:
-    DeserializePictureBench(const char* name, sk_sp<SkData> encodedPicture);
+    // If inPlace, loads through SkPictureStreamReader::MakeFromData(), which references
+    // encodedPicture (usually a mapped file) rather than copying out of it.
+    DeserializePictureBench(const char* name, sk_sp<SkData> encodedPicture, bool inPlace = false);
 
 protected:
     const char* onGetName() override;
@@ -55,6 +57,27 @@ protected:
 private:
     SkString      fName;
     sk_sp<SkData> fEncodedPicture;
+    bool          fInPlace;
+
+    typedef Benchmark INHERITED;
+};
+
+// Times deserializing a picture and playing it back once, either all at once through
+// SkPicture::MakeFromData() or in chunks through SkPictureStreamReader.
+class FirstPixelPictureBench : public Benchmark {
+public:
+    FirstPixelPictureBench(const char* name, sk_sp<SkData> encodedPicture, bool streaming);
+
+protected:
+    const char* onGetName() override;
+    bool isSuitableFor(Backend) override;
+    SkIPoint onGetSize() override;
+    void onDraw(int loops, SkCanvas*) override;
+
+private:
+    SkString      fName;
+    sk_sp<SkData> fEncodedPicture;
+    bool          fStreaming;
 
     typedef Benchmark INHERITED;
 };
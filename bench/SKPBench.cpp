@@ -21,17 +21,21 @@ DEFINE_int32(GPUbenchTileW, 1600, "Tile width  used for GPU SKP playback.");
 DEFINE_int32(GPUbenchTileH, 512, "Tile height used for GPU SKP playback.");
 
 SKPBench::SKPBench(const char* name, const SkPicture* pic, const SkIRect& clip, SkScalar scale,
-                   bool useMultiPictureDraw, bool doLooping)
+                   bool useMultiPictureDraw, bool doLooping, SkExecutor* parallelExecutor)
     : fPic(SkRef(pic))
     , fClip(clip)
     , fScale(scale)
     , fName(name)
     , fUseMultiPictureDraw(useMultiPictureDraw)
-    , fDoLooping(doLooping) {
+    , fDoLooping(doLooping)
+    , fParallelExecutor(parallelExecutor) {
     fUniqueName.printf("%s_%.2g", name, scale);  // Scale makes this unqiue for perf.skia.org traces.
     if (useMultiPictureDraw) {
         fUniqueName.append("_mpd");
     }
+    if (parallelExecutor) {
+        fUniqueName.append("_parallel");
+    }
 }
 
 SKPBench::~SKPBench() {
@@ -99,6 +103,10 @@ void SKPBench::onPerCanvasPostDraw(SkCanvas* canvas) {
 }
 
 bool SKPBench::isSuitableFor(Backend backend) {
+    if (fParallelExecutor) {
+        // Only raster tiles can be drawn from several threads at once.
+        return backend == kRaster_Backend;
+    }
     return backend != kNonRendering_Backend;
 }
 
@@ -109,7 +117,9 @@ SkIPoint SKPBench::onGetSize() {
 void SKPBench::onDraw(int loops, SkCanvas* canvas) {
     SkASSERT(fDoLooping || 1 == loops);
     while (1) {
-        if (fUseMultiPictureDraw) {
+        if (fParallelExecutor) {
+            this->drawParallelPicture();
+        } else if (fUseMultiPictureDraw) {
             this->drawMPDPicture();
         } else {
             this->drawPicture();
@@ -150,6 +160,16 @@ void SKPBench::drawPicture() {
     }
 }
 
+void SKPBench::drawParallelPicture() {
+    // The tile canvases already hold the scale; playbackParallel() adds each tile's offset.
+    fPic->playbackParallel(fTileRects.begin(), fTileRects.count(), *fParallelExecutor,
+                           [this](int j, const SkIRect&) { return fSurfaces[j]->getCanvas(); });
+
+    for (int j = 0; j < fTileRects.count(); ++j) {
+        fSurfaces[j]->getCanvas()->flush();
+    }
+}
+
 #include "GrGpu.h"
 static void draw_pic_for_stats(SkCanvas* canvas, GrContext* context, const SkPicture* picture,
                                SkTArray<SkString>* keys, SkTArray<double>* values,
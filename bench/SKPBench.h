@@ -13,15 +13,18 @@
 #include "SkPicture.h"
 #include "SkTDArray.h"
 
+class SkExecutor;
 class SkSurface;
 
 /**
  * Runs an SkPicture as a benchmark by repeatedly drawing it scaled inside a device clip.
+ * If parallelExecutor is set, raster tiles are replayed concurrently with
+ * SkPicture::playbackParallel() instead of one after another.
  */
 class SKPBench : public Benchmark {
 public:
     SKPBench(const char* name, const SkPicture*, const SkIRect& devClip, SkScalar scale,
-             bool useMultiPictureDraw, bool doLooping);
+             bool useMultiPictureDraw, bool doLooping, SkExecutor* parallelExecutor = nullptr);
     ~SKPBench() override;
 
     int calculateLoops(int defaultLoops) const override {
@@ -41,6 +44,7 @@ protected:
 
     virtual void drawMPDPicture();
     virtual void drawPicture();
+    virtual void drawParallelPicture();
 
     const SkPicture* picture() const { return fPic.get(); }
     const SkTArray<sk_sp<SkSurface>>& surfaces() const { return fSurfaces; }
@@ -58,6 +62,7 @@ private:
     SkTDArray<SkIRect> fTileRects;     // for MultiPictureDraw
 
     const bool fDoLooping;
+    SkExecutor* const fParallelExecutor;
 
     typedef Benchmark INHERITED;
 };
@@ -10,6 +10,7 @@
 
 #include "Benchmark.h"
 #include "SkCanvas.h"
+#include "SkExecutor.h"
 #include "SkStrikeCache.h"
 #include "SkGraphics.h"
 #include "SkTaskGroup.h"
@@ -111,7 +112,65 @@ private:
     SkString fName;
 };
 
+// Runs a fixed amount of text work spread over a pool of the given number of threads, so the
+// time per loop across thread counts shows how throughput scales with contention on the strike
+// cache and the font host.
+class SkGlyphCacheThreadedBench : public Benchmark {
+public:
+    explicit SkGlyphCacheThreadedBench(int threads) : fThreads(threads) {
+        fName.printf("SkGlyphCacheThreaded_%d", fThreads);
+    }
+
+protected:
+    const char* onGetName() override {
+        return fName.c_str();
+    }
+
+    bool isSuitableFor(Backend backend) override {
+        return backend == kNonRendering_Backend;
+    }
+
+    void onDelayedSetup() override {
+        fExecutor = SkExecutor::MakeFIFOThreadPool(fThreads);
+        fTypefaces[0] = sk_tool_utils::create_portable_typeface("serif", SkFontStyle::Italic());
+        fTypefaces[1] = sk_tool_utils::create_portable_typeface("sans-serif", SkFontStyle::Italic());
+        fTypefaces[2] = sk_tool_utils::create_portable_typeface("monospace", SkFontStyle::Normal());
+        fTypefaces[3] = sk_tool_utils::create_portable_typeface("serif", SkFontStyle::Bold());
+    }
+
+    void onDraw(int loops, SkCanvas*) override {
+        size_t oldCacheLimitSize = SkGraphics::GetFontCacheLimit();
+        SkGraphics::SetFontCacheLimit(32 * 1024 * 1024);
+
+        for (int work = 0; work < loops; work++) {
+            SkTaskGroup(*fExecutor).batch(kWorkUnits, [&](int unit) {
+                SkFont font;
+                font.setEdging(SkFont::Edging::kAntiAlias);
+                font.setSubpixel(true);
+                font.setTypeface(fTypefaces[unit % SK_ARRAY_COUNT(fTypefaces)]);
+                // Skew each unit so that different units want different strikes at a time.
+                font.setSkewX(SkIntToScalar(unit / SK_ARRAY_COUNT(fTypefaces)) / 16);
+                do_font_stuff(&font);
+            });
+        }
+        SkGraphics::SetFontCacheLimit(oldCacheLimitSize);
+    }
+
+private:
+    static constexpr int kWorkUnits = 32;
+
+    typedef Benchmark INHERITED;
+    const int                   fThreads;
+    SkString                    fName;
+    std::unique_ptr<SkExecutor> fExecutor;
+    sk_sp<SkTypeface>           fTypefaces[4];
+};
+
 DEF_BENCH( return new SkGlyphCacheBasic(256 * 1024); )
 DEF_BENCH( return new SkGlyphCacheBasic(32 * 1024 * 1024); )
 DEF_BENCH( return new SkGlyphCacheStressTest(256 * 1024); )
 DEF_BENCH( return new SkGlyphCacheStressTest(32 * 1024 * 1024); )
+DEF_BENCH( return new SkGlyphCacheThreadedBench(1); )
+DEF_BENCH( return new SkGlyphCacheThreadedBench(4); )
+DEF_BENCH( return new SkGlyphCacheThreadedBench(16); )
+DEF_BENCH( return new SkGlyphCacheThreadedBench(32); )
@@ -0,0 +1,114 @@
+/*
+ * Copyright 2018 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "Benchmark.h"
+
+#if SK_SUPPORT_GPU
+
+#include "SkSLCompiler.h"
+#include "SkSLInterpreter.h"
+
+// Runs an SkSL pipeline stage over a row of pixels, with its callbacks either walking the IR
+// tree one pixel at a time or running as bytecode over a whole pipeline stride at once.
+class SkSLInterpreterBench : public Benchmark {
+public:
+    SkSLInterpreterBench(const char* name, const char* src, bool byteCode)
+        : fName(SkStringPrintf("sksl_interpreter_%s_%s", name, byteCode ? "bytecode" : "tree"))
+        , fSrc(src)
+        , fByteCode(byteCode) {}
+
+    bool isSuitableFor(Backend backend) override { return backend == kNonRendering_Backend; }
+
+protected:
+    const char* onGetName() override { return fName.c_str(); }
+
+    void onDelayedSetup() override {
+        for (int i = 0; i < kWidth; ++i) {
+            fSrcPixels[4 * i + 0] = i / (kWidth - 1.0f);
+            fSrcPixels[4 * i + 1] = 1 - i / (kWidth - 1.0f);
+            fSrcPixels[4 * i + 2] = (i % 7) / 6.0f;
+            fSrcPixels[4 * i + 3] = 1;
+        }
+        std::unique_ptr<SkSL::Program> program = fCompiler.convertProgram(
+                                                                 SkSL::Program::kPipelineStage_Kind,
+                                                                 SkSL::String(fSrc),
+                                                                 SkSL::Program::Settings());
+        SkASSERT(program);
+        fSrcCtx = { fSrcPixels, 0 };
+        fDstCtx = { fDstPixels, 0 };
+        fPipeline.append(SkRasterPipeline::load_f32, &fSrcCtx);
+        fInterpreter.reset(new SkSL::Interpreter(std::move(program), &fPipeline, &fStack));
+        fInterpreter->setByteCodeEnabled(fByteCode);
+        fInterpreter->run();
+        fPipeline.append(SkRasterPipeline::store_f32, &fDstCtx);
+    }
+
+    void onDraw(int loops, SkCanvas*) override {
+        while (loops --> 0) {
+            fPipeline.run(0, 0, kWidth, 1);
+        }
+    }
+
+private:
+    static constexpr int kWidth = 256;
+
+    SkString                              fName;
+    const char*                           fSrc;
+    bool                                  fByteCode;
+    SkSL::Compiler                        fCompiler;
+    SkRasterPipeline_<256>                fPipeline;
+    std::vector<SkSL::Interpreter::Value> fStack;
+    std::unique_ptr<SkSL::Interpreter>    fInterpreter;
+    SkRasterPipeline_MemoryCtx            fSrcCtx, fDstCtx;
+    float                                 fSrcPixels[4 * kWidth];
+    float                                 fDstPixels[4 * kWidth];
+
+    typedef Benchmark INHERITED;
+};
+
+// A straight-line color matrix with clamping.
+static const char* kSaturate =
+    "void saturate(inout float r, inout float g, inout float b) {"
+    "    float l = 0.2126 * r + 0.7152 * g + 0.0722 * b;"
+    "    r = clamp(l + (r - l) * 1.5, 0, 1);"
+    "    g = clamp(l + (g - l) * 1.5, 0, 1);"
+    "    b = clamp(l + (b - l) * 1.5, 0, 1);"
+    "}"
+    "void appendStages(SkRasterPipeline p) { append(p, saturate); }";
+
+// Per-pixel branches that diverge within a stride.
+static const char* kPosterize =
+    "void posterize(inout float r, inout float g, inout float b) {"
+    "    if (r > 0.66) { r = 1; } else if (r > 0.33) { r = 0.5; } else { r = 0; }"
+    "    if (g > 0.66) { g = 1; } else if (g > 0.33) { g = 0.5; } else { g = 0; }"
+    "    b = b > 0.5 ? 1 : 0;"
+    "}"
+    "void appendStages(SkRasterPipeline p) { append(p, posterize); }";
+
+// A loop whose trip count differs per pixel.
+static const char* kGamma =
+    "void gamma(inout float r, inout float g, inout float b) {"
+    "    int n = int(b * 6) + 1;"
+    "    float rr = r;"
+    "    float gg = g;"
+    "    for (int i = 1; i < n; i++) {"
+    "        rr *= r;"
+    "        gg *= g;"
+    "    }"
+    "    r = rr;"
+    "    g = gg;"
+    "}"
+    "void appendStages(SkRasterPipeline p) { append(p, gamma); }";
+
+DEF_BENCH(return new SkSLInterpreterBench("saturate",  kSaturate,  false));
+DEF_BENCH(return new SkSLInterpreterBench("saturate",  kSaturate,  true));
+DEF_BENCH(return new SkSLInterpreterBench("posterize", kPosterize, false));
+DEF_BENCH(return new SkSLInterpreterBench("posterize", kPosterize, true));
+DEF_BENCH(return new SkSLInterpreterBench("gamma",     kGamma,     false));
+DEF_BENCH(return new SkSLInterpreterBench("gamma",     kGamma,     true));
+
+#endif
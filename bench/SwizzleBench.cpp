@@ -6,28 +6,39 @@
  */
 
 #include "Benchmark.h"
+#include "SkCodec.h"
+#include "SkEncodedInfo.h"
 #include "SkOpts.h"
+#include "SkRandom.h"
+#include "SkSwizzler.h"
 
 class SwizzleBench : public Benchmark {
 public:
 
-    SwizzleBench(const char* name, SkOpts::Swizzle_8888_u32 fn) : fName(name), fFn_u32(fn) {}
-    SwizzleBench(const char* name, SkOpts::Swizzle_8888_u8  fn) : fName(name), fFn_u8 (fn) {}
+    SwizzleBench(const char* name, SkOpts::Swizzle_8888_u32   fn) : fName(name), fFn_u32(fn) {}
+    SwizzleBench(const char* name, SkOpts::Swizzle_8888_u8    fn) : fName(name), fFn_u8 (fn) {}
+    SwizzleBench(const char* name, SkOpts::Swizzle_565_u8     fn) : fName(name), fFn_565(fn) {}
+    SwizzleBench(const char* name, SkOpts::Swizzle_8888_index fn) : fName(name), fFn_idx(fn) {}
 
     bool isSuitableFor(Backend backend) override { return backend == kNonRendering_Backend; }
     const char* onGetName() override { return fName; }
     void onDraw(int loops, SkCanvas*) override {
         static const int K = 1023; // Arbitrary, but nice to be a non-power-of-two to trip up SIMD.
-        uint32_t dst[K], src[K];
+        uint32_t dst[K], table[256];
+        uint64_t src[K];           // Room for the widest source pixels, 16-bit RGBA.
         while (loops --> 0) {
-            if (fFn_u32) { fFn_u32(dst,                 src, K); }
-            if (fFn_u8)  { fFn_u8 (dst, (const uint8_t*)src, K); }
+            if (fFn_u32) { fFn_u32(dst, (const uint32_t*)src, K); }
+            if (fFn_u8)  { fFn_u8 (dst, (const uint8_t*) src, K); }
+            if (fFn_565) { fFn_565((uint16_t*)dst, (const uint8_t*)src, K); }
+            if (fFn_idx) { fFn_idx(dst, (const uint8_t*)src, K, table); }
         }
     }
 private:
     const char* fName;
-    SkOpts::Swizzle_8888_u32 fFn_u32 = nullptr;
-    SkOpts::Swizzle_8888_u8  fFn_u8  = nullptr;
+    SkOpts::Swizzle_8888_u32   fFn_u32 = nullptr;
+    SkOpts::Swizzle_8888_u8    fFn_u8  = nullptr;
+    SkOpts::Swizzle_565_u8     fFn_565 = nullptr;
+    SkOpts::Swizzle_8888_index fFn_idx = nullptr;
 };
 
 
@@ -41,3 +52,122 @@ DEF_BENCH(return new SwizzleBench("SkOpts::grayA_to_RGBA", SkOpts::grayA_to_RGBA
 DEF_BENCH(return new SwizzleBench("SkOpts::grayA_to_rgbA", SkOpts::grayA_to_rgbA));
 DEF_BENCH(return new SwizzleBench("SkOpts::inverted_CMYK_to_RGB1", SkOpts::inverted_CMYK_to_RGB1));
 DEF_BENCH(return new SwizzleBench("SkOpts::inverted_CMYK_to_BGR1", SkOpts::inverted_CMYK_to_BGR1));
+DEF_BENCH(return new SwizzleBench("SkOpts::RGB16_to_RGB1",  SkOpts::RGB16_to_RGB1));
+DEF_BENCH(return new SwizzleBench("SkOpts::RGB16_to_BGR1",  SkOpts::RGB16_to_BGR1));
+DEF_BENCH(return new SwizzleBench("SkOpts::RGBA16_to_RGBA", SkOpts::RGBA16_to_RGBA));
+DEF_BENCH(return new SwizzleBench("SkOpts::RGBA16_to_BGRA", SkOpts::RGBA16_to_BGRA));
+DEF_BENCH(return new SwizzleBench("SkOpts::RGBA16_to_rgbA", SkOpts::RGBA16_to_rgbA));
+DEF_BENCH(return new SwizzleBench("SkOpts::RGBA16_to_bgrA", SkOpts::RGBA16_to_bgrA));
+DEF_BENCH(return new SwizzleBench("SkOpts::RGB_to_565",     SkOpts::RGB_to_565));
+DEF_BENCH(return new SwizzleBench("SkOpts::BGR_to_565",     SkOpts::BGR_to_565));
+DEF_BENCH(return new SwizzleBench("SkOpts::RGB16_to_565",   SkOpts::RGB16_to_565));
+DEF_BENCH(return new SwizzleBench("SkOpts::index_to_8888",  SkOpts::index_to_8888));
+
+// Swizzles a row through SkSwizzler, as a codec would, so sampled rows and the formats that
+// have no SkOpts function are measured too.
+class SwizzlerBench : public Benchmark {
+public:
+    SwizzlerBench(const char* srcName, SkEncodedInfo::Color color, SkEncodedInfo::Alpha alpha,
+                  int bitsPerComponent, SkColorType dstColorType, SkAlphaType dstAlphaType,
+                  int sampleX)
+        : fColor(color)
+        , fAlpha(alpha)
+        , fBitsPerComponent(bitsPerComponent)
+        , fDstColorType(dstColorType)
+        , fDstAlphaType(dstAlphaType)
+        , fSampleX(sampleX)
+    {
+        const char* dstName = kRGBA_8888_SkColorType == dstColorType ? "RGBA" :
+                              kBGRA_8888_SkColorType == dstColorType ? "BGRA" : "565";
+        fName.printf("Swizzler_%s_to_%s%s", srcName, dstName,
+                     kUnpremul_SkAlphaType == dstAlphaType ? "_unpremul" : "");
+        if (sampleX > 1) {
+            fName.appendf("_sample%d", sampleX);
+        }
+    }
+
+    bool isSuitableFor(Backend backend) override { return backend == kNonRendering_Backend; }
+    const char* onGetName() override { return fName.c_str(); }
+
+    void onDelayedSetup() override {
+        SkEncodedInfo info = SkEncodedInfo::Make(kWidth, 1, fColor, fAlpha, fBitsPerComponent);
+        SkImageInfo dstInfo = SkImageInfo::Make(kWidth, 1, fDstColorType, fDstAlphaType);
+
+        SkRandom rand;
+        for (SkPMColor& c : fTable) {
+            c = rand.nextU();
+        }
+        fSrc.reset(kWidth * 8);
+        for (int i = 0; i < kWidth * 8; i++) {
+            fSrc[i] = rand.nextU();
+        }
+        fDst.reset(kWidth);
+
+        fSwizzler = SkSwizzler::Make(info, fTable, dstInfo, SkCodec::Options());
+        SkASSERT(fSwizzler);
+        fSwizzler->setSampleX(fSampleX);
+    }
+
+    void onDraw(int loops, SkCanvas*) override {
+        while (loops --> 0) {
+            fSwizzler->swizzle(fDst.get(), fSrc.get());
+        }
+    }
+
+private:
+    static const int kWidth = 1023;
+
+    SkString                    fName;
+    const SkEncodedInfo::Color  fColor;
+    const SkEncodedInfo::Alpha  fAlpha;
+    const int                   fBitsPerComponent;
+    const SkColorType           fDstColorType;
+    const SkAlphaType           fDstAlphaType;
+    const int                   fSampleX;
+    SkPMColor                   fTable[256];
+    SkAutoTMalloc<uint8_t>      fSrc;
+    SkAutoTMalloc<uint32_t>     fDst;
+    std::unique_ptr<SkSwizzler> fSwizzler;
+};
+
+#define SWIZZLER_BENCH(name, color, alpha, bpc, ct, at, sampleX) \
+    DEF_BENCH(return new SwizzlerBench(name, color, alpha, bpc, ct, at, sampleX);)
+
+#define SWIZZLER_BENCHES(name, color, bpc)                                                      \
+    SWIZZLER_BENCH(name, color, SkEncodedInfo::kOpaque_Alpha, bpc,                              \
+                   kRGBA_8888_SkColorType, kOpaque_SkAlphaType, 1)                              \
+    SWIZZLER_BENCH(name, color, SkEncodedInfo::kOpaque_Alpha, bpc,                              \
+                   kBGRA_8888_SkColorType, kOpaque_SkAlphaType, 1)                              \
+    SWIZZLER_BENCH(name, color, SkEncodedInfo::kOpaque_Alpha, bpc,                              \
+                   kRGB_565_SkColorType,   kOpaque_SkAlphaType, 1)                              \
+    SWIZZLER_BENCH(name, color, SkEncodedInfo::kOpaque_Alpha, bpc,                              \
+                   kRGBA_8888_SkColorType, kOpaque_SkAlphaType, 2)                              \
+    SWIZZLER_BENCH(name, color, SkEncodedInfo::kOpaque_Alpha, bpc,                              \
+                   kRGB_565_SkColorType,   kOpaque_SkAlphaType, 4)
+
+SWIZZLER_BENCHES("gray",  SkEncodedInfo::kGray_Color,          8)
+SWIZZLER_BENCHES("index", SkEncodedInfo::kPalette_Color,       8)
+SWIZZLER_BENCHES("RGB",   SkEncodedInfo::kRGB_Color,           8)
+SWIZZLER_BENCHES("BGR",   SkEncodedInfo::kBGR_Color,           8)
+SWIZZLER_BENCHES("RGB16", SkEncodedInfo::kRGB_Color,          16)
+SWIZZLER_BENCHES("CMYK",  SkEncodedInfo::kInvertedCMYK_Color,  8)
+
+// 565 destinations are not supported for sources with alpha.
+#define SWIZZLER_ALPHA_BENCHES(name, color, bpc)                                                \
+    SWIZZLER_BENCH(name, color, SkEncodedInfo::kUnpremul_Alpha, bpc,                            \
+                   kRGBA_8888_SkColorType, kPremul_SkAlphaType,   1)                            \
+    SWIZZLER_BENCH(name, color, SkEncodedInfo::kUnpremul_Alpha, bpc,                            \
+                   kBGRA_8888_SkColorType, kPremul_SkAlphaType,   1)                            \
+    SWIZZLER_BENCH(name, color, SkEncodedInfo::kUnpremul_Alpha, bpc,                            \
+                   kRGBA_8888_SkColorType, kUnpremul_SkAlphaType, 1)                            \
+    SWIZZLER_BENCH(name, color, SkEncodedInfo::kUnpremul_Alpha, bpc,                            \
+                   kBGRA_8888_SkColorType, kUnpremul_SkAlphaType, 1)                            \
+    SWIZZLER_BENCH(name, color, SkEncodedInfo::kUnpremul_Alpha, bpc,                            \
+                   kRGBA_8888_SkColorType, kPremul_SkAlphaType,   2)                            \
+    SWIZZLER_BENCH(name, color, SkEncodedInfo::kUnpremul_Alpha, bpc,                            \
+                   kBGRA_8888_SkColorType, kUnpremul_SkAlphaType, 3)
+
+SWIZZLER_ALPHA_BENCHES("grayA",  SkEncodedInfo::kGrayAlpha_Color,  8)
+SWIZZLER_ALPHA_BENCHES("RGBA",   SkEncodedInfo::kRGBA_Color,       8)
+SWIZZLER_ALPHA_BENCHES("BGRA",   SkEncodedInfo::kBGRA_Color,       8)
+SWIZZLER_ALPHA_BENCHES("RGBA16", SkEncodedInfo::kRGBA_Color,      16)
@@ -34,12 +34,15 @@
 #include "SkData.h"
 #include "SkDebugfTracer.h"
 #include "SkEventTracingPriv.h"
+#include "SkExecutor.h"
 #include "SkGraphics.h"
 #include "SkJSONWriter.h"
 #include "SkLeanWindows.h"
 #include "SkOSFile.h"
 #include "SkOSPath.h"
 #include "SkPictureRecorder.h"
+#include "SkPictureStreamReader.h"
+#include "SkRasterPipeline.h"
 #include "SkScan.h"
 #include "SkString.h"
 #include "SkSurface.h"
@@ -122,9 +125,17 @@ DEFINE_string(scales, "1.0", "Space-separated scales for SKPs.");
 DEFINE_string(zoom, "1.0,0", "Comma-separated zoomMax,zoomPeriodMs factors for a periodic SKP zoom "
                              "function that ping-pongs between 1.0 and zoomMax.");
 DEFINE_bool(bbh, true, "Build a BBH for SKPs?");
+DEFINE_bool(mmapSKPs, false, "Load SKPs in place from mapped files instead of copying them out?");
+DEFINE_bool(optimizeSKPs, false, "Merge clips and cull occluded draws in SKPs before playback?");
 DEFINE_bool(lite, false, "Use SkLiteRecorder in recording benchmarks?");
 DEFINE_bool(mpd, true, "Use MultiPictureDraw for the SKPs?");
 DEFINE_bool(loopSKP, true, "Loop SKPs like we do for micro benches?");
+DEFINE_bool(parallelSKP, false, "Also replay SKP tiles concurrently with "
+                                "SkPicture::playbackParallel, using --backendThreads threads?");
+DEFINE_string(codecThreads, "0", "Space-separated thread counts to decode images with in "
+                                "CodecBench.  0 decodes without an executor.  If any count is "
+                                "nonzero, every count decodes to Display P3, so that each image "
+                                "has a color xform to run on the executor.");
 DEFINE_int32(flushEvery, 10, "Flush --outResultsFile every Nth run.");
 DEFINE_bool(gpuStats, false, "Print GPU stats after each gpu benchmark?");
 DEFINE_bool(gpuStatsDump, false, "Dump GPU states after each benchmark to json");
@@ -136,6 +147,9 @@ DEFINE_string(benchType,  "",
         "Apply usual --match rules to bench type: micro, recording, piping, playback, skcodec, etc.");
 
 DEFINE_bool(forceRasterPipeline, false, "sets gSkForceRasterPipelineBlitter");
+DEFINE_int32(dumpPipelines, 0, "Print the N most frequently built raster pipelines at exit.");
+DEFINE_bool(pipelinePrecision, false, "Report how many raster pipelines each bench built to "
+                                      "run in lowp and in highp.");
 
 static double now_ms() { return SkTime::GetNSecs() * 1e-6; }
 
@@ -145,9 +159,20 @@ static SkString humanize(double ms) {
 }
 #define HUMANIZE(ms) humanize(ms).c_str()
 
+// The 'threaded' config rasterizes with its own pool of --backendThreads threads.
+static SkExecutor* threaded_raster_executor() {
+    static SkExecutor* gExecutor = SkExecutor::MakeFIFOThreadPool(FLAGS_backendThreads).release();
+    return gExecutor;
+}
+
 bool Target::init(SkImageInfo info, Benchmark* bench) {
     if (Benchmark::kRaster_Backend == config.backend) {
-        this->surface = SkSurface::MakeRaster(info);
+        if (config.name.equals("threaded")) {
+            this->surface = SkSurface::MakeRasterThreaded(info, threaded_raster_executor(),
+                                                          FLAGS_backendTiles);
+        } else {
+            this->surface = SkSurface::MakeRaster(info);
+        }
         if (!this->surface) {
             return false;
         }
@@ -476,6 +501,13 @@ static void create_config(const SkCommandLineConfig* config, SkTArray<Config>* c
     CPU_CONFIG(8888, kRaster_Backend,     kN32_SkColorType, kPremul_SkAlphaType, nullptr)
     CPU_CONFIG(565,  kRaster_Backend, kRGB_565_SkColorType, kOpaque_SkAlphaType, nullptr)
 
+    // Like 8888, but rasterized by SkSurface::MakeRasterThreaded() with --backendThreads threads
+    // and --backendTiles tiles.
+    CPU_CONFIG(threaded, kRaster_Backend, kN32_SkColorType, kPremul_SkAlphaType, nullptr)
+
+    // Like 8888, but with every raster pipeline forced to run in highp, to compare against 8888.
+    CPU_CONFIG(highp, kRaster_Backend, kN32_SkColorType, kPremul_SkAlphaType, nullptr)
+
     // 'narrow' has a gamut narrower than sRGB, and different transfer function.
     auto narrow = SkColorSpace::MakeRGB(SkNamedTransferFn::k2Dot2, gNarrow_toXYZD50),
            srgb = SkColorSpace::MakeSRGB(),
@@ -587,17 +619,28 @@ static void collect_files(const SkCommandLineFlags::StringArray& paths, const ch
     }
 }
 
+static uint32_t skp_finish_flags() {
+    uint32_t flags = 0;
+    if (FLAGS_optimizeSKPs) {
+        flags |= SkPictureRecorder::kOptimizeClipsAndOcclusion_FinishFlag;
+    }
+    return flags;
+}
+
 class BenchmarkStream {
 public:
     BenchmarkStream() : fBenches(BenchRegistry::Head())
                       , fGMs(skiagm::GMRegistry::Head())
                       , fCurrentRecording(0)
                       , fCurrentDeserialPicture(0)
+                      , fCurrentFirstPixelPicture(0)
                       , fCurrentScale(0)
                       , fCurrentSKP(0)
                       , fCurrentSVG(0)
                       , fCurrentUseMPD(0)
+                      , fDidParallelSKP(false)
                       , fCurrentCodec(0)
+                      , fCurrentCodecThreads(0)
                       , fCurrentAndroidCodec(0)
                       , fCurrentBRDImage(0)
                       , fCurrentColorType(0)
@@ -643,6 +686,15 @@ public:
             fColorTypes.push_back(kAlpha_8_SkColorType);
             fColorTypes.push_back(kGray_8_SkColorType);
         }
+
+        // An executor only helps a decode with rows to swizzle or color transform, so when
+        // comparing thread counts, give every image a color xform.
+        for (int i = 0; i < FLAGS_codecThreads.count(); i++) {
+            if (atoi(FLAGS_codecThreads[i]) > 0) {
+                fCodecColorSpace = SkColorSpace::MakeRGB(SkNamedTransferFn::kSRGB,
+                                                         SkNamedGamut::kDCIP3);
+            }
+        }
     }
 
     static sk_sp<SkPicture> ReadPicture(const char* path) {
@@ -652,6 +704,15 @@ public:
             return nullptr;
         }
 
+        if (FLAGS_mmapSKPs) {
+            sk_sp<SkData> data = SkData::MakeFromFileName(path);
+            if (!data) {
+                SkDebugf("Could not read %s.\n", path);
+                return nullptr;
+            }
+            return SkPictureStreamReader::MakeFromData(std::move(data));
+        }
+
         std::unique_ptr<SkStream> stream = SkStream::MakeFromFile(path);
         if (!stream) {
             SkDebugf("Could not read %s.\n", path);
@@ -749,7 +810,23 @@ public:
             fBenchType  = "deserial";
             fSKPBytes = static_cast<double>(data->size());
             fSKPOps   = 0;
-            return new DeserializePictureBench(name.c_str(), std::move(data));
+            return new DeserializePictureBench(name.c_str(), std::move(data), FLAGS_mmapSKPs);
+        }
+
+        // Compare loading and playing back each .skp all at once against streaming it in.
+        while (fCurrentFirstPixelPicture < 2 * fSKPs.count()) {
+            const bool streaming = fCurrentFirstPixelPicture % 2;
+            const SkString& path = fSKPs[fCurrentFirstPixelPicture++ / 2];
+            sk_sp<SkData> data = SkData::MakeFromFileName(path.c_str());
+            if (!data) {
+                continue;
+            }
+            SkString name = SkOSPath::Basename(path.c_str());
+            fSourceType = "skp";
+            fBenchType  = "first_pixel";
+            fSKPBytes = static_cast<double>(data->size());
+            fSKPOps   = 0;
+            return new FirstPixelPictureBench(name.c_str(), std::move(data), streaming);
         }
 
         // Then once each for each scale as SKPBenches (playback).
@@ -762,23 +839,46 @@ public:
                     continue;
                 }
 
+                // The SKP we read off disk doesn't have a BBH.  Re-record so it grows one.
+                // Parallel playback always wants one, so each tile only replays its own ops.
+                // Any extra optimizations run as we re-record too.
+                auto reRecord = [](sk_sp<SkPicture> pic, bool bbh) {
+                    SkRTreeFactory factory;
+                    SkPictureRecorder recorder;
+                    pic->playback(recorder.beginRecording(pic->cullRect().width(),
+                                                          pic->cullRect().height(),
+                                                          bbh ? &factory : nullptr,
+                                                          0));
+                    return recorder.finishRecordingAsPicture(skp_finish_flags());
+                };
+
                 while (fCurrentUseMPD < fUseMPDs.count()) {
-                    if (FLAGS_bbh) {
-                        // The SKP we read off disk doesn't have a BBH.  Re-record so it grows one.
-                        SkRTreeFactory factory;
-                        SkPictureRecorder recorder;
-                        pic->playback(recorder.beginRecording(pic->cullRect().width(),
-                                                              pic->cullRect().height(),
-                                                              &factory,
-                                                              0));
-                        pic = recorder.finishRecordingAsPicture();
+                    const int originalOps = pic->approximateOpCount();
+                    if (FLAGS_bbh || skp_finish_flags()) {
+                        pic = reRecord(std::move(pic), FLAGS_bbh);
                     }
                     SkString name = SkOSPath::Basename(path.c_str());
+                    fSKPOps = pic->approximateOpCount();
+                    if (skp_finish_flags() && 0 == fCurrentUseMPD && 0 == fCurrentScale) {
+                        SkDebugf("%s: %d ops optimized to %d\n",
+                                 name.c_str(), originalOps, (int)fSKPOps);
+                    }
                     fSourceType = "skp";
                     fBenchType = "playback";
                     return new SKPBench(name.c_str(), pic.get(), fClip, fScales[fCurrentScale],
                                         fUseMPDs[fCurrentUseMPD++], FLAGS_loopSKP);
                 }
+                if (FLAGS_parallelSKP && !fDidParallelSKP) {
+                    fDidParallelSKP = true;
+                    pic = reRecord(std::move(pic), true);
+                    SkString name = SkOSPath::Basename(path.c_str());
+                    fSKPOps = pic->approximateOpCount();
+                    fSourceType = "skp";
+                    fBenchType = "playback";
+                    return new SKPBench(name.c_str(), pic.get(), fClip, fScales[fCurrentScale],
+                                        false, FLAGS_loopSKP, threaded_raster_executor());
+                }
+                fDidParallelSKP = false;
                 fCurrentUseMPD = 0;
                 fCurrentSKP++;
             }
@@ -868,9 +968,10 @@ public:
                     }
                 }
 
-                // Make sure we can decode to this color type and alpha type.
-                SkImageInfo info =
-                        codec->getInfo().makeColorType(colorType).makeAlphaType(alphaType);
+                // Make sure we can decode to this color type, alpha type and color space.
+                SkImageInfo info = codec->getInfo().makeColorType(colorType)
+                                                   .makeAlphaType(alphaType)
+                                                   .makeColorSpace(fCodecColorSpace);
                 const size_t rowBytes = info.minRowBytes();
                 SkAutoMalloc storage(info.computeByteSize(rowBytes));
 
@@ -880,7 +981,9 @@ public:
                     case SkCodec::kSuccess:
                     case SkCodec::kIncompleteInput:
                         return new CodecBench(SkOSPath::Basename(path.c_str()),
-                                              encoded.get(), colorType, alphaType);
+                                              encoded.get(), colorType, alphaType,
+                                              atoi(FLAGS_codecThreads[fCurrentCodecThreads]),
+                                              fCodecColorSpace);
                     case SkCodec::kInvalidConversion:
                         // This is okay. Not all conversions are valid.
                         break;
@@ -891,6 +994,14 @@ public:
                 }
             }
             fCurrentColorType = 0;
+
+            // Go through this image again for each of --codecThreads.
+            if (fCurrentCodecThreads + 1 < FLAGS_codecThreads.count()) {
+                fCurrentCodecThreads++;
+                fCurrentCodec--;
+            } else {
+                fCurrentCodecThreads = 0;
+            }
         }
 
         // Run AndroidCodecBenches
@@ -930,9 +1041,10 @@ public:
         // android/libraries/social/tiledimage.  In this library, an image is decoded in 512x512
         // tiles.  The image can be translated freely, so the location of a tile may be anywhere in
         // the image.  For that reason, we will benchmark decodes in five representative locations
-        // in the image.  Additionally, this use case utilizes power of two scaling, so we will
-        // test on power of two sample sizes.  The output tile is always 512x512, so, when a
-        // sampleSize is used, the size of the subset that is decoded is always
+        // in the image, and at a sequence of random locations, each with a new decoder for the
+        // same data (as a tile server would make).  Additionally, this use case utilizes power of
+        // two scaling, so we will test on power of two sample sizes.  The output tile is always
+        // 512x512, so, when a sampleSize is used, the size of the subset that is decoded is always
         // (sampleSize*512)x(sampleSize*512).
         // There are a few good reasons to only test on power of two sample sizes at this time:
         //     All use cases we are aware of only scale by powers of two.
@@ -967,6 +1079,7 @@ public:
 
                         SkString basename = SkOSPath::Basename(path.c_str());
                         SkIRect subset;
+                        bool randomSubsets = false;
                         const uint32_t subsetSize = sampleSize * minOutputSize;
                         switch (currentSubsetType) {
                             case kTopLeft_SubsetType:
@@ -993,12 +1106,17 @@ public:
                                 subset = SkIRect::MakeXYWH(width - subsetSize,
                                         height - subsetSize, subsetSize, subsetSize);
                                 break;
+                            case kRandom_SubsetType:
+                                basename.append("_Random");
+                                subset = SkIRect::MakeWH(subsetSize, subsetSize);
+                                randomSubsets = true;
+                                break;
                             default:
                                 SkASSERT(false);
                         }
 
                         return new BitmapRegionDecoderBench(basename.c_str(), encoded.get(),
-                                colorType, sampleSize, subset);
+                                colorType, sampleSize, subset, randomSubsets);
                     }
                     fCurrentSubsetType = 0;
                     fCurrentSampleSize++;
@@ -1021,7 +1139,9 @@ public:
                                                   fClip.fRight, fClip.fBottom).c_str());
             SkASSERT_RELEASE(fCurrentScale < fScales.count());  // debugging paranoia
             log.appendString("scale", SkStringPrintf("%.2g", fScales[fCurrentScale]).c_str());
-            if (fCurrentUseMPD > 0) {
+            if (fDidParallelSKP) {
+                log.appendString("parallel_playback", "true");
+            } else if (fCurrentUseMPD > 0) {
                 SkASSERT(1 == fCurrentUseMPD || 2 == fCurrentUseMPD);
                 log.appendString("multi_picture_draw",
                                  fUseMPDs[fCurrentUseMPD-1] ? "true" : "false");
@@ -1033,6 +1153,10 @@ public:
         if (0 == strcmp(fBenchType, "recording")) {
             log.appendMetric("bytes", fSKPBytes);
             log.appendMetric("ops", fSKPOps);
+        } else if (0 == strcmp(fBenchType, "playback") && 0 == strcmp(fSourceType, "skp") &&
+                   skp_finish_flags()) {
+            // Compare against the recording bench's ops to see what the optimizations removed.
+            log.appendMetric("ops", fSKPOps);
         }
     }
 
@@ -1043,10 +1167,11 @@ private:
         kMiddle_SubsetType      = 2,
         kBottomLeft_SubsetType  = 3,
         kBottomRight_SubsetType = 4,
-        kTranslate_SubsetType   = 5,
-        kZoom_SubsetType        = 6,
+        kRandom_SubsetType      = 5,
+        kTranslate_SubsetType   = 6,
+        kZoom_SubsetType        = 7,
         kLast_SubsetType        = kZoom_SubsetType,
-        kLastSingle_SubsetType  = kBottomRight_SubsetType,
+        kLastSingle_SubsetType  = kRandom_SubsetType,
     };
 
     const BenchRegistry* fBenches;
@@ -1058,6 +1183,7 @@ private:
     SkTArray<bool>     fUseMPDs;
     SkTArray<SkString> fImages;
     SkTArray<SkColorType, true> fColorTypes;
+    sk_sp<SkColorSpace> fCodecColorSpace;  // Codec benches decode to this, if set.
     SkScalar           fZoomMax;
     double             fZoomPeriodMs;
 
@@ -1067,11 +1193,14 @@ private:
     const char* fBenchType;   // How we bench it: micro, recording, playback, ...
     int fCurrentRecording;
     int fCurrentDeserialPicture;
+    int fCurrentFirstPixelPicture;
     int fCurrentScale;
     int fCurrentSKP;
     int fCurrentSVG;
     int fCurrentUseMPD;
+    bool fDidParallelSKP;
     int fCurrentCodec;
+    int fCurrentCodecThreads;
     int fCurrentAndroidCodec;
     int fCurrentBRDImage;
     int fCurrentColorType;
@@ -1197,6 +1326,8 @@ int main(int argc, char** argv) {
     if (FLAGS_forceRasterPipeline) {
         gSkForceRasterPipelineBlitter = true;
     }
+    gSkCountRasterPipelinePrecision = FLAGS_pipelinePrecision;
+    gSkCountRasterPipelineSequences = FLAGS_dumpPipelines > 0;
 
     int runs = 0;
     BenchmarkStream benchStream;
@@ -1233,6 +1364,7 @@ int main(int argc, char** argv) {
             TRACE_EVENT2("skia", "Benchmark", "name", TRACE_STR_COPY(bench->getUniqueName()),
                                               "config", TRACE_STR_COPY(config));
 
+            gSkForceRasterPipelineHighp = configs[i].name.equals("highp");
             target->setup();
             bench->perCanvasPreDraw(canvas);
 
@@ -1256,6 +1388,9 @@ int main(int argc, char** argv) {
                 } while (now_ms() < stop);
             }
 
+            gSkRasterPipelineLowpCount  = 0;
+            gSkRasterPipelineHighpCount = 0;
+
             if (FLAGS_ms) {
                 samples.reset();
                 auto stop = now_ms() + FLAGS_ms;
@@ -1269,6 +1404,10 @@ int main(int argc, char** argv) {
                 }
             }
 
+            // Pipelines built while timing the samples, so these scale with the samples' loops.
+            const int lowpPipelines  = gSkRasterPipelineLowpCount,
+                      highpPipelines = gSkRasterPipelineHighpCount;
+
             SkTArray<SkString> keys;
             SkTArray<double> values;
             bool gpuStatsDump = FLAGS_gpuStatsDump && Benchmark::kGPU_Backend == configs[i].backend;
@@ -1276,6 +1415,7 @@ int main(int argc, char** argv) {
                 // TODO cache stats
                 bench->getGpuStats(canvas, &keys, &values);
             }
+            bench->getMetrics(&keys, &values);
 
             bench->perCanvasPostDraw(canvas);
 
@@ -1308,12 +1448,14 @@ int main(int argc, char** argv) {
             }
             log.endArray(); // samples
             benchStream.fillCurrentMetrics(log);
-            if (gpuStatsDump) {
-                // dump to json, only SKPBench currently returns valid keys / values
-                SkASSERT(keys.count() == values.count());
-                for (int i = 0; i < keys.count(); i++) {
-                    log.appendMetric(keys[i].c_str(), values[i]);
-                }
+            if (FLAGS_pipelinePrecision) {
+                log.appendMetric("lowp_pipelines", lowpPipelines);
+                log.appendMetric("highp_pipelines", highpPipelines);
+            }
+            // dump to json, GPU stats if asked for and whatever else the bench measured
+            SkASSERT(keys.count() == values.count());
+            for (int i = 0; i < keys.count(); i++) {
+                log.appendMetric(keys[i].c_str(), values[i]);
             }
 
             log.endObject(); // config
@@ -1375,6 +1517,15 @@ int main(int argc, char** argv) {
                 target->dumpStats();
             }
 
+            if (FLAGS_pipelinePrecision && lowpPipelines + highpPipelines > 0) {
+                SkDebugf("\t%d lowp, %d highp raster pipelines (%.0f%% lowp)\t%s\t%s\n"
+                         , lowpPipelines
+                         , highpPipelines
+                         , 100.0 * lowpPipelines / (lowpPipelines + highpPipelines)
+                         , bench->getUniqueName()
+                         , config);
+            }
+
             if (FLAGS_verbose) {
                 SkDebugf("Samples:  ");
                 for (int i = 0; i < samples.count(); i++) {
@@ -1391,6 +1542,10 @@ int main(int argc, char** argv) {
 
     SkGraphics::PurgeAllCaches();
 
+    if (FLAGS_dumpPipelines > 0) {
+        SkRasterPipeline::DumpSequenceCounts(FLAGS_dumpPipelines);
+    }
+
     log.beginBench("memory_usage", 0, 0);
     log.beginObject("meta"); // config
     log.appendS32("max_rss_mb", sk_tools::getMaxResidentSetSizeMB());
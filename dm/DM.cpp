@@ -32,7 +32,9 @@
 #include "SkMutex.h"
 #include "SkOSFile.h"
 #include "SkOSPath.h"
+#include "SkPictureRecorder.h"
 #include "SkPngEncoder.h"
+#include "SkRasterPipeline.h"
 #include "SkScan.h"
 #include "SkSpinlock.h"
 #include "SkTestFontMgr.h"
@@ -88,6 +90,7 @@ DEFINE_int32(shard,  0, "Which shard do I run?");
 
 DEFINE_string(mskps, "", "Directory to read mskps from, or a single mskp file.");
 DEFINE_bool(forceRasterPipeline, false, "sets gSkForceRasterPipelineBlitter");
+DEFINE_int32(dumpPipelines, 0, "Print the N most frequently built raster pipelines at exit.");
 
 DEFINE_string(bisect, "",
         "Pair of: SKP file to bisect, followed by an l/r bisect trail string (e.g., 'lrll'). The "
@@ -900,6 +903,9 @@ static Sink* create_sink(const GrContextOptions& grCtxOptions, const SkCommandLi
         SINK("565",     RasterSink, kRGB_565_SkColorType);
         SINK("4444",    RasterSink, kARGB_4444_SkColorType);
         SINK("8888",    RasterSink, kN32_SkColorType);
+        SINK("threaded", ThreadedSink, kN32_SkColorType);
+        SINK("daa",     DeltaAASink, kN32_SkColorType);
+        SINK("parallelpic", ParallelPictureSink, kN32_SkColorType);
         SINK("rgba",    RasterSink, kRGBA_8888_SkColorType);
         SINK("bgra",    RasterSink, kBGRA_8888_SkColorType);
         SINK("rgbx",    RasterSink, kRGB_888x_SkColorType);
@@ -947,11 +953,14 @@ static Sink* create_via(const SkString& tag, Sink* wrapped) {
     VIA("p3",        ViaCSXform,           wrapped,
                      SkColorSpace::MakeRGB(SkNamedTransferFn::kSRGB, SkNamedGamut::kDCIP3), false);
     VIA("lite",      ViaLite,              wrapped);
+    VIA("highp",     ViaHighp,             wrapped);
 #ifdef TEST_VIA_SVG
     VIA("svg",       ViaSVG,               wrapped);
 #endif
     VIA("serialize", ViaSerialization,     wrapped);
     VIA("pic",       ViaPicture,           wrapped);
+    VIA("opt",       ViaOptimizedPicture,
+        SkPictureRecorder::kOptimizeClipsAndOcclusion_FinishFlag, wrapped);
     VIA("tiles",     ViaTiles, 256, 256, nullptr,            wrapped);
     VIA("tiles_rt",  ViaTiles, 256, 256, new SkRTreeFactory, wrapped);
 
@@ -1436,6 +1445,7 @@ int main(int argc, char** argv) {
     if (FLAGS_forceRasterPipeline) {
         gSkForceRasterPipelineBlitter = true;
     }
+    gSkCountRasterPipelineSequences = FLAGS_dumpPipelines > 0;
 
     // The bots like having a verbose.log to upload, so always touch the file even if --verbose.
     if (!FLAGS_writePath.isEmpty()) {
@@ -1519,6 +1529,10 @@ int main(int argc, char** argv) {
     // Make sure we've flushed all our results to disk.
     JsonWriter::DumpJson();
 
+    if (FLAGS_dumpPipelines > 0) {
+        SkRasterPipeline::DumpSequenceCounts(FLAGS_dumpPipelines);
+    }
+
     if (gFailures.count() > 0) {
         info("Failures:\n");
         for (int i = 0; i < gFailures.count(); i++) {
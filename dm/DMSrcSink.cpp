@@ -46,6 +46,7 @@
 #include "SkPictureRecorder.h"
 #include "SkPDFDocument.h"
 #include "SkRandom.h"
+#include "SkRasterPipeline.h"
 #include "SkRecordDraw.h"
 #include "SkRecorder.h"
 #include "SkStream.h"
@@ -54,6 +55,7 @@
 #include "SkSwizzler.h"
 #include "SkTLogic.h"
 #include "SkTaskGroup.h"
+#include "SkThreadedBMPDevice.h"
 #if defined(SK_BUILD_FOR_WIN)
     #include "SkAutoCoInitialize.h"
     #include "SkHRESULT.h"
@@ -1674,15 +1676,16 @@ RasterSink::RasterSink(SkColorType colorType, sk_sp<SkColorSpace> colorSpace)
     : fColorType(colorType)
     , fColorSpace(std::move(colorSpace)) {}
 
-Error RasterSink::draw(const Src& src, SkBitmap* dst, SkWStream*, SkString*) const {
-    const SkISize size = src.size();
+SkImageInfo RasterSink::makeInfo(SkISize size) const {
     // If there's an appropriate alpha type for this color type, use it, otherwise use premul.
     SkAlphaType alphaType = kPremul_SkAlphaType;
     (void)SkColorTypeValidateAlphaType(fColorType, alphaType, &alphaType);
 
-    dst->allocPixelsFlags(SkImageInfo::Make(size.width(), size.height(),
-                                            fColorType, alphaType, fColorSpace),
-                          SkBitmap::kZeroPixels_AllocFlag);
+    return SkImageInfo::Make(size.width(), size.height(), fColorType, alphaType, fColorSpace);
+}
+
+Error RasterSink::draw(const Src& src, SkBitmap* dst, SkWStream*, SkString*) const {
+    dst->allocPixelsFlags(this->makeInfo(src.size()), SkBitmap::kZeroPixels_AllocFlag);
 
     SkCanvas canvas(*dst);
     return src.draw(&canvas);
@@ -1690,6 +1693,146 @@ Error RasterSink::draw(const Src& src, SkBitmap* dst, SkWStream*, SkString*) con
 
 /*~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~*/
 
+ThreadedSink::ThreadedSink(SkColorType colorType, sk_sp<SkColorSpace> colorSpace)
+    : RasterSink(colorType, std::move(colorSpace)) {}
+
+// All threaded sinks share one pool, separate from DM's own, so --backendThreads is honored.
+static SkExecutor* backend_executor() {
+    static SkExecutor* gExecutor = SkExecutor::MakeFIFOThreadPool(FLAGS_backendThreads).release();
+    return gExecutor;
+}
+
+Error ThreadedSink::draw(const Src& src, SkBitmap* dst, SkWStream*, SkString*) const {
+    const SkImageInfo info = this->makeInfo(src.size());
+    auto surface = SkSurface::MakeRasterThreaded(info, backend_executor(), FLAGS_backendTiles);
+    if (!surface) {
+        return "Could not create a threaded raster surface.";
+    }
+
+    Error err = src.draw(surface->getCanvas());
+    if (!err.isEmpty()) {
+        return err;
+    }
+
+    dst->allocPixels(info);
+    if (!surface->readPixels(*dst, 0, 0)) {
+        return "Could not read back threaded raster surface.";
+    }
+    return "";
+}
+
+/*~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~*/
+
+// Counts the pixels of actual that differ from expected by more than tolerance in any byte, and
+// finds the largest difference.  Both must have the same info.
+static int count_mismatched(const SkBitmap& expected, const SkBitmap& actual, int tolerance,
+                            int* maxDiff) {
+    SkASSERT(expected.info() == actual.info());
+    const int bpp = expected.bytesPerPixel();
+    int mismatched = 0;
+    *maxDiff = 0;
+    for (int y = 0; y < expected.height(); ++y) {
+        const uint8_t* e = static_cast<const uint8_t*>(expected.getAddr(0, y));
+        const uint8_t* a = static_cast<const uint8_t*>(actual  .getAddr(0, y));
+        for (int x = 0; x < expected.width(); ++x) {
+            int diff = 0;
+            for (int i = 0; i < bpp; ++i) {
+                diff = SkTMax(diff, SkTAbs(e[i] - a[i]));
+            }
+            *maxDiff = SkTMax(*maxDiff, diff);
+            mismatched += diff > tolerance;
+            e += bpp;
+            a += bpp;
+        }
+    }
+    return mismatched;
+}
+
+DEFINE_int32(daaTolerance, 32, "Largest difference in any channel the 'daa' config allows a pixel "
+                              "to have from analytic AA.");
+DEFINE_double(daaMismatch, 1.0, "Percent of pixels the 'daa' config allows to exceed "
+                                "--daaTolerance.");
+
+DeltaAASink::DeltaAASink(SkColorType colorType, sk_sp<SkColorSpace> colorSpace)
+    : RasterSink(colorType, std::move(colorSpace)) {}
+
+Error DeltaAASink::draw(const Src& src, SkBitmap* dst, SkWStream* stream, SkString* log) const {
+    const SkImageInfo info = this->makeInfo(src.size());
+    dst->allocPixelsFlags(info, SkBitmap::kZeroPixels_AllocFlag);
+    {
+        const SkSurfaceProps props(SkSurfaceProps::kLegacyFontHost_InitType);
+        SkCanvas canvas(sk_make_sp<SkThreadedBMPDevice>(*dst, props, backend_executor(),
+                                                        FLAGS_backendTiles,
+                                                        SkThreadedBMPDevice::DeltaAA::kForce));
+        Error err = src.draw(&canvas);
+        if (!err.isEmpty()) {
+            return err;
+        }
+        canvas.flush();
+    }
+
+    SkBitmap reference;
+    Error err = this->RasterSink::draw(src, &reference, stream, log);
+    if (!err.isEmpty()) {
+        return err;
+    }
+
+    const int pixels = info.width() * info.height();
+    int maxDiff;
+    const int mismatched = count_mismatched(reference, *dst, FLAGS_daaTolerance, &maxDiff);
+    if (mismatched > FLAGS_daaMismatch * pixels / 100) {
+        return SkStringPrintf("%d of %d pixels differ from analytic AA by more than %d "
+                              "(by up to %d).", mismatched, pixels, FLAGS_daaTolerance, maxDiff);
+    }
+    return "";
+}
+
+/*~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~*/
+
+ParallelPictureSink::ParallelPictureSink(SkColorType colorType, sk_sp<SkColorSpace> colorSpace)
+    : RasterSink(colorType, std::move(colorSpace)) {}
+
+Error ParallelPictureSink::draw(const Src& src, SkBitmap* dst, SkWStream*, SkString*) const {
+    const SkISize size = src.size();
+
+    SkRTreeFactory factory;
+    SkPictureRecorder recorder;
+    Error err = src.draw(recorder.beginRecording(SkIntToScalar(size.width()),
+                                                 SkIntToScalar(size.height()),
+                                                 &factory));
+    if (!err.isEmpty()) {
+        return err;
+    }
+    sk_sp<SkPicture> pic = recorder.finishRecordingAsPicture();
+
+    dst->allocPixelsFlags(this->makeInfo(size), SkBitmap::kZeroPixels_AllocFlag);
+
+    const int kTileSize = 256;
+    SkTArray<SkIRect> tiles;
+    for (int y = 0; y < size.height(); y += kTileSize) {
+        for (int x = 0; x < size.width(); x += kTileSize) {
+            tiles.push_back(SkIRect::MakeLTRB(x, y, SkTMin(x + kTileSize, size.width()),
+                                                    SkTMin(y + kTileSize, size.height())));
+        }
+    }
+
+    // Each tile draws straight into its own subset of dst.
+    std::vector<std::unique_ptr<SkCanvas>> canvases(tiles.count());
+    pic->playbackParallel(tiles.begin(), tiles.count(), *backend_executor(),
+                          [&](int i, const SkIRect& tile) -> SkCanvas* {
+        SkPixmap subset;
+        if (!dst->pixmap().extractSubset(&subset, tile)) {
+            return nullptr;
+        }
+        canvases[i] = SkCanvas::MakeRasterDirect(subset.info(), subset.writable_addr(),
+                                                 subset.rowBytes());
+        return canvases[i].get();
+    });
+    return "";
+}
+
+/*~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~*/
+
 // Handy for front-patching a Src.  Do whatever up-front work you need, then call draw_to_canvas(),
 // passing the Sink draw() arguments, a size, and a function draws into an SkCanvas.
 // Several examples below.
@@ -1964,6 +2107,29 @@ Error ViaPicture::draw(const Src& src, SkBitmap* bitmap, SkWStream* stream, SkSt
 
 /*~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~*/
 
+Error ViaOptimizedPicture::draw(
+        const Src& src, SkBitmap* bitmap, SkWStream* stream, SkString* log) const {
+    auto size = src.size();
+    SkPictureRecorder recorder;
+    Error err = src.draw(recorder.beginRecording(SkIntToScalar(size.width()),
+                                                 SkIntToScalar(size.height())));
+    if (!err.isEmpty()) {
+        return err;
+    }
+    sk_sp<SkPicture> pic(recorder.finishRecordingAsPicture(fFinishFlags));
+
+    err = draw_to_canvas(fSink.get(), bitmap, stream, log, size, [&](SkCanvas* canvas) {
+        canvas->drawPicture(pic);
+        return "";
+    });
+    if (!err.isEmpty()) {
+        return err;
+    }
+    return check_against_reference(bitmap, src, fSink.get());
+}
+
+/*~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~*/
+
 #ifdef TEST_VIA_SVG
 #include "SkXMLWriter.h"
 #include "SkSVGCanvas.h"
@@ -2068,4 +2234,44 @@ Error ViaCSXform::draw(const Src& src, SkBitmap* bitmap, SkWStream* stream, SkSt
     return "";
 }
 
+/*~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~*/
+
+DEFINE_int32(highpTolerance, 1, "Largest difference in any channel the 'highp' via allows a "
+                                "lowp pixel.");
+DEFINE_double(highpMismatch, 0.0, "Percent of pixels the 'highp' via allows to exceed "
+                                  "--highpTolerance.");
+
+Error ViaHighp::draw(const Src& src, SkBitmap* bitmap, SkWStream* stream, SkString* log) const {
+    Error err = fSink->draw(src, bitmap, stream, log);
+    if (!err.isEmpty() || !bitmap || bitmap->drawsNothing()) {
+        return err;
+    }
+
+    SkBitmap reference;
+    SkString referenceLog;
+    SkDynamicMemoryWStream referenceStream;
+    gSkForceRasterPipelineHighp = true;
+    err = fSink->draw(src, &reference, &referenceStream, &referenceLog);
+    gSkForceRasterPipelineHighp = false;
+    if (!err.isEmpty()) {
+        return err;
+    }
+    if (reference.info() != bitmap->info()) {
+        return SkStringPrintf("Highp drew %dx%d, lowp %dx%d.", reference.width(),
+                              reference.height(), bitmap->width(), bitmap->height());
+    }
+
+    const int pixels = bitmap->width() * bitmap->height();
+    int maxDiff;
+    const int mismatched = count_mismatched(reference, *bitmap, FLAGS_highpTolerance, &maxDiff);
+    if (mismatched > FLAGS_highpMismatch * pixels / 100) {
+        return SkStringPrintf("%d of %d pixels differ from highp by more than %d "
+                              "(by up to %d).", mismatched, pixels, FLAGS_highpTolerance, maxDiff);
+    }
+    if (maxDiff > 0) {
+        log->appendf("Pixels differ from highp by up to %d.", maxDiff);
+    }
+    return "";
+}
+
 }  // namespace DM
@@ -434,6 +434,9 @@ public:
     const char* fileExtension() const override { return "png"; }
     SinkFlags flags() const override { return SinkFlags{ SinkFlags::kRaster, SinkFlags::kDirect }; }
 
+protected:
+    SkImageInfo makeInfo(SkISize) const;
+
 private:
     SkColorType         fColorType;
     sk_sp<SkColorSpace> fColorSpace;
@@ -445,6 +448,22 @@ public:
     Error draw(const Src&, SkBitmap*, SkWStream*, SkString*) const override;
 };
 
+// Draws through the threaded raster backend with Delta AA forced for every antialiased path fill,
+// and fails if that strays from RasterSink, which fills with analytic AA, by more than
+// --daaTolerance in more than --daaMismatch percent of the pixels.
+class DeltaAASink : public RasterSink {
+public:
+    explicit DeltaAASink(SkColorType, sk_sp<SkColorSpace> = nullptr);
+    Error draw(const Src&, SkBitmap*, SkWStream*, SkString*) const override;
+};
+
+// Records the Src into an SkPicture with an SkRTree, then replays it in tiles concurrently.
+class ParallelPictureSink : public RasterSink {
+public:
+    explicit ParallelPictureSink(SkColorType, sk_sp<SkColorSpace> = nullptr);
+    Error draw(const Src&, SkBitmap*, SkWStream*, SkString*) const override;
+};
+
 class SKPSink : public Sink {
 public:
     SKPSink();
@@ -518,6 +537,15 @@ public:
     Error draw(const Src&, SkBitmap*, SkWStream*, SkString*) const override;
 };
 
+// Records into a picture with the given SkPictureRecorder::FinishFlags optimizations.
+class ViaOptimizedPicture : public Via {
+public:
+    ViaOptimizedPicture(uint32_t finishFlags, Sink* sink) : Via(sink), fFinishFlags(finishFlags) {}
+    Error draw(const Src&, SkBitmap*, SkWStream*, SkString*) const override;
+private:
+    const uint32_t fFinishFlags;
+};
+
 class ViaTiles : public Via {
 public:
     ViaTiles(int w, int h, SkBBHFactory*, Sink*);
@@ -548,6 +576,16 @@ public:
     Error draw(const Src&, SkBitmap*, SkWStream*, SkString*) const override;
 };
 
+// Draws through the wrapped sink, and again with every raster pipeline forced to run in highp,
+// and fails if the usual lowp output strays by more than --highpTolerance in more than
+// --highpMismatch percent of the pixels.  Pipelines are forced to highp on this thread only, so
+// this is meant to wrap single-threaded raster sinks.
+class ViaHighp : public Via {
+public:
+    explicit ViaHighp(Sink* sink) : Via(sink) {}
+    Error draw(const Src&, SkBitmap*, SkWStream*, SkString*) const override;
+};
+
 class ViaCSXform : public Via {
 public:
     explicit ViaCSXform(Sink*, sk_sp<SkColorSpace>, bool colorSpin);
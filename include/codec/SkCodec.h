@@ -26,6 +26,7 @@
 
 class SkColorSpace;
 class SkData;
+class SkExecutor;
 class SkFrameHolder;
 class SkPngChunkReader;
 class SkSampler;
@@ -257,6 +258,7 @@ public:
             , fSubset(nullptr)
             , fFrameIndex(0)
             , fPriorFrame(kNoFrame)
+            , fExecutor(nullptr)
         {}
 
         ZeroInitialized            fZeroInitialized;
@@ -300,6 +302,15 @@ public:
          *  If set to kNoFrame, the codec will decode any necessary required frame(s) first.
          */
         int                        fPriorFrame;
+
+        /**
+         *  If not NULL, getPixels() may use this executor to do part of the decode in parallel,
+         *  e.g. swizzling and color converting rows while later rows are still being decoded.
+         *  The output is the same as without an executor.
+         *
+         *  Ignored by incremental and scanline decodes.
+         */
+        SkExecutor*                fExecutor;
     };
 
     /**
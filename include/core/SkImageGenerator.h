@@ -82,6 +82,16 @@ public:
      */
     bool getPixels(const SkImageInfo& info, void* pixels, size_t rowBytes);
 
+    /**
+     *  Returns the smallest dimensions, no smaller than desiredScale times getInfo()'s, that
+     *  getPixels() can produce more cheaply than decoding at full size and scaling down
+     *  (e.g. by decoding a jpeg at a reduced DCT scale).  Returns getInfo()'s dimensions if
+     *  the generator has no such size.
+     *
+     *  @param desiredScale In (0, 1].
+     */
+    SkISize getScaledDimensions(float desiredScale) const;
+
     /**
      *  If decoding to YUV is supported, this returns true.  Otherwise, this
      *  returns false and does not modify any of the parameters.
@@ -169,6 +179,7 @@ protected:
     virtual sk_sp<SkData> onRefEncodedData() { return nullptr; }
     struct Options {};
     virtual bool onGetPixels(const SkImageInfo&, void*, size_t, const Options&) { return false; }
+    virtual SkISize onGetScaledDimensions(float) const { return fInfo.dimensions(); }
     virtual bool onIsValid(GrContext*) const { return true; }
     virtual bool onQueryYUVA8(SkYUVASizeInfo*, SkYUVAIndex[SkYUVAIndex::kIndexCount],
                               SkYUVColorSpace*) const { return false; }
@@ -22,9 +22,12 @@
 #include "SkRect.h"
 #include "SkTypes.h"
 
+#include <functional>
+
 class SkCanvas;
 class SkData;
 struct SkDeserialProcs;
+class SkExecutor;
 class SkImage;
 struct SkSerialProcs;
 class SkStream;
@@ -133,6 +136,26 @@ public:
     */
     virtual void playback(SkCanvas* canvas, AbortCallback* callback = nullptr) const = 0;
 
+    /** Replays the drawing commands into several tiles at once, one task per tile on executor.
+        For each tile, makeCanvas is called on the thread drawing that tile with the tile index
+        and its bounds, and returns the canvas receiving that tile; nullptr skips the tile.
+        The returned canvas must not be shared with another tile. Its device origin is the
+        tile's top-left corner, and its matrix maps SkPicture to the whole destination;
+        playbackParallel() offsets that matrix by the tile origin.
+
+        Each tile is clipped to its bounds, so SkPicture with a bounding box hierarchy, such
+        as SkRTree, only replays the commands that intersect the tile.
+        Returns after every tile has been drawn.
+
+        @param tiles       device bounds of each tile
+        @param count       number of tiles
+        @param executor    runs the tiles concurrently
+        @param makeCanvas  returns the canvas drawing one tile
+    */
+    void playbackParallel(const SkIRect tiles[], int count, SkExecutor& executor,
+                          const std::function<SkCanvas*(int index, const SkIRect& tile)>&
+                                  makeCanvas) const;
+
     /** Returns cull SkRect for this picture, passed in when SkPicture was created.
         Returned SkRect does not specify clipping SkRect for SkPicture; cull is hint
         of SkPicture bounds.
@@ -209,12 +232,14 @@ private:
     friend class SkBigPicture;
     friend class SkEmptyPicture;
     friend class SkPicturePriv;
+    friend class SkStreamedPicture;
     template <typename> friend class SkMiniPicture;
 
     void serialize(SkWStream*, const SkSerialProcs*, class SkRefCntSet* typefaces) const;
     static sk_sp<SkPicture> MakeFromStream(SkStream*, const SkDeserialProcs*,
                                            class SkTypefacePlayback*);
     friend class SkPictureData;
+    friend class SkPictureStreamReader;
 
     /** Return true if the SkStream/Buffer represents a serialized picture, and
      fills out SkPictInfo. After this function returns, the data source is not
@@ -267,10 +292,11 @@ private:
     // V66: Add saveBehind
     // V67: Blobs serialize fonts instead of paints
     // V68: Paint doesn't serialize font-related stuff
+    // V69: Pad streamed op and arrays sections to 4-byte alignment
 
     // Only SKPs within the min/current picture version range (inclusive) can be read.
     static const uint32_t     MIN_PICTURE_VERSION = 56;     // august 2017
-    static const uint32_t CURRENT_PICTURE_VERSION = 68;
+    static const uint32_t CURRENT_PICTURE_VERSION = 69;
 
     static_assert(MIN_PICTURE_VERSION <= 62, "Remove kFontAxes_bad from SkFontDescriptor.cpp");
 
@@ -39,6 +39,9 @@ public:
     };
 
     enum FinishFlags {
+        // Also merge consecutive aliased clip rects and drop draws hidden by a later opaque draw.
+        // Exact unless the picture is played back under an anti-aliased clip.
+        kOptimizeClipsAndOcclusion_FinishFlag   = 1 << 0,
     };
 
     /** Returns the canvas that records the drawing commands.
@@ -30,6 +30,7 @@
 
 class SkCanvas;
 class SkDeferredDisplayList;
+class SkExecutor;
 class SkPaint;
 class SkSurfaceCharacterization;
 class GrBackendRenderTarget;
@@ -170,6 +171,33 @@ public:
     static sk_sp<SkSurface> MakeRasterN32Premul(int width, int height,
                                                 const SkSurfaceProps* surfaceProps = nullptr);
 
+    /** Allocates raster SkSurface whose SkCanvas rasterizes on several threads.
+        Allocates and zeroes pixel memory. Pixel memory size is imageInfo.height() times
+        imageInfo.minRowBytes(). Pixel memory is deleted when SkSurface is deleted.
+
+        Draws to SkCanvas are recorded and binned into horizontal tiles; tiles are rasterized
+        concurrently on executor when pixels are required, or when SkCanvas::flush() is called.
+        Pixels drawn are identical to those drawn by SkSurface returned by MakeRaster().
+        executor must remain valid for the lifetime of SkSurface.
+
+        SkSurface is returned if all parameters are valid.
+        Valid parameters include:
+        info dimensions are greater than zero;
+        info contains SkColorType and SkAlphaType supported by raster surface;
+        executor is not nullptr.
+
+        @param imageInfo     width, height, SkColorType, SkAlphaType, SkColorSpace,
+                             of raster surface; width and height must be greater than zero
+        @param executor      runs tile rasterization; must not be nullptr
+        @param tiles         number of horizontal tiles; zero or less chooses a default
+        @param surfaceProps  LCD striping orientation and setting for device independent fonts;
+                             may be nullptr
+        @return              SkSurface if all parameters are valid; otherwise, nullptr
+    */
+    static sk_sp<SkSurface> MakeRasterThreaded(const SkImageInfo& imageInfo, SkExecutor* executor,
+                                               int tiles = 0,
+                                               const SkSurfaceProps* surfaceProps = nullptr);
+
     /** Caller data passed to RenderTarget/TextureReleaseProc; may be nullptr. */
     typedef void* ReleaseContext;
 
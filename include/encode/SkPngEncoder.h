@@ -11,6 +11,7 @@
 #include "SkEncoder.h"
 #include "SkDataTable.h"
 
+class SkExecutor;
 class SkPngEncoderMgr;
 class SkWStream;
 
@@ -59,6 +60,13 @@ public:
          *  and the (2i + 1)-th entry is the text for the i-th comment.
          */
         sk_sp<SkDataTable> fComments;
+
+        /**
+         *  If not null, rows are filtered and compressed in independent chunks on this
+         *  executor, and the chunks are stitched into a single zlib stream.  The result is a
+         *  valid png, typically a little larger than one encoded without an executor.
+         */
+        SkExecutor* fExecutor = nullptr;
     };
 
     /**
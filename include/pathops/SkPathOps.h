@@ -11,6 +11,7 @@
 #include "../private/SkTDArray.h"
 #include "SkPreConfig.h"
 
+class SkExecutor;
 class SkPath;
 struct SkRect;
 
@@ -101,6 +102,17 @@ public:
       */
     bool resolve(SkPath* result);
 
+    /** Like resolve(), but if every operand is a union, first partitions the paths into
+        clusters whose bounds do not touch. Each cluster is resolved on its own, concurrently
+        if executor is not null, and the results are concatenated. The product covers the
+        same area as resolve()'s, but its contours may be ordered differently.
+
+        @param result The product of the operands.
+        @param executor Runs the clusters; may be null to resolve them on this thread.
+        @return True if the operation succeeded.
+      */
+    bool resolve(SkPath* result, SkExecutor* executor);
+
 private:
     SkTArray<SkPath> fPathRefs;
     SkTDArray<SkPathOp> fOps;
@@ -9,12 +9,44 @@
 #define SkAnimCodecPlayer_DEFINED
 
 #include "SkCodec.h"
+#include "../private/SkMutex.h"
 
+#include <atomic>
+
+class SkExecutor;
 class SkImage;
+class SkTaskGroup;
 
 class SkAnimCodecPlayer {
 public:
+    struct Options {
+        /**
+         *  If not null, the frames after the current one are decoded ahead of time on this
+         *  executor, so that they are usually ready by the time seek() reaches them.
+         */
+        SkExecutor* fExecutor = nullptr;
+
+        /**
+         *  How many frames past the current one to decode ahead of time, if fExecutor is set.
+         */
+        int fLookAhead = 2;
+
+        /**
+         *  The most decoded frames to hold on to.  When there are more, the ones that will be
+         *  shown furthest in the future are dropped, to be decoded again when needed.
+         *  0 means no limit.
+         */
+        int fFrameBudget = 0;
+
+        /**
+         *  If not 0, identifies the encoded image.  Players with the same fSharedID share their
+         *  decoded keyframes (frames that depend on no other frame) through SkResourceCache.
+         */
+        uint32_t fSharedID = 0;
+    };
+
     SkAnimCodecPlayer(std::unique_ptr<SkCodec> codec);
+    SkAnimCodecPlayer(std::unique_ptr<SkCodec> codec, const Options&);
     ~SkAnimCodecPlayer();
 
     /**
@@ -44,16 +76,33 @@ public:
      */
     bool seek(uint32_t msec);
 
+    /**
+     *  Returns how many times getFrame() has found its frame not yet decoded, and had to decode
+     *  it (or wait for it to finish decoding) before returning.
+     */
+    int lateFrames() const { return fLateFrames; }
 
 private:
-    std::unique_ptr<SkCodec>        fCodec;
+    std::unique_ptr<SkCodec>        fCodec;         // guarded by fCodecMutex
     SkImageInfo                     fImageInfo;
     std::vector<SkCodec::FrameInfo> fFrameInfos;
-    std::vector<sk_sp<SkImage> >    fImages;
-    int                             fCurrIndex = 0;
+    std::vector<sk_sp<SkImage> >    fImages;        // guarded by fImagesMutex
+    int                             fImageCount = 0;
+    std::atomic<int>                fCurrIndex{0};
     uint32_t                        fTotalDuration;
+    Options                         fOptions;
+    int                             fLateFrames = 0;
+
+    SkMutex                         fCodecMutex;
+    SkMutex                         fImagesMutex;
+    std::unique_ptr<SkTaskGroup>    fLookAheadTasks;
+    std::atomic<bool>               fLookAheadPending{false};
 
     sk_sp<SkImage> getFrameAt(int index);
+    sk_sp<SkImage> findFrame(int index);
+    sk_sp<SkImage> decodeFrame(int index);
+    void storeFrame(int index, sk_sp<SkImage>);
+    void lookAhead();
 };
 
 #endif
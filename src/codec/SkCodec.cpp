@@ -29,6 +29,9 @@
 #else
 #include "SkGifCodec.h"
 #endif
+#ifdef SK_HAS_WUFFS_PNG_LIBRARY
+#include "SkWuffsPngCodec.h"
+#endif
 
 struct DecoderProc {
     bool (*IsFormat)(const void*, size_t);
@@ -98,7 +101,13 @@ std::unique_ptr<SkCodec> SkCodec::MakeFromStream(std::unique_ptr<SkStream> strea
     }
 
     // PNG is special, since we want to be able to supply an SkPngChunkReader.
-    // But this code follows the same pattern as the loop.
+    // But this code follows the same pattern as the loop. Wuffs has no way to
+    // hand us unknown chunks, so only libpng decodes when there is a reader.
+#ifdef SK_HAS_WUFFS_PNG_LIBRARY
+    if (!chunkReader && SkWuffsPngCodec_IsFormat(buffer, bytesRead)) {
+        return SkWuffsPngCodec_MakeFromStream(std::move(stream), outResult);
+    }
+#endif
 #ifdef SK_HAS_PNG_LIBRARY
     if (SkPngCodec::IsPng(buffer, bytesRead)) {
         return SkPngCodec::MakeFromStream(std::move(stream), outResult, chunkReader);
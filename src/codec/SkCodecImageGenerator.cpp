@@ -66,6 +66,24 @@ bool SkCodecImageGenerator::onGetPixels(const SkImageInfo& requestInfo, void* re
     return SkPixmapPriv::Orient(dst, fCodec->getOrigin(), decode);
 }
 
+SkISize SkCodecImageGenerator::onGetScaledDimensions(float desiredScale) const {
+    // The codec rounds to the nearest scale it supports, but we promise never to return less
+    // than was asked for, so step up until we get there.  1/16 is finer than any codec's steps.
+    const SkISize full = fCodec->dimensions();
+    const float minWidth  = desiredScale * full.width(),
+                minHeight = desiredScale * full.height();
+    for (float scale = desiredScale; scale < 1; scale += 1.0f / 16) {
+        SkISize size = fCodec->getScaledDimensions(scale);
+        if (size.width() >= minWidth && size.height() >= minHeight) {
+            if (SkPixmapPriv::ShouldSwapWidthHeight(fCodec->getOrigin())) {
+                size.set(size.height(), size.width());
+            }
+            return size;
+        }
+    }
+    return this->getInfo().dimensions();
+}
+
 bool SkCodecImageGenerator::onQueryYUVA8(SkYUVASizeInfo* sizeInfo,
                                          SkYUVAIndex yuvaIndices[SkYUVAIndex::kIndexCount],
                                          SkYUVColorSpace* colorSpace) const {
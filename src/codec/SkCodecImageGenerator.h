@@ -27,6 +27,8 @@ protected:
     bool onGetPixels(
         const SkImageInfo& info, void* pixels, size_t rowBytes, const Options& opts) override;
 
+    SkISize onGetScaledDimensions(float desiredScale) const override;
+
     bool onQueryYUVA8(
         SkYUVASizeInfo*, SkYUVAIndex[SkYUVAIndex::kIndexCount], SkYUVColorSpace*) const override;
 
@@ -13,6 +13,7 @@
 #include "SkJpegDecoderMgr.h"
 #include "SkJpegInfo.h"
 #include "SkStream.h"
+#include "SkTaskGroup.h"
 #include "SkTemplates.h"
 #include "SkTo.h"
 #include "SkTypes.h"
@@ -552,6 +553,94 @@ int SkJpegCodec::readRows(const SkImageInfo& dstInfo, void* dst, size_t rowBytes
     return count;
 }
 
+int SkJpegCodec::decodeRows(void* dst, size_t rowBytes, int count) {
+    // Set the jump location for libjpeg-turbo errors
+    skjpeg_error_mgr::AutoPushJmpBuf jmp(fDecoderMgr->errorMgr());
+    if (setjmp(jmp)) {
+        return -1;
+    }
+
+    for (int y = 0; y < count; y++) {
+        JSAMPLE* row = (JSAMPLE*) SkTAddOffset<void>(dst, y * rowBytes);
+        if (0 == jpeg_read_scanlines(fDecoderMgr->dinfo(), &row, 1)) {
+            return y;
+        }
+    }
+    return count;
+}
+
+int SkJpegCodec::readRowsPipelined(const SkImageInfo& dstInfo, void* dst, size_t rowBytes,
+                                   SkExecutor* executor) {
+    // libjpeg-turbo's entropy decoding is serial, so this thread decodes bands of rows into a
+    // small ring of buffers while the executor swizzles and color transforms the bands already
+    // decoded.  Without an intermediate buffer (a color xform in place), we decode into dst.
+    constexpr int kBandRows = 16;
+    constexpr int kBandsInFlight = 4;
+
+    const int height = dstInfo.height();
+    const int dstWidth = fSwizzler ? fSwizzler->swizzleWidth() : dstInfo.width();
+    const bool decodeIntoDst = !fSwizzleSrcRow && !fColorXformSrcRow;
+    size_t decodeRowBytes = rowBytes;
+    if (fSwizzleSrcRow) {
+        decodeRowBytes = get_row_bytes(fDecoderMgr->dinfo());
+    } else if (fColorXformSrcRow) {
+        decodeRowBytes = dstWidth * sizeof(uint32_t);
+    }
+    // When we both swizzle and color transform, each band also needs a row to swizzle into.
+    const size_t scratchBytes = (fSwizzler && fColorXformSrcRow) ? dstWidth * sizeof(uint32_t)
+                                                                 : 0;
+    const size_t bandBytes = decodeIntoDst ? 0 : kBandRows * decodeRowBytes + scratchBytes;
+    SkAutoTMalloc<uint8_t> storage(kBandsInFlight * bandBytes);
+
+    // One task group per buffer.  Each waits for its last band when destroyed.
+    std::unique_ptr<SkTaskGroup> bands[kBandsInFlight];
+    for (auto& band : bands) {
+        band.reset(new SkTaskGroup(*executor));
+    }
+
+    int rowsDecoded = 0;
+    for (int i = 0; rowsDecoded < height; i++) {
+        SkTaskGroup* band = bands[i % kBandsInFlight].get();
+        uint8_t* bandStorage = storage.get() + (i % kBandsInFlight) * bandBytes;
+        // Wait for the last band that used this buffer to be done with it.
+        band->wait();
+
+        const int top = rowsDecoded;
+        void* dstRow = SkTAddOffset<void>(dst, top * rowBytes);
+        void* decoded = decodeIntoDst ? dstRow : bandStorage;
+        const int rows = this->decodeRows(decoded, decodeRowBytes,
+                                          SkTMin(kBandRows, height - top));
+        if (rows < 0) {
+            return 0;
+        }
+        rowsDecoded += rows;
+
+        uint32_t* scratch = (uint32_t*) (bandStorage + kBandRows * decodeRowBytes);
+        band->add([=] {
+            const uint8_t* src = (const uint8_t*) decoded;
+            void* row = dstRow;
+            for (int y = 0; y < rows; y++) {
+                const void* xformSrc = src;
+                if (fSwizzler) {
+                    void* swizzleDst = fColorXformSrcRow ? scratch : row;
+                    fSwizzler->swizzle(swizzleDst, src);
+                    xformSrc = swizzleDst;
+                }
+                if (this->colorXform()) {
+                    this->applyColorXform(row, xformSrc, dstWidth);
+                }
+                src += decodeRowBytes;
+                row = SkTAddOffset<void>(row, rowBytes);
+            }
+        });
+
+        if (rows < SkTMin(kBandRows, height - top)) {
+            break;
+        }
+    }
+    return rowsDecoded;
+}
+
 /*
  * This is a bit tricky.  We only need the swizzler to do format conversion if the jpeg is
  * encoded as CMYK.
@@ -605,7 +694,12 @@ SkCodec::Result SkJpegCodec::onGetPixels(const SkImageInfo& dstInfo,
 
     this->allocateStorage(dstInfo);
 
-    int rows = this->readRows(dstInfo, dst, dstRowBytes, dstInfo.height(), options);
+    int rows;
+    if (options.fExecutor && (fSwizzler || this->colorXform())) {
+        rows = this->readRowsPipelined(dstInfo, dst, dstRowBytes, options.fExecutor);
+    } else {
+        rows = this->readRows(dstInfo, dst, dstRowBytes, dstInfo.height(), options);
+    }
     if (rows < dstInfo.height()) {
         *rowsDecoded = rows;
         return fDecoderMgr->returnFailure("Incomplete image data", kIncompleteInput);
@@ -109,6 +109,18 @@ private:
     void allocateStorage(const SkImageInfo& dstInfo);
     int readRows(const SkImageInfo& dstInfo, void* dst, size_t rowBytes, int count, const Options&);
 
+    /*
+     *  Like readRows() for a whole image, but swizzles and color transforms on the executor
+     *  while the following rows are being decoded.
+     */
+    int readRowsPipelined(const SkImageInfo& dstInfo, void* dst, size_t rowBytes, SkExecutor*);
+
+    /*
+     *  Decodes up to count rows without any post-processing.
+     *  Returns the number of rows read, or -1 if libjpeg-turbo reported an error.
+     */
+    int decodeRows(void* dst, size_t rowBytes, int count);
+
     /*
      * Scanline decoding.
      */
@@ -15,6 +15,7 @@
 #include "SkOpts.h"
 #include "SkPngCodec.h"
 #include "SkPngPriv.h"
+#include "SkPngRegionIndex.h"
 #include "SkPoint3.h"
 #include "SkSize.h"
 #include "SkStream.h"
@@ -571,6 +572,17 @@ private:
             fRowsNeeded = get_scaled_dimension(fLastRow - fFirstRow + 1, sampleY);
         }
 
+        // Rather than have libpng inflate and discard every row above the subset, start from
+        // the nearest restart point.
+        if (fFirstRow > 0 && 0 == fRowsWrittenToOutput) {
+            if (SkPngRegionIndex* index = this->regionIndex()) {
+                SkPngRegionIndex::Reader reader(*index, this->stream()->getMemoryBase());
+                if (reader.seek(fFirstRow)) {
+                    return this->decodeFromIndex(&reader, rowsDecoded);
+                }
+            }
+        }
+
         const bool success = this->processData();
         if (success && fRowsWrittenToOutput == fRowsNeeded) {
             return kSuccess;
@@ -583,6 +595,34 @@ private:
         return log_and_return_error(success);
     }
 
+    Result decodeFromIndex(SkPngRegionIndex::Reader* reader, int* rowsDecoded) {
+        for (int rowNum = fFirstRow; rowNum <= fLastRow && fRowsWrittenToOutput < fRowsNeeded;
+                rowNum++) {
+            const uint8_t* row = reader->nextRow();
+            if (!row) {
+                break;
+            }
+            fRowsReadFromIndex++;
+
+            if (!this->swizzler() || this->swizzler()->rowNeeded(rowNum - fFirstRow)) {
+                this->applyXformRow(fDst, row);
+                fDst = SkTAddOffset<void>(fDst, fRowBytes);
+                fRowsWrittenToOutput++;
+            }
+        }
+
+        if (fRowsWrittenToOutput == fRowsNeeded) {
+            return kSuccess;
+        }
+
+        if (rowsDecoded) {
+            *rowsDecoded = fRowsWrittenToOutput;
+        }
+
+        // The index was built from this data, so it cannot be merely incomplete.
+        return log_and_return_error(false);
+    }
+
     void rowCallback(png_bytep row, int rowNum) {
         if (rowNum < fFirstRow) {
             // Ignore this row.
@@ -842,11 +882,16 @@ void AutoCleanPng::infoCallback(size_t idatLength) {
     png_get_IHDR(fPng_ptr, fInfo_ptr, &origWidth, &origHeight, &bitDepth,
                  &encodedColorType, nullptr, nullptr, nullptr);
 
+    // Whether libpng hands us the rows as they are stored, so that they can also be read without
+    // it, from an SkPngRegionIndex.
+    bool rawRows = true;
+
     // TODO: Should we support 16-bits of precision for gray images?
     if (bitDepth == 16 && (PNG_COLOR_TYPE_GRAY == encodedColorType ||
                            PNG_COLOR_TYPE_GRAY_ALPHA == encodedColorType)) {
         bitDepth = 8;
         png_set_strip_16(fPng_ptr);
+        rawRows = false;
     }
 
     // Now determine the default colorType and alphaType and set the required transforms.
@@ -862,6 +907,7 @@ void AutoCleanPng::infoCallback(size_t idatLength) {
                 // TODO: Should we use SkSwizzler here?
                 bitDepth = 8;
                 png_set_packing(fPng_ptr);
+                rawRows = false;
             }
 
             color = SkEncodedInfo::kPalette_Color;
@@ -873,6 +919,7 @@ void AutoCleanPng::infoCallback(size_t idatLength) {
             if (png_get_valid(fPng_ptr, fInfo_ptr, PNG_INFO_tRNS)) {
                 // Convert to RGBA if transparency chunk exists.
                 png_set_tRNS_to_alpha(fPng_ptr);
+                rawRows = false;
                 color = SkEncodedInfo::kRGBA_Color;
                 alpha = SkEncodedInfo::kBinary_Alpha;
             } else {
@@ -886,10 +933,12 @@ void AutoCleanPng::infoCallback(size_t idatLength) {
                 // TODO: Should we use SkSwizzler here?
                 bitDepth = 8;
                 png_set_expand_gray_1_2_4_to_8(fPng_ptr);
+                rawRows = false;
             }
 
             if (png_get_valid(fPng_ptr, fInfo_ptr, PNG_INFO_tRNS)) {
                 png_set_tRNS_to_alpha(fPng_ptr);
+                rawRows = false;
                 color = SkEncodedInfo::kGrayAlpha_Color;
                 alpha = SkEncodedInfo::kBinary_Alpha;
             } else {
@@ -962,6 +1011,7 @@ void AutoCleanPng::infoCallback(size_t idatLength) {
                     numberPasses);
         }
         static_cast<SkPngCodec*>(*fOutCodec)->setIdatLength(idatLength);
+        static_cast<SkPngCodec*>(*fOutCodec)->setRawRows(rawRows && 1 == numberPasses);
     }
 
     // Release the pointers, which are now owned by the codec or the caller is expected to
@@ -977,8 +1027,11 @@ SkPngCodec::SkPngCodec(SkEncodedInfo&& encodedInfo, std::unique_ptr<SkStream> st
     , fInfo_ptr(info_ptr)
     , fColorXformSrcRow(nullptr)
     , fBitDepth(bitDepth)
+    , fRowsReadFromIndex(0)
     , fIdatLength(0)
     , fDecodedIdat(false)
+    , fRawRows(false)
+    , fRegionIndexChecked(false)
 {}
 
 SkPngCodec::~SkPngCodec() {
@@ -1153,6 +1206,25 @@ SkCodec::Result SkPngCodec::onGetPixels(const SkImageInfo& dstInfo, void* dst,
     return this->decodeAllRows(dst, rowBytes, rowsDecoded);
 }
 
+SkPngRegionIndex* SkPngCodec::regionIndex() {
+    if (!fRegionIndexChecked) {
+        fRegionIndexChecked = true;
+
+        // The index reads the encoded data in place, so it must all be in memory.
+        SkStream* stream = this->stream();
+        const void* data = stream->getMemoryBase();
+        if (fRawRows && data && stream->hasLength() && stream->getLength() >= 8 &&
+                IsPng(static_cast<const char*>(data), 8)) {
+            png_structp png_ptr = this->png_ptr();
+            png_infop info_ptr = this->info_ptr();
+            fRegionIndex = SkPngRegionIndex::Find(data, stream->getLength(),
+                    this->dimensions().height(), png_get_rowbytes(png_ptr, info_ptr),
+                    png_get_channels(png_ptr, info_ptr) * png_get_bit_depth(png_ptr, info_ptr));
+        }
+    }
+    return fRegionIndex.get();
+}
+
 SkCodec::Result SkPngCodec::onStartIncrementalDecode(const SkImageInfo& dstInfo,
         void* dst, size_t rowBytes, const SkCodec::Options& options) {
     Result result = this->initializeXforms(dstInfo, options);
@@ -15,6 +15,7 @@
 #include "SkRefCnt.h"
 #include "SkSwizzler.h"
 
+class SkPngRegionIndex;
 class SkStream;
 
 class SkPngCodec : public SkCodec {
@@ -28,6 +29,13 @@ public:
     // FIXME (scroggo): Temporarily needed by AutoCleanPng.
     void setIdatLength(size_t len) { fIdatLength = len; }
 
+    // Set by AutoCleanPng when libpng is to apply no transforms to the rows, as required for
+    // decoding them from an SkPngRegionIndex.
+    void setRawRows(bool rawRows) { fRawRows = rawRows; }
+
+    // For tests: how many rows this codec has read from its regionIndex() rather than libpng.
+    int rowsReadFromIndex() const { return fRowsReadFromIndex; }
+
     ~SkPngCodec() override;
 
 protected:
@@ -60,6 +68,10 @@ protected:
 
     SkSwizzler* swizzler() { return fSwizzler.get(); }
 
+    // Returns the index for decoding rows far from the top, or nullptr if this image has none.
+    // Only images whose rows are raw and whose data is all in memory can have one.
+    SkPngRegionIndex* regionIndex();
+
     // Initialize variables used by applyXformRow.
     void initializeXformParams();
 
@@ -85,6 +97,7 @@ protected:
     SkAutoTMalloc<uint8_t>      fStorage;
     void*                       fColorXformSrcRow;
     const int                   fBitDepth;
+    int                         fRowsReadFromIndex;
 
 private:
 
@@ -116,6 +129,10 @@ private:
     size_t                         fIdatLength;
     bool                           fDecodedIdat;
 
+    bool                           fRawRows;
+    bool                           fRegionIndexChecked;
+    sk_sp<SkPngRegionIndex>        fRegionIndex;
+
     typedef SkCodec INHERITED;
 };
 #endif  // SkPngCodec_DEFINED
@@ -0,0 +1,425 @@
+/*
+ * Copyright 2018 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "SkPngRegionIndex.h"
+
+#include "SkOpts.h"
+#include "SkResourceCache.h"
+#include "SkTo.h"
+
+#include <string.h>
+#include <utility>
+
+// Output of the zlib stream between restart points. Each point costs the 32K window plus about
+// two rows, so this keeps an index to a few percent of the image it describes.
+static constexpr size_t kPointSpacing = 1 << 20;
+
+static constexpr size_t kSignatureSize = 8;
+static constexpr size_t kChunkOverhead = 12;  // Length, type and CRC.
+
+static uint32_t read_be32(const uint8_t* p) {
+    return (uint32_t)p[0] << 24 | (uint32_t)p[1] << 16 | (uint32_t)p[2] << 8 | (uint32_t)p[3];
+}
+
+static int paeth(int a, int b, int c) {
+    const int pa = SkTAbs(b - c);
+    const int pb = SkTAbs(a - c);
+    const int pc = SkTAbs(a + b - 2 * c);
+    if (pa <= pb && pa <= pc) {
+        return a;
+    }
+    return pb <= pc ? b : c;
+}
+
+// row and prev both start with a filter byte. Unfilters row in place.
+static bool unfilter(uint8_t* row, const uint8_t* prev, size_t rowBytes, size_t bpp) {
+    uint8_t* r = row + 1;
+    const uint8_t* p = prev + 1;
+    switch (row[0]) {
+        case 0:  // None
+            return true;
+        case 1:  // Sub
+            for (size_t i = bpp; i < rowBytes; i++) {
+                r[i] += r[i - bpp];
+            }
+            return true;
+        case 2:  // Up
+            for (size_t i = 0; i < rowBytes; i++) {
+                r[i] += p[i];
+            }
+            return true;
+        case 3:  // Average
+            for (size_t i = 0; i < bpp && i < rowBytes; i++) {
+                r[i] += p[i] >> 1;
+            }
+            for (size_t i = bpp; i < rowBytes; i++) {
+                r[i] += (r[i - bpp] + p[i]) >> 1;
+            }
+            return true;
+        case 4:  // Paeth
+            for (size_t i = 0; i < bpp && i < rowBytes; i++) {
+                r[i] += p[i];
+            }
+            for (size_t i = bpp; i < rowBytes; i++) {
+                r[i] += paeth(r[i - bpp], p[i], p[i - bpp]);
+            }
+            return true;
+        default:
+            return false;
+    }
+}
+
+namespace {
+static unsigned gPngRegionIndexKeyNamespaceLabel;
+
+struct PngRegionIndexKey : public SkResourceCache::Key {
+public:
+    PngRegionIndexKey(const void* data, size_t length, uint32_t fingerprint)
+        : fAddressLo((uint32_t)(uintptr_t)data)
+        , fAddressHi((uint32_t)((uint64_t)(uintptr_t)data >> 32))
+        , fLengthLo((uint32_t)length)
+        , fLengthHi((uint32_t)((uint64_t)length >> 32))
+        , fFingerprint(fingerprint)
+    {
+        this->init(&gPngRegionIndexKeyNamespaceLabel, 0,
+                   sizeof(fAddressLo) + sizeof(fAddressHi) + sizeof(fLengthLo) +
+                   sizeof(fLengthHi) + sizeof(fFingerprint));
+    }
+
+    uint32_t fAddressLo;
+    uint32_t fAddressHi;
+    uint32_t fLengthLo;
+    uint32_t fLengthHi;
+    uint32_t fFingerprint;
+};
+
+// A null fIndex records that the data could not be indexed, so it is not scanned again.
+struct PngRegionIndexRec : public SkResourceCache::Rec {
+    PngRegionIndexRec(const PngRegionIndexKey& key, sk_sp<SkPngRegionIndex> index)
+        : fKey(key)
+        , fIndex(std::move(index))
+    {}
+
+    PngRegionIndexKey        fKey;
+    sk_sp<SkPngRegionIndex>  fIndex;
+
+    const Key& getKey() const override { return fKey; }
+    size_t bytesUsed() const override {
+        return sizeof(*this) + (fIndex ? fIndex->bytesUsed() : 0);
+    }
+    const char* getCategory() const override { return "png-region-index"; }
+
+    static bool Visitor(const SkResourceCache::Rec& baseRec, void* contextData) {
+        const PngRegionIndexRec& rec = static_cast<const PngRegionIndexRec&>(baseRec);
+        *static_cast<sk_sp<SkPngRegionIndex>*>(contextData) = rec.fIndex;
+        return true;
+    }
+};
+} // namespace
+
+sk_sp<SkPngRegionIndex> SkPngRegionIndex::Find(const void* data, size_t length, int height,
+                                               size_t rowBytes, int bitsPerPixel) {
+    if (height <= 0 || 0 == rowBytes || bitsPerPixel <= 0 ||
+            (rowBytes + 1) * height < 2 * kPointSpacing) {
+        return nullptr;
+    }
+
+    // Gather the IDAT chunks, and fingerprint the data by its header and their CRCs, which is
+    // far cheaper than hashing all of it.
+    const uint8_t* bytes = static_cast<const uint8_t*>(data);
+    SkTArray<Span, true> spans;
+    size_t zlibLength = 0;
+    uint32_t fingerprint = 0;
+    for (size_t offset = kSignatureSize; length >= kChunkOverhead &&
+                                         offset <= length - kChunkOverhead; ) {
+        const size_t chunkLength = read_be32(bytes + offset);
+        if (chunkLength > length - kChunkOverhead - offset) {
+            break;
+        }
+        const uint8_t* type = bytes + offset + 4;
+        if (!memcmp(type, "IHDR", 4)) {
+            fingerprint = SkOpts::hash(type, chunkLength + 4, fingerprint);
+        } else if (!memcmp(type, "IDAT", 4)) {
+            if (chunkLength > 0) {
+                spans.push_back({ offset + 8, chunkLength, zlibLength });
+                zlibLength += chunkLength;
+            }
+            const uint32_t id[2] = { (uint32_t)chunkLength, read_be32(type + 4 + chunkLength) };
+            fingerprint = SkOpts::hash(id, sizeof(id), fingerprint);
+        } else if (!spans.empty() || !memcmp(type, "IEND", 4)) {
+            // The IDAT chunks must be consecutive, so this is the end of the image data.
+            break;
+        }
+        offset += kChunkOverhead + chunkLength;
+    }
+    if (spans.empty()) {
+        return nullptr;
+    }
+    const int count = spans.count();
+    fingerprint = SkOpts::hash(&count, sizeof(count), fingerprint);
+
+    PngRegionIndexKey key(data, length, fingerprint);
+    sk_sp<SkPngRegionIndex> index;
+    if (SkResourceCache::Find(key, PngRegionIndexRec::Visitor, &index)) {
+        return index;
+    }
+
+    index = Build(bytes, std::move(spans), height, rowBytes, bitsPerPixel);
+    SkResourceCache::Add(new PngRegionIndexRec(key, index));
+    return index;
+}
+
+sk_sp<SkPngRegionIndex> SkPngRegionIndex::Build(const uint8_t* data, SkTArray<Span, true>&& spans,
+                                                int height, size_t rowBytes, int bitsPerPixel) {
+    // Check the zlib header: deflate, with no preset dictionary. What follows is read as a raw
+    // deflate stream, which is how it must be restarted.
+    if (spans[0].fLength < 2) {
+        return nullptr;
+    }
+    const uint8_t* header = data + spans[0].fOffset;
+    if ((header[0] & 0x0F) != 8 || (header[0] >> 4) > 7 || (header[0] << 8 | header[1]) % 31 ||
+            (header[1] & 0x20)) {
+        return nullptr;
+    }
+
+    sk_sp<SkPngRegionIndex> index(new SkPngRegionIndex(height, rowBytes,
+                                                       SkTMax(1, bitsPerPixel / 8)));
+    index->fSpans = std::move(spans);
+    const SkTArray<Span, true>& idats = index->fSpans;
+
+    z_stream stream;
+    memset(&stream, 0, sizeof(stream));
+    if (Z_OK != inflateInit2(&stream, -15)) {
+        return nullptr;
+    }
+
+    // The window is circular, as in zlib's examples/zran.c.
+    const size_t filteredBytes = rowBytes + 1;
+    SkAutoTMalloc<uint8_t> storage(kWindowSize + 2 * filteredBytes);
+    uint8_t* window = storage.get();
+    uint8_t* cur  = window + kWindowSize;
+    uint8_t* prev = cur + filteredBytes;
+    memset(prev, 0, filteredBytes);
+
+    size_t windowFill = 0;
+    size_t totalOut = 0;
+    size_t lastPoint = 0;
+    int row = 0;
+    size_t rowFill = 0;
+    int span = 0;
+    stream.next_in = const_cast<Bytef*>(header + 2);
+    stream.avail_in = SkToUInt(idats[0].fLength - 2);
+    bool success = false;
+    while (true) {
+        if (0 == stream.avail_in) {
+            if (++span == idats.count()) {
+                break;
+            }
+            stream.next_in = const_cast<Bytef*>(data + idats[span].fOffset);
+            stream.avail_in = SkToUInt(idats[span].fLength);
+        }
+        if (kWindowSize == windowFill) {
+            windowFill = 0;
+        }
+        stream.next_out = window + windowFill;
+        stream.avail_out = SkToUInt(kWindowSize - windowFill);
+        const int ret = inflate(&stream, Z_BLOCK);
+
+        const uint8_t* out = window + windowFill;
+        size_t produced = kWindowSize - windowFill - stream.avail_out;
+        windowFill += produced;
+        totalOut += produced;
+        bool badFilter = false;
+        while (produced > 0 && row < height) {
+            const size_t n = SkTMin(produced, filteredBytes - rowFill);
+            memcpy(cur + rowFill, out, n);
+            out += n;
+            produced -= n;
+            rowFill += n;
+            if (filteredBytes == rowFill) {
+                if (!unfilter(cur, prev, rowBytes, index->fBytesPerPixel)) {
+                    badFilter = true;
+                    break;
+                }
+                std::swap(cur, prev);
+                row++;
+                rowFill = 0;
+            }
+        }
+
+        if (badFilter || row == height || Z_STREAM_END == ret) {
+            success = !badFilter && row == height;
+            break;
+        }
+        if (Z_OK != ret && Z_BUF_ERROR != ret) {
+            break;
+        }
+
+        // Bit 7 of data_type marks the end of a block, and bit 6 the end of the last block.
+        if ((stream.data_type & 128) && !(stream.data_type & 64) &&
+                totalOut - lastPoint >= kPointSpacing) {
+            Point& point = index->fPoints.push_back();
+            point.fIn = idats[span].fStart + (stream.next_in - (data + idats[span].fOffset));
+            point.fBits = stream.data_type & 7;
+            point.fRow = row;
+            point.fRowFill = rowFill;
+            uint8_t* state = point.fState.reset(kWindowSize + rowBytes + rowFill);
+            memcpy(state, window + windowFill, kWindowSize - windowFill);
+            memcpy(state + kWindowSize - windowFill, window, windowFill);
+            memcpy(state + kWindowSize, prev + 1, rowBytes);
+            memcpy(state + kWindowSize + rowBytes, cur, rowFill);
+            lastPoint = totalOut;
+        }
+    }
+    inflateEnd(&stream);
+
+    if (!success || index->fPoints.empty()) {
+        return nullptr;
+    }
+    return index;
+}
+
+size_t SkPngRegionIndex::bytesUsed() const {
+    size_t bytes = sizeof(*this) + fSpans.count() * sizeof(Span);
+    for (const Point& point : fPoints) {
+        bytes += sizeof(Point) + kWindowSize + fRowBytes + point.fRowFill;
+    }
+    return bytes;
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+SkPngRegionIndex::Reader::Reader(const SkPngRegionIndex& index, const void* data)
+    : fIndex(index)
+    , fData(static_cast<const uint8_t*>(data))
+    , fStreamInitialized(false)
+    , fSpan(0)
+    , fRow(index.fHeight)
+    , fRowFill(0)
+    , fStorage(2 * (index.fRowBytes + 1))
+    , fCur(fStorage.get())
+    , fPrev(fCur + index.fRowBytes + 1)
+{
+    memset(&fStream, 0, sizeof(fStream));
+    fStreamInitialized = Z_OK == inflateInit2(&fStream, -15);
+}
+
+SkPngRegionIndex::Reader::~Reader() {
+    if (fStreamInitialized) {
+        inflateEnd(&fStream);
+    }
+}
+
+bool SkPngRegionIndex::Reader::seek(int y) {
+    if (!fStreamInitialized || y < 0 || y >= fIndex.fHeight) {
+        return false;
+    }
+
+    int point = -1;
+    while (point + 1 < fIndex.fPoints.count() && fIndex.fPoints[point + 1].fRow <= y) {
+        point++;
+    }
+
+    // Carry on from the current row if no restart point is closer.
+    const int pointRow = point < 0 ? 0 : fIndex.fPoints[point].fRow;
+    if ((fRow > y || fRow < pointRow) && !this->restart(point)) {
+        return false;
+    }
+    while (fRow < y) {
+        if (!this->nextRow()) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool SkPngRegionIndex::Reader::restart(int point) {
+    const SkTArray<Span, true>& spans = fIndex.fSpans;
+    const size_t rowBytes = fIndex.fRowBytes;
+    fRow = fIndex.fHeight;
+    if (Z_OK != inflateReset(&fStream)) {
+        return false;
+    }
+
+    size_t in = 2;
+    if (point < 0) {
+        fRowFill = 0;
+        memset(fPrev, 0, rowBytes + 1);
+    } else {
+        const Point& p = fIndex.fPoints[point];
+        in = p.fIn;
+        if (p.fBits) {
+            int s = 0;
+            while (in - 1 >= spans[s].fStart + spans[s].fLength) {
+                s++;
+            }
+            const uint8_t byte = fData[spans[s].fOffset + (in - 1 - spans[s].fStart)];
+            if (Z_OK != inflatePrime(&fStream, p.fBits, byte >> (8 - p.fBits))) {
+                return false;
+            }
+        }
+        if (Z_OK != inflateSetDictionary(&fStream, p.fState.get(), SkToUInt(kWindowSize))) {
+            return false;
+        }
+        memcpy(fPrev + 1, p.fState.get() + kWindowSize, rowBytes);
+        fRowFill = p.fRowFill;
+        memcpy(fCur, p.fState.get() + kWindowSize + rowBytes, fRowFill);
+    }
+
+    fSpan = 0;
+    while (fSpan < spans.count() && in >= spans[fSpan].fStart + spans[fSpan].fLength) {
+        fSpan++;
+    }
+    if (fSpan < spans.count()) {
+        const size_t skip = in - spans[fSpan].fStart;
+        fStream.next_in = const_cast<Bytef*>(fData + spans[fSpan].fOffset + skip);
+        fStream.avail_in = SkToUInt(spans[fSpan].fLength - skip);
+    } else {
+        fStream.avail_in = 0;
+    }
+    fRow = point < 0 ? 0 : fIndex.fPoints[point].fRow;
+    return true;
+}
+
+bool SkPngRegionIndex::Reader::inflateRow() {
+    const SkTArray<Span, true>& spans = fIndex.fSpans;
+    const size_t filteredBytes = fIndex.fRowBytes + 1;
+    while (fRowFill < filteredBytes) {
+        if (0 == fStream.avail_in) {
+            if (fSpan + 1 >= spans.count()) {
+                return false;
+            }
+            fSpan++;
+            fStream.next_in = const_cast<Bytef*>(fData + spans[fSpan].fOffset);
+            fStream.avail_in = SkToUInt(spans[fSpan].fLength);
+        }
+        fStream.next_out = fCur + fRowFill;
+        fStream.avail_out = SkToUInt(filteredBytes - fRowFill);
+        const int ret = inflate(&fStream, Z_NO_FLUSH);
+        fRowFill = filteredBytes - fStream.avail_out;
+        if (Z_STREAM_END == ret) {
+            return fRowFill == filteredBytes;
+        }
+        if (Z_OK != ret && Z_BUF_ERROR != ret) {
+            return false;
+        }
+    }
+    return true;
+}
+
+const uint8_t* SkPngRegionIndex::Reader::nextRow() {
+    if (fRow >= fIndex.fHeight || !this->inflateRow() ||
+            !unfilter(fCur, fPrev, fIndex.fRowBytes, fIndex.fBytesPerPixel)) {
+        // Whatever state we are in, the next seek() must restart.
+        fRow = fIndex.fHeight;
+        return nullptr;
+    }
+    std::swap(fCur, fPrev);
+    fRow++;
+    fRowFill = 0;
+    return fPrev + 1;
+}
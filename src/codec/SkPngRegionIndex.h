@@ -0,0 +1,100 @@
+/*
+ * Copyright 2018 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#ifndef SkPngRegionIndex_DEFINED
+#define SkPngRegionIndex_DEFINED
+
+#include "SkRefCnt.h"
+#include "SkTArray.h"
+#include "SkTemplates.h"
+
+#include "zlib.h"
+
+/**
+ *  Restart points into the image data of a non-interlaced PNG, so that a decode of rows near the
+ *  bottom need not inflate and unfilter every row above them.
+ *
+ *  Deflate blocks refer back to the previous 32K of output, and PNG filters to the previous row,
+ *  so each restart point saves both, at a deflate block boundary. Building the index takes one
+ *  pass over the whole image. Indexes are kept in SkResourceCache, keyed by the encoded bytes'
+ *  address and content, so codecs made later for the same data reuse them.
+ */
+class SkPngRegionIndex : public SkNVRefCnt<SkPngRegionIndex> {
+public:
+    /**
+     *  Returns the index for the PNG in data, building it if there is none in the cache.
+     *  rowBytes and bitsPerPixel describe the image's unfiltered rows. Returns nullptr if the
+     *  image is too small to be worth indexing, or its data is not valid.
+     */
+    static sk_sp<SkPngRegionIndex> Find(const void* data, size_t length, int height,
+                                        size_t rowBytes, int bitsPerPixel);
+
+    size_t bytesUsed() const;
+
+    /**
+     *  Reads unfiltered rows, starting at any row. The data must be the same as the index was
+     *  made from; it is only read within the spans the index found, so bad data gives bad rows,
+     *  not bad reads.
+     */
+    class Reader {
+    public:
+        Reader(const SkPngRegionIndex&, const void* data);
+        ~Reader();
+
+        /** Positions the reader so that nextRow() returns row y. Returns false on bad data. */
+        bool seek(int y);
+
+        /** Returns the next row, without its filter byte, or nullptr on bad data. */
+        const uint8_t* nextRow();
+
+    private:
+        bool restart(int point);  // -1 restarts at the top of the image.
+        bool inflateRow();
+
+        const SkPngRegionIndex& fIndex;
+        const uint8_t*          fData;
+        z_stream                fStream;
+        bool                    fStreamInitialized;
+        int                     fSpan;        // Index into fIndex.fSpans of the current input.
+        int                     fRow;         // The row nextRow() returns next.
+        size_t                  fRowFill;     // Bytes of the filtered row inflated so far.
+        SkAutoTMalloc<uint8_t>  fStorage;
+        uint8_t*                fCur;         // Filter byte, then the row being inflated.
+        uint8_t*                fPrev;        // Filter byte, then the previous row, unfiltered.
+    };
+
+private:
+    struct Span {
+        size_t fOffset;     // Of the IDAT payload in the encoded data.
+        size_t fLength;
+        size_t fStart;      // Of the payload in the zlib stream made by joining the IDATs.
+    };
+
+    struct Point {
+        size_t                 fIn;        // Next byte of the zlib stream to read.
+        int                    fBits;      // Bits of the byte before fIn not yet read.
+        int                    fRow;       // Row being inflated.
+        size_t                 fRowFill;   // Bytes of it inflated so far.
+        SkAutoTMalloc<uint8_t> fState;     // Window, then previous row, then partial row.
+    };
+
+    static constexpr size_t kWindowSize = 32768;
+
+    SkPngRegionIndex(int height, size_t rowBytes, int bytesPerPixel)
+        : fHeight(height), fRowBytes(rowBytes), fBytesPerPixel(bytesPerPixel) {}
+
+    static sk_sp<SkPngRegionIndex> Build(const uint8_t* data, SkTArray<Span, true>&& spans,
+                                         int height, size_t rowBytes, int bitsPerPixel);
+
+    const int            fHeight;
+    const size_t         fRowBytes;       // Unfiltered; a filtered row has one more byte.
+    const int            fBytesPerPixel;  // Rounded up to 1, as the filters want.
+    SkTArray<Span, true> fSpans;
+    SkTArray<Point>      fPoints;
+};
+
+#endif  // SkPngRegionIndex_DEFINED
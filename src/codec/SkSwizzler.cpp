@@ -243,6 +243,17 @@ static void swizzle_index_to_n32(
     }
 }
 
+static void fast_swizzle_index_to_n32(
+        void* dst, const uint8_t* src, int width, int bpp, int deltaSrc, int offset,
+        const SkPMColor ctable[]) {
+
+    // This function must not be called if we are sampling.  If we are not
+    // sampling, deltaSrc should equal bpp.
+    SkASSERT(deltaSrc == bpp);
+
+    SkOpts::index_to_8888((uint32_t*) dst, src + offset, width, ctable);
+}
+
 static void swizzle_index_to_n32_skipZ(
         void* SK_RESTRICT dstRow, const uint8_t* SK_RESTRICT src, int dstWidth,
         int bpp, int deltaSrc, int offset, const SkPMColor ctable[]) {
@@ -385,6 +396,17 @@ static void swizzle_bgr_to_565(
     }
 }
 
+static void fast_swizzle_bgr_to_565(
+        void* dst, const uint8_t* src, int width, int bpp, int deltaSrc, int offset,
+        const SkPMColor ctable[]) {
+
+    // This function must not be called if we are sampling.  If we are not
+    // sampling, deltaSrc should equal bpp.
+    SkASSERT(deltaSrc == bpp);
+
+    SkOpts::BGR_to_565((uint16_t*) dst, src + offset, width);
+}
+
 // kRGB
 
 static void swizzle_rgb_to_rgba(
@@ -445,6 +467,17 @@ static void swizzle_rgb_to_565(
     }
 }
 
+static void fast_swizzle_rgb_to_565(
+        void* dst, const uint8_t* src, int width, int bpp, int deltaSrc, int offset,
+        const SkPMColor ctable[]) {
+
+    // This function must not be called if we are sampling.  If we are not
+    // sampling, deltaSrc should equal bpp.
+    SkASSERT(deltaSrc == bpp);
+
+    SkOpts::RGB_to_565((uint16_t*) dst, src + offset, width);
+}
+
 // kRGBA
 
 static void swizzle_rgba_to_rgba_premul(
@@ -624,6 +657,83 @@ static void swizzle_rgba16_to_bgra_premul(
     }
 }
 
+static void fast_swizzle_rgb16_to_rgba(
+        void* dst, const uint8_t* src, int width, int bpp, int deltaSrc, int offset,
+        const SkPMColor ctable[]) {
+
+    // This function must not be called if we are sampling.  If we are not
+    // sampling, deltaSrc should equal bpp.
+    SkASSERT(deltaSrc == bpp);
+
+    SkOpts::RGB16_to_RGB1((uint32_t*) dst, src + offset, width);
+}
+
+static void fast_swizzle_rgb16_to_bgra(
+        void* dst, const uint8_t* src, int width, int bpp, int deltaSrc, int offset,
+        const SkPMColor ctable[]) {
+
+    // This function must not be called if we are sampling.  If we are not
+    // sampling, deltaSrc should equal bpp.
+    SkASSERT(deltaSrc == bpp);
+
+    SkOpts::RGB16_to_BGR1((uint32_t*) dst, src + offset, width);
+}
+
+static void fast_swizzle_rgb16_to_565(
+        void* dst, const uint8_t* src, int width, int bpp, int deltaSrc, int offset,
+        const SkPMColor ctable[]) {
+
+    // This function must not be called if we are sampling.  If we are not
+    // sampling, deltaSrc should equal bpp.
+    SkASSERT(deltaSrc == bpp);
+
+    SkOpts::RGB16_to_565((uint16_t*) dst, src + offset, width);
+}
+
+static void fast_swizzle_rgba16_to_rgba_unpremul(
+        void* dst, const uint8_t* src, int width, int bpp, int deltaSrc, int offset,
+        const SkPMColor ctable[]) {
+
+    // This function must not be called if we are sampling.  If we are not
+    // sampling, deltaSrc should equal bpp.
+    SkASSERT(deltaSrc == bpp);
+
+    SkOpts::RGBA16_to_RGBA((uint32_t*) dst, src + offset, width);
+}
+
+static void fast_swizzle_rgba16_to_rgba_premul(
+        void* dst, const uint8_t* src, int width, int bpp, int deltaSrc, int offset,
+        const SkPMColor ctable[]) {
+
+    // This function must not be called if we are sampling.  If we are not
+    // sampling, deltaSrc should equal bpp.
+    SkASSERT(deltaSrc == bpp);
+
+    SkOpts::RGBA16_to_rgbA((uint32_t*) dst, src + offset, width);
+}
+
+static void fast_swizzle_rgba16_to_bgra_unpremul(
+        void* dst, const uint8_t* src, int width, int bpp, int deltaSrc, int offset,
+        const SkPMColor ctable[]) {
+
+    // This function must not be called if we are sampling.  If we are not
+    // sampling, deltaSrc should equal bpp.
+    SkASSERT(deltaSrc == bpp);
+
+    SkOpts::RGBA16_to_BGRA((uint32_t*) dst, src + offset, width);
+}
+
+static void fast_swizzle_rgba16_to_bgra_premul(
+        void* dst, const uint8_t* src, int width, int bpp, int deltaSrc, int offset,
+        const SkPMColor ctable[]) {
+
+    // This function must not be called if we are sampling.  If we are not
+    // sampling, deltaSrc should equal bpp.
+    SkASSERT(deltaSrc == bpp);
+
+    SkOpts::RGBA16_to_bgrA((uint32_t*) dst, src + offset, width);
+}
+
 // kCMYK
 //
 // CMYK is stored as four bytes per pixel.
@@ -925,6 +1035,7 @@ std::unique_ptr<SkSwizzler> SkSwizzler::Make(const SkEncodedInfo& encodedInfo,
                                 proc = &swizzle_index_to_n32_skipZ;
                             } else {
                                 proc = &swizzle_index_to_n32;
+                                fastProc = &fast_swizzle_index_to_n32;
                             }
                             break;
                         case kRGB_565_SkColorType:
@@ -947,6 +1058,7 @@ std::unique_ptr<SkSwizzler> SkSwizzler::Make(const SkEncodedInfo& encodedInfo,
                 case kRGBA_8888_SkColorType:
                     if (16 == encodedInfo.bitsPerComponent()) {
                         proc = &swizzle_rgb16_to_rgba;
+                        fastProc = &fast_swizzle_rgb16_to_rgba;
                         break;
                     }
 
@@ -957,6 +1069,7 @@ std::unique_ptr<SkSwizzler> SkSwizzler::Make(const SkEncodedInfo& encodedInfo,
                 case kBGRA_8888_SkColorType:
                     if (16 == encodedInfo.bitsPerComponent()) {
                         proc = &swizzle_rgb16_to_bgra;
+                        fastProc = &fast_swizzle_rgb16_to_bgra;
                         break;
                     }
 
@@ -967,10 +1080,12 @@ std::unique_ptr<SkSwizzler> SkSwizzler::Make(const SkEncodedInfo& encodedInfo,
                 case kRGB_565_SkColorType:
                     if (16 == encodedInfo.bitsPerComponent()) {
                         proc = &swizzle_rgb16_to_565;
+                        fastProc = &fast_swizzle_rgb16_to_565;
                         break;
                     }
 
                     proc = &swizzle_rgb_to_565;
+                    fastProc = &fast_swizzle_rgb_to_565;
                     break;
                 default:
                     return nullptr;
@@ -982,6 +1097,8 @@ std::unique_ptr<SkSwizzler> SkSwizzler::Make(const SkEncodedInfo& encodedInfo,
                     if (16 == encodedInfo.bitsPerComponent()) {
                         proc = premultiply ? &swizzle_rgba16_to_rgba_premul :
                                              &swizzle_rgba16_to_rgba_unpremul;
+                        fastProc = premultiply ? &fast_swizzle_rgba16_to_rgba_premul :
+                                                 &fast_swizzle_rgba16_to_rgba_unpremul;
                         break;
                     }
 
@@ -1009,6 +1126,8 @@ std::unique_ptr<SkSwizzler> SkSwizzler::Make(const SkEncodedInfo& encodedInfo,
                     if (16 == encodedInfo.bitsPerComponent()) {
                         proc = premultiply ? &swizzle_rgba16_to_bgra_premul :
                                              &swizzle_rgba16_to_bgra_unpremul;
+                        fastProc = premultiply ? &fast_swizzle_rgba16_to_bgra_premul :
+                                                 &fast_swizzle_rgba16_to_bgra_unpremul;
                         break;
                     }
 
@@ -1049,6 +1168,7 @@ std::unique_ptr<SkSwizzler> SkSwizzler::Make(const SkEncodedInfo& encodedInfo,
                     break;
                 case kRGB_565_SkColorType:
                     proc = &swizzle_bgr_to_565;
+                    fastProc = &fast_swizzle_bgr_to_565;
                     break;
                 default:
                     return nullptr;
@@ -1172,6 +1292,7 @@ SkSwizzler::SkSwizzler(RowProc fastProc, RowProc proc, const SkPMColor* ctable,
     : fFastProc(fastProc)
     , fSlowProc(proc)
     , fActualProc(fFastProc ? fFastProc : fSlowProc)
+    , fGatherSamples(false)
     , fColorTable(ctable)
     , fSrcOffset(srcOffset)
     , fDstOffset(dstOffset)
@@ -1218,10 +1339,13 @@ int SkSwizzler::onSetSampleX(int sampleX) {
         }
     }
 
-    // The optimized swizzler functions do not support sampling.  Sampled swizzles
-    // are already fast because they skip pixels.  We haven't seen a situation
-    // where speeding up sampling has a significant impact on total decode time.
-    if (1 == fSampleX && fFastProc) {
+    // The optimized swizzler functions do not support sampling, so a sampled swizzle gathers
+    // the pixels it keeps and runs the optimized function on those.  When the optimized
+    // function would only copy them, the slow proc's strided copy is all there is to do.
+    const bool fastProcCopies = &copy == fFastProc ||
+                                &SkipLeading8888ZerosThen<copy> == fFastProc;
+    fGatherSamples = 1 != fSampleX && fFastProc && !fastProcCopies;
+    if (fFastProc && (1 == fSampleX || fGatherSamples)) {
         fActualProc = fFastProc;
     } else {
         fActualProc = fSlowProc;
@@ -1230,8 +1354,48 @@ int SkSwizzler::onSetSampleX(int sampleX) {
     return fAllocatedWidth;
 }
 
+template <int kBPP>
+static void gather(uint8_t* dst, const uint8_t* src, int count, int deltaSrc) {
+    for (int i = 0; i < count; i++) {
+        memcpy(dst, src, kBPP);
+        dst += kBPP;
+        src += deltaSrc;
+    }
+}
+
+void SkSwizzler::gatherThenSwizzle(void* dst, const uint8_t* SK_RESTRICT src) {
+    // Small enough to stay in L1 between the gather and the swizzle.  The widest source
+    // pixels are 16-bit RGBA.
+    static constexpr int kMaxPixels = 256;
+    uint8_t buffer[kMaxPixels * 8];
+    SkASSERT(fSrcBPP <= 8);
+
+    const int deltaSrc = fSampleX * fSrcBPP;
+    src += fSrcOffsetUnits;
+    for (int x = 0; x < fSwizzleWidth; x += kMaxPixels) {
+        const int count = SkTMin(kMaxPixels, fSwizzleWidth - x);
+        switch (fSrcBPP) {
+            case 1: gather<1>(buffer, src, count, deltaSrc); break;
+            case 2: gather<2>(buffer, src, count, deltaSrc); break;
+            case 3: gather<3>(buffer, src, count, deltaSrc); break;
+            case 4: gather<4>(buffer, src, count, deltaSrc); break;
+            case 6: gather<6>(buffer, src, count, deltaSrc); break;
+            case 8: gather<8>(buffer, src, count, deltaSrc); break;
+            default: SkASSERT(false); return;
+        }
+        fFastProc(dst, buffer, count, fSrcBPP, fSrcBPP, 0, fColorTable);
+
+        src += count * deltaSrc;
+        dst = SkTAddOffset<void>(dst, count * fDstBPP);
+    }
+}
+
 void SkSwizzler::swizzle(void* dst, const uint8_t* SK_RESTRICT src) {
     SkASSERT(nullptr != dst && nullptr != src);
+    if (fGatherSamples) {
+        this->gatherThenSwizzle(SkTAddOffset<void>(dst, fDstOffsetBytes), src);
+        return;
+    }
     fActualProc(SkTAddOffset<void>(dst, fDstOffsetBytes), src, fSwizzleWidth, fSrcBPP,
             fSampleX * fSrcBPP, fSrcOffsetUnits, fColorTable);
 }
@@ -116,13 +116,22 @@ private:
     static void SkipLeadingGrayAlphaZerosThen(void* dst, const uint8_t* src, int width, int bpp,
                                               int deltaSrc, int offset, const SkPMColor ctable[]);
 
+    /**
+     *  Copies the pixels a sampled swizzle keeps into a contiguous buffer, a chunk at a time,
+     *  and runs fFastProc on each chunk.
+     */
+    void gatherThenSwizzle(void* dst, const uint8_t* SK_RESTRICT src);
+
     // May be NULL.  We have not implemented optimized functions for all supported transforms.
+    // Does not support sampling on its own.
     const RowProc       fFastProc;
     // Always non-NULL.  Supports sampling.
     const RowProc       fSlowProc;
     // The actual RowProc we are using.  This depends on if fFastProc is non-NULL and
     // whether or not we are sampling.
     RowProc             fActualProc;
+    // Whether fActualProc is fFastProc run on sampled pixels gathered by gatherThenSwizzle().
+    bool                fGatherSamples;
 
     const SkPMColor*    fColorTable;      // Unowned pointer
 
@@ -16,6 +16,7 @@
 #include "SkRasterPipeline.h"
 #include "SkSampler.h"
 #include "SkStreamPriv.h"
+#include "SkTaskGroup.h"
 #include "SkTemplates.h"
 #include "SkTo.h"
 
@@ -493,6 +494,11 @@ SkCodec::Result SkWebpCodec::onGetPixels(const SkImageInfo& dstInfo, void* dst,
         webpDst.installPixels(webpInfo, dst, rowBytes);
     }
 
+    if (options.fExecutor) {
+        // libwebp runs its own worker thread for filtering alongside decoding.
+        config.options.use_threads = 1;
+    }
+
     config.output.colorspace = webp_decode_mode(webpInfo.colorType(),
             frame.has_alpha && dstInfo.alphaType() == kPremul_SkAlphaType && !this->colorXform());
     config.output.is_external_memory = 1;
@@ -530,38 +536,48 @@ SkCodec::Result SkWebpCodec::onGetPixels(const SkImageInfo& dstInfo, void* dst,
     const size_t srcRowBytes = config.output.u.RGBA.stride;
 
     const auto dstCT = dstInfo.colorType();
-    if (this->colorXform()) {
-        uint32_t* xformSrc = (uint32_t*) config.output.u.RGBA.rgba;
-        SkBitmap tmp;
-        void* xformDst;
-
-        if (blendWithPrevFrame) {
-            // Xform into temporary bitmap big enough for one row.
-            tmp.allocPixels(dstInfo.makeWH(scaledWidth, 1));
-            xformDst = tmp.getPixels();
-        } else {
-            xformDst = dst;
-        }
-
-        for (int y = 0; y < rowsDecoded; y++) {
-            this->applyColorXform(xformDst, xformSrc, scaledWidth);
+    const bool xform = this->colorXform();
+    // Rows are independent once libwebp is done, so this may run in bands on an executor.
+    auto finishRows = [&](int top, int bottom) {
+        const uint8_t* src = SkTAddOffset<const uint8_t>(config.output.u.RGBA.rgba,
+                                                         top * srcRowBytes);
+        void* dstRow = SkTAddOffset<void>(dst, top * rowBytes);
+        if (xform) {
+            SkBitmap tmp;
             if (blendWithPrevFrame) {
-                blend_line(dstCT, dst, dstCT, xformDst,
+                // Xform into temporary bitmap big enough for one row.
+                tmp.allocPixels(dstInfo.makeWH(scaledWidth, 1));
+            }
+            for (int y = top; y < bottom; y++) {
+                if (blendWithPrevFrame) {
+                    this->applyColorXform(tmp.getPixels(), src, scaledWidth);
+                    blend_line(dstCT, dstRow, dstCT, tmp.getPixels(),
+                            dstInfo.alphaType(), frame.has_alpha, scaledWidth);
+                } else {
+                    this->applyColorXform(dstRow, src, scaledWidth);
+                }
+                dstRow = SkTAddOffset<void>(dstRow, rowBytes);
+                src = SkTAddOffset<const uint8_t>(src, srcRowBytes);
+            }
+        } else if (blendWithPrevFrame) {
+            for (int y = top; y < bottom; y++) {
+                blend_line(dstCT, dstRow, webpDst.colorType(), src,
                         dstInfo.alphaType(), frame.has_alpha, scaledWidth);
-                dst = SkTAddOffset<void>(dst, rowBytes);
-            } else {
-                xformDst = SkTAddOffset<void>(xformDst, rowBytes);
+                src = SkTAddOffset<const uint8_t>(src, srcRowBytes);
+                dstRow = SkTAddOffset<void>(dstRow, rowBytes);
             }
-            xformSrc = SkTAddOffset<uint32_t>(xformSrc, srcRowBytes);
         }
-    } else if (blendWithPrevFrame) {
-        const uint8_t* src = config.output.u.RGBA.rgba;
-
-        for (int y = 0; y < rowsDecoded; y++) {
-            blend_line(dstCT, dst, webpDst.colorType(), src,
-                    dstInfo.alphaType(), frame.has_alpha, scaledWidth);
-            src = SkTAddOffset<const uint8_t>(src, srcRowBytes);
-            dst = SkTAddOffset<void>(dst, rowBytes);
+    };
+
+    if (xform || blendWithPrevFrame) {
+        constexpr int kRowsPerBand = 64;
+        const int bands = options.fExecutor ? (rowsDecoded + kRowsPerBand - 1) / kRowsPerBand : 1;
+        if (bands > 1) {
+            SkTaskGroup(*options.fExecutor).batch(bands, [&](int band) {
+                finishRows(band * kRowsPerBand, SkTMin((band + 1) * kRowsPerBand, rowsDecoded));
+            });
+        } else {
+            finishRows(0, rowsDecoded);
         }
     }
 
@@ -0,0 +1,703 @@
+/*
+ * Copyright 2018 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "SkWuffsPngCodec.h"
+
+#include "../private/SkMalloc.h"
+#include "SkCodecPriv.h"
+#include "SkPngPriv.h"
+#include "SkSampler.h"
+#include "SkStream.h"
+#include "SkSwizzler.h"
+#include "SkTemplates.h"
+#include "SkUtils.h"
+#ifdef SK_HAS_PNG_LIBRARY
+#include "SkPngCodec.h"
+#endif
+
+// As in SkWuffsCodec.cpp, this #include is of a header file, even though that
+// file name ends in ".c". PNG needs a newer Wuffs release than the GIF codec,
+// so it comes from its own checkout: see //third_party/wuffs:wuffs_png.
+#if defined(WUFFS_IMPLEMENTATION)
+#error "SkWuffsPngCodec should not #define WUFFS_IMPLEMENTATION"
+#endif
+#include "wuffs-v0.3.c"
+#if (WUFFS_VERSION_MAJOR == 0) && (WUFFS_VERSION_MINOR < 3)
+#error "Wuffs version is too old. SkWuffsPngCodec needs v0.3 or later."
+#endif
+
+#define SK_WUFFS_PNG_CODEC_BUFFER_SIZE 4096
+
+static bool fill_buffer(wuffs_base__io_buffer* b, SkStream* s) {
+    b->compact();
+    size_t num_read = s->read(b->data.ptr + b->meta.wi, b->data.len - b->meta.wi);
+    b->meta.wi += num_read;
+    b->meta.closed = s->isAtEnd();
+    return num_read > 0;
+}
+
+// -------------------------------- PNG header
+
+// Wuffs' image config has the width, height and pixel format of the image, but
+// not everything that SkPngCodec puts in its SkEncodedInfo: the sBIT chunk
+// and, unless there's an ICC profile, the color chunks. SkPngHeader holds what
+// we read of the chunks before the first IDAT so that the two codecs report
+// the same SkEncodedInfo for the same image.
+struct SkPngHeader {
+    uint32_t fWidth;
+    uint32_t fHeight;
+    int      fBitDepth;
+    int      fColorType;
+    bool     fInterlaced;
+
+    bool fHasTRNS;
+    bool fHasICCP;
+    bool fHasSRGB;
+    bool fHasCHRM;
+    bool fHasGAMA;
+    bool fHasSBIT;
+
+    uint32_t fCHRM[8];  // White point, then red, green and blue, times 100000.
+    uint32_t fGAMA;     // 1 / gamma, times 100000.
+    uint8_t  fSBIT[4];
+};
+
+// The PNG color types.
+enum {
+    kGray_PngColorType      = 0,
+    kRGB_PngColorType       = 2,
+    kPalette_PngColorType   = 3,
+    kGrayAlpha_PngColorType = 4,
+    kRGBA_PngColorType      = 6,
+};
+
+static uint32_t read_be32(const uint8_t* p) {
+    return (uint32_t(p[0]) << 24) | (uint32_t(p[1]) << 16) | (uint32_t(p[2]) << 8) | p[3];
+}
+
+static int sbit_length(int colorType) {
+    switch (colorType) {
+        case kGray_PngColorType:      return 1;
+        case kRGB_PngColorType:       return 3;
+        case kPalette_PngColorType:   return 3;
+        case kGrayAlpha_PngColorType: return 2;
+        case kRGBA_PngColorType:      return 4;
+        default:                      return 0;
+    }
+}
+
+// Reads the chunks before the first IDAT. Chunks we don't need are skipped,
+// not checked: Wuffs verifies all of them when it decodes.
+static SkCodec::Result read_header(SkStream* stream, SkPngHeader* header) {
+    sk_bzero(header, sizeof(*header));
+
+    uint8_t signature[8];
+    if (stream->read(signature, sizeof(signature)) != sizeof(signature)) {
+        return SkCodec::kIncompleteInput;
+    }
+    if (!SkWuffsPngCodec_IsFormat(signature, sizeof(signature))) {
+        return SkCodec::kInvalidInput;
+    }
+
+    bool sawIHDR = false;
+    while (true) {
+        uint8_t chunk[8];
+        if (stream->read(chunk, sizeof(chunk)) != sizeof(chunk)) {
+            return SkCodec::kIncompleteInput;
+        }
+        const uint32_t length = read_be32(chunk);
+        const uint8_t* tag = chunk + 4;
+        if (length > 0x7FFFFFFF) {
+            return SkCodec::kInvalidInput;
+        }
+        auto is = [tag](const char* name) { return memcmp(tag, name, 4) == 0; };
+
+        // IHDR must come first.
+        if (sawIHDR == is("IHDR")) {
+            return SkCodec::kInvalidInput;
+        }
+        if (is("IDAT")) {
+            return SkCodec::kSuccess;
+        }
+        if (is("IEND")) {
+            return SkCodec::kInvalidInput;
+        }
+
+        uint8_t  data[32];
+        uint32_t dataLength = 0;
+        if (is("IHDR") && length == 13) {
+            dataLength = 13;
+        } else if (is("cHRM") && length == 32) {
+            dataLength = 32;
+        } else if (is("gAMA") && length == 4) {
+            dataLength = 4;
+        } else if (is("sBIT") && sawIHDR && length == SkToU32(sbit_length(header->fColorType))) {
+            dataLength = length;
+        } else if (is("IHDR")) {
+            return SkCodec::kInvalidInput;
+        }
+        if (dataLength && stream->read(data, dataLength) != dataLength) {
+            return SkCodec::kIncompleteInput;
+        }
+
+        if (is("IHDR")) {
+            sawIHDR = true;
+            header->fWidth = read_be32(data);
+            header->fHeight = read_be32(data + 4);
+            header->fBitDepth = data[8];
+            header->fColorType = data[9];
+            header->fInterlaced = data[12] != 0;
+        } else if (is("tRNS")) {
+            header->fHasTRNS = true;
+        } else if (is("iCCP")) {
+            header->fHasICCP = true;
+        } else if (is("sRGB")) {
+            header->fHasSRGB = true;
+        } else if (is("cHRM") && dataLength) {
+            header->fHasCHRM = true;
+            for (int i = 0; i < 8; i++) {
+                header->fCHRM[i] = read_be32(data + 4 * i);
+            }
+        } else if (is("gAMA") && dataLength) {
+            // As libpng does, ignore a gamma of zero.
+            header->fGAMA = read_be32(data);
+            header->fHasGAMA = header->fGAMA != 0;
+        } else if (is("sBIT") && dataLength) {
+            header->fHasSBIT = true;
+            memcpy(header->fSBIT, data, dataLength);
+        }
+
+        // Skip the rest of the chunk and its CRC.
+        const size_t toSkip = length - dataLength + 4;
+        if (stream->skip(toSkip) != toSkip) {
+            return SkCodec::kIncompleteInput;
+        }
+    }
+}
+
+// Matches read_color_profile in SkPngCodec.cpp, for a PNG with no ICC profile.
+static std::unique_ptr<SkEncodedInfo::ICCProfile> make_color_profile(const SkPngHeader& header) {
+    if (header.fHasSRGB) {
+        return nullptr;
+    }
+
+    skcms_Matrix3x3 toXYZD50 = skcms_sRGB_profile()->toXYZD50;
+    if (header.fHasCHRM) {
+        float c[8];
+        for (int i = 0; i < 8; i++) {
+            c[i] = header.fCHRM[i] * 0.00001f;
+        }
+        skcms_Matrix3x3 tmp;
+        if (skcms_PrimariesToXYZD50(c[2], c[3], c[4], c[5], c[6], c[7], c[0], c[1], &tmp)) {
+            toXYZD50 = tmp;
+        }
+    }
+
+    skcms_TransferFunction fn;
+    if (header.fHasGAMA) {
+        fn.a = 1.0f;
+        fn.b = fn.c = fn.d = fn.e = fn.f = 0.0f;
+        fn.g = 1.0f / (header.fGAMA * 0.00001f);
+    } else {
+        fn = *skcms_sRGB_TransferFunction();
+    }
+
+    skcms_ICCProfile skcmsProfile;
+    skcms_Init(&skcmsProfile);
+    skcms_SetTransferFunction(&skcmsProfile, &fn);
+    skcms_SetXYZD50(&skcmsProfile, &toXYZD50);
+    return SkEncodedInfo::ICCProfile::Make(skcmsProfile);
+}
+
+// Matches AutoCleanPng::infoCallback in SkPngCodec.cpp.
+static SkEncodedInfo make_encoded_info(const SkPngHeader& header) {
+    int bitDepth = header.fBitDepth;
+    if (bitDepth == 16 && (kGray_PngColorType == header.fColorType ||
+                           kGrayAlpha_PngColorType == header.fColorType)) {
+        bitDepth = 8;
+    }
+
+    SkEncodedInfo::Color color;
+    SkEncodedInfo::Alpha alpha;
+    switch (header.fColorType) {
+        case kPalette_PngColorType:
+            bitDepth = 8;
+            color = SkEncodedInfo::kPalette_Color;
+            alpha = header.fHasTRNS ? SkEncodedInfo::kUnpremul_Alpha
+                                    : SkEncodedInfo::kOpaque_Alpha;
+            break;
+        case kRGB_PngColorType:
+            if (header.fHasTRNS) {
+                color = SkEncodedInfo::kRGBA_Color;
+                alpha = SkEncodedInfo::kBinary_Alpha;
+            } else {
+                color = SkEncodedInfo::kRGB_Color;
+                alpha = SkEncodedInfo::kOpaque_Alpha;
+            }
+            break;
+        case kGray_PngColorType:
+            bitDepth = SkTMax(bitDepth, 8);
+            if (header.fHasTRNS) {
+                color = SkEncodedInfo::kGrayAlpha_Color;
+                alpha = SkEncodedInfo::kBinary_Alpha;
+            } else {
+                color = SkEncodedInfo::kGray_Color;
+                alpha = SkEncodedInfo::kOpaque_Alpha;
+            }
+            break;
+        case kGrayAlpha_PngColorType:
+            color = SkEncodedInfo::kGrayAlpha_Color;
+            alpha = SkEncodedInfo::kUnpremul_Alpha;
+            break;
+        default:
+            color = SkEncodedInfo::kRGBA_Color;
+            alpha = SkEncodedInfo::kUnpremul_Alpha;
+            break;
+    }
+
+    if (header.fHasSBIT) {
+        const uint8_t* sigBits = header.fSBIT;
+        if (kGrayAlpha_PngColorType == header.fColorType) {
+            if (8 == sigBits[1] && kGraySigBit_GrayAlphaIsJustAlpha == sigBits[0]) {
+                color = SkEncodedInfo::kXAlpha_Color;
+            }
+        } else if (SkEncodedInfo::kOpaque_Alpha == alpha &&
+                   kGray_PngColorType != header.fColorType) {
+            if (5 == sigBits[0] && 6 == sigBits[1] && 5 == sigBits[2]) {
+                color = SkEncodedInfo::k565_Color;
+            }
+        }
+    }
+
+    return SkEncodedInfo::Make(header.fWidth, header.fHeight, color, alpha, bitDepth,
+                               make_color_profile(header));
+}
+
+// -------------------------------- Class definition
+
+// SkWuffsPngCodec has Wuffs decode the whole image, deinterlacing and
+// expanding it to 8 (or, for 16-bit images, 16) bits per channel, non
+// premultiplied BGRA or RGBA. Each row of that is then sampled and converted
+// to the destination: by an SkSwizzler for 8888 destinations, or by skcms for
+// everything else and for color transforms.
+class SkWuffsPngCodec final : public SkCodec {
+public:
+    SkWuffsPngCodec(SkEncodedInfo&&                                         encodedInfo,
+                    skcms_PixelFormat                                       srcFormat,
+                    bool                                                    interlaced,
+                    std::unique_ptr<SkStream>                               stream,
+                    std::unique_ptr<wuffs_png__decoder, decltype(&sk_free)> dec,
+                    const wuffs_base__pixel_config&                         pixcfg,
+                    size_t                                                  workbuf_len,
+                    wuffs_base__io_buffer                                   iobuf);
+
+private:
+    // SkCodec overrides.
+    SkEncodedImageFormat onGetEncodedFormat() const override;
+    Result onGetPixels(const SkImageInfo&, void*, size_t, const Options&, int*) override;
+    Result               onStartIncrementalDecode(const SkImageInfo&      dstInfo,
+                                                  void*                   dst,
+                                                  size_t                  rowBytes,
+                                                  const SkCodec::Options& options) override;
+    Result               onIncrementalDecode(int* rowsDecoded) override;
+    SkSampler*           getSampler(bool createIfNecessary) override;
+    bool                 onRewind() override;
+
+    bool        allocateBuffers();
+    void        freeBuffers();
+    const char* decodeFrame();
+    void        convertRow(void* dst, const uint8_t* src);
+
+    const skcms_PixelFormat                                 fSrcFormat;
+    const size_t                                            fSrcBytesPerPixel;
+    const bool                                              fInterlaced;
+    std::unique_ptr<wuffs_png__decoder, decltype(&sk_free)> fDecoder;
+    const wuffs_base__pixel_config                          fPixelConfig;
+    const size_t                                            fWorkbufLen;
+
+    // The decoded image, and what Wuffs needs to decode it, can be far bigger than the encoded
+    // one, so these are only allocated while decoding.
+    std::unique_ptr<uint8_t, decltype(&sk_free)>            fPixbufPtr;
+    std::unique_ptr<uint8_t, decltype(&sk_free)>            fWorkbufPtr;
+
+    wuffs_base__pixel_buffer fPixelBuffer;
+    wuffs_base__io_buffer    fIOBuffer;
+
+    // Incremental decoding state.
+    uint8_t* fIncrDecDst;
+    size_t   fIncrDecRowBytes;
+    uint32_t fIncrDecRowsSwizzled;  // Source rows already converted to fIncrDecDst.
+    int      fIncrDecDstRows;       // Destination rows written so far.
+
+    std::unique_ptr<SkSwizzler> fSwizzler;
+    SkAutoTMalloc<uint8_t>      fXformRow;  // Non-empty if rows go through skcms.
+    skcms_PixelFormat           fDstFormat;
+    skcms_AlphaFormat           fDstAlphaFormat;
+
+    uint8_t fBuffer[SK_WUFFS_PNG_CODEC_BUFFER_SIZE];
+
+    typedef SkCodec INHERITED;
+};
+
+// -------------------------------- SkWuffsPngCodec implementation
+
+SkWuffsPngCodec::SkWuffsPngCodec(
+        SkEncodedInfo&&                                         encodedInfo,
+        skcms_PixelFormat                                       srcFormat,
+        bool                                                    interlaced,
+        std::unique_ptr<SkStream>                               stream,
+        std::unique_ptr<wuffs_png__decoder, decltype(&sk_free)> dec,
+        const wuffs_base__pixel_config&                         pixcfg,
+        size_t                                                  workbuf_len,
+        wuffs_base__io_buffer                                   iobuf)
+    : INHERITED(std::move(encodedInfo), srcFormat, std::move(stream)),
+      fSrcFormat(srcFormat),
+      fSrcBytesPerPixel(srcFormat == skcms_PixelFormat_BGRA_16161616LE ? 8 : 4),
+      fInterlaced(interlaced),
+      fDecoder(std::move(dec)),
+      fPixelConfig(pixcfg),
+      fWorkbufLen(workbuf_len),
+      fPixbufPtr(nullptr, &sk_free),
+      fWorkbufPtr(nullptr, &sk_free),
+      fPixelBuffer(wuffs_base__null_pixel_buffer()),
+      fIOBuffer(wuffs_base__empty_io_buffer()),
+      fIncrDecDst(nullptr),
+      fIncrDecRowBytes(0),
+      fIncrDecRowsSwizzled(0),
+      fIncrDecDstRows(0),
+      fSwizzler(nullptr),
+      fDstFormat(skcms_PixelFormat_RGBA_8888),
+      fDstAlphaFormat(skcms_AlphaFormat_Unpremul) {
+    // As in SkWuffsCodec, copy any outstanding data from iobuf, whose backing
+    // array is on the caller's stack, to fIOBuffer.
+    SkASSERT(iobuf.data.len == SK_WUFFS_PNG_CODEC_BUFFER_SIZE);
+    memmove(fBuffer, iobuf.data.ptr, iobuf.meta.wi);
+    fIOBuffer.data = wuffs_base__make_slice_u8(fBuffer, SK_WUFFS_PNG_CODEC_BUFFER_SIZE);
+    fIOBuffer.meta = iobuf.meta;
+}
+
+bool SkWuffsPngCodec::allocateBuffers() {
+    // Wuffs only writes the pixels it has decoded, so start from transparent
+    // black, as SkWuffsCodec does, for a partial decode to be well defined.
+    const uint64_t pixbuf_len = fPixelConfig.pixbuf_len();
+    fPixbufPtr.reset(reinterpret_cast<uint8_t*>(
+        pixbuf_len <= SIZE_MAX ? sk_calloc_canfail(SkToSizeT(pixbuf_len)) : nullptr));
+    if (!fPixbufPtr) {
+        return false;
+    }
+    wuffs_base__status status = fPixelBuffer.set_from_slice(
+        &fPixelConfig, wuffs_base__make_slice_u8(fPixbufPtr.get(), SkToSizeT(pixbuf_len)));
+    if (status.repr != nullptr) {
+        SkCodecPrintf("set_from_slice: %s\n", status.message());
+        return false;
+    }
+
+    if (fWorkbufLen) {
+        fWorkbufPtr.reset(reinterpret_cast<uint8_t*>(sk_malloc_canfail(fWorkbufLen)));
+        if (!fWorkbufPtr) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void SkWuffsPngCodec::freeBuffers() {
+    fPixelBuffer = wuffs_base__null_pixel_buffer();
+    fPixbufPtr.reset();
+    fWorkbufPtr.reset();
+}
+
+SkEncodedImageFormat SkWuffsPngCodec::onGetEncodedFormat() const {
+    return SkEncodedImageFormat::kPNG;
+}
+
+SkCodec::Result SkWuffsPngCodec::onGetPixels(const SkImageInfo& dstInfo,
+                                             void*              dst,
+                                             size_t             rowBytes,
+                                             const Options&     options,
+                                             int*               rowsDecoded) {
+    SkCodec::Result result = this->onStartIncrementalDecode(dstInfo, dst, rowBytes, options);
+    if (result != kSuccess) {
+        return result;
+    }
+    return this->onIncrementalDecode(rowsDecoded);
+}
+
+SkCodec::Result SkWuffsPngCodec::onStartIncrementalDecode(const SkImageInfo&      dstInfo,
+                                                          void*                   dst,
+                                                          size_t                  rowBytes,
+                                                          const SkCodec::Options& options) {
+    if (options.fSubset) {
+        return SkCodec::kUnimplemented;
+    }
+
+    const bool n32Dst = kRGBA_8888_SkColorType == dstInfo.colorType() ||
+                        kBGRA_8888_SkColorType == dstInfo.colorType();
+    fXformRow.reset(0);
+    if (n32Dst && !this->colorXform() && fSrcBytesPerPixel == 4) {
+        const auto& info = this->getEncodedInfo();
+        const SkEncodedInfo decodedInfo = SkEncodedInfo::Make(
+                info.width(), info.height(),
+                fSrcFormat == skcms_PixelFormat_BGRA_8888 ? SkEncodedInfo::kBGRA_Color
+                                                          : SkEncodedInfo::kRGBA_Color,
+                info.alpha(), 8);
+        fSwizzler = SkSwizzler::Make(decodedInfo, nullptr, dstInfo, options);
+    } else {
+        if (!this->colorXform()) {
+            // The profiles match, but skcms still converts the format for us.
+            if (kAlpha_8_SkColorType == dstInfo.colorType()) {
+                fDstFormat = skcms_PixelFormat_A_8;
+            } else if (!sk_select_xform_format(dstInfo.colorType(), false, &fDstFormat)) {
+                return SkCodec::kInvalidConversion;
+            }
+            const bool premul = kPremul_SkAlphaType == dstInfo.alphaType() &&
+                                SkEncodedInfo::kOpaque_Alpha != this->getEncodedInfo().alpha();
+            fDstAlphaFormat = premul ? skcms_AlphaFormat_PremulAsEncoded
+                                     : skcms_AlphaFormat_Unpremul;
+        }
+
+        // The swizzler only samples, into fXformRow.
+        const SkImageInfo sampleInfo = dstInfo.makeColorType(
+                fSrcBytesPerPixel == 8 ? kRGBA_F16_SkColorType : kN32_SkColorType)
+                                              .makeAlphaType(kUnpremul_SkAlphaType);
+        Options sampleOptions = options;
+        sampleOptions.fZeroInitialized = kNo_ZeroInitialized;
+        fSwizzler = SkSwizzler::MakeSimple(fSrcBytesPerPixel, sampleInfo, sampleOptions);
+        fXformRow.reset(dstInfo.width() * fSrcBytesPerPixel);
+    }
+    if (!fSwizzler) {
+        return SkCodec::kInvalidConversion;
+    }
+
+    if (!this->allocateBuffers()) {
+        this->freeBuffers();
+        return SkCodec::kInternalError;
+    }
+    fIncrDecDst = static_cast<uint8_t*>(dst);
+    fIncrDecRowBytes = rowBytes;
+    fIncrDecRowsSwizzled = 0;
+    fIncrDecDstRows = 0;
+    return SkCodec::kSuccess;
+}
+
+void SkWuffsPngCodec::convertRow(void* dst, const uint8_t* src) {
+    if (!fXformRow.get()) {
+        fSwizzler->swizzle(dst, src);
+        return;
+    }
+
+    fSwizzler->swizzle(fXformRow.get(), src);
+    const int count = fSwizzler->swizzleWidth();
+    if (this->colorXform()) {
+        this->applyColorXform(dst, fXformRow.get(), count);
+    } else {
+        const skcms_ICCProfile* profile = this->getEncodedInfo().profile();
+        SkAssertResult(skcms_Transform(fXformRow.get(), fSrcFormat, skcms_AlphaFormat_Unpremul,
+                                       profile, dst, fDstFormat, fDstAlphaFormat, profile,
+                                       count));
+    }
+}
+
+SkCodec::Result SkWuffsPngCodec::onIncrementalDecode(int* rowsDecoded) {
+    if (!fIncrDecDst) {
+        return SkCodec::kInternalError;
+    }
+
+    SkCodec::Result result = SkCodec::kSuccess;
+    const char*     status = this->decodeFrame();
+    if (status != nullptr) {
+        if (status == wuffs_base__suspension__short_read) {
+            result = SkCodec::kIncompleteInput;
+        } else {
+            SkCodecPrintf("decodeFrame: %s\n", status);
+            result = SkCodec::kErrorInInput;
+        }
+    }
+
+    // Wuffs writes whole rows from the top down, so the rows above the bottom of the dirty
+    // rect are final, and each call only converts the rows that arrived since the last one.
+    // Later Adam7 passes fill in rows again, so interlaced images are converted once complete.
+    uint32_t height = fIncrDecRowsSwizzled;
+    if (result == SkCodec::kSuccess) {
+        height = SkToU32(this->getInfo().height());
+    } else if (!fInterlaced) {
+        height = SkTMax(height, fDecoder->frame_dirty_rect().max_excl_y);
+    }
+
+    const int                  sampleY = fSwizzler->sampleY();
+    const int                  scaledHeight = get_scaled_dimension(dstInfo().height(), sampleY);
+    const wuffs_base__table_u8 pixels = fPixelBuffer.plane(0);
+    for (uint32_t y = fIncrDecRowsSwizzled; y < height; y++) {
+        int dstY = y;
+        if (sampleY != 1) {
+            if (!fSwizzler->rowNeeded(y)) {
+                continue;
+            }
+            dstY /= sampleY;
+            if (dstY >= scaledHeight) {
+                break;
+            }
+        }
+        this->convertRow(fIncrDecDst + dstY * fIncrDecRowBytes, pixels.ptr + y * pixels.stride);
+        fIncrDecDstRows = dstY + 1;
+    }
+    fIncrDecRowsSwizzled = height;
+    if (rowsDecoded) {
+        *rowsDecoded = fIncrDecDstRows;
+    }
+
+    if (result == SkCodec::kSuccess) {
+        fIncrDecDst = nullptr;
+        fIncrDecRowBytes = 0;
+        this->freeBuffers();
+    }
+    return result;
+}
+
+SkSampler* SkWuffsPngCodec::getSampler(bool createIfNecessary) {
+    // The swizzler is made in onStartIncrementalDecode, when we know the
+    // destination, which is before anything asks to sample.
+    return fSwizzler.get();
+}
+
+const char* SkWuffsPngCodec::decodeFrame() {
+    while (true) {
+        wuffs_base__status status = fDecoder->decode_frame(
+                &fPixelBuffer, &fIOBuffer, WUFFS_BASE__PIXEL_BLEND__SRC,
+                wuffs_base__make_slice_u8(fWorkbufPtr.get(), fWorkbufLen), nullptr);
+        if ((status.repr == wuffs_base__suspension__short_read) &&
+            fill_buffer(&fIOBuffer, this->stream())) {
+            continue;
+        }
+        return status.repr;
+    }
+}
+
+// See SkWuffsCodec.cpp for an overview of the Wuffs decoding API. A PNG has
+// one frame, and a Wuffs decoder that has started decoding it can only resume
+// or start over, so every decode after the first begins here.
+static SkCodec::Result reset_and_decode_image_config(wuffs_png__decoder*       decoder,
+                                                     wuffs_base__image_config* imgcfg,
+                                                     wuffs_base__io_buffer*    b,
+                                                     SkStream*                 s) {
+    // Calling decoder->initialize will memset it to zero.
+    wuffs_base__status status =
+        decoder->initialize(sizeof__wuffs_png__decoder(), WUFFS_VERSION, 0);
+    if (status.repr != nullptr) {
+        SkCodecPrintf("initialize: %s\n", status.message());
+        return SkCodec::kInternalError;
+    }
+    while (true) {
+        status = decoder->decode_image_config(imgcfg, b);
+        if (status.repr == nullptr) {
+            break;
+        } else if (status.repr != wuffs_base__suspension__short_read) {
+            SkCodecPrintf("decode_image_config: %s\n", status.message());
+            return SkCodec::kErrorInInput;
+        } else if (!fill_buffer(b, s)) {
+            return SkCodec::kIncompleteInput;
+        }
+    }
+    return SkCodec::kSuccess;
+}
+
+bool SkWuffsPngCodec::onRewind() {
+    fIncrDecDst = nullptr;
+    this->freeBuffers();
+    fIOBuffer.meta = wuffs_base__empty_io_buffer_meta();
+    wuffs_base__image_config imgcfg = wuffs_base__null_image_config();
+    return reset_and_decode_image_config(fDecoder.get(), &imgcfg, &fIOBuffer, this->stream()) ==
+           SkCodec::kSuccess;
+}
+
+// -------------------------------- SkWuffsPngCodec.h functions
+
+bool SkWuffsPngCodec_IsFormat(const void* buf, size_t bytesRead) {
+    constexpr uint8_t png_ptr[] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+    constexpr size_t  png_len = sizeof(png_ptr);
+    return (bytesRead >= png_len) && (memcmp(buf, png_ptr, png_len) == 0);
+}
+
+std::unique_ptr<SkCodec> SkWuffsPngCodec_MakeFromStream(std::unique_ptr<SkStream> stream,
+                                                        SkCodec::Result*          result) {
+    SkPngHeader header;
+    SkCodec::Result header_result = read_header(stream.get(), &header);
+    if (!stream->rewind()) {
+        *result = SkCodec::kCouldNotRewind;
+        return nullptr;
+    }
+    if (header_result != SkCodec::kSuccess) {
+        *result = header_result;
+        return nullptr;
+    }
+#ifdef SK_HAS_PNG_LIBRARY
+    // The ICC profile is zlib compressed and needs parsing and checking, as
+    // SkPngCodec (with libpng's help) does. Those images are rare enough to
+    // leave to SkPngCodec.
+    if (header.fHasICCP) {
+        return SkPngCodec::MakeFromStream(std::move(stream), result);
+    }
+#endif
+
+    uint8_t               buffer[SK_WUFFS_PNG_CODEC_BUFFER_SIZE];
+    wuffs_base__io_buffer iobuf = wuffs_base__make_io_buffer(
+        wuffs_base__make_slice_u8(buffer, SK_WUFFS_PNG_CODEC_BUFFER_SIZE),
+        wuffs_base__empty_io_buffer_meta());
+    wuffs_base__image_config imgcfg = wuffs_base__null_image_config();
+
+    // See SkWuffsCodec_MakeFromStream for why this isn't a C++ new.
+    void* decoder_raw = sk_malloc_canfail(sizeof__wuffs_png__decoder());
+    if (!decoder_raw) {
+        *result = SkCodec::kInternalError;
+        return nullptr;
+    }
+    std::unique_ptr<wuffs_png__decoder, decltype(&sk_free)> decoder(
+        reinterpret_cast<wuffs_png__decoder*>(decoder_raw), &sk_free);
+
+    SkCodec::Result reset_result =
+        reset_and_decode_image_config(decoder.get(), &imgcfg, &iobuf, stream.get());
+    if (reset_result != SkCodec::kSuccess) {
+        *result = reset_result;
+        return nullptr;
+    }
+
+    uint32_t width = imgcfg.pixcfg.width();
+    uint32_t height = imgcfg.pixcfg.height();
+    if ((width == 0) || (width > INT_MAX) || (height == 0) || (height > INT_MAX) ||
+        (width != header.fWidth) || (height != header.fHeight)) {
+        *result = SkCodec::kInvalidInput;
+        return nullptr;
+    }
+
+    // Override the image's own pixel format with one skcms can read: keep 16
+    // bits per channel where SkPngCodec would, and 8 otherwise.
+    SkEncodedInfo     encodedInfo = make_encoded_info(header);
+    uint32_t          pixfmt;
+    skcms_PixelFormat srcFormat;
+    if (encodedInfo.bitsPerComponent() == 16) {
+        pixfmt = WUFFS_BASE__PIXEL_FORMAT__BGRA_NONPREMUL_4X16LE;
+        srcFormat = skcms_PixelFormat_BGRA_16161616LE;
+    } else if (kN32_SkColorType == kBGRA_8888_SkColorType) {
+        pixfmt = WUFFS_BASE__PIXEL_FORMAT__BGRA_NONPREMUL;
+        srcFormat = skcms_PixelFormat_BGRA_8888;
+    } else {
+        pixfmt = WUFFS_BASE__PIXEL_FORMAT__RGBA_NONPREMUL;
+        srcFormat = skcms_PixelFormat_RGBA_8888;
+    }
+    imgcfg.pixcfg.set(pixfmt, WUFFS_BASE__PIXEL_SUBSAMPLING__NONE, width, height);
+
+    uint64_t workbuf_len = decoder->workbuf_len().max_incl;
+    if (workbuf_len > SIZE_MAX) {
+        *result = SkCodec::kInternalError;
+        return nullptr;
+    }
+
+    *result = SkCodec::kSuccess;
+    return std::unique_ptr<SkCodec>(new SkWuffsPngCodec(
+        std::move(encodedInfo), srcFormat, header.fInterlaced, std::move(stream),
+        std::move(decoder), imgcfg.pixcfg, SkToSizeT(workbuf_len), iobuf));
+}
@@ -0,0 +1,18 @@
+/*
+ * Copyright 2018 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#ifndef SkWuffsPngCodec_DEFINED
+#define SkWuffsPngCodec_DEFINED
+
+#include "SkCodec.h"
+
+// These functions' types match DecoderProc in SkCodec.cpp.
+bool                     SkWuffsPngCodec_IsFormat(const void*, size_t);
+std::unique_ptr<SkCodec> SkWuffsPngCodec_MakeFromStream(std::unique_ptr<SkStream>,
+                                                        SkCodec::Result*);
+
+#endif  // SkWuffsPngCodec_DEFINED
@@ -42,6 +42,7 @@ public:
                                                            &fAlloc, true);
             fBlitter = fAlloc.make<SkPairBlitter>(fBlitter, coverageBlitter);
         }
+        fBlitter = draw.applyBlitClip(fBlitter, &fAlloc);
         return fBlitter;
     }
 
@@ -30,7 +30,7 @@ void SkNotifyBitmapGenIDIsStale(uint32_t bitmapGenID) {
 SkBitmapCacheDesc SkBitmapCacheDesc::Make(uint32_t imageID, const SkIRect& subset) {
     SkASSERT(imageID);
     SkASSERT(subset.width() > 0 && subset.height() > 0);
-    return { imageID, subset };
+    return { imageID, subset, {0, 0} };
 }
 
 SkBitmapCacheDesc SkBitmapCacheDesc::Make(const SkImage* image) {
@@ -38,6 +38,15 @@ SkBitmapCacheDesc SkBitmapCacheDesc::Make(const SkImage* image) {
     return Make(image->uniqueID(), bounds);
 }
 
+SkBitmapCacheDesc SkBitmapCacheDesc::Make(const SkImage* image, const SkISize& scaledSize) {
+    SkBitmapCacheDesc desc = Make(image);
+    if (scaledSize != desc.fSubset.size()) {
+        SkASSERT(!scaledSize.isEmpty());
+        desc.fScaledSize = scaledSize;
+    }
+    return desc;
+}
+
 namespace {
 static unsigned gBitmapKeyNamespaceLabel;
 
@@ -175,9 +184,9 @@ void SkBitmapCache::PrivateDeleteRec(Rec* rec) { delete rec; }
 
 SkBitmapCache::RecPtr SkBitmapCache::Alloc(const SkBitmapCacheDesc& desc, const SkImageInfo& info,
                                            SkPixmap* pmap) {
-    // Ensure that the info matches the subset (i.e. the subset is the entire image)
-    SkASSERT(info.width() == desc.fSubset.width());
-    SkASSERT(info.height() == desc.fSubset.height());
+    // Ensure that the info matches the subset (i.e. the subset is the entire image), or the
+    // size it was decoded at.
+    SkASSERT(info.dimensions() == desc.dimensions());
 
     const size_t rb = info.minRowBytes();
     size_t size = info.computeByteSize(rb);
@@ -291,7 +300,7 @@ const SkMipMap* SkMipMapCache::AddAndRef(const SkBitmapProvider& provider,
         return nullptr;
     }
 
-    SkMipMap* mipmap = SkMipMap::Build(src, get_fact(localCache));
+    SkMipMap* mipmap = SkMipMap::BuildLazily(src, get_fact(localCache));
     if (mipmap) {
         MipMapRec* rec = new MipMapRec(provider.makeCacheDesc(), mipmap);
         CHECK_LOCAL(localCache, add, Add, rec);
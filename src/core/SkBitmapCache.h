@@ -26,14 +26,22 @@ void SkNotifyBitmapGenIDIsStale(uint32_t bitmapGenID);
 struct SkBitmapCacheDesc {
     uint32_t    fImageID;       // != 0
     SkIRect     fSubset;        // always set to a valid rect (entire or subset)
+    SkISize     fScaledSize;    // (0, 0), or the reduced size the subset was decoded at
 
     void validate() const {
         SkASSERT(fImageID);
         SkASSERT(fSubset.fLeft >= 0 && fSubset.fTop >= 0);
         SkASSERT(fSubset.width() > 0 && fSubset.height() > 0);
+        SkASSERT(fScaledSize.isZero() || !fScaledSize.isEmpty());
+    }
+
+    // The size of the pixels cached under this desc.
+    SkISize dimensions() const {
+        return fScaledSize.isZero() ? fSubset.size() : fScaledSize;
     }
 
     static SkBitmapCacheDesc Make(const SkImage*);
+    static SkBitmapCacheDesc Make(const SkImage*, const SkISize& scaledSize);
     static SkBitmapCacheDesc Make(uint32_t genID, const SkIRect& subset);
 };
 
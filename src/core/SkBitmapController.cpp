@@ -76,29 +76,54 @@ bool SkBitmapController::State::processMediumRequest(const SkBitmapProvider& pro
     }
 
     if (invScaleSize.width() > SK_Scalar1 || invScaleSize.height() > SK_Scalar1) {
-        fCurrMip.reset(SkMipMapCache::FindAndRef(provider.makeCacheDesc()));
-        if (nullptr == fCurrMip.get()) {
-            fCurrMip.reset(SkMipMapCache::AddAndRef(provider));
+        SkSize scale = SkSize::Make(SkScalarInvert(invScaleSize.width()),
+                                    SkScalarInvert(invScaleSize.height()));
+
+        // Lazy images may be able to decode at a reduced size that is still no smaller than we
+        // draw (e.g. jpegs, by DCT scaling).  If so, we work from that instead of a full decode.
+        const SkBitmapProvider scaledProvider =
+                provider.makeScaled(SkTMax(scale.width(), scale.height()));
+        const bool isScaled = scaledProvider.dimensions() != provider.dimensions();
+        SkMatrix inv = fInvMatrix;
+        if (isScaled) {
+            const SkISize& full = provider.dimensions();
+            const SkISize& reduced = scaledProvider.dimensions();
+            const SkSize baseScale = SkSize::Make(SkIntToScalar(reduced.width())  / full.width(),
+                                                  SkIntToScalar(reduced.height()) / full.height());
+            inv.postScale(baseScale.width(), baseScale.height());
+            scale.set(scale.width() / baseScale.width(), scale.height() / baseScale.height());
+        }
+
+        if (!isScaled || scale.width() < 1 || scale.height() < 1) {
+            fCurrMip.reset(SkMipMapCache::FindAndRef(scaledProvider.makeCacheDesc()));
             if (nullptr == fCurrMip.get()) {
-                return false;
+                fCurrMip.reset(SkMipMapCache::AddAndRef(scaledProvider));
+                if (nullptr == fCurrMip.get()) {
+                    return false;
+                }
+            }
+            // diagnostic for a crasher...
+            SkASSERT_RELEASE(fCurrMip->data());
+
+            SkMipMap::Level level;
+            if (fCurrMip->extractLevel(scale, &level)) {
+                const SkSize& invScaleFixup = level.fScale;
+                fInvMatrix = inv;
+                fInvMatrix.postScale(invScaleFixup.width(), invScaleFixup.height());
+
+                // todo: if we could wrap the fCurrMip in a pixelref, then we could just install
+                //       that here, and not need to explicitly track it ourselves.
+                return fResultBitmap.installPixels(level.fPixmap);
+            } else {
+                // failed to extract, so release the mipmap
+                fCurrMip.reset(nullptr);
             }
         }
-        // diagnostic for a crasher...
-        SkASSERT_RELEASE(fCurrMip->data());
-
-        const SkSize scale = SkSize::Make(SkScalarInvert(invScaleSize.width()),
-                                          SkScalarInvert(invScaleSize.height()));
-        SkMipMap::Level level;
-        if (fCurrMip->extractLevel(scale, &level)) {
-            const SkSize& invScaleFixup = level.fScale;
-            fInvMatrix.postScale(invScaleFixup.width(), invScaleFixup.height());
-
-            // todo: if we could wrap the fCurrMip in a pixelref, then we could just install
-            //       that here, and not need to explicitly track it ourselves.
-            return fResultBitmap.installPixels(level.fPixmap);
-        } else {
-            // failed to extract, so release the mipmap
-            fCurrMip.reset(nullptr);
+
+        // The reduced size decode is close enough to what we draw to use as is.
+        if (isScaled && scaledProvider.asBitmap(&fResultBitmap)) {
+            fInvMatrix = inv;
+            return true;
         }
     }
     return false;
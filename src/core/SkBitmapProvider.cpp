@@ -8,8 +8,14 @@
 #include "SkBitmapProvider.h"
 #include "SkImage_Base.h"
 
+SkBitmapProvider SkBitmapProvider::makeScaled(float scale) const {
+    SkBitmapProvider scaled(*this);
+    scaled.fSize = as_IB(fImage)->scaledDimensions(scale);
+    return scaled;
+}
+
 SkBitmapCacheDesc SkBitmapProvider::makeCacheDesc() const {
-    return SkBitmapCacheDesc::Make(fImage);
+    return SkBitmapCacheDesc::Make(fImage, fSize);
 }
 
 void SkBitmapProvider::notifyAddedToCache() const {
@@ -17,5 +23,5 @@ void SkBitmapProvider::notifyAddedToCache() const {
 }
 
 bool SkBitmapProvider::asBitmap(SkBitmap* bm) const {
-    return as_IB(fImage)->getROPixels(bm);
+    return as_IB(fImage)->getScaledROPixels(bm, fSize);
 }
@@ -14,13 +14,23 @@
 class SkBitmapProvider {
 public:
     explicit SkBitmapProvider(const SkImage* img)
-        : fImage(img) {
+        : fImage(img)
+        , fSize(img->dimensions()) {
         SkASSERT(img);
     }
     SkBitmapProvider(const SkBitmapProvider& other)
         : fImage(other.fImage)
+        , fSize(other.fSize)
     {}
 
+    // Returns a provider of the same image, decoded at the smallest size that is at least
+    // scale times the image's and that the image can produce more cheaply than a full size
+    // copy (see SkImage_Base::scaledDimensions()).  Often that is the full size.
+    SkBitmapProvider makeScaled(float scale) const;
+
+    // The dimensions of the bitmap asBitmap() returns.
+    const SkISize& dimensions() const { return fSize; }
+
     SkBitmapCacheDesc makeCacheDesc() const;
     void notifyAddedToCache() const;
 
@@ -36,6 +46,7 @@ private:
     // SkBitmapProvider is always short-lived/stack allocated, and the source image is guaranteed
     // to outlive its scope => we can store a raw ptr to avoid ref churn.
     const SkImage* fImage;
+    SkISize        fSize;
 };
 
 #endif
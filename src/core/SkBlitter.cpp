@@ -110,8 +110,6 @@ void SkBlitter::blitCoverageDeltas(SkCoverageDeltaList* deltas, const SkIRect& c
     SkAlpha*    alphas  = reinterpret_cast<SkAlpha*>(runs + runSize);
     runs[clip.width()]  = 0; // we must set the last run to 0 so blitAntiH can stop there
 
-    bool canUseMask = !deltas->forceRLE() &&
-                      SkCoverageDeltaMask::CanHandle(SkIRect::MakeLTRB(0, 0, clip.width(), 1));
     const SkAntiRect& antiRect = deltas->getAntiRect();
 
     // Only access rows within our clip. Otherwise, we'll have data race in the threaded backend.
@@ -160,7 +158,7 @@ void SkBlitter::blitCoverageDeltas(SkCoverageDeltaList* deltas, const SkIRect& c
         // If there are too many deltas, sorting will be slow. Using a mask is much faster.
         // This is such an important optimization that will bring ~2x speedup for benches like
         // path_fill_small_long_line and path_stroke_small_sawtooth.
-        if (canUseMask && !deltas->sorted(y) && deltas->count(y) << 3 >= clip.width()) {
+        if (deltas->blitRowAsMask(y, clip.width())) {
             // Note that deltas->left()/right() may be different than clip.fLeft/fRight because in
             // the threaded backend, deltas are generated in the initFn with full clip, while
             // blitCoverageDeltas is called in drawFn with a subclip. For inverse fill, the clip
@@ -174,7 +172,8 @@ void SkBlitter::blitCoverageDeltas(SkCoverageDeltaList* deltas, const SkIRect& c
                 mask.addDelta(delta.fX, y, delta.fDelta);
             }
             mask.convertCoverageToAlpha(isEvenOdd, isInverse, isConvex);
-            this->blitMask(mask.prepareSkMask(), rowIR);
+            this->blitMask(mask.prepareSkMask(),
+                           SkIRect::MakeLTRB(clip.fLeft, y, clip.fRight, y + 1));
             continue;
         }
 
@@ -588,6 +587,26 @@ const SkPixmap* SkRectClipBlitter::justAnOpaqueColor(uint32_t* value) {
     return fBlitter->justAnOpaqueColor(value);
 }
 
+void SkRectClipBlitter::blitCoverageDeltas(SkCoverageDeltaList* deltas, const SkIRect& clip,
+                                           bool isEvenOdd, bool isInverse, bool isConvex) {
+    // Rows outside of our clip draw nothing, so don't even accumulate them. Each tile of the
+    // threaded backend then only reads its own rows of a list shared by all tiles.
+    SkIRect rows = clip;
+    rows.fTop    = SkTMax(clip.fTop,    fClipRect.fTop);
+    rows.fBottom = SkTMin(clip.fBottom, fClipRect.fBottom);
+    if (rows.fTop >= rows.fBottom) {
+        return;
+    }
+
+    if (fClipRect.fLeft <= clip.fLeft && clip.fRight <= fClipRect.fRight) {
+        // Nothing within clip needs clipping horizontally, so let the wrapped blitter skip rows
+        // outside of its own clip too.
+        fBlitter->blitCoverageDeltas(deltas, rows, isEvenOdd, isInverse, isConvex);
+    } else {
+        this->SkBlitter::blitCoverageDeltas(deltas, rows, isEvenOdd, isInverse, isConvex);
+    }
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 
 void SkRgnClipBlitter::blitH(int x, int y, int width) {
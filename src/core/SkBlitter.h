@@ -198,6 +198,8 @@ public:
                      SkAlpha leftAlpha, SkAlpha rightAlpha) override;
     void blitMask(const SkMask&, const SkIRect& clip) override;
     const SkPixmap* justAnOpaqueColor(uint32_t* value) override;
+    void blitCoverageDeltas(SkCoverageDeltaList* deltas, const SkIRect& clip,
+                            bool isEvenOdd, bool isInverse, bool isConvex) override;
 
     int requestRowsPreserved() const override {
         return fBlitter->requestRowsPreserved();
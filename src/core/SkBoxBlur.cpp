@@ -0,0 +1,424 @@
+/*
+ * Copyright 2018 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "SkBoxBlur.h"
+
+#include "SkExecutor.h"
+#include "SkNx.h"
+#include "SkOpts.h"
+#include "SkPixmap.h"
+#include "SkTaskGroup.h"
+#include "SkTemplates.h"
+
+#include <cmath>
+#include <functional>
+#include <limits>
+#include <utility>
+
+static constexpr double kPi = 3.14159265358979323846264338327950288;
+
+// 255 is the largest window that will not cause a buffer full of 255 values to overflow.
+// Explanation of maximums:
+//   sum0 = window * 255
+//   sum1 = window * sum0 -> window * window * 255
+//   sum2 = window * sum1 -> window * window * window * 255 -> window^3 * 255
+//
+//   The value window^3 * 255 must fit in a uint32_t. So,
+//      window^3 < 2^32. window = 255.
+//
+// That is a sigma of about 136 at full scale.  Larger sigmas have to be downscaled.
+static constexpr int kMaxWindow = 255;
+
+// This is defined by the SVG spec.
+static int window_for_sigma(double sigma) {
+    return std::max(1, static_cast<int>(floor(sigma * 3 * sqrt(2 * kPi) / 4 + 0.5)));
+}
+
+// The border is the distance in pixels between the first dst pixel and the first src pixel (or
+// the last src pixel and the last dst pixel).  Given a stack of filters seven wide for the odd
+// case of three passes,
+//
+//        S
+//     aaaAaaa
+//     bbbBbbb
+//     cccCccc
+//        D
+//
+// the furthest changed pixel is when the filters are in the following configuration.
+//
+//                 S
+//           aaaAaaa
+//        bbbBbbb
+//     cccCccc
+//        D
+//
+// The A pixel is calculated using the value S, the B uses A, and the C uses B, and finally D is
+// C.  So, with a window size of seven the border is nine.  In the odd case, the border is
+// 3*((window - 1)/2).
+//
+// For even windows the spec specifies two passes of even filters and a final pass of odd
+// filters, one wider.  That makes the border 3 * (window/2) - 1.
+static int border_for_window(int window) {
+    return (window & 1) == 1 ? 3 * ((window - 1) / 2) : 3 * (window / 2) - 1;
+}
+
+// How far three box passes spread pixels, as a variance.
+static double variance_for_window(int window) {
+    double w = window;
+    return (window & 1) == 1 ? (w * w - 1) / 4 : (3 * w * w + 2 * w - 2) / 12;
+}
+
+// Box filtering down by scale and interpolating back up spreads pixels by about scale^2/4 more,
+// so a downscaled blur runs the window whose spread comes closest to making up the rest.  What it
+// gets wrong is mostly the difference in spread, and the curvature the interpolation misses.
+// Either is worst along a hard edge; the weights here fit the worst errors measured along the
+// edges of rects and checkerboards, in 8-bit steps.
+static double downscale_error(double variance, int scale, int window) {
+    const double sigma  = sqrt(variance),
+                 scaled = scale * sqrt(variance_for_window(window) + 0.25);
+    return 140 * std::abs(scaled - sigma) / sigma + 24 * scale * scale / variance;
+}
+
+static SkBoxBlur::Pass make_pass(double sigma, float maxError) {
+    SkBoxBlur::Pass pass;
+    // Far past any layer's worth of pixels, this just keeps the window in range.
+    const int window = window_for_sigma(std::min(sigma, 10000.0));
+    if (window <= 1) {
+        return pass;
+    }
+    if (window <= kMaxWindow) {
+        pass.fWindow = window;
+        pass.fBorder = border_for_window(window);
+    }
+
+    // Try the largest scales first, leaving at least a few pixels of blur at the smaller scale.
+    // Halving barely pays for resampling, so that is only worth it to keep the sums in range.
+    const double variance = variance_for_window(window);
+    const int minScale = window > kMaxWindow ? 2 : 3;
+    double bestError = std::numeric_limits<double>::infinity();
+    for (int scale = static_cast<int>(sqrt(variance) / 3); scale >= minScale; scale--) {
+        const double target = variance / (scale * scale) - 0.25;
+        const int guess = static_cast<int>(sqrt(4 * target + 1));
+        int smallWindow = 0;
+        for (int w = std::max(2, guess - 1); w <= std::min(kMaxWindow, guess + 2); w++) {
+            if (!smallWindow || std::abs(variance_for_window(w) - target) <
+                                std::abs(variance_for_window(smallWindow) - target)) {
+                smallWindow = w;
+            }
+        }
+        if (!smallWindow) {
+            continue;
+        }
+
+        double error = downscale_error(variance, scale, smallWindow);
+        // At full scale the sums would overflow, so settle for the closest downscale if need be.
+        if (error <= maxError || (window > kMaxWindow && error < bestError)) {
+            bestError = error;
+            pass.fWindow = smallWindow;
+            pass.fScale  = scale;
+            // The blur at the smaller scale reaches its border past the small pixels src covers,
+            // which can end almost a small pixel past src, and interpolation reaches another.
+            pass.fBorder = scale * (border_for_window(smallWindow) + 2);
+            if (error <= maxError) {
+                break;
+            }
+        }
+    }
+    return pass;
+}
+
+SkBoxBlur::SkBoxBlur(double sigmaX, double sigmaY, float maxError, Rounding rounding)
+    : fRounding(rounding) {
+    SkASSERT(sigmaX >= 0 && sigmaY >= 0);
+    // The errors of the two directions add up along corners.
+    const bool both = window_for_sigma(sigmaX) > 1 && window_for_sigma(sigmaY) > 1;
+    fX = make_pass(sigmaX, both ? maxError / 2 : maxError);
+    fY = make_pass(sigmaY, both ? maxError / 2 : maxError);
+}
+
+bool SkBoxBlur::isIdentity() const {
+    return fX.fWindow <= 1 && fY.fWindow <= 1;
+}
+
+// Splits count units of work, each about unitBytes, into bands big enough to be worth a task.
+static void for_each_band(SkExecutor* executor, int count, size_t unitBytes,
+                          const std::function<void(int, int)>& fn) {
+    constexpr size_t kMinBandBytes = 64 * 1024;
+    const int bands = executor ? (int)std::min<size_t>(count, count * unitBytes / kMinBandBytes)
+                               : 1;
+    if (bands > 1) {
+        SkTaskGroup(*executor).batch(bands, [&](int band) {
+            fn(count * band / bands, count * (band + 1) / bands);
+        });
+    } else {
+        fn(0, count);
+    }
+}
+
+// Blurs down the width byte columns of src into dst.  Row 0 of src lands on row srcTop of dst.
+// Bands of columns are independent, so they can run in parallel.
+static void blur_columns(int window, bool roundProduct,
+                         const uint8_t* src, size_t srcRB, int srcH, int srcTop,
+                         uint8_t* dst, size_t dstRB, int dstH, int width, SkExecutor* executor) {
+    if (window <= 1) {
+        for (int y = 0; y < dstH; y++) {
+            if (0 <= y - srcTop && y - srcTop < srcH) {
+                memcpy(dst + y * dstRB, src + (y - srcTop) * srcRB, width);
+            } else {
+                sk_bzero(dst + y * dstRB, width);
+            }
+        }
+        return;
+    }
+
+    // Bands are whole 16 byte strips, as SkOpts::box_blur_columns() blurs them.
+    const int strips = (width + 15) / 16;
+    for_each_band(executor, strips, 16 * (size_t)(srcH + dstH), [&](int first, int last) {
+        const int left  = 16 * first,
+                  right = std::min(width, 16 * last);
+        SkOpts::box_blur_columns(src + left, srcRB, srcH, srcTop,
+                                 dst + left, dstRB, dstH, right - left, window, roundProduct);
+    });
+}
+
+// dst[x][y] = src[y][x].
+static void transpose(int bpp, uint8_t* dst, size_t dstRB, const uint8_t* src, size_t srcRB,
+                      int w, int h) {
+    if (bpp == 1) {
+        SkOpts::transpose8(dst, dstRB, src, srcRB, w, h);
+    } else {
+        SkOpts::transpose32((uint32_t*)dst, dstRB, (const uint32_t*)src, srcRB, w, h);
+    }
+}
+
+// Blurs at full scale; src lands at (left, top) in dst.  Both directions run down columns, in
+// strips that make the most of each cache line.  To blur across rows, bands of them are
+// transposed into columns of a small buffer and back again into dst, where the blur down
+// columns can then run in place, as each row it writes has already been read.
+static void blur_full_scale(const SkBoxBlur::Pass& passX, const SkBoxBlur::Pass& passY,
+                            bool roundProduct, int bpp,
+                            const uint8_t* src, size_t srcRB, int srcW, int srcH, int left, int top,
+                            uint8_t* dst, size_t dstRB, int dstW, int dstH,
+                            SkExecutor* executor) {
+    SkASSERT(passX.fScale == 1 && passY.fScale == 1);
+    if (passX.fWindow <= 1) {
+        blur_columns(passY.fWindow, roundProduct, src, srcRB, srcH, top,
+                     dst + left * bpp, dstRB, dstH, srcW * bpp, executor);
+        for (int y = 0; y < dstH; y++) {
+            sk_bzero(dst + y * dstRB, left * bpp);
+            sk_bzero(dst + y * dstRB + (left + srcW) * bpp, (dstW - left - srcW) * bpp);
+        }
+        return;
+    }
+
+    // Each band of rows becomes 64 byte rows of t, whose columns blur into u.
+    const int bandRows = 64 / bpp;
+    const int bands = (srcH + bandRows - 1) / bandRows;
+    for_each_band(executor, bands, 64 * (size_t)(srcW + dstW), [&](int first, int last) {
+        SkAutoTMalloc<uint8_t> t(srcW * 64),
+                               u(dstW * 64);
+        for (int y = first * bandRows; y < std::min(srcH, last * bandRows); y += bandRows) {
+            const int rows = std::min(bandRows, srcH - y);
+            const size_t tRB = rows * bpp;
+            transpose(bpp, t.get(), tRB, src + y * srcRB, srcRB, srcW, rows);
+            blur_columns(passX.fWindow, roundProduct, t.get(), tRB, srcW, left,
+                         u.get(), tRB, dstW, tRB, nullptr);
+            transpose(bpp, dst + (top + y) * dstRB, dstRB, u.get(), tRB, rows, dstW);
+        }
+    });
+
+    if (passY.fWindow <= 1) {
+        for (int y = 0; y < dstH; y++) {
+            if (y < top || y >= top + srcH) {
+                sk_bzero(dst + y * dstRB, dstW * bpp);
+            }
+        }
+        return;
+    }
+    blur_columns(passY.fWindow, roundProduct, dst + top * dstRB, dstRB, srcH, top,
+                 dst, dstRB, dstH, dstW * bpp, executor);
+}
+
+// At 1/scale, small pixel j covers the full scale pixels from offset + j*scale to just before
+// offset + (j+1)*scale.  Full scale pixel d lies between the centers of small pixels k and k+1,
+// frac/256 of the way to k+1.
+static void locate(int d, int offset, int scale, int* k, int* frac) {
+    const int num = 2 * (d - offset) + 1 - scale,
+              den = 2 * scale;
+    *k = num >= 0 ? num / den : -((den - 1 - num) / den);
+    *frac = ((num - *k * den) * 256 + scale) / den;
+}
+
+// Box filters src down by scaleX x scaleY into small, padding src's edges with zeros.
+static void downsample(int bpp, const uint8_t* src, size_t srcRB, int srcW, int srcH,
+                       int scaleX, int scaleY, uint8_t* small, size_t smallRB,
+                       SkExecutor* executor) {
+    const int smallW = (srcW + scaleX - 1) / scaleX,
+              smallH = (srcH + scaleY - 1) / scaleY,
+              width  = srcW * bpp;
+    const float invArea = 1.0f / (scaleX * scaleY);
+
+    for_each_band(executor, smallH, scaleY * srcRB, [&](int first, int last) {
+        // The columns of each band of scaleY rows are summed four bytes at a time.
+        SkAutoTMalloc<uint32_t> sums(width);
+        for (int j = first; j < last; j++) {
+            sk_bzero(sums.get(), width * sizeof(uint32_t));
+            for (int y = j * scaleY; y < std::min(srcH, (j + 1) * scaleY); y++) {
+                const uint8_t* row = src + y * srcRB;
+                int c = 0;
+                for (; c + 4 <= width; c += 4) {
+                    (Sk4u::Load(sums + c) + SkNx_cast<uint32_t>(Sk4b::Load(row + c)))
+                            .store(sums + c);
+                }
+                for (; c < width; c++) {
+                    sums[c] += row[c];
+                }
+            }
+
+            uint8_t* out = small + j * smallRB;
+            for (int i = 0; i < smallW; i++) {
+                const int end = std::min(srcW, (i + 1) * scaleX);
+                if (bpp == 4) {
+                    Sk4u sum(0);
+                    for (int x = i * scaleX; x < end; x++) {
+                        sum += Sk4u::Load(sums + 4 * x);
+                    }
+                    SkNx_cast<uint8_t>(SkNx_cast<float>(sum) * invArea + 0.5f).store(out + 4 * i);
+                } else {
+                    uint32_t sum = 0;
+                    for (int x = i * scaleX; x < end; x++) {
+                        sum += sums[x];
+                    }
+                    out[i] = static_cast<uint8_t>(sum * invArea + 0.5f);
+                }
+            }
+        }
+    });
+}
+
+// Interpolates small back up into dst, where small pixel (0,0) sits at (left, top) at 1/scale.
+// Each small row is interpolated across into a dst wide row of 8.8 fixed point values, and each
+// dst row mixes the two of those around it.
+static void upsample(int bpp, const uint8_t* small, size_t smallRB, int smallW, int smallH,
+                     int left, int top, int scaleX, int scaleY,
+                     uint8_t* dst, size_t dstRB, int dstW, int dstH, SkExecutor* executor) {
+    SkAutoTMalloc<int> columns(dstW),
+                       fracs(dstW);
+    for (int x = 0; x < dstW; x++) {
+        locate(x, left, scaleX, &columns[x], &fracs[x]);
+        SkASSERT(0 <= columns[x] && columns[x] + 1 < smallW);
+    }
+
+    const int width = dstW * bpp;
+    auto across = [&](int k, uint16_t* row) {
+        const uint8_t* p = small + k * smallRB;
+        for (int x = 0; x < dstW; x++) {
+            const uint8_t* pair = p + columns[x] * bpp;
+            const int f = fracs[x];
+            for (int channel = 0; channel < bpp; channel++) {
+                row[x * bpp + channel] = pair[channel] * (256 - f) + pair[bpp + channel] * f;
+            }
+        }
+    };
+
+    for_each_band(executor, dstH, width, [&](int first, int last) {
+        SkAutoTMalloc<uint16_t> rows(2 * width);
+        uint16_t* a = rows.get();
+        uint16_t* b = a + width;
+        int ka = -2;    // The small row in a, none yet.
+        for (int y = first; y < last; y++) {
+            int k, frac;
+            locate(y, top, scaleY, &k, &frac);
+            SkASSERT(0 <= k && k + 1 < smallH);
+            if (k != ka) {
+                if (k == ka + 1) {
+                    std::swap(a, b);
+                } else {
+                    across(k, a);
+                }
+                across(k + 1, b);
+                ka = k;
+            }
+
+            uint8_t* out = dst + y * dstRB;
+            int c = 0;
+            if (frac == 0) {
+                for (; c + 8 <= width; c += 8) {
+                    SkNx_cast<uint8_t>((Sk8h::Load(a + c) + Sk8h(128)) >> 8).store(out + c);
+                }
+                for (; c < width; c++) {
+                    out[c] = (a[c] + 128) >> 8;
+                }
+            } else {
+                // mulHi() by 8.8 weights keeps the mix in 8.8, a hair under the exact value.
+                const Sk8h wa((256 - frac) << 8),
+                           wb(frac << 8);
+                for (; c + 8 <= width; c += 8) {
+                    Sk8h mix = Sk8h::Load(a + c).mulHi(wa) + Sk8h::Load(b + c).mulHi(wb);
+                    SkNx_cast<uint8_t>((mix + Sk8h(128)) >> 8).store(out + c);
+                }
+                for (; c < width; c++) {
+                    out[c] = (((a[c] * (256 - frac)) >> 8) + ((b[c] * frac) >> 8) + 128) >> 8;
+                }
+            }
+        }
+    });
+}
+
+void SkBoxBlur::blur(const SkPixmap& src, SkIPoint srcOffset, const SkPixmap& dst,
+                     SkExecutor* executor) const {
+    SkASSERT(src.colorType() == dst.colorType());
+    SkASSERT(src.colorType() == kAlpha_8_SkColorType || src.colorType() == kN32_SkColorType);
+    SkASSERT(SkIRect::MakeWH(dst.width(), dst.height()).contains(
+             SkIRect::MakeXYWH(srcOffset.x(), srcOffset.y(), src.width(), src.height())));
+
+    const int bpp = src.info().bytesPerPixel();
+    auto srcPixels = static_cast<const uint8_t*>(src.addr());
+    auto dstPixels = static_cast<uint8_t*>(dst.writable_addr());
+    const bool roundProduct = fRounding == Rounding::kProduct;
+
+    if (fX.fScale == 1 && fY.fScale == 1) {
+        blur_full_scale(fX, fY, roundProduct, bpp,
+                        srcPixels, src.rowBytes(), src.width(), src.height(),
+                        srcOffset.x(), srcOffset.y(),
+                        dstPixels, dst.rowBytes(), dst.width(), dst.height(), executor);
+        return;
+    }
+
+    // Downscale src, blur that into a small dst with room for the interpolation on all sides,
+    // and interpolate it back up into dst.
+    Pass smallX = fX,
+         smallY = fY;
+    smallX.fScale = smallY.fScale = 1;
+
+    const int scaleX = fX.fScale,
+              scaleY = fY.fScale;
+    int firstX, lastX, firstY, lastY, unused;
+    locate(0,                srcOffset.x(), scaleX, &firstX, &unused);
+    locate(dst.width()  - 1, srcOffset.x(), scaleX, &lastX,  &unused);
+    locate(0,                srcOffset.y(), scaleY, &firstY, &unused);
+    locate(dst.height() - 1, srcOffset.y(), scaleY, &lastY,  &unused);
+
+    // Small src can reach a pixel past small dst in a downscaled direction, but that direction
+    // is blurred, and blurring takes src of any extent.
+    const int smallSrcW = (src.width()  + scaleX - 1) / scaleX,
+              smallSrcH = (src.height() + scaleY - 1) / scaleY,
+              smallDstW = lastX - firstX + 2,
+              smallDstH = lastY - firstY + 2;
+
+    SkAutoTMalloc<uint8_t> smallSrc(smallSrcW * smallSrcH * bpp),
+                           smallDst(smallDstW * smallDstH * bpp);
+    downsample(bpp, srcPixels, src.rowBytes(), src.width(), src.height(), scaleX, scaleY,
+               smallSrc.get(), smallSrcW * bpp, executor);
+    blur_full_scale(smallX, smallY, roundProduct, bpp,
+                    smallSrc.get(), smallSrcW * bpp, smallSrcW, smallSrcH,
+                    -firstX, -firstY,
+                    smallDst.get(), smallDstW * bpp, smallDstW, smallDstH, executor);
+    upsample(bpp, smallDst.get(), smallDstW * bpp, smallDstW, smallDstH,
+             srcOffset.x() + firstX * scaleX, srcOffset.y() + firstY * scaleY, scaleX, scaleY,
+             dstPixels, dst.rowBytes(), dst.width(), dst.height(), executor);
+}
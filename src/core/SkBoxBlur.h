@@ -0,0 +1,65 @@
+/*
+ * Copyright 2018 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#ifndef SkBoxBlur_DEFINED
+#define SkBoxBlur_DEFINED
+
+#include "SkPoint.h"
+#include "SkTypes.h"
+
+class SkExecutor;
+class SkPixmap;
+
+// A Gaussian blur approximated by three box blurs in each direction, as the SVG spec describes:
+// https://drafts.fxtf.org/filter-effects/#feGaussianBlurElement
+// SkMaskBlurFilter uses it for A8 masks, and SkBlurImageFilter for N32 images.
+//
+// Large blurs are cheaper done on a downscaled copy of the source and interpolated back up.
+// SkBoxBlur does that when it estimates that no pixel will come out more than maxError (in 8-bit
+// steps) from the full scale blur.  Sigmas too large for the full scale blur's 32-bit sums are
+// always downscaled.
+class SkBoxBlur {
+public:
+    static constexpr float kDefaultMaxError = 2;
+
+    // How the blurred sums are scaled to 8 bits.  SkBlurImageFilter and SkMaskBlurFilter each
+    // keep the rounding they always had, so their full scale output doesn't change.
+    enum class Rounding {
+        kSum,       // (sum + divisor/2) * weight >> 32, as SkBlurImageFilter did.
+        kProduct,   // (sum * weight + 2^31) >> 32, as SkMaskBlurFilter did.
+    };
+
+    SkBoxBlur(double sigmaX, double sigmaY, float maxError = kDefaultMaxError,
+              Rounding rounding = Rounding::kSum);
+
+    // True if this blurs in neither direction.
+    bool isIdentity() const;
+
+    // How far the blur spreads each pixel to either side.
+    SkIPoint border() const { return {fX.fBorder, fY.fBorder}; }
+
+    // How much each direction is downscaled, 1 if it is blurred at full scale.
+    SkIPoint scale() const { return {fX.fScale, fY.fScale}; }
+
+    // Blurs src into dst, both A8 or both N32.  src lands at srcOffset, and must fit inside dst.
+    // Every dst pixel is written.  Large blurs are split into bands run on the executor, if any.
+    void blur(const SkPixmap& src, SkIPoint srcOffset, const SkPixmap& dst,
+              SkExecutor* executor = nullptr) const;
+
+    // One direction of the blur.
+    struct Pass {
+        int fWindow = 1;    // The box width, at 1/fScale.  1 means no blur.
+        int fScale  = 1;
+        int fBorder = 0;    // At full scale.
+    };
+
+private:
+    Pass     fX, fY;
+    Rounding fRounding;
+};
+
+#endif
@@ -42,6 +42,19 @@ SkCoverageDeltaList::SkCoverageDeltaList(SkArenaAlloc* alloc, const SkIRect& bou
     }
 }
 
+bool SkCoverageDeltaList::blitRowAsMask(int y, int clipWidth) const {
+    return !fForceRLE && !this->sorted(y) && this->count(y) << 3 >= clipWidth &&
+           SkCoverageDeltaMask::CanHandle(SkIRect::MakeLTRB(0, 0, clipWidth, 1));
+}
+
+void SkCoverageDeltaList::sortForBlit(int clipWidth) {
+    for (int y = fBounds.fTop; y < fBounds.fBottom; ++y) {
+        if (!this->blitRowAsMask(y, clipWidth)) {
+            this->sort(y);
+        }
+    }
+}
+
 int SkCoverageDeltaMask::ExpandWidth(int width) {
     int result = width + PADDING * 2;
     return result + (SIMD_WIDTH - result % SIMD_WIDTH) % SIMD_WIDTH;
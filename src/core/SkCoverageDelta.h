@@ -74,6 +74,14 @@ public:
         }
     }
 
+    // Whether blitting row y within a clip clipWidth wide goes through a one-row mask instead of
+    // sorting the row: a mask is much faster for rows with many unsorted deltas.
+    bool blitRowAsMask(int y, int clipWidth) const;
+
+    // Sorts every row that blitting within a clip clipWidth wide would sort. After this, blitting
+    // within such a clip only reads the list, so several threads may blit it at once.
+    void sortForBlit(int clipWidth);
+
     const SkAntiRect& getAntiRect() const { return fAntiRect; }
     void setAntiRect(int x, int y, int width, int height,
             SkAlpha leftAlpha, SkAlpha rightAlpha) {
@@ -194,22 +202,28 @@ struct SkDAARecord {
     SkMask               fMask;
     SkCoverageDeltaList* fList;
     SkArenaAlloc*        fAlloc;
+    bool                 fForceDAA;     // Use DAA even where another scan converter is preferred.
 
-    SkDAARecord(SkArenaAlloc* alloc) : fType(Type::kToBeComputed), fAlloc(alloc) {}
+    SkDAARecord(SkArenaAlloc* alloc, bool forceDAA = false)
+        : fType(Type::kToBeComputed), fAlloc(alloc), fForceDAA(forceDAA) {}
 
-    // When the scan converter returns early (e.g., the path is completely out of the clip), we set
-    // the type to empty to signal that the record has been computed and it's empty. This is
-    // required only for DEBUG where we check that the type must not be kToBeComputed after
-    // init-once.
+    // Scan converting with a record that's still to be computed is the init-once phase: it only
+    // fills in the record, and blits nothing that the draw phase won't blit again.
+    static bool IsInitOnce(const SkDAARecord* record) { // record may be nullptr
+        return record && record->fType == Type::kToBeComputed;
+    }
+
+    // When the scan converter returns early (e.g., the path is completely out of the clip), or
+    // leaves the path to another scan converter, we set the type to empty to signal that the
+    // record has been computed and there's nothing in it. The draw phase then follows the same
+    // early return, or draws the path without the record.
     void setEmpty() { fType = Type::kEmpty; }
     static inline void SetEmpty(SkDAARecord* record) { // record may be nullptr
-#ifdef SK_DEBUG
-        // If type != kToBeComputed, then we're in the draw phase and we shouldn't set it to empty
-        // because being empty in one tile does not imply emptiness in other tiles.
-        if (record && record->fType == Type::kToBeComputed) {
+        // If type != kToBeComputed, then we're in the draw phase, where every tile reads the same
+        // record concurrently, so we must not write to it.
+        if (IsInitOnce(record)) {
             record->setEmpty();
         }
-#endif
     }
 };
 
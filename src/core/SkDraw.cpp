@@ -13,6 +13,7 @@
 #include "SkBlitter.h"
 #include "SkCanvas.h"
 #include "SkColorData.h"
+#include "SkCoverageDelta.h"
 #include "SkDevice.h"
 #include "SkDrawProcs.h"
 #include "SkMaskFilterBase.h"
@@ -50,6 +51,64 @@ static SkPaint make_paint_with_image(
 
 SkDraw::SkDraw() {}
 
+namespace {
+// Confines blits to SkDraw::fBlitClip. justAnOpaqueColor() is disabled because callers use it
+// to write straight into the returned pixmap, which would bypass our clip.
+// Pixel pairs always reach the real blitter as pairs, since some blitters blend blitAntiH2() and
+// blitAntiV2() differently from blitAntiH() and we must match unclipped drawing. When a pair
+// straddles the clip, we pair its inside pixel with its other neighbor at zero coverage, which
+// leaves that neighbor unchanged.
+class BlitClipBlitter final : public SkRectClipBlitter {
+public:
+    void init(SkBlitter* blitter, const SkIRect& clipRect) {
+        this->INHERITED::init(blitter, clipRect);
+        fRealBlitter = blitter;
+        fClip = clipRect;
+    }
+
+    void blitAntiH2(int x, int y, U8CPU a0, U8CPU a1) override {
+        if (fClip.contains(SkIRect::MakeXYWH(x, y, 2, 1))) {
+            fRealBlitter->blitAntiH2(x, y, a0, a1);
+        } else if (fClip.contains(SkIRect::MakeXYWH(x - 1, y, 2, 1))) {
+            fRealBlitter->blitAntiH2(x - 1, y, 0, a0);
+        } else if (fClip.contains(SkIRect::MakeXYWH(x + 1, y, 2, 1))) {
+            fRealBlitter->blitAntiH2(x + 1, y, a1, 0);
+        } else {
+            this->INHERITED::blitAntiH2(x, y, a0, a1);
+        }
+    }
+
+    void blitAntiV2(int x, int y, U8CPU a0, U8CPU a1) override {
+        if (fClip.contains(SkIRect::MakeXYWH(x, y, 1, 2))) {
+            fRealBlitter->blitAntiV2(x, y, a0, a1);
+        } else if (fClip.contains(SkIRect::MakeXYWH(x, y - 1, 1, 2))) {
+            fRealBlitter->blitAntiV2(x, y - 1, 0, a0);
+        } else if (fClip.contains(SkIRect::MakeXYWH(x, y + 1, 1, 2))) {
+            fRealBlitter->blitAntiV2(x, y + 1, a1, 0);
+        } else {
+            this->INHERITED::blitAntiV2(x, y, a0, a1);
+        }
+    }
+
+    const SkPixmap* justAnOpaqueColor(uint32_t*) override { return nullptr; }
+
+private:
+    SkBlitter* fRealBlitter;
+    SkIRect    fClip;
+
+    typedef SkRectClipBlitter INHERITED;
+};
+}  // namespace
+
+SkBlitter* SkDraw::applyBlitClip(SkBlitter* blitter, SkArenaAlloc* alloc) const {
+    if (!fBlitClip || !blitter) {
+        return blitter;
+    }
+    auto clipped = alloc->make<BlitClipBlitter>();
+    clipped->init(blitter, *fBlitClip);
+    return clipped;
+}
+
 bool SkDraw::computeConservativeLocalClipBounds(SkRect* localBounds) const {
     if (fRC->isEmpty()) {
         return false;
@@ -820,6 +879,19 @@ void SkDraw::drawDevPath(const SkPath& devPath, const SkPaint& paint, bool drawC
     if (SkPathPriv::TooBigForMath(devPath)) {
         return;
     }
+    // Mask filters blit from filterPath(), so they can't be split into phases.
+    const bool useDAARecord = fDAARecord && doFill && paint.isAntiAlias() &&
+                              !paint.getMaskFilter();
+    if (SkDAARecord::IsInitOnce(fDAARecord)) {
+        if (useDAARecord) {
+            SkNullBlitter nullBlitter;
+            SkScan::AntiFillPath(devPath, *fRC, &nullBlitter, fDAARecord);
+        } else {
+            SkDAARecord::SetEmpty(fDAARecord);  // The draw phase draws this without the record.
+        }
+        return;
+    }
+
     SkBlitter* blitter = nullptr;
     SkAutoBlitterChoose blitterStorage;
     if (nullptr == customBlitter) {
@@ -877,7 +949,11 @@ void SkDraw::drawDevPath(const SkPath& devPath, const SkPaint& paint, bool drawC
         }
     }
 
-    proc(devPath, *fRC, blitter);
+    if (useDAARecord) {
+        SkScan::AntiFillPath(devPath, *fRC, blitter, fDAARecord);
+    } else {
+        proc(devPath, *fRC, blitter);
+    }
 }
 
 void SkDraw::drawPath(const SkPath& origSrcPath, const SkPaint& origPaint,
@@ -1101,6 +1177,7 @@ void SkDraw::drawBitmap(const SkBitmap& bitmap, const SkMatrix& prematrix,
             // blitter will be owned by the allocator.
             SkBlitter* blitter = SkBlitter::ChooseSprite(fDst, *paint, pmap, ix, iy, &allocator);
             if (blitter) {
+                blitter = this->applyBlitClip(blitter, &allocator);
                 SkScan::FillIRect(SkIRect::MakeXYWH(ix, iy, pmap.width(), pmap.height()),
                                   *fRC, blitter);
                 return;
@@ -1156,6 +1233,7 @@ void SkDraw::drawSprite(const SkBitmap& bitmap, int x, int y, const SkPaint& ori
         SkSTArenaAlloc<kSkBlitterContextSize> allocator;
         SkBlitter* blitter = SkBlitter::ChooseSprite(fDst, paint, pmap, x, y, &allocator);
         if (blitter) {
+            blitter = this->applyBlitClip(blitter, &allocator);
             SkScan::FillIRect(bounds, *fRC, blitter);
             return;
         }
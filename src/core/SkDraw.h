@@ -18,8 +18,10 @@
 #include "SkStrokeRec.h"
 #include "SkVertices.h"
 
+class SkArenaAlloc;
 class SkBitmap;
 class SkClipStack;
+struct SkDAARecord;
 class SkBaseDevice;
 class SkBlitter;
 class SkMatrix;
@@ -126,6 +128,13 @@ public:
                                       SkScalar sizeLimit = 1024);
 
     static SkScalar ComputeResScaleForStroking(const SkMatrix& );
+
+    /**
+     *  If fBlitClip is set, returns a blitter (allocated in alloc) that forwards to blitter but
+     *  never touches pixels outside of fBlitClip. Otherwise returns blitter unchanged.
+     */
+    SkBlitter* applyBlitClip(SkBlitter* blitter, SkArenaAlloc* alloc) const;
+
 private:
     void drawBitmapAsMask(const SkBitmap&, const SkPaint&) const;
 
@@ -161,6 +170,17 @@ public:
     // optional, will be same dimensions as fDst if present
     const SkPixmap* fCoverage{nullptr};
 
+    // optional, if present all blits are confined to this device-space rect. Unlike fRC, this
+    // does not affect how geometry is clipped and scan converted, so the pixels drawn inside it
+    // are exactly those that would be drawn without it. This lets several SkDraws share one fDst
+    // from different threads.
+    const SkIRect* fBlitClip{nullptr};
+
+    // optional, if present antialiased path fills are scan converted in two phases through this
+    // record. While the record is still to be computed, drawing a path only computes it and
+    // blits nothing, so that can happen on any thread; later draws blit from the record.
+    SkDAARecord* fDAARecord{nullptr};
+
 #ifdef SK_DEBUG
     void validate() const;
 #else
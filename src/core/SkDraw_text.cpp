@@ -46,6 +46,7 @@ void SkDraw::paintMasks(SkSpan<const SkMask> masks, const SkPaint& paint) const
                 blitter,
                 SkBlitter::Choose(*fCoverage, *fMatrix, SkPaint(), &alloc, true));
     }
+    blitter = this->applyBlitClip(blitter, &alloc);
 
     SkAAClipBlitterWrapper wrapper{*fRC, blitter};
     blitter = wrapper.getBlitter();
@@ -290,7 +290,8 @@ void SkDraw::drawVertices(SkVertices::VertexMode vmode, int vertexCount,
 
         if (!textures) {    // only tricolor shader
             SkASSERT(matrix43);
-            auto blitter = SkCreateRasterPipelineBlitter(fDst, p, *fMatrix, &outerAlloc);
+            auto blitter = this->applyBlitClip(
+                    SkCreateRasterPipelineBlitter(fDst, p, *fMatrix, &outerAlloc), &outerAlloc);
             while (vertProc(&state)) {
                 if (!update_tricolor_matrix(ctmInv, vertices, dstColors,
                                             state.f0, state.f1, state.f2,
@@ -327,7 +328,8 @@ void SkDraw::drawVertices(SkVertices::VertexMode vmode, int vertexCount,
                 SkPoint tmp[] = {
                     devVerts[state.f0], devVerts[state.f1], devVerts[state.f2]
                 };
-                auto blitter = SkCreateRasterPipelineBlitter(fDst, p, *ctm, &innerAlloc);
+                auto blitter = this->applyBlitClip(
+                        SkCreateRasterPipelineBlitter(fDst, p, *ctm, &innerAlloc), &innerAlloc);
                 SkScan::FillTriangle(tmp, *fRC, blitter);
             }
         }
@@ -96,6 +96,9 @@ bool SkFontDescriptor::Deserialize(SkStream* stream, SkFontDescriptor* result) {
             case kFontIndex:
                 if (!stream->readPackedUInt(&index)) { return false; }
                 break;
+            case kInvalid:
+                // The stream ended early.
+                return false;
             default:
                 SkDEBUGFAIL("Unknown id used by a font descriptor");
                 return false;
@@ -107,7 +110,6 @@ bool SkFontDescriptor::Deserialize(SkStream* stream, SkFontDescriptor* result) {
     if (length > 0) {
         sk_sp<SkData> data(SkData::MakeUninitialized(length));
         if (stream->read(data->writable_data(), length) != length) {
-            SkDEBUGFAIL("Could not read font data");
             return false;
         }
         result->fFontData = skstd::make_unique<SkFontData>(
@@ -30,6 +30,13 @@ bool SkImageGenerator::getPixels(const SkImageInfo& info, void* pixels, size_t r
     return this->onGetPixels(info, pixels, rowBytes, defaultOpts);
 }
 
+SkISize SkImageGenerator::getScaledDimensions(float desiredScale) const {
+    if (!(desiredScale > 0) || desiredScale >= 1) {
+        return fInfo.dimensions();
+    }
+    return this->onGetScaledDimensions(desiredScale);
+}
+
 bool SkImageGenerator::queryYUVA8(SkYUVASizeInfo* sizeInfo,
                                   SkYUVAIndex yuvaIndices[SkYUVAIndex::kIndexCount],
                                   SkYUVColorSpace* colorSpace) const {
@@ -7,250 +7,22 @@
 
 #include "SkMaskBlurFilter.h"
 
-#include "SkArenaAlloc.h"
+#include "SkBoxBlur.h"
 #include "SkColorPriv.h"
+#include "SkExecutor.h"
 #include "SkGaussFilter.h"
 #include "SkMalloc.h"
 #include "SkNx.h"
+#include "SkPixmap.h"
 #include "SkTemplates.h"
 #include "SkTo.h"
 
 #include <cmath>
 #include <climits>
 
-namespace {
-static const double kPi = 3.14159265358979323846264338327950288;
-
-class PlanGauss final {
-public:
-    explicit PlanGauss(double sigma) {
-        auto possibleWindow = static_cast<int>(floor(sigma * 3 * sqrt(2 * kPi) / 4 + 0.5));
-        auto window = std::max(1, possibleWindow);
-
-        fPass0Size = window - 1;
-        fPass1Size = window - 1;
-        fPass2Size = (window & 1) == 1 ? window - 1 : window;
-
-        // Calculating the border is tricky. I will go through the odd case which is simpler, and
-        // then through the even case. Given a stack of filters seven wide for the odd case of
-        // three passes.
-        //
-        //        S
-        //     aaaAaaa
-        //     bbbBbbb
-        //     cccCccc
-        //        D
-        //
-        // The furthest changed pixel is when the filters are in the following configuration.
-        //
-        //                 S
-        //           aaaAaaa
-        //        bbbBbbb
-        //     cccCccc
-        //        D
-        //
-        //  The A pixel is calculated using the value S, the B uses A, and the C uses B, and
-        // finally D is C. So, with a window size of seven the border is nine. In general, the
-        // border is 3*((window - 1)/2).
-        //
-        // For even cases the filter stack is more complicated. The spec specifies two passes
-        // of even filters and a final pass of odd filters. A stack for a width of six looks like
-        // this.
-        //
-        //       S
-        //    aaaAaa
-        //     bbBbbb
-        //    cccCccc
-        //       D
-        //
-        // The furthest pixel looks like this.
-        //
-        //               S
-        //          aaaAaa
-        //        bbBbbb
-        //    cccCccc
-        //       D
-        //
-        // For a window of size, the border value is seven. In general the border is 3 *
-        // (window/2) -1.
-        fBorder = (window & 1) == 1 ? 3 * ((window - 1) / 2) : 3 * (window / 2) - 1;
-        fSlidingWindow = 2 * fBorder + 1;
-
-        // If the window is odd then the divisor is just window ^ 3 otherwise,
-        // it is window * window * (window + 1) = window ^ 2 + window ^ 3;
-        auto window2 = window * window;
-        auto window3 = window2 * window;
-        auto divisor = (window & 1) == 1 ? window3 : window3 + window2;
-
-        fWeight = static_cast<uint64_t>(round(1.0 / divisor * (1ull << 32)));
-    }
-
-    size_t bufferSize() const { return fPass0Size + fPass1Size + fPass2Size; }
-
-    int    border()     const { return fBorder; }
-
-public:
-    class Scan {
-    public:
-        Scan(uint64_t weight, int noChangeCount,
-             uint32_t* buffer0, uint32_t* buffer0End,
-             uint32_t* buffer1, uint32_t* buffer1End,
-             uint32_t* buffer2, uint32_t* buffer2End)
-            : fWeight{weight}
-            , fNoChangeCount{noChangeCount}
-            , fBuffer0{buffer0}
-            , fBuffer0End{buffer0End}
-            , fBuffer1{buffer1}
-            , fBuffer1End{buffer1End}
-            , fBuffer2{buffer2}
-            , fBuffer2End{buffer2End}
-        { }
-
-        template <typename AlphaIter> void blur(const AlphaIter srcBegin, const AlphaIter srcEnd,
-                    uint8_t* dst, int dstStride, uint8_t* dstEnd) const {
-            auto buffer0Cursor = fBuffer0;
-            auto buffer1Cursor = fBuffer1;
-            auto buffer2Cursor = fBuffer2;
-
-            std::memset(fBuffer0, 0x00, (fBuffer2End - fBuffer0) * sizeof(*fBuffer0));
-
-            uint32_t sum0 = 0;
-            uint32_t sum1 = 0;
-            uint32_t sum2 = 0;
-
-            // Consume the source generating pixels.
-            for (AlphaIter src = srcBegin; src < srcEnd; ++src, dst += dstStride) {
-                uint32_t leadingEdge = *src;
-                sum0 += leadingEdge;
-                sum1 += sum0;
-                sum2 += sum1;
-
-                *dst = this->finalScale(sum2);
-
-                sum2 -= *buffer2Cursor;
-                *buffer2Cursor = sum1;
-                buffer2Cursor = (buffer2Cursor + 1) < fBuffer2End ? buffer2Cursor + 1 : fBuffer2;
-
-                sum1 -= *buffer1Cursor;
-                *buffer1Cursor = sum0;
-                buffer1Cursor = (buffer1Cursor + 1) < fBuffer1End ? buffer1Cursor + 1 : fBuffer1;
-
-                sum0 -= *buffer0Cursor;
-                *buffer0Cursor = leadingEdge;
-                buffer0Cursor = (buffer0Cursor + 1) < fBuffer0End ? buffer0Cursor + 1 : fBuffer0;
-            }
-
-            // The leading edge is off the right side of the mask.
-            for (int i = 0; i < fNoChangeCount; i++) {
-                uint32_t leadingEdge = 0;
-                sum0 += leadingEdge;
-                sum1 += sum0;
-                sum2 += sum1;
-
-                *dst = this->finalScale(sum2);
-
-                sum2 -= *buffer2Cursor;
-                *buffer2Cursor = sum1;
-                buffer2Cursor = (buffer2Cursor + 1) < fBuffer2End ? buffer2Cursor + 1 : fBuffer2;
-
-                sum1 -= *buffer1Cursor;
-                *buffer1Cursor = sum0;
-                buffer1Cursor = (buffer1Cursor + 1) < fBuffer1End ? buffer1Cursor + 1 : fBuffer1;
-
-                sum0 -= *buffer0Cursor;
-                *buffer0Cursor = leadingEdge;
-                buffer0Cursor = (buffer0Cursor + 1) < fBuffer0End ? buffer0Cursor + 1 : fBuffer0;
-
-                dst += dstStride;
-            }
-
-            // Starting from the right, fill in the rest of the buffer.
-            std::memset(fBuffer0, 0, (fBuffer2End - fBuffer0) * sizeof(*fBuffer0));
-
-            sum0 = sum1 = sum2 = 0;
-
-            uint8_t* dstCursor = dstEnd;
-            AlphaIter src = srcEnd;
-            while (dstCursor > dst) {
-                dstCursor -= dstStride;
-                uint32_t leadingEdge = *(--src);
-                sum0 += leadingEdge;
-                sum1 += sum0;
-                sum2 += sum1;
-
-                *dstCursor = this->finalScale(sum2);
-
-                sum2 -= *buffer2Cursor;
-                *buffer2Cursor = sum1;
-                buffer2Cursor = (buffer2Cursor + 1) < fBuffer2End ? buffer2Cursor + 1 : fBuffer2;
-
-                sum1 -= *buffer1Cursor;
-                *buffer1Cursor = sum0;
-                buffer1Cursor = (buffer1Cursor + 1) < fBuffer1End ? buffer1Cursor + 1 : fBuffer1;
-
-                sum0 -= *buffer0Cursor;
-                *buffer0Cursor = leadingEdge;
-                buffer0Cursor = (buffer0Cursor + 1) < fBuffer0End ? buffer0Cursor + 1 : fBuffer0;
-            }
-        }
-
-    private:
-        static constexpr uint64_t kHalf = static_cast<uint64_t>(1) << 31;
-
-        uint8_t finalScale(uint32_t sum) const {
-            return SkTo<uint8_t>((fWeight * sum + kHalf) >> 32);
-        }
-
-        uint64_t  fWeight;
-        int       fNoChangeCount;
-        uint32_t* fBuffer0;
-        uint32_t* fBuffer0End;
-        uint32_t* fBuffer1;
-        uint32_t* fBuffer1End;
-        uint32_t* fBuffer2;
-        uint32_t* fBuffer2End;
-    };
-
-    Scan makeBlurScan(int width, uint32_t* buffer) const {
-        uint32_t* buffer0, *buffer0End, *buffer1, *buffer1End, *buffer2, *buffer2End;
-        buffer0 = buffer;
-        buffer0End = buffer1 = buffer0 + fPass0Size;
-        buffer1End = buffer2 = buffer1 + fPass1Size;
-        buffer2End = buffer2 + fPass2Size;
-        int noChangeCount = fSlidingWindow > width ? fSlidingWindow - width : 0;
-
-        return Scan(
-            fWeight, noChangeCount,
-            buffer0, buffer0End,
-            buffer1, buffer1End,
-            buffer2, buffer2End);
-    }
-
-    uint64_t fWeight;
-    int      fBorder;
-    int      fSlidingWindow;
-    int      fPass0Size;
-    int      fPass1Size;
-    int      fPass2Size;
-};
-
-} // namespace
-
-// NB 136 is the largest sigma that will not cause a buffer full of 255 mask values to overflow
-// using the Gauss filter. It also limits the size of buffers used hold intermediate values.
-// Explanation of maximums:
-//   sum0 = window * 255
-//   sum1 = window * sum0 -> window * window * 255
-//   sum2 = window * sum1 -> window * window * window * 255 -> window^3 * 255
-//
-//   The value window^3 * 255 must fit in a uint32_t. So,
-//      window^3 < 2^32. window = 255.
-//
-//   window = floor(sigma * 3 * sqrt(2 * kPi) / 4 + 0.5)
-//   For window <= 255, the largest value for sigma is 136.
 SkMaskBlurFilter::SkMaskBlurFilter(double sigmaW, double sigmaH)
-    : fSigmaW{SkTPin(sigmaW, 0.0, 136.0)}
-    , fSigmaH{SkTPin(sigmaH, 0.0, 136.0)}
+    : fSigmaW{std::max(sigmaW, 0.0)}
+    , fSigmaH{std::max(sigmaH, 0.0)}
 {
     SkASSERT(sigmaW >= 0);
     SkASSERT(sigmaH >= 0);
@@ -949,27 +721,31 @@ static SkIPoint small_blur(double sigmaX, double sigmaY, const SkMask& src, SkMa
     return {radiusX, radiusY};
 }
 
-// TODO: assuming sigmaW = sigmaH. Allow different sigmas. Right now the
-// API forces the sigmas to be the same.
+// SkBoxBlur blurs A8, so other formats are converted first.
+template <typename AlphaIter>
+static void convert_to_a8(AlphaIter row, uint32_t rowBytes, int width, int height, uint8_t* a8) {
+    for (int y = 0; y < height; ++y, row >>= rowBytes) {
+        AlphaIter alpha = row;
+        for (int x = 0; x < width; ++x, ++alpha) {
+            *a8++ = *alpha;
+        }
+    }
+}
+
 SkIPoint SkMaskBlurFilter::blur(const SkMask& src, SkMask* dst) const {
 
     if (fSigmaW < 2.0 && fSigmaH < 2.0) {
         return small_blur(fSigmaW, fSigmaH, src, dst);
     }
 
-    // 1024 is a place holder guess until more analysis can be done.
-    SkSTArenaAlloc<1024> alloc;
+    SkBoxBlur boxBlur(fSigmaW, fSigmaH, SkBoxBlur::kDefaultMaxError,
+                      SkBoxBlur::Rounding::kProduct);
+    const SkIPoint border = boxBlur.border();
+    SkASSERT(border.x() >= 0 && border.y() >= 0);
 
-    PlanGauss planW(fSigmaW);
-    PlanGauss planH(fSigmaH);
-
-    int borderW = planW.border(),
-        borderH = planH.border();
-    SkASSERT(borderH >= 0 && borderW >= 0);
-
-    *dst = SkMask::PrepareDestination(borderW, borderH, src);
+    *dst = SkMask::PrepareDestination(border.x(), border.y(), src);
     if (src.fImage == nullptr) {
-        return {SkTo<int32_t>(borderW), SkTo<int32_t>(borderH)};
+        return border;
     }
     if (dst->fImage == nullptr) {
         dst->fBounds.setEmpty();
@@ -982,68 +758,34 @@ SkIPoint SkMaskBlurFilter::blur(const SkMask& src, SkMask* dst) const {
         dstH = dst->fBounds.height();
     SkASSERT(srcW >= 0 && srcH >= 0 && dstW >= 0 && dstH >= 0);
 
-    auto bufferSize = std::max(planW.bufferSize(), planH.bufferSize());
-    auto buffer = alloc.makeArrayDefault<uint32_t>(bufferSize);
-
-    // Blur both directions.
-    int tmpW = srcH,
-        tmpH = dstW;
-
-    auto tmp = alloc.makeArrayDefault<uint8_t>(tmpW * tmpH);
-
-    // Blur horizontally, and transpose.
-    const PlanGauss::Scan& scanW = planW.makeBlurScan(srcW, buffer);
-    switch (src.fFormat) {
-        case SkMask::kBW_Format: {
-            const uint8_t* bwStart = src.fImage;
-            auto start = SkMask::AlphaIter<SkMask::kBW_Format>(bwStart, 0);
-            auto end = SkMask::AlphaIter<SkMask::kBW_Format>(bwStart + (srcW / 8), srcW % 8);
-            for (int y = 0; y < srcH; ++y, start >>= src.fRowBytes, end >>= src.fRowBytes) {
-                auto tmpStart = &tmp[y];
-                scanW.blur(start, end, tmpStart, tmpW, tmpStart + tmpW * tmpH);
-            }
-        } break;
-        case SkMask::kA8_Format: {
-            const uint8_t* a8Start = src.fImage;
-            auto start = SkMask::AlphaIter<SkMask::kA8_Format>(a8Start);
-            auto end = SkMask::AlphaIter<SkMask::kA8_Format>(a8Start + srcW);
-            for (int y = 0; y < srcH; ++y, start >>= src.fRowBytes, end >>= src.fRowBytes) {
-                auto tmpStart = &tmp[y];
-                scanW.blur(start, end, tmpStart, tmpW, tmpStart + tmpW * tmpH);
-            }
-        } break;
-        case SkMask::kARGB32_Format: {
-            const uint32_t* argbStart = reinterpret_cast<const uint32_t*>(src.fImage);
-            auto start = SkMask::AlphaIter<SkMask::kARGB32_Format>(argbStart);
-            auto end = SkMask::AlphaIter<SkMask::kARGB32_Format>(argbStart + srcW);
-            for (int y = 0; y < srcH; ++y, start >>= src.fRowBytes, end >>= src.fRowBytes) {
-                auto tmpStart = &tmp[y];
-                scanW.blur(start, end, tmpStart, tmpW, tmpStart + tmpW * tmpH);
-            }
-        } break;
-        case SkMask::kLCD16_Format: {
-            const uint16_t* lcdStart = reinterpret_cast<const uint16_t*>(src.fImage);
-            auto start = SkMask::AlphaIter<SkMask::kLCD16_Format>(lcdStart);
-            auto end = SkMask::AlphaIter<SkMask::kLCD16_Format>(lcdStart + srcW);
-            for (int y = 0; y < srcH; ++y, start >>= src.fRowBytes, end >>= src.fRowBytes) {
-                auto tmpStart = &tmp[y];
-                scanW.blur(start, end, tmpStart, tmpW, tmpStart + tmpW * tmpH);
-            }
-        } break;
-        default:
-            SK_ABORT("Unhandled format.");
+    SkPixmap srcA8(SkImageInfo::MakeA8(srcW, srcH), src.fImage, src.fRowBytes);
+    SkAutoTMalloc<uint8_t> converted;
+    if (src.fFormat != SkMask::kA8_Format) {
+        converted.reset(srcW * srcH);
+        switch (src.fFormat) {
+            case SkMask::kBW_Format:
+                convert_to_a8(SkMask::AlphaIter<SkMask::kBW_Format>(src.fImage, 0),
+                              src.fRowBytes, srcW, srcH, converted.get());
+                break;
+            case SkMask::kARGB32_Format:
+                convert_to_a8(SkMask::AlphaIter<SkMask::kARGB32_Format>(
+                                      reinterpret_cast<const uint32_t*>(src.fImage)),
+                              src.fRowBytes, srcW, srcH, converted.get());
+                break;
+            case SkMask::kLCD16_Format:
+                convert_to_a8(SkMask::AlphaIter<SkMask::kLCD16_Format>(
+                                      reinterpret_cast<const uint16_t*>(src.fImage)),
+                              src.fRowBytes, srcW, srcH, converted.get());
+                break;
+            default:
+                SK_ABORT("Unhandled format.");
+        }
+        srcA8.reset(SkImageInfo::MakeA8(srcW, srcH), converted.get(), srcW);
     }
 
-    // Blur vertically (scan in memory order because of the transposition),
-    // and transpose back to the original orientation.
-    const PlanGauss::Scan& scanH = planH.makeBlurScan(tmpW, buffer);
-    for (int y = 0; y < tmpH; y++) {
-        auto tmpStart = &tmp[y * tmpW];
-        auto dstStart = &dst->fImage[y];
-
-        scanH.blur(tmpStart, tmpStart + tmpW,
-                   dstStart, dst->fRowBytes, dstStart + dst->fRowBytes * dstH);
-    }
+    boxBlur.blur(srcA8, border,
+                 SkPixmap(SkImageInfo::MakeA8(dstW, dstH), dst->fImage, dst->fRowBytes),
+                 &SkExecutor::GetDefault());
 
-    return {SkTo<int32_t>(borderW), SkTo<int32_t>(borderH)};
+    return border;
 }
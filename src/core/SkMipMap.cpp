@@ -13,6 +13,8 @@
 #include "SkImageInfoPriv.h"
 #include "SkMathPriv.h"
 #include "SkNx.h"
+#include "SkOpts.h"
+#include "SkTaskGroup.h"
 #include "SkTo.h"
 #include "SkTypes.h"
 #include <new>
@@ -311,78 +313,132 @@ size_t SkMipMap::AllocLevelsSize(int levelCount, size_t pixelSize) {
     return SkTo<int32_t>(size);
 }
 
-SkMipMap* SkMipMap::Build(const SkPixmap& src, SkDiscardableFactoryProc fact) {
-    typedef void FilterProc(void*, const void* srcPtr, size_t srcRB, int count);
-
-    FilterProc* proc_1_2 = nullptr;
-    FilterProc* proc_1_3 = nullptr;
-    FilterProc* proc_2_1 = nullptr;
-    FilterProc* proc_2_2 = nullptr;
-    FilterProc* proc_2_3 = nullptr;
-    FilterProc* proc_3_1 = nullptr;
-    FilterProc* proc_3_2 = nullptr;
-    FilterProc* proc_3_3 = nullptr;
+typedef void FilterProc(void*, const void* srcPtr, size_t srcRB, int count);
+
+namespace {
+struct FilterProcs {
+    FilterProc* f_1_2;
+    FilterProc* f_1_3;
+    FilterProc* f_2_1;
+    FilterProc* f_2_2;
+    FilterProc* f_2_3;
+    FilterProc* f_3_1;
+    FilterProc* f_3_2;
+    FilterProc* f_3_3;
+};
+}
 
-    const SkColorType ct = src.colorType();
-    const SkAlphaType at = src.alphaType();
+template <typename F> static FilterProcs portable_procs() {
+    return { downsample_1_2<F>, downsample_1_3<F>, downsample_2_1<F>, downsample_2_2<F>,
+             downsample_2_3<F>, downsample_3_1<F>, downsample_3_2<F>, downsample_3_3<F> };
+}
 
+static bool choose_procs(SkColorType ct, FilterProcs* procs) {
     switch (ct) {
         case kRGBA_8888_SkColorType:
         case kBGRA_8888_SkColorType:
-            proc_1_2 = downsample_1_2<ColorTypeFilter_8888>;
-            proc_1_3 = downsample_1_3<ColorTypeFilter_8888>;
-            proc_2_1 = downsample_2_1<ColorTypeFilter_8888>;
-            proc_2_2 = downsample_2_2<ColorTypeFilter_8888>;
-            proc_2_3 = downsample_2_3<ColorTypeFilter_8888>;
-            proc_3_1 = downsample_3_1<ColorTypeFilter_8888>;
-            proc_3_2 = downsample_3_2<ColorTypeFilter_8888>;
-            proc_3_3 = downsample_3_3<ColorTypeFilter_8888>;
-            break;
+            *procs = portable_procs<ColorTypeFilter_8888>();
+            procs->f_2_2 = SkOpts::downsample_2_2_8888;
+            procs->f_3_3 = SkOpts::downsample_3_3_8888;
+            return true;
         case kRGB_565_SkColorType:
-            proc_1_2 = downsample_1_2<ColorTypeFilter_565>;
-            proc_1_3 = downsample_1_3<ColorTypeFilter_565>;
-            proc_2_1 = downsample_2_1<ColorTypeFilter_565>;
-            proc_2_2 = downsample_2_2<ColorTypeFilter_565>;
-            proc_2_3 = downsample_2_3<ColorTypeFilter_565>;
-            proc_3_1 = downsample_3_1<ColorTypeFilter_565>;
-            proc_3_2 = downsample_3_2<ColorTypeFilter_565>;
-            proc_3_3 = downsample_3_3<ColorTypeFilter_565>;
-            break;
+            *procs = portable_procs<ColorTypeFilter_565>();
+            return true;
         case kARGB_4444_SkColorType:
-            proc_1_2 = downsample_1_2<ColorTypeFilter_4444>;
-            proc_1_3 = downsample_1_3<ColorTypeFilter_4444>;
-            proc_2_1 = downsample_2_1<ColorTypeFilter_4444>;
-            proc_2_2 = downsample_2_2<ColorTypeFilter_4444>;
-            proc_2_3 = downsample_2_3<ColorTypeFilter_4444>;
-            proc_3_1 = downsample_3_1<ColorTypeFilter_4444>;
-            proc_3_2 = downsample_3_2<ColorTypeFilter_4444>;
-            proc_3_3 = downsample_3_3<ColorTypeFilter_4444>;
-            break;
+            *procs = portable_procs<ColorTypeFilter_4444>();
+            return true;
         case kAlpha_8_SkColorType:
         case kGray_8_SkColorType:
-            proc_1_2 = downsample_1_2<ColorTypeFilter_8>;
-            proc_1_3 = downsample_1_3<ColorTypeFilter_8>;
-            proc_2_1 = downsample_2_1<ColorTypeFilter_8>;
-            proc_2_2 = downsample_2_2<ColorTypeFilter_8>;
-            proc_2_3 = downsample_2_3<ColorTypeFilter_8>;
-            proc_3_1 = downsample_3_1<ColorTypeFilter_8>;
-            proc_3_2 = downsample_3_2<ColorTypeFilter_8>;
-            proc_3_3 = downsample_3_3<ColorTypeFilter_8>;
-            break;
+            *procs = portable_procs<ColorTypeFilter_8>();
+            procs->f_2_2 = SkOpts::downsample_2_2_a8;
+            procs->f_3_3 = SkOpts::downsample_3_3_a8;
+            return true;
         case kRGBA_F16Norm_SkColorType:
         case kRGBA_F16_SkColorType:
-            proc_1_2 = downsample_1_2<ColorTypeFilter_F16>;
-            proc_1_3 = downsample_1_3<ColorTypeFilter_F16>;
-            proc_2_1 = downsample_2_1<ColorTypeFilter_F16>;
-            proc_2_2 = downsample_2_2<ColorTypeFilter_F16>;
-            proc_2_3 = downsample_2_3<ColorTypeFilter_F16>;
-            proc_3_1 = downsample_3_1<ColorTypeFilter_F16>;
-            proc_3_2 = downsample_3_2<ColorTypeFilter_F16>;
-            proc_3_3 = downsample_3_3<ColorTypeFilter_F16>;
-            break;
+            *procs = portable_procs<ColorTypeFilter_F16>();
+            procs->f_2_2 = SkOpts::downsample_2_2_f16;
+            procs->f_3_3 = SkOpts::downsample_3_3_f16;
+            return true;
         default:
-            return nullptr;
+            return false;
     }
+}
+
+// Filters src down into dst, which is the next level (half the size, rounded down).
+static void downsample(const SkPixmap& src, const SkPixmap& dst, SkExecutor* executor) {
+    FilterProcs procs;
+    SkAssertResult(choose_procs(src.colorType(), &procs));
+
+    const int width  = src.width(),
+              height = src.height();
+    FilterProc* proc;
+    if (height & 1) {
+        if (height == 1) {        // src-height is 1
+            if (width & 1) {      // src-width is 3
+                proc = procs.f_3_1;
+            } else {              // src-width is 2
+                proc = procs.f_2_1;
+            }
+        } else {                  // src-height is 3
+            if (width & 1) {
+                if (width == 1) { // src-width is 1
+                    proc = procs.f_1_3;
+                } else {          // src-width is 3
+                    proc = procs.f_3_3;
+                }
+            } else {              // src-width is 2
+                proc = procs.f_2_3;
+            }
+        }
+    } else {                      // src-height is 2
+        if (width & 1) {
+            if (width == 1) {     // src-width is 1
+                proc = procs.f_1_2;
+            } else {              // src-width is 3
+                proc = procs.f_3_2;
+            }
+        } else {                  // src-width is 2
+            proc = procs.f_2_2;
+        }
+    }
+
+    const size_t srcRB = src.rowBytes(),
+                 dstRB = dst.rowBytes();
+    auto filterRows = [&](int top, int bottom) {
+        const char* srcRow = (const char*)src.addr() + top * srcRB * 2;
+        char*       dstRow = (char*)dst.writable_addr() + top * dstRB;
+        for (int y = top; y < bottom; y++) {
+            proc(dstRow, srcRow, srcRB, dst.width());
+            srcRow += srcRB * 2; // jump two rows
+            dstRow += dstRB;
+        }
+    };
+
+    // Each dst row reads its own src rows, so bands of rows can be filtered independently.
+    // Only bother for levels with plenty of pixels to go around.
+    constexpr int64_t kMinBandPixels = 64 * 1024;
+    const int bands = executor ? (int)SkTMin<int64_t>(dst.height(),
+                                                     dst.width() * (int64_t)dst.height()
+                                                                 / kMinBandPixels)
+                               : 1;
+    if (bands > 1) {
+        SkTaskGroup(*executor).batch(bands, [&](int band) {
+            filterRows(dst.height() *  band      / bands,
+                       dst.height() * (band + 1) / bands);
+        });
+    } else {
+        filterRows(0, dst.height());
+    }
+}
+
+SkMipMap* SkMipMap::Allocate(const SkPixmap& src, SkDiscardableFactoryProc fact) {
+    FilterProcs procs;
+    if (!choose_procs(src.colorType(), &procs)) {
+        return nullptr;
+    }
+
+    const SkColorType ct = src.colorType();
+    const SkAlphaType at = src.alphaType();
 
     if (src.width() <= 1 && src.height() <= 1) {
         return nullptr;
@@ -423,43 +479,12 @@ SkMipMap* SkMipMap::Build(const SkPixmap& src, SkDiscardableFactoryProc fact) {
     int         width = src.width();
     int         height = src.height();
     uint32_t    rowBytes;
-    SkPixmap    srcPM(src);
 
     // Depending on architecture and other factors, the pixel data alignment may need to be as
     // large as 8 (for F16 pixels). See the comment on SkMipMap::Level.
     SkASSERT(SkIsAlign8((uintptr_t)addr));
 
     for (int i = 0; i < countLevels; ++i) {
-        FilterProc* proc;
-        if (height & 1) {
-            if (height == 1) {        // src-height is 1
-                if (width & 1) {      // src-width is 3
-                    proc = proc_3_1;
-                } else {              // src-width is 2
-                    proc = proc_2_1;
-                }
-            } else {                  // src-height is 3
-                if (width & 1) {
-                    if (width == 1) { // src-width is 1
-                        proc = proc_1_3;
-                    } else {          // src-width is 3
-                        proc = proc_3_3;
-                    }
-                } else {              // src-width is 2
-                    proc = proc_2_3;
-                }
-            }
-        } else {                      // src-height is 2
-            if (width & 1) {
-                if (width == 1) {     // src-width is 1
-                    proc = proc_1_2;
-                } else {              // src-width is 3
-                    proc = proc_3_2;
-                }
-            } else {                  // src-width is 2
-                proc = proc_2_2;
-            }
-        }
         width = SkTMax(1, width >> 1);
         height = SkTMax(1, height >> 1);
         rowBytes = SkToU32(SkColorTypeMinRowBytes(ct, width));
@@ -470,18 +495,6 @@ SkMipMap* SkMipMap::Build(const SkPixmap& src, SkDiscardableFactoryProc fact) {
         new (&levels[i].fPixmap) SkPixmap(SkImageInfo::Make(width, height, ct, at), addr, rowBytes);
         levels[i].fScale  = SkSize::Make(SkIntToScalar(width)  / src.width(),
                                          SkIntToScalar(height) / src.height());
-
-        const SkPixmap& dstPM = levels[i].fPixmap;
-        const void* srcBasePtr = srcPM.addr();
-        void* dstBasePtr = dstPM.writable_addr();
-
-        const size_t srcRB = srcPM.rowBytes();
-        for (int y = 0; y < height; y++) {
-            proc(dstBasePtr, srcBasePtr, srcRB, width);
-            srcBasePtr = (char*)srcBasePtr + srcRB * 2; // jump two rows
-            dstBasePtr = (char*)dstBasePtr + dstPM.rowBytes();
-        }
-        srcPM = dstPM;
         addr += height * rowBytes;
     }
     SkASSERT(addr == baseAddr + size);
@@ -490,6 +503,45 @@ SkMipMap* SkMipMap::Build(const SkPixmap& src, SkDiscardableFactoryProc fact) {
     return mipmap;
 }
 
+SkMipMap* SkMipMap::Build(const SkPixmap& src, SkDiscardableFactoryProc fact,
+                          SkExecutor* executor) {
+    SkMipMap* mipmap = Allocate(src, fact);
+    if (!mipmap) {
+        return nullptr;
+    }
+    SkPixmap srcPM(src);
+    for (int i = 0; i < mipmap->fCount; ++i) {
+        const SkPixmap& dstPM = mipmap->fLevels[i].fPixmap;
+        downsample(srcPM, dstPM, executor);
+        srcPM = dstPM;
+    }
+    mipmap->fBuiltCount.store(mipmap->fCount, std::memory_order_relaxed);
+    return mipmap;
+}
+
+SkMipMap* SkMipMap::BuildLazily(const SkPixmap& src, SkDiscardableFactoryProc fact) {
+    SkMipMap* mipmap = Allocate(src, fact);
+    if (!mipmap) {
+        return nullptr;
+    }
+    // Every later level is built from the one above it, so only the first needs src.
+    downsample(src, mipmap->fLevels[0].fPixmap, nullptr);
+    mipmap->fBuiltCount.store(1, std::memory_order_relaxed);
+    return mipmap;
+}
+
+void SkMipMap::buildLevels(int count) const {
+    SkASSERT(count <= fCount);
+    if (fBuiltCount.load(std::memory_order_acquire) >= count) {
+        return;
+    }
+    SkAutoMutexAcquire lock(fBuildMutex);
+    for (int i = fBuiltCount.load(std::memory_order_relaxed); i < count; ++i) {
+        downsample(fLevels[i - 1].fPixmap, fLevels[i].fPixmap, nullptr);
+        fBuiltCount.store(i + 1, std::memory_order_release);
+    }
+}
+
 int SkMipMap::ComputeLevelCount(int baseWidth, int baseHeight) {
     if (baseWidth < 1 || baseHeight < 1) {
         return 0;
@@ -585,6 +637,7 @@ bool SkMipMap::extractLevel(const SkSize& scaleSize, Level* levelPtr) const {
     if (level > fCount) {
         level = fCount;
     }
+    this->buildLevels(level);
     if (levelPtr) {
         *levelPtr = fLevels[level - 1];
         // need to augment with our colorspace
@@ -595,12 +648,21 @@ bool SkMipMap::extractLevel(const SkSize& scaleSize, Level* levelPtr) const {
 
 // Helper which extracts a pixmap from the src bitmap
 //
-SkMipMap* SkMipMap::Build(const SkBitmap& src, SkDiscardableFactoryProc fact) {
+SkMipMap* SkMipMap::Build(const SkBitmap& src, SkDiscardableFactoryProc fact,
+                          SkExecutor* executor) {
+    SkPixmap srcPixmap;
+    if (!src.peekPixels(&srcPixmap)) {
+        return nullptr;
+    }
+    return Build(srcPixmap, fact, executor);
+}
+
+SkMipMap* SkMipMap::BuildLazily(const SkBitmap& src, SkDiscardableFactoryProc fact) {
     SkPixmap srcPixmap;
     if (!src.peekPixels(&srcPixmap)) {
         return nullptr;
     }
-    return Build(srcPixmap, fact);
+    return BuildLazily(srcPixmap, fact);
 }
 
 int SkMipMap::countLevels() const {
@@ -617,6 +679,7 @@ bool SkMipMap::getLevel(int index, Level* levelPtr) const {
     if (index > fCount - 1) {
         return false;
     }
+    this->buildLevels(index + 1);
     if (levelPtr) {
         *levelPtr = fLevels[index];
     }
@@ -10,13 +10,17 @@
 
 #include "SkCachedData.h"
 #include "SkImageInfoPriv.h"
+#include "SkMutex.h"
 #include "SkPixmap.h"
 #include "SkScalar.h"
 #include "SkSize.h"
 #include "SkShaderBase.h"
 
+#include <atomic>
+
 class SkBitmap;
 class SkDiscardableMemory;
+class SkExecutor;
 
 typedef SkDiscardableMemory* (*SkDiscardableFactoryProc)(size_t bytes);
 
@@ -29,8 +33,16 @@ typedef SkDiscardableMemory* (*SkDiscardableFactoryProc)(size_t bytes);
  */
 class SkMipMap : public SkCachedData {
 public:
-    static SkMipMap* Build(const SkPixmap& src, SkDiscardableFactoryProc);
-    static SkMipMap* Build(const SkBitmap& src, SkDiscardableFactoryProc);
+    // If an executor is given, large levels are filtered in bands of rows on it.
+    static SkMipMap* Build(const SkPixmap& src, SkDiscardableFactoryProc,
+                           SkExecutor* = nullptr);
+    static SkMipMap* Build(const SkBitmap& src, SkDiscardableFactoryProc,
+                           SkExecutor* = nullptr);
+
+    // Allocates all the levels and fills in the first, but leaves the smaller levels until they
+    // are asked for through extractLevel() or getLevel(). Does not hold on to src.
+    static SkMipMap* BuildLazily(const SkPixmap& src, SkDiscardableFactoryProc);
+    static SkMipMap* BuildLazily(const SkBitmap& src, SkDiscardableFactoryProc);
 
     // Determines how many levels a SkMipMap will have without creating that mipmap.
     // This does not include the base mipmap level that the user provided when
@@ -71,10 +83,18 @@ private:
     Level*              fLevels;    // managed by the baseclass, may be null due to onDataChanged.
     int                 fCount;
 
+    // Levels [0, fBuiltCount) hold pixels; the rest are built on demand under fBuildMutex.
+    mutable SkMutex          fBuildMutex;
+    mutable std::atomic<int> fBuiltCount{0};
+
     SkMipMap(void* malloc, size_t size) : INHERITED(malloc, size) {}
     SkMipMap(size_t size, SkDiscardableMemory* dm) : INHERITED(size, dm) {}
 
     static size_t AllocLevelsSize(int levelCount, size_t pixelSize);
+    static SkMipMap* Allocate(const SkPixmap& src, SkDiscardableFactoryProc);
+
+    // Makes sure the first count levels are filled in.
+    void buildLevels(int count) const;
 
     typedef SkCachedData INHERITED;
 };
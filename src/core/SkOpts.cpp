@@ -16,6 +16,8 @@
     #else
         #define SK_OPTS_NS neon
     #endif
+#elif SK_CPU_SSE_LEVEL >= SK_CPU_SSE_LEVEL_AVX512
+    #define SK_OPTS_NS skx
 #elif SK_CPU_SSE_LEVEL >= SK_CPU_SSE_LEVEL_AVX2
     #define SK_OPTS_NS avx2
 #elif SK_CPU_SSE_LEVEL >= SK_CPU_SSE_LEVEL_AVX
@@ -39,8 +41,11 @@
 #include "SkBitmapProcState_opts.h"
 #include "SkBlitMask_opts.h"
 #include "SkBlitRow_opts.h"
+#include "SkBoxBlur_opts.h"
 #include "SkChecksum_opts.h"
+#include "SkMipMap_opts.h"
 #include "SkRasterPipeline_opts.h"
+#include "SkScan_opts.h"
 #include "SkSwizzler_opts.h"
 #include "SkUtils_opts.h"
 #include "SkXfermode_opts.h"
@@ -67,6 +72,31 @@ namespace SkOpts {
     DEFINE_DEFAULT(grayA_to_rgbA);
     DEFINE_DEFAULT(inverted_CMYK_to_RGB1);
     DEFINE_DEFAULT(inverted_CMYK_to_BGR1);
+    DEFINE_DEFAULT(RGB16_to_RGB1);
+    DEFINE_DEFAULT(RGB16_to_BGR1);
+    DEFINE_DEFAULT(RGBA16_to_RGBA);
+    DEFINE_DEFAULT(RGBA16_to_BGRA);
+    DEFINE_DEFAULT(RGBA16_to_rgbA);
+    DEFINE_DEFAULT(RGBA16_to_bgrA);
+    DEFINE_DEFAULT(RGB_to_565);
+    DEFINE_DEFAULT(BGR_to_565);
+    DEFINE_DEFAULT(RGB16_to_565);
+    DEFINE_DEFAULT(index_to_8888);
+
+    DEFINE_DEFAULT(downsample_2_2_8888);
+    DEFINE_DEFAULT(downsample_3_3_8888);
+    DEFINE_DEFAULT(downsample_2_2_a8);
+    DEFINE_DEFAULT(downsample_3_3_a8);
+    DEFINE_DEFAULT(downsample_2_2_f16);
+    DEFINE_DEFAULT(downsample_3_3_f16);
+
+    DEFINE_DEFAULT(accumulate_coverage);
+    DEFINE_DEFAULT(add_coverage);
+    DEFINE_DEFAULT(coverage_to_runs);
+
+    DEFINE_DEFAULT(box_blur_columns);
+    DEFINE_DEFAULT(transpose8);
+    DEFINE_DEFAULT(transpose32);
 
     DEFINE_DEFAULT(memset16);
     DEFINE_DEFAULT(memset32);
@@ -97,6 +127,7 @@ namespace SkOpts {
     void Init_sse42();
     void Init_avx();
     void Init_hsw();
+    void Init_skx();
     void Init_crc32();
 
     static void init() {
@@ -119,6 +150,10 @@ namespace SkOpts {
             if (SkCpu::Supports(SkCpu::HSW)) { Init_hsw();   }
         #endif
 
+        #if SK_CPU_SSE_LEVEL < SK_CPU_SSE_LEVEL_AVX512
+            if (SkCpu::Supports(SkCpu::SKX)) { Init_skx();   }
+        #endif
+
     #elif defined(SK_CPU_ARM64)
         if (SkCpu::Supports(SkCpu::CRC32)) { Init_crc32(); }
 
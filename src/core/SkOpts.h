@@ -43,6 +43,44 @@ namespace SkOpts {
                            grayA_to_RGBA,   // i.e. expand to color channels
                            grayA_to_rgbA;   // i.e. expand to color channels and premultiply
 
+    // 16-bit big-endian channels, as PNG stores them, keeping the high byte of each.
+    extern Swizzle_8888_u8 RGB16_to_RGB1,   // i.e. strip to 8 bits and insert an opaque alpha
+                           RGB16_to_BGR1,   // i.e. strip, swap RB and insert an opaque alpha
+                           RGBA16_to_RGBA,  // i.e. just strip to 8 bits
+                           RGBA16_to_BGRA,  // i.e. strip and swap RB
+                           RGBA16_to_rgbA,  // i.e. strip and premultiply
+                           RGBA16_to_bgrA;  // i.e. strip, swap RB and premultiply
+
+    // Swizzle input into a 565 pixel.
+    typedef void (*Swizzle_565_u8)(uint16_t*, const uint8_t*, int);
+    extern Swizzle_565_u8 RGB_to_565,       // i.e. truncate to 5/6/5 bits
+                          BGR_to_565,       // i.e. swap RB and truncate
+                          RGB16_to_565;     // i.e. strip 16-bit channels and truncate
+
+    // Look up 8-bit indices in a table of 256 8888 pixels.
+    typedef void (*Swizzle_8888_index)(uint32_t*, const uint8_t*, int, const uint32_t* table);
+    extern Swizzle_8888_index index_to_8888;
+
+    // Mipmap filters: 2x2 boxes for even source dimensions, 3x3 triangles for odd ones.
+    typedef void (*Downsample)(void* dst, const void* src, size_t srcRB, int count);
+    extern Downsample downsample_2_2_8888, downsample_3_3_8888,
+                      downsample_2_2_a8,   downsample_3_3_a8,
+                      downsample_2_2_f16,  downsample_3_3_f16;
+
+    // Analytic AA coverage rows: saturating adds, and conversion to runs of snapped alphas.
+    extern void (*accumulate_coverage)(SkAlpha dst[], const SkAlpha src[], int count);
+    extern void (*add_coverage)(SkAlpha dst[], SkAlpha alpha, int count);
+    extern bool (*coverage_to_runs)(SkAlpha alphas[], int16_t runs[], SkAlpha coverage[], int);
+
+    // SkBoxBlur's passes: three box blurs down the byte columns of an image, and transposes.
+    extern void (*box_blur_columns)(const uint8_t* src, size_t srcRB, int srcH, int srcTop,
+                                    uint8_t* dst, size_t dstRB, int dstH, int width, int window,
+                                    bool roundProduct);
+    extern void (*transpose8) (uint8_t*  dst, size_t dstRB, const uint8_t*  src, size_t srcRB,
+                               int w, int h);
+    extern void (*transpose32)(uint32_t* dst, size_t dstRB, const uint32_t* src, size_t srcRB,
+                               int w, int h);
+
     extern void (*memset16)(uint16_t[], uint16_t, int);
     extern void SK_API (*memset32)(uint32_t[], uint32_t, int);
     extern void (*memset64)(uint64_t[], uint64_t, int);
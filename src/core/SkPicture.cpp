@@ -7,6 +7,7 @@
 
 #include "SkPicture.h"
 
+#include "SkCanvas.h"
 #include "SkImageGenerator.h"
 #include "SkMathPriv.h"
 #include "SkPictureCommon.h"
@@ -16,6 +17,7 @@
 #include "SkPictureRecord.h"
 #include "SkPictureRecorder.h"
 #include "SkSerialProcs.h"
+#include "SkTaskGroup.h"
 #include "SkTo.h"
 #include <atomic>
 
@@ -182,6 +184,9 @@ sk_sp<SkPicture> SkPicture::MakeFromStream(SkStream* stream, const SkDeserialPro
             if (stream->read(data->writable_data(), size) != size) {
                 return nullptr;
             }
+            // serialize() pads custom data to 4 bytes; skip that so any sub-picture after this
+            // one starts where it was written.
+            stream->skip(SkAlign4(size) - size);
             return procs.fPictureProc(data->data(), size, procs.fPictureCtx);
         }
         default:    // fall through to error return
@@ -311,6 +316,30 @@ void SkPicturePriv::Flatten(const sk_sp<const SkPicture> picture, SkWriteBuffer&
     }
 }
 
+void SkPicture::playbackParallel(const SkIRect tiles[], int count, SkExecutor& executor,
+                                 const std::function<SkCanvas*(int, const SkIRect&)>&
+                                         makeCanvas) const {
+    // Each tile is independent: playback() is const, and the clip lets SkBigPicture search its
+    // bounding box hierarchy for just the ops touching that tile.
+    SkTaskGroup tg(executor);
+    tg.batch(count, [&](int i) {
+        const SkIRect& tile = tiles[i];
+        SkCanvas* canvas = makeCanvas(i, tile);
+        if (!canvas) {
+            return;
+        }
+        SkAutoCanvasRestore acr(canvas, true);
+        SkMatrix ctm = canvas->getTotalMatrix();
+        ctm.postTranslate(-SkIntToScalar(tile.fLeft), -SkIntToScalar(tile.fTop));
+
+        canvas->resetMatrix();
+        canvas->clipRect(SkRect::MakeIWH(tile.width(), tile.height()));
+        canvas->setMatrix(ctm);
+        this->playback(canvas);
+    });
+    tg.wait();
+}
+
 sk_sp<SkPicture> SkPicture::MakePlaceholder(SkRect cull) {
     struct Placeholder : public SkPicture {
           explicit Placeholder(SkRect cull) : fCull(cull) {}
@@ -93,6 +93,17 @@ static void write_tag_size(SkWStream* stream, uint32_t tag, size_t size) {
     stream->write32(SkToU32(size));
 }
 
+// Pads the stream so that the section after the next tag and size starts 4-byte aligned, which
+// lets a mapped file be read in place.  The picture header leaves us 1 byte off to begin with.
+static void write_padding(SkWStream* stream) {
+    const size_t pad = SkAlign4(stream->bytesWritten()) - stream->bytesWritten();
+    if (pad) {
+        const uint32_t zero = 0;
+        write_tag_size(stream, SK_PICT_PADDING_TAG, pad);
+        stream->write(&zero, pad);
+    }
+}
+
 void SkPictureData::WriteFactories(SkWStream* stream, const SkFactorySet& rec) {
     int count = rec.count();
 
@@ -199,6 +210,7 @@ static SkSerialProcs skip_typeface_proc(const SkSerialProcs& procs) {
 void SkPictureData::serialize(SkWStream* stream, const SkSerialProcs& procs,
                               SkRefCntSet* topLevelTypeFaceSet) const {
     // This can happen at pretty much any time, so might as well do it first.
+    write_padding(stream);
     write_tag_size(stream, SK_PICT_READER_TAG, fOpData->size());
     stream->write(fOpData->bytes(), fOpData->size());
 
@@ -238,6 +250,7 @@ void SkPictureData::serialize(SkWStream* stream, const SkSerialProcs& procs,
     }
 
     // Write the buffer.
+    write_padding(stream);
     write_tag_size(stream, SK_PICT_BUFFER_SIZE_TAG, buffer.bytesWritten());
     buffer.writeToStream(stream);
 
@@ -277,19 +290,45 @@ void SkPictureData::flatten(SkWriteBuffer& buffer) const {
 
 ///////////////////////////////////////////////////////////////////////////////
 
+// If the stream is reading source, returns where its next size bytes start in source.
+static bool stream_reads_source(const SkData* source, SkStream* stream, size_t size,
+                                size_t* offset) {
+    if (!source || stream->getMemoryBase() != source->data() || !stream->hasPosition()) {
+        return false;
+    }
+    *offset = stream->getPosition();
+    return *offset <= source->size() && size <= source->size() - *offset;
+}
+
 bool SkPictureData::parseStreamTag(SkStream* stream,
                                    uint32_t tag,
                                    uint32_t size,
                                    const SkDeserialProcs& procs,
                                    SkTypefacePlayback* topLevelTFPlayback) {
     switch (tag) {
-        case SK_PICT_READER_TAG:
+        case SK_PICT_READER_TAG: {
             SkASSERT(nullptr == fOpData);
-            fOpData = SkData::MakeFromStream(stream, size);
+            // SkReadBuffer needs the ops 4-byte aligned.  serialize() pads them to be, but older
+            // files and sources that don't start aligned still need a copy.
+            size_t offset;
+            if (stream_reads_source(fSource, stream, size, &offset) &&
+                SkIsAlign4((uintptr_t)fSource->bytes() + offset)) {
+                if (stream->skip(size) != size) {
+                    return false;
+                }
+                fOpData = SkData::MakeSubset(fSource, offset, size);
+            } else {
+                fOpData = SkData::MakeFromStream(stream, size);
+            }
             if (!fOpData) {
                 return false;
             }
-            break;
+        } break;
+        case SK_PICT_PADDING_TAG: {
+            if (stream->skip(size) != size) {
+                return false;
+            }
+        } break;
         case SK_PICT_FACTORY_TAG: {
             if (!stream->readU32(&size)) { return false; }
             fFactoryPlayback = skstd::make_unique<SkFactoryPlayback>(size);
@@ -329,13 +368,31 @@ bool SkPictureData::parseStreamTag(SkStream* stream,
             }
         } break;
         case SK_PICT_BUFFER_SIZE_TAG: {
-            SkAutoMalloc storage(size);
-            if (stream->read(storage.get(), size) != size) {
-                return false;
+            size_t offset;
+            const bool readsSource = stream_reads_source(fSource, stream, size, &offset);
+
+            SkAutoMalloc storage;
+            const void* bytes;
+            if (readsSource && SkIsAlign4((uintptr_t)fSource->bytes() + offset)) {
+                if (stream->skip(size) != size) {
+                    return false;
+                }
+                bytes = fSource->bytes() + offset;
+            } else {
+                storage.reset(size);
+                if (stream->read(storage.get(), size) != size) {
+                    return false;
+                }
+                bytes = storage.get();
             }
 
-            SkReadBuffer buffer(storage.get(), size);
+            SkReadBuffer buffer(bytes, size);
             buffer.setVersion(fInfo.getVersion());
+            if (readsSource) {
+                // Even if we had to copy the buffer, its encoded images can still come
+                // straight from the source.
+                buffer.setSourceData(fSource, offset);
+            }
 
             if (!fFactoryPlayback) {
                 return false;
@@ -467,13 +524,17 @@ void SkPictureData::parseBufferTag(SkReadBuffer& buffer, uint32_t tag, uint32_t
 SkPictureData* SkPictureData::CreateFromStream(SkStream* stream,
                                                const SkPictInfo& info,
                                                const SkDeserialProcs& procs,
-                                               SkTypefacePlayback* topLevelTFPlayback) {
+                                               SkTypefacePlayback* topLevelTFPlayback,
+                                               const SkData* source) {
     std::unique_ptr<SkPictureData> data(new SkPictureData(info));
     if (!topLevelTFPlayback) {
         topLevelTFPlayback = &data->fTFPlayback;
     }
 
-    if (!data->parseStream(stream, procs, topLevelTFPlayback)) {
+    data->fSource = source;
+    bool parsed = data->parseStream(stream, procs, topLevelTFPlayback);
+    data->fSource = nullptr;
+    if (!parsed) {
         return nullptr;
     }
     return data.release();
@@ -65,6 +65,9 @@ public:
 #define SK_PICT_VERTICES_BUFFER_TAG SkSetFourByteTag('v', 'e', 'r', 't')
 #define SK_PICT_IMAGE_BUFFER_TAG    SkSetFourByteTag('i', 'm', 'a', 'g')
 
+// Zero bytes that align the section after the next tag and size in a stream
+#define SK_PICT_PADDING_TAG SkSetFourByteTag('p', 'a', 'd', ' ')
+
 // Always write this guy last (with no length field afterwards)
 #define SK_PICT_EOF_TAG     SkSetFourByteTag('e', 'o', 'f', ' ')
 
@@ -78,10 +81,13 @@ class SkPictureData {
 public:
     SkPictureData(const SkPictureRecord& record, const SkPictInfo&);
     // Does not affect ownership of SkStream.
+    // If the stream reads from source, the ops and encoded images reference source's bytes
+    // where they can instead of being copied.
     static SkPictureData* CreateFromStream(SkStream*,
                                            const SkPictInfo&,
                                            const SkDeserialProcs&,
-                                           SkTypefacePlayback*);
+                                           SkTypefacePlayback*,
+                                           const SkData* source = nullptr);
     static SkPictureData* CreateFromBuffer(SkReadBuffer&, const SkPictInfo&);
 
     void serialize(SkWStream*, const SkSerialProcs&, SkRefCntSet*) const;
@@ -161,10 +167,14 @@ private:
 
     const SkPictInfo fInfo;
 
+    const SkData* fSource = nullptr;    // only set while parsing
+
     static void WriteFactories(SkWStream* stream, const SkFactorySet& rec);
     static void WriteTypefaces(SkWStream* stream, const SkRefCntSet& rec, const SkSerialProcs&);
 
     void initForPlayback() const;
+
+    friend class SkPictureStreamReader;
 };
 
 #endif
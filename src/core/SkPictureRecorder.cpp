@@ -17,6 +17,14 @@
 #include "SkRecorder.h"
 #include "SkTypes.h"
 
+static uint32_t record_optimize_flags(uint32_t finishFlags) {
+    uint32_t flags = 0;
+    if (finishFlags & SkPictureRecorder::kOptimizeClipsAndOcclusion_FinishFlag) {
+        flags |= kCoalesceClips_RecordOptimizeFlag | kCullOccludedDraws_RecordOptimizeFlag;
+    }
+    return flags;
+}
+
 SkPictureRecorder::SkPictureRecorder() {
     fActivelyRecording = false;
     fMiniRecorder.reset(new SkMiniRecorder);
@@ -64,7 +72,7 @@ sk_sp<SkPicture> SkPictureRecorder::finishRecordingAsPicture(uint32_t finishFlag
     }
 
     // TODO: delay as much of this work until just before first playback?
-    SkRecordOptimize(fRecord.get());
+    SkRecordOptimize(fRecord.get(), record_optimize_flags(finishFlags));
 
     SkDrawableList* drawableList = fRecorder->getDrawableList();
     SkBigPicture::SnapshotArray* pictList =
@@ -118,7 +126,7 @@ sk_sp<SkDrawable> SkPictureRecorder::finishRecordingAsDrawable(uint32_t finishFl
     fRecorder->flushMiniRecorder();
     fRecorder->restoreToCount(1);  // If we were missing any restores, add them now.
 
-    SkRecordOptimize(fRecord.get());
+    SkRecordOptimize(fRecord.get(), record_optimize_flags(finishFlags));
 
     if (fBBH.get()) {
         SkAutoTMalloc<SkRect> bounds(fRecord->count());
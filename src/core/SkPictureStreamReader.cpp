@@ -0,0 +1,371 @@
+/*
+ * Copyright 2018 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "SkPictureStreamReader.h"
+
+#include "SkAutoMalloc.h"
+#include "SkBBHFactory.h"
+#include "SkCanvas.h"
+#include "SkOnce.h"
+#include "SkPicturePlayback.h"
+#include "SkPictureRecord.h"
+#include "SkPictureRecorder.h"
+#include "SkReadBuffer.h"
+#include "SkStream.h"
+#include "SkTextBlob.h"
+#include "SkTypeface.h"
+#include "SkVertices.h"
+
+// Matches kPictureData_TrailingStreamByteAfterPictInfo in SkPicture.cpp.
+static const uint8_t kPictureData_TrailingStreamByte = 1;
+
+// Steps over the ops in [*offset, available) of an op section of the given size, counting them.
+// Returns false if one is invalid.
+static bool walk_ops(const uint8_t* ops, size_t available, size_t size,
+                     size_t* offset, int* count, bool* walkable) {
+    while (*walkable && *offset + sizeof(uint32_t) <= available) {
+        uint32_t packed;
+        memcpy(&packed, ops + *offset, sizeof(packed));
+
+        uint32_t op, opSize;
+        UNPACK_8_24(packed, op, opSize);
+        if (op <= UNUSED || op > LAST_DRAWTYPE_ENUM) {
+            return false;
+        }
+        if (MASK_24 == opSize || opSize < sizeof(uint32_t) || !SkIsAlign4(opSize)) {
+            // Op sizes that don't fit in 24 bits aren't reliable enough to walk past (see
+            // SkPictureRecord::addDraw()). Leave the rest to SkPicturePlayback to validate.
+            *walkable = false;
+            break;
+        }
+        if (opSize > size - *offset) {
+            return false;
+        }
+        *offset += opSize;
+        (*count)++;
+    }
+    return true;
+}
+
+// Plays its ops straight from the SkPictureData, re-recording them into an SkRTree only once a
+// playback asks for part of the picture.
+class SkStreamedPicture final : public SkPicture {
+public:
+    SkStreamedPicture(const SkPictInfo& info, std::unique_ptr<SkPictureData> data, int opCount)
+        : fCullRect(info.fCullRect)
+        , fData(std::move(data))
+        , fOpCount(opCount) {}
+
+    void playback(SkCanvas* canvas, AbortCallback* callback) const override {
+        SkRect clip;
+        if (canvas->getLocalClipBounds(&clip) && !clip.contains(fCullRect)) {
+            this->seekable()->playback(canvas, callback);
+            return;
+        }
+        SkPicturePlayback playback(fData.get());
+        playback.draw(canvas, callback, nullptr);
+    }
+
+    int approximateOpCount() const override { return fOpCount; }
+
+    size_t approximateBytesUsed() const override {
+        return sizeof(*this) + fData->opData()->size();
+    }
+
+    SkRect cullRect() const override { return fCullRect; }
+
+private:
+    const SkPicture* seekable() const {
+        fSeekableOnce([this] {
+            SkRTreeFactory factory;
+            SkPictureRecorder recorder;
+            SkPicturePlayback playback(fData.get());
+            playback.draw(recorder.beginRecording(fCullRect, &factory), nullptr, nullptr);
+            fSeekable = recorder.finishRecordingAsPicture();
+        });
+        return fSeekable.get();
+    }
+
+    const SkRect                         fCullRect;
+    const std::unique_ptr<SkPictureData> fData;
+    const int                            fOpCount;
+
+    mutable SkOnce                       fSeekableOnce;
+    mutable sk_sp<SkPicture>             fSeekable;
+};
+
+SkPictureStreamReader::SkPictureStreamReader(const SkDeserialProcs* procs)
+    : fState(kHeader_State)
+    , fConsumed(0)
+    , fRetrySize(0)
+    , fOpOffset(0)
+    , fOpCount(0)
+    , fOpsWalkable(true) {
+    if (procs) {
+        fProcs = *procs;
+    }
+}
+
+SkPictureStreamReader::~SkPictureStreamReader() {}
+
+bool SkPictureStreamReader::append(const void* data, size_t size) {
+    if (!this->isValid()) {
+        return false;
+    }
+    if (kDone_State == fState) {
+        return true;    // MakeFromStream() ignores anything after the end tag too.
+    }
+    if (!SkTFitsIn<int>(fPending.count() + size)) {
+        fState = kInvalid_State;
+        return false;
+    }
+    fPending.append(SkToInt(size), static_cast<const uint8_t*>(data));
+    return this->parse(false);
+}
+
+sk_sp<SkPicture> SkPictureStreamReader::finish() {
+    if (kTags_State == fState) {
+        this->parse(true);
+    }
+
+    sk_sp<SkPicture> picture;
+    if (kDone_State == fState) {
+        // Playback may run on several threads at once, so path bounds can't be computed lazily.
+        fData->initForPlayback();
+        picture = sk_make_sp<SkStreamedPicture>(fInfo, std::move(fData), fOpCount);
+    } else if (kCustom_State == fState) {
+        picture = SkPicture::MakeFromData(fPending.begin(), fPending.count(), &fProcs);
+    }
+
+    fState = kInvalid_State;
+    fPending.reset();
+    fData.reset();
+    return picture;
+}
+
+sk_sp<SkPicture> SkPictureStreamReader::MakeFromStream(SkStream* stream,
+                                                       const SkDeserialProcs* procs,
+                                                       size_t chunkSize) {
+    SkASSERT(chunkSize > 0);
+    SkPictureStreamReader reader(procs);
+    SkAutoMalloc storage(chunkSize);
+    while (!stream->isAtEnd()) {
+        size_t bytesRead = stream->read(storage.get(), chunkSize);
+        if (0 == bytesRead) {
+            break;
+        }
+        if (!reader.append(storage.get(), bytesRead)) {
+            return nullptr;
+        }
+    }
+    return reader.finish();
+}
+
+sk_sp<SkPicture> SkPictureStreamReader::MakeFromData(sk_sp<SkData> data,
+                                                     const SkDeserialProcs* procsPtr) {
+    if (!data) {
+        return nullptr;
+    }
+    SkDeserialProcs procs;
+    if (procsPtr) {
+        procs = *procsPtr;
+    }
+
+    SkMemoryStream stream(data);
+    SkPictInfo info;
+    uint8_t trailingByte;
+    if (!SkPicture::StreamIsSKP(&stream, &info) || !stream.readU8(&trailingByte)) {
+        return nullptr;
+    }
+    if (kPictureData_TrailingStreamByte != trailingByte) {
+        return SkPicture::MakeFromData(data.get(), procsPtr);
+    }
+
+    std::unique_ptr<SkPictureData> pictureData(
+            SkPictureData::CreateFromStream(&stream, info, procs, nullptr, data.get()));
+    if (!pictureData || !pictureData->opData()) {
+        return nullptr;
+    }
+
+    const SkData* ops = pictureData->opData().get();
+    size_t offset = 0;
+    int opCount = 0;
+    bool walkable = true;
+    if (!walk_ops(ops->bytes(), ops->size(), ops->size(), &offset, &opCount, &walkable)) {
+        return nullptr;
+    }
+    pictureData->initForPlayback();
+    return sk_make_sp<SkStreamedPicture>(info, std::move(pictureData), opCount);
+}
+
+bool SkPictureStreamReader::parse(bool final) {
+    Result result = kParsed_Result;
+    while (kParsed_Result == result) {
+        switch (fState) {
+            case kHeader_State: result = this->parseHeader();    break;
+            case kTags_State:   result = this->parseTag(final);  break;
+            default:            result = kNeedMore_Result;       break;
+        }
+    }
+
+    if (kFailed_Result == result) {
+        fState = kInvalid_State;
+        fPending.reset();
+        fData.reset();
+        return false;
+    }
+
+    // Drop the sections we have parsed. Custom pictures keep every byte for MakeFromData().
+    if (fConsumed > 0 && kCustom_State != fState) {
+        fPending.remove(0, SkToInt(fConsumed));
+        fConsumed = 0;
+    }
+    return true;
+}
+
+SkPictureStreamReader::Result SkPictureStreamReader::parseHeader() {
+    SkASSERT(0 == fConsumed);
+    size_t available = fPending.count();
+
+    // The header's size depends on its version, which follows the magic bytes.
+    uint32_t version;
+    if (available < sizeof(fInfo.fMagic) + sizeof(version)) {
+        return kNeedMore_Result;
+    }
+    memcpy(&version, fPending.begin() + sizeof(fInfo.fMagic), sizeof(version));
+    size_t headerSize = sizeof(fInfo.fMagic) + sizeof(version) + sizeof(SkRect);
+    if (version < SkReadBuffer::kRemoveHeaderFlags_Version) {
+        headerSize += sizeof(uint32_t);
+    }
+    if (available < headerSize + 1) {
+        return kNeedMore_Result;
+    }
+
+    SkMemoryStream stream(fPending.begin(), available);
+    uint8_t trailingByte;
+    if (!SkPicture::StreamIsSKP(&stream, &fInfo) || !stream.readU8(&trailingByte)) {
+        return kFailed_Result;
+    }
+    if (kPictureData_TrailingStreamByte != trailingByte) {
+        // A custom or failed picture; leave it all to MakeFromData().
+        fState = kCustom_State;
+        return kNeedMore_Result;
+    }
+
+    fData.reset(new SkPictureData(fInfo));
+    fConsumed = stream.getPosition();
+    fState = kTags_State;
+    return kParsed_Result;
+}
+
+SkPictureStreamReader::Result SkPictureStreamReader::parseTag(bool final) {
+    const Result needMore = final ? kFailed_Result : kNeedMore_Result;
+    const uint8_t* bytes = fPending.begin() + fConsumed;
+    size_t available = fPending.count() - fConsumed;
+
+    uint32_t tag, size;
+    if (available < sizeof(tag)) {
+        return needMore;
+    }
+    memcpy(&tag, bytes, sizeof(tag));
+    if (SK_PICT_EOF_TAG == tag) {
+        fConsumed += sizeof(tag);
+        if (!fData->opData()) {
+            return kFailed_Result;
+        }
+        fState = kDone_State;
+        return kParsed_Result;
+    }
+    if (available < sizeof(tag) + sizeof(size)) {
+        return needMore;
+    }
+    memcpy(&size, bytes + sizeof(tag), sizeof(size));
+    bytes     += sizeof(tag) + sizeof(size);
+    available -= sizeof(tag) + sizeof(size);
+
+    SkMemoryStream stream(bytes, available);
+    switch (tag) {
+        case SK_PICT_READER_TAG:
+            if (!this->validateOps(bytes, available, size)) {
+                return kFailed_Result;
+            }
+            // fall through
+        case SK_PICT_PADDING_TAG:
+        case SK_PICT_FACTORY_TAG:
+        case SK_PICT_BUFFER_SIZE_TAG:
+            // These sizes count bytes, so we know when they are complete.
+            if (available < size) {
+                return needMore;
+            }
+            break;
+        case SK_PICT_TYPEFACE_TAG:
+        case SK_PICT_PICTURE_TAG: {
+            // These sizes count typefaces or pictures, so all we can do is try to parse them.
+            // Leave the final attempt to parseStreamTag(), which is what MakeFromStream() uses.
+            if (final) {
+                break;
+            }
+            if (available < fRetrySize || available < size) {
+                return kNeedMore_Result;
+            }
+            bool parsed = SK_PICT_TYPEFACE_TAG == tag ? this->parseTypefaces(&stream, size)
+                                                      : this->parsePictures(&stream, size);
+            if (!parsed) {
+                // Wait for twice as much before trying again, so we stay linear in the size.
+                fRetrySize = 2 * available;
+                return kNeedMore_Result;
+            }
+            fRetrySize = 0;
+            fConsumed += sizeof(tag) + sizeof(size) + stream.getPosition();
+            return kParsed_Result;
+        }
+        default:
+            break;
+    }
+
+    if (!fData->parseStreamTag(&stream, tag, size, fProcs, &fData->fTFPlayback)) {
+        return kFailed_Result;
+    }
+    fConsumed += sizeof(tag) + sizeof(size) + stream.getPosition();
+    return kParsed_Result;
+}
+
+bool SkPictureStreamReader::parseTypefaces(SkStream* stream, uint32_t count) {
+    SkTArray<sk_sp<SkTypeface>> typefaces;
+    for (uint32_t i = 0; i < count; ++i) {
+        sk_sp<SkTypeface> tf = SkTypeface::MakeDeserialize(stream);
+        if (!tf) {
+            return false;
+        }
+        typefaces.push_back(std::move(tf));
+    }
+
+    fData->fTFPlayback.setCount(count);
+    for (uint32_t i = 0; i < count; ++i) {
+        fData->fTFPlayback[i] = std::move(typefaces[i]);
+    }
+    return true;
+}
+
+bool SkPictureStreamReader::parsePictures(SkStream* stream, uint32_t count) {
+    SkTArray<sk_sp<const SkPicture>> pictures;
+    for (uint32_t i = 0; i < count; ++i) {
+        auto pic = SkPicture::MakeFromStream(stream, &fProcs, &fData->fTFPlayback);
+        if (!pic) {
+            return false;
+        }
+        pictures.push_back(std::move(pic));
+    }
+
+    SkASSERT(fData->fPictures.empty());
+    fData->fPictures = std::move(pictures);
+    return true;
+}
+
+bool SkPictureStreamReader::validateOps(const uint8_t* ops, size_t available, size_t size) {
+    return walk_ops(ops, SkTMin(available, size), size, &fOpOffset, &fOpCount, &fOpsWalkable);
+}
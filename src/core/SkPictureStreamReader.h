@@ -0,0 +1,103 @@
+/*
+ * Copyright 2018 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#ifndef SkPictureStreamReader_DEFINED
+#define SkPictureStreamReader_DEFINED
+
+#include "SkPictureData.h"
+#include "SkSerialProcs.h"
+#include "SkTDArray.h"
+
+#include <memory>
+
+/**
+ *  Incrementally deserializes a picture written by SkPicture::serialize() as its bytes arrive,
+ *  e.g. in chunks over IPC, instead of waiting for the whole stream like
+ *  SkPicture::MakeFromStream().
+ *
+ *  Each section of the stream is parsed as soon as it is complete, and the ops are validated
+ *  while they are still arriving, so a malformed stream is rejected before the rest of it is
+ *  read. Unlike MakeFromStream(), an op with an unknown type fails the whole picture rather than
+ *  truncating it.
+ *
+ *  The picture returned by finish() plays back its ops straight from the deserialized data
+ *  instead of re-recording them first, so it is ready to draw as soon as the last byte has been
+ *  parsed. Embedded images stay encoded until first drawn. The first playback clipped to less
+ *  than the whole picture records the ops once into an SkRTree, so later partial playbacks (e.g.
+ *  tiles) only replay the ops they touch.
+ */
+class SkPictureStreamReader : SkNoncopyable {
+public:
+    explicit SkPictureStreamReader(const SkDeserialProcs* procs = nullptr);
+    ~SkPictureStreamReader();
+
+    /**
+     *  Appends the next bytes of the stream and parses every section they complete.
+     *  Returns false once the stream can no longer form a valid picture.
+     */
+    bool append(const void* data, size_t size);
+
+    /**
+     *  Call once every byte has been appended. Returns the picture, or nullptr if the stream was
+     *  not a valid picture. The reader is left invalid.
+     */
+    sk_sp<SkPicture> finish();
+
+    bool isValid() const { return kInvalid_State != fState; }
+
+    /** Number of ops validated so far. */
+    int validatedOpCount() const { return fOpCount; }
+
+    /**
+     *  Deserializes a picture that is already all in memory, e.g. a file mapped by
+     *  SkData::MakeFromFileName(), into the same kind of picture as finish() returns. Encoded
+     *  images, and the ops when they are 4-byte aligned, reference data in place instead of
+     *  being copied, so loading a large mapped file mostly costs page faults as it is drawn.
+     */
+    static sk_sp<SkPicture> MakeFromData(sk_sp<SkData>, const SkDeserialProcs* = nullptr);
+
+    /** Reads a whole stream through a reader, chunkSize bytes at a time. */
+    static sk_sp<SkPicture> MakeFromStream(SkStream*, const SkDeserialProcs* = nullptr,
+                                           size_t chunkSize = 64 * 1024);
+
+private:
+    enum State {
+        kHeader_State,      // waiting for SkPictInfo and the byte after it
+        kTags_State,        // parsing the tagged sections of SkPictureData
+        kDone_State,        // saw the end tag
+        kCustom_State,      // not SkPictureData; buffer everything for MakeFromData()
+        kInvalid_State,
+    };
+
+    enum Result {
+        kNeedMore_Result,
+        kParsed_Result,
+        kFailed_Result,
+    };
+
+    Result parseHeader();
+    Result parseTag(bool final);
+    bool   parseTypefaces(SkStream*, uint32_t count);
+    bool   parsePictures(SkStream*, uint32_t count);
+    bool   validateOps(const uint8_t* ops, size_t available, size_t size);
+    bool   parse(bool final);
+
+    SkDeserialProcs                fProcs;
+    State                          fState;
+    SkTDArray<uint8_t>             fPending;        // bytes not yet parsed, from fConsumed on
+    size_t                         fConsumed;
+    size_t                         fRetrySize;      // don't retry a variable-sized tag until then
+    SkPictInfo                     fInfo;
+    std::unique_ptr<SkPictureData> fData;
+
+    // Incremental walk over the op section.
+    size_t                         fOpOffset;
+    int                            fOpCount;
+    bool                           fOpsWalkable;
+};
+
+#endif
@@ -6,9 +6,18 @@
  */
 
 #include "SkRasterPipeline.h"
+#include "SkMutex.h"
 #include "SkOpts.h"
+#include "SkTHash.h"
 #include <algorithm>
 
+thread_local bool gSkForceRasterPipelineHighp = false;
+std::atomic<bool> gSkCountRasterPipelinePrecision{false};
+std::atomic<int>  gSkRasterPipelineLowpCount{0};
+std::atomic<int>  gSkRasterPipelineHighpCount{0};
+std::atomic<int>  gSkRasterPipelineFusedCount{0};
+std::atomic<bool> gSkCountRasterPipelineSequences{false};
+
 SkRasterPipeline::SkRasterPipeline(SkArenaAlloc* alloc) : fAlloc(alloc) {
     this->reset();
 }
@@ -58,17 +67,20 @@ void SkRasterPipeline::extend(const SkRasterPipeline& src) {
     fSlotsNeeded += src.fSlotsNeeded - 1;  // Don't double count just_returns().
 }
 
+static const char* stage_name(uint64_t stage) {
+    switch (stage) {
+    #define M(x) case SkRasterPipeline::x: return #x;
+        SK_RASTER_PIPELINE_STAGES(M)
+    #undef M
+    }
+    return "";
+}
+
 void SkRasterPipeline::dump() const {
     SkDebugf("SkRasterPipeline, %d stages\n", fNumStages);
     std::vector<const char*> stages;
     for (auto st = fStages; st; st = st->prev) {
-        const char* name = "";
-        switch (st->stage) {
-        #define M(x) case x: name = #x; break;
-            SK_RASTER_PIPELINE_STAGES(M)
-        #undef M
-        }
-        stages.push_back(name);
+        stages.push_back(stage_name(st->stage));
     }
     std::reverse(stages.begin(), stages.end());
     for (const char* name : stages) {
@@ -259,30 +271,123 @@ void SkRasterPipeline::append_gamut_clamp_if_normalized(const SkImageInfo& dstIn
     }
 }
 
-SkRasterPipeline::StartPipelineFn SkRasterPipeline::build_pipeline(void** ip) const {
-    // We'll try to build a lowp pipeline, but if that fails fallback to a highp float pipeline.
-    void** reset_point = ip;
+static void count_pipeline(std::atomic<int>* count, int n = 1) {
+    if (gSkCountRasterPipelinePrecision.load(std::memory_order_relaxed)) {
+        count->fetch_add(n, std::memory_order_relaxed);
+    }
+}
 
-    // Stages are stored backwards in fStages, so we reverse here, back to front.
-    *--ip = (void*)SkOpts::just_return_lowp;
-    for (const StageList* st = fStages; st; st = st->prev) {
-        SkOpts::StageFn fn;
-        if (!st->rawFunction && (fn = SkOpts::stages_lowp[st->stage])) {
+// Stage sequences common enough to be worth fusing into a single stage.  A fused stage runs
+// its sequence's stages back to back, reading their contexts from the program in order.
+static const struct {
+    SkRasterPipeline::StockStage fused;
+    int                          count;
+    SkRasterPipeline::StockStage stages[3];
+} kFusedStages[] = {
+    { SkRasterPipeline::seed_shader_matrix_translate,        2,
+        { SkRasterPipeline::seed_shader, SkRasterPipeline::matrix_translate } },
+    { SkRasterPipeline::seed_shader_matrix_scale_translate,  2,
+        { SkRasterPipeline::seed_shader, SkRasterPipeline::matrix_scale_translate } },
+    { SkRasterPipeline::seed_shader_matrix_2x3,              2,
+        { SkRasterPipeline::seed_shader, SkRasterPipeline::matrix_2x3 } },
+    { SkRasterPipeline::gather_8888_srcover_rgba_8888,       2,
+        { SkRasterPipeline::gather_8888, SkRasterPipeline::srcover_rgba_8888 } },
+    { SkRasterPipeline::bilerp_clamp_8888_srcover_rgba_8888, 2,
+        { SkRasterPipeline::bilerp_clamp_8888, SkRasterPipeline::srcover_rgba_8888 } },
+    { SkRasterPipeline::load_8888_srcover_rgba_8888,         2,
+        { SkRasterPipeline::load_8888, SkRasterPipeline::srcover_rgba_8888 } },
+    { SkRasterPipeline::load_8888_dst_srcover_store_8888,    3,
+        { SkRasterPipeline::load_8888_dst, SkRasterPipeline::srcover,
+          SkRasterPipeline::store_8888 } },
+};
+
+const SkRasterPipeline::StageList* SkRasterPipeline::Fuse(const StageList* st,
+                                                          const StageFn stages[], StageFn* fn) {
+    for (const auto& f : kFusedStages) {
+        // Some fused stages have no lowp kernel, so their components run separately instead.
+        if (!stages[f.fused]) {
+            continue;
+        }
+        // Stages are stored backwards, so we match the sequence back to front.
+        const StageList* first = st;
+        int i = f.count - 1;
+        for (; i >= 0 && first && !first->rawFunction && first->stage == (uint64_t)f.stages[i];
+               i--) {
+            if (i > 0) {
+                first = first->prev;
+            }
+        }
+        if (i < 0) {
+            *fn = stages[f.fused];
+            return first;
+        }
+    }
+    return st;
+}
+
+SkRasterPipeline::StartPipelineFn SkRasterPipeline::build_pipeline(void*** program) const {
+    if (gSkCountRasterPipelineSequences.load(std::memory_order_relaxed)) {
+        this->count_sequence();
+    }
+
+    // We'll try to build a lowp pipeline, but if that fails fallback to a highp float pipeline.
+    void** reset_point = *program;
+    void** ip = reset_point;
+
+    // Lay out the stages from st back to first as the single fused stage fn.
+    int fused = 0;
+    auto append_fused = [&ip, &fused](const StageList* first, const StageList* st,
+                                      SkOpts::StageFn fn) {
+        for (;; st = st->prev) {
             if (st->ctx) {
                 *--ip = st->ctx;
             }
-            *--ip = (void*)fn;
-        } else {
-            ip = reset_point;
-            break;
+            if (st == first) {
+                break;
+            }
+        }
+        *--ip = (void*)fn;
+        fused++;
+    };
+
+    if (!gSkForceRasterPipelineHighp) {
+        // Stages are stored backwards in fStages, so we reverse here, back to front.
+        *--ip = (void*)SkOpts::just_return_lowp;
+        for (const StageList* st = fStages; st; st = st->prev) {
+            SkOpts::StageFn fn;
+            const StageList* first = Fuse(st, SkOpts::stages_lowp, &fn);
+            if (first != st) {
+                append_fused(first, st, fn);
+                st = first;
+            } else if (!st->rawFunction && (fn = SkOpts::stages_lowp[st->stage])) {
+                if (st->ctx) {
+                    *--ip = st->ctx;
+                }
+                *--ip = (void*)fn;
+            } else {
+                ip = reset_point;
+                fused = 0;
+                break;
+            }
+        }
+        if (ip != reset_point) {
+            count_pipeline(&gSkRasterPipelineLowpCount);
+            count_pipeline(&gSkRasterPipelineFusedCount, fused);
+            *program = ip;
+            return SkOpts::start_pipeline_lowp;
         }
     }
-    if (ip != reset_point) {
-        return SkOpts::start_pipeline_lowp;
-    }
+    count_pipeline(&gSkRasterPipelineHighpCount);
 
     *--ip = (void*)SkOpts::just_return_highp;
     for (const StageList* st = fStages; st; st = st->prev) {
+        SkOpts::StageFn fn;
+        const StageList* first = Fuse(st, SkOpts::stages_highp, &fn);
+        if (first != st) {
+            append_fused(first, st, fn);
+            st = first;
+            continue;
+        }
         if (st->ctx) {
             *--ip = st->ctx;
         }
@@ -292,19 +397,69 @@ SkRasterPipeline::StartPipelineFn SkRasterPipeline::build_pipeline(void** ip) co
             *--ip = (void*)SkOpts::stages_highp[st->stage];
         }
     }
+    count_pipeline(&gSkRasterPipelineFusedCount, fused);
+    *program = ip;
     return SkOpts::start_pipeline_highp;
 }
 
+SK_DECLARE_STATIC_MUTEX(gSequenceCountsMutex);
+
+static SkTHashMap<SkString, int>& sequence_counts() {
+    static auto* counts = new SkTHashMap<SkString, int>;
+    return *counts;
+}
+
+void SkRasterPipeline::count_sequence() const {
+    std::vector<const char*> stages;
+    for (auto st = fStages; st; st = st->prev) {
+        stages.push_back(st->rawFunction ? "(raw)" : stage_name(st->stage));
+    }
+    SkString sequence;
+    for (auto name = stages.rbegin(); name != stages.rend(); ++name) {
+        if (!sequence.isEmpty()) {
+            sequence.append(" ");
+        }
+        sequence.append(*name);
+    }
+
+    SkAutoMutexAcquire lock(gSequenceCountsMutex);
+    int* count = sequence_counts().find(sequence);
+    if (count) {
+        *count += 1;
+    } else {
+        sequence_counts().set(sequence, 1);
+    }
+}
+
+void SkRasterPipeline::DumpSequenceCounts(int n) {
+    SkAutoMutexAcquire lock(gSequenceCountsMutex);
+
+    std::vector<std::pair<int, const SkString*>> counts;
+    sequence_counts().foreach([&](const SkString& sequence, int* count) {
+        counts.push_back({*count, &sequence});
+    });
+    std::sort(counts.begin(), counts.end(), [](const std::pair<int, const SkString*>& a,
+                                               const std::pair<int, const SkString*>& b) {
+        return a.first > b.first;
+    });
+
+    SkDebugf("Most frequently built raster pipelines, of %d distinct:\n", (int)counts.size());
+    for (int i = 0; i < n && i < (int)counts.size(); i++) {
+        SkDebugf("%10d\t%s\n", counts[i].first, counts[i].second->c_str());
+    }
+}
+
 void SkRasterPipeline::run(size_t x, size_t y, size_t w, size_t h) const {
     if (this->empty()) {
         return;
     }
 
     // Best to not use fAlloc here... we can't bound how often run() will be called.
-    SkAutoSTMalloc<64, void*> program(fSlotsNeeded);
+    SkAutoSTMalloc<64, void*> storage(fSlotsNeeded);
 
-    auto start_pipeline = this->build_pipeline(program.get() + fSlotsNeeded);
-    start_pipeline(x,y,x+w,y+h, program.get());
+    void** program = storage.get() + fSlotsNeeded;
+    auto start_pipeline = this->build_pipeline(&program);
+    start_pipeline(x,y,x+w,y+h, program);
 }
 
 std::function<void(size_t, size_t, size_t, size_t)> SkRasterPipeline::compile() const {
@@ -312,9 +467,9 @@ std::function<void(size_t, size_t, size_t, size_t)> SkRasterPipeline::compile()
         return [](size_t, size_t, size_t, size_t) {};
     }
 
-    void** program = fAlloc->makeArray<void*>(fSlotsNeeded);
+    void** program = fAlloc->makeArray<void*>(fSlotsNeeded) + fSlotsNeeded;
 
-    auto start_pipeline = this->build_pipeline(program + fSlotsNeeded);
+    auto start_pipeline = this->build_pipeline(&program);
     return [=](size_t x, size_t y, size_t w, size_t h) {
         start_pipeline(x,y,x+w,y+h, program);
     };
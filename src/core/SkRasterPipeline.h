@@ -14,6 +14,7 @@
 #include "SkNx.h"
 #include "SkTArray.h" // TODO: unused
 #include "SkTypes.h"
+#include <atomic>
 #include <functional>
 #include <vector>  // TODO: unused
 
@@ -93,7 +94,14 @@
     M(byte_tables)                                                 \
     M(rgb_to_hsl) M(hsl_to_rgb)                                    \
     M(gauss_a_to_rgba)                                             \
-    M(emboss)
+    M(emboss)                                                      \
+    M(seed_shader_matrix_translate)                                \
+    M(seed_shader_matrix_scale_translate)                          \
+    M(seed_shader_matrix_2x3)                                      \
+    M(gather_8888_srcover_rgba_8888)                               \
+    M(bilerp_clamp_8888_srcover_rgba_8888)                         \
+    M(load_8888_srcover_rgba_8888)                                 \
+    M(load_8888_dst_srcover_store_8888)
 
 // The largest number of pixels we handle at a time.
 static const int SkRasterPipeline_kMaxStride = 16;
@@ -120,6 +128,9 @@ struct SkRasterPipeline_SamplerCtx {
     float     fy[SkRasterPipeline_kMaxStride];
     float scalex[SkRasterPipeline_kMaxStride];
     float scaley[SkRasterPipeline_kMaxStride];
+
+    // Only used by lowp: fixed point sums of the weighted samples so far, for r,g,b,a.
+    int32_t   sum[4][SkRasterPipeline_kMaxStride];
 };
 
 struct SkRasterPipeline_TileCtx {
@@ -174,6 +185,19 @@ struct SkRasterPipeline_EmbossCtx {
 
 
 
+// For tools: gSkForceRasterPipelineHighp makes every pipeline built on this thread run with float
+// stages, and while gSkCountRasterPipelinePrecision is set, we count how many pipelines are built
+// to run each way, and how many fused stages they use.
+extern thread_local bool gSkForceRasterPipelineHighp;
+extern std::atomic<bool> gSkCountRasterPipelinePrecision;
+extern std::atomic<int>  gSkRasterPipelineLowpCount;
+extern std::atomic<int>  gSkRasterPipelineHighpCount;
+extern std::atomic<int>  gSkRasterPipelineFusedCount;
+
+// For tools: while gSkCountRasterPipelineSequences is set, we count how often each sequence of
+// stages is built, and SkRasterPipeline::DumpSequenceCounts() prints the most frequent.
+extern std::atomic<bool> gSkCountRasterPipelineSequences;
+
 class SkRasterPipeline {
 public:
     explicit SkRasterPipeline(SkArenaAlloc*);
@@ -208,6 +232,9 @@ public:
 
     void dump() const;
 
+    // Prints the n most frequently built stage sequences, see gSkCountRasterPipelineSequences.
+    static void DumpSequenceCounts(int n);
+
     // Appends a stage for the specified matrix.
     // Tries to optimize the stage by analyzing the type of matrix.
     void append_matrix(SkArenaAlloc*, const SkMatrix&);
@@ -245,7 +272,18 @@ private:
     };
 
     using StartPipelineFn = void(*)(size_t,size_t,size_t,size_t, void** program);
-    StartPipelineFn build_pipeline(void**) const;
+
+    // *program points just past the space for fSlotsNeeded slots, and is moved back to the
+    // start of the program built there.  Fused stages may leave some of that space unused.
+    StartPipelineFn build_pipeline(void*** program) const;
+
+    using StageFn = void(*)(void);
+
+    // If st is the last stage of a sequence whose fused stage has a kernel in stages, sets *fn
+    // to that kernel and returns the first stage of the sequence.  Otherwise returns st.
+    static const StageList* Fuse(const StageList* st, const StageFn stages[], StageFn* fn);
+
+    void count_sequence() const;
 
     void unchecked_append(StockStage, void*);
 
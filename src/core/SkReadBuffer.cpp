@@ -319,10 +319,22 @@ sk_sp<SkImage> SkReadBuffer::readImage() {
         return nullptr;
     }
 
-    sk_sp<SkData> data = SkData::MakeUninitialized(size);
-    if (!this->readPad32(data->writable_data(), size)) {
-        this->validate(false);
-        return nullptr;
+    sk_sp<SkData> data;
+    if (fSourceData) {
+        size_t offset = fSourceOffset + ((const char*)fReader.peek() - (const char*)fReader.base());
+        if (!this->skip(size)) {
+            return nullptr;
+        }
+        data = SkData::MakeSubset(fSourceData, offset, size);
+        if (!this->validate(data != nullptr)) {
+            return nullptr;
+        }
+    } else {
+        data = SkData::MakeUninitialized(size);
+        if (!this->readPad32(data->writable_data(), size)) {
+            this->validate(false);
+            return nullptr;
+        }
     }
     if (this->isVersionLT(kDontNegateImageSize_Version)) {
         (void)this->read32();   // originX
@@ -47,6 +47,7 @@ public:
         kSaveBehind_Version                = 66,
         kSerializeFonts_Version            = 67,
         kPaintDoesntSerializeFonts_Version = 68,
+        kPadStreamSections_Version         = 69,
     };
 
     /**
@@ -168,6 +169,16 @@ public:
     void setDeserialProcs(const SkDeserialProcs& procs);
     const SkDeserialProcs& getDeserialProcs() const { return fProcs; }
 
+    /**
+     *  Says that the buffer's bytes are (or are a copy of) data's bytes starting at offset.
+     *  Encoded images then reference data rather than being copied out of the buffer.
+     *  Does not ref data, so it must outlive the buffer.
+     */
+    void setSourceData(const SkData* data, size_t offset) {
+        fSourceData = data;
+        fSourceOffset = offset;
+    }
+
     /**
      *  If isValid is false, sets the buffer to be "invalid". Returns true if the buffer
      *  is still valid.
@@ -227,6 +238,9 @@ private:
 
     SkDeserialProcs fProcs;
 
+    const SkData* fSourceData = nullptr;
+    size_t        fSourceOffset = 0;
+
     static bool IsPtrAlign4(const void* ptr) {
         return SkIsAlign4((uintptr_t)ptr);
     }
@@ -255,6 +269,7 @@ public:
         kSaveBehind_Version                = 66,
         kSerializeFonts_Version            = 67,
         kPaintDoesntSerializeFonts_Version = 68,
+        kPadStreamSections_Version         = 69,
     };
 
     bool isVersionLT(Version) const { return false; }
@@ -337,6 +352,7 @@ public:
     SkFilterQuality checkFilterQuality() { return SkFilterQuality::kNone_SkFilterQuality; }
 
     void setTypefaceArray(sk_sp<SkTypeface>[], int)        {}
+    void setSourceData(const SkData*, size_t)              {}
     void setFactoryPlayback(SkFlattenable::Factory[], int) {}
     void setDeserialProcs(const SkDeserialProcs&)          {}
 
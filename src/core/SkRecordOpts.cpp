@@ -8,8 +8,10 @@
 #include "SkRecordOpts.h"
 
 #include "SkCanvasPriv.h"
+#include "SkImage.h"
 #include "SkRecordPattern.h"
 #include "SkRecords.h"
+#include "SkShader.h"
 #include "SkTDArray.h"
 
 using namespace SkRecords;
@@ -289,7 +291,198 @@ void SkRecordMergeSvgOpacityAndFilterLayers(SkRecord* record) {
 
 ///////////////////////////////////////////////////////////////////////////////////////////////////
 
-void SkRecordOptimize(SkRecord* record) {
+// Intersects two aliased, intersecting ClipRects separated only by NoOps into the second one.
+// Aliased clips snap each edge to pixels independently, so clipping once to the intersection
+// covers the same pixels as clipping to both.
+struct ClipRectCoalescer {
+    typedef Pattern<Is<ClipRect>,
+                    Greedy<Is<NoOp>>,
+                    Is<ClipRect>>
+        Match;
+
+    bool onMatch(SkRecord* record, Match* match, int begin, int end) {
+        ClipRect* first  = match->first<ClipRect>();
+        ClipRect* second = match->third<ClipRect>();
+        if (!IsAliasedIntersect(first->opAA) || !IsAliasedIntersect(second->opAA)) {
+            return false;
+        }
+
+        if (!second->rect.intersect(first->rect)) {
+            second->rect.setEmpty();
+        }
+        record->replace<NoOp>(begin);  // first ClipRect
+        return true;
+    }
+
+    static bool IsAliasedIntersect(const ClipOpAndAA& opAA) {
+        return opAA.op() == SkClipOp::kIntersect && !opAA.aa();
+    }
+};
+void SkRecordCoalesceClips(SkRecord* record) {
+    ClipRectCoalescer pass;
+    // Each match only looks at a pair, so run until longer runs have collapsed too.
+    while (apply(&pass, record));
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+// Does drawing with this paint leave every pixel it covers opaque, whatever was there before?
+static bool paint_covers_opaquely(const SkPaint& paint) {
+    if (paint.getPathEffect()  ||
+        paint.getMaskFilter()  ||
+        paint.getColorFilter() ||
+        paint.getImageFilter() ||
+        paint.getLooper()      ||
+        paint.getStyle() != SkPaint::kFill_Style) {
+        return false;
+    }
+    if (0xFF != paint.getAlpha() || (paint.getShader() && !paint.getShader()->isOpaque())) {
+        return false;
+    }
+    return paint.isSrcOver() || paint.getBlendMode() == SkBlendMode::kSrc;
+}
+
+// Does drawing with this paint touch only pixels whose centers are inside the geometry drawn?
+static bool paint_stays_inside_geometry(const SkPaint* paint) {
+    return !paint || (!paint->isAntiAlias()   &&
+                      !paint->getPathEffect() &&
+                      !paint->getMaskFilter() &&
+                      !paint->getImageFilter() &&
+                      !paint->getLooper()     &&
+                      paint->getStyle() == SkPaint::kFill_Style);
+}
+
+// Anti-aliased clips partially cover pixels along their edges, where aliased draws show through
+// each other.
+struct AAClipFinder {
+    bool operator()(const ClipPath&  op) { return op.opAA.aa(); }
+    bool operator()(const ClipRRect& op) { return op.opAA.aa(); }
+    bool operator()(const ClipRect&  op) { return op.opAA.aa(); }
+    template <typename T> bool operator()(const T&) { return false; }
+};
+
+// Walks the record a segment at a time, where a segment is a run of draws under the same matrix
+// and clip. When a draw opaquely covers everything an earlier draw in its segment can touch, the
+// earlier draw is turned into a NoOp.
+class OcclusionCuller {
+public:
+    explicit OcclusionCuller(SkRecord* record) : fRecord(record), fIndex(0), fChanged(false) {}
+
+    bool cull() {
+        AAClipFinder aaClip;
+        for (int i = 0; i < fRecord->count(); i++) {
+            if (fRecord->visit(i, aaClip)) {
+                return false;
+            }
+        }
+
+        for (fIndex = 0; fIndex < fRecord->count(); fIndex++) {
+            fRecord->mutate(fIndex, *this);
+        }
+        return fChanged;
+    }
+
+    // Ops that neither draw nor change the matrix or clip don't end the segment.
+    void operator()(NoOp*) {}
+    void operator()(Flush*) {}
+    void operator()(DrawAnnotation*) {}
+
+    // Anything else that doesn't draw may change the matrix or clip.
+    template <typename T>
+    SK_WHEN(!(T::kTags & kDraw_Tag), void) operator()(T*) { fSegment.rewind(); }
+
+    // DrawBehind draws under everything before it, so nothing before it may change.
+    void operator()(DrawBehind*) { fSegment.rewind(); }
+
+    // Nested pictures and drawables are never culled. They may hold a save layer whose backdrop
+    // filter reads what was drawn before them, so they end the segment the way SaveLayer does.
+    void operator()(DrawPicture*)  { fSegment.rewind(); }
+    void operator()(DrawDrawable*) { fSegment.rewind(); }
+
+    void operator()(DrawPaint* op) {
+        if (paint_covers_opaquely(op->paint)) {
+            // DrawPaint fills the whole clip.
+            for (const Candidate& c : fSegment) {
+                this->kill(c.index);
+            }
+            fSegment.rewind();
+        }
+        this->addUnbounded();
+    }
+
+    void operator()(DrawRect* op) {
+        if (!op->paint.isAntiAlias() && paint_covers_opaquely(op->paint) &&
+                op->rect.isSorted() && op->rect.isFinite()) {
+            for (int i = 0; i < fSegment.count();) {
+                if (fSegment[i].bounded && op->rect.contains(fSegment[i].bounds)) {
+                    this->kill(fSegment[i].index);
+                    fSegment.remove(i);
+                } else {
+                    i++;
+                }
+            }
+        }
+        this->add(&op->paint, op->rect);
+    }
+
+    void operator()(DrawOval*  op) { this->add(&op->paint, op->oval); }
+    void operator()(DrawRRect* op) { this->add(&op->paint, op->rrect.getBounds()); }
+    void operator()(DrawPath*  op) {
+        if (op->path.isInverseFillType()) {
+            this->addUnbounded();
+        } else {
+            this->add(&op->paint, op->path.getBounds());
+        }
+    }
+    void operator()(DrawImage* op) {
+        this->add(op->paint, SkRect::MakeXYWH(op->left, op->top,
+                                              op->image->width(), op->image->height()));
+    }
+    void operator()(DrawImageRect* op) { this->add(op->paint, op->dst); }
+
+    // Any other draw can only be hidden by DrawPaint.
+    template <typename T>
+    SK_WHEN(T::kTags & kDraw_Tag, void) operator()(T*) { this->addUnbounded(); }
+
+private:
+    struct Candidate {
+        int    index;
+        SkRect bounds;
+        bool   bounded;  // Touches only pixels inside bounds.
+    };
+
+    // Past this, forget the oldest draws of a segment rather than go quadratic.
+    static constexpr int kMaxCandidates = 256;
+
+    void addUnbounded() { this->push({fIndex, SkRect::MakeEmpty(), false}); }
+    void add(const SkPaint* paint, const SkRect& bounds) {
+        this->push({fIndex, bounds, paint_stays_inside_geometry(paint) && bounds.isFinite()});
+    }
+    void push(const Candidate& candidate) {
+        if (fSegment.count() == kMaxCandidates) {
+            fSegment.remove(0);
+        }
+        fSegment.push_back(candidate);
+    }
+
+    void kill(int index) {
+        fRecord->replace<NoOp>(index);
+        fChanged = true;
+    }
+
+    SkRecord*             fRecord;
+    SkTDArray<Candidate>  fSegment;
+    int                   fIndex;
+    bool                  fChanged;
+};
+
+void SkRecordCullOccludedDraws(SkRecord* record) {
+    OcclusionCuller(record).cull();
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void SkRecordOptimize(SkRecord* record, uint32_t flags) {
     // This might be useful  as a first pass in the future if we want to weed
     // out junk for other optimization passes.  Right now, nothing needs it,
     // and the bounding box hierarchy will do the work of skipping no-op
@@ -307,6 +500,13 @@ void SkRecordOptimize(SkRecord* record) {
 #endif
     SkRecordMergeSvgOpacityAndFilterLayers(record);
 
+    if (flags & kCoalesceClips_RecordOptimizeFlag) {
+        SkRecordCoalesceClips(record);
+    }
+    if (flags & kCullOccludedDraws_RecordOptimizeFlag) {
+        SkRecordCullOccludedDraws(record);
+    }
+
     record->defrag();
 }
 
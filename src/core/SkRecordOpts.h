@@ -10,8 +10,14 @@
 
 #include "SkRecord.h"
 
-// Run all optimizations in recommended order.
-void SkRecordOptimize(SkRecord*);
+// Optional passes SkRecordOptimize() can run on top of its default ones.
+enum SkRecordOptimizeFlags {
+    kCoalesceClips_RecordOptimizeFlag     = 1 << 0,
+    kCullOccludedDraws_RecordOptimizeFlag = 1 << 1,
+};
+
+// Run all optimizations in recommended order, plus the optional passes selected by flags.
+void SkRecordOptimize(SkRecord*, uint32_t flags = 0);
 
 // Turns logical no-op Save-[non-drawing command]*-Restore patterns into actual no-ops.
 void SkRecordNoopSaveRestores(SkRecord*);
@@ -26,6 +32,14 @@ void SkRecordNoopSaveLayerDrawRestores(SkRecord*);
 // the alpha of the first SaveLayer to the second SaveLayer.
 void SkRecordMergeSvgOpacityAndFilterLayers(SkRecord*);
 
+// Intersects runs of aliased, intersecting ClipRects under the same matrix into one ClipRect.
+void SkRecordCoalesceClips(SkRecord*);
+
+// Turns draws that a later opaque draw completely covers, under the same matrix and clip, into
+// no-ops. Non-AA coverage only, so this is exact as long as the record is not played back under
+// an anti-aliased clip; records that set an anti-aliased clip themselves are left alone.
+void SkRecordCullOccludedDraws(SkRecord*);
+
 // Experimental optimizers
 void SkRecordOptimize2(SkRecord*);
 
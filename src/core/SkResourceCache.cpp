@@ -11,7 +11,9 @@
 #include "SkMessageBus.h"
 #include "SkMipMap.h"
 #include "SkMutex.h"
+#include "SkOnce.h"
 #include "SkOpts.h"
+#include "SkSharedMutex.h"
 #include "SkTo.h"
 #include "SkTraceMemoryDump.h"
 
@@ -74,16 +76,28 @@ namespace {
 class SkResourceCache::Hash :
     public SkTHashTable<SkResourceCache::Rec*, SkResourceCache::Key, HashTraits> {};
 
+struct SkResourceCache::Shard {
+    SkSharedMutex fLock;
+    Rec*    fHead = nullptr;
+    Rec*    fTail = nullptr;
+    Hash    fHash;
+    size_t  fBytesUsed = 0;
+    int     fCount = 0;
+};
+
+// Counts the PurgeSharedIDMessages posted, so that checkMessages() can skip polling the inbox
+// (and taking its lock) when nothing new has been posted.
+static std::atomic<uint32_t> gPurgeSharedIDPostCount{0};
 
 ///////////////////////////////////////////////////////////////////////////////
 
 void SkResourceCache::init() {
-    fHead = nullptr;
-    fTail = nullptr;
-    fHash = new Hash;
+    fShards = new Shard[kShardCount];
     fTotalBytesUsed = 0;
     fCount = 0;
     fSingleAllocationByteLimit = 0;
+    // Make the first checkMessages() poll.
+    fCheckedPurgeSharedIDPostCount = gPurgeSharedIDPostCount.load() - 1;
 
     // One of these should be explicit set by the caller after we return.
     fTotalByteLimit = 0;
@@ -101,13 +115,21 @@ SkResourceCache::SkResourceCache(size_t byteLimit) {
 }
 
 SkResourceCache::~SkResourceCache() {
-    Rec* rec = fHead;
-    while (rec) {
-        Rec* next = rec->fNext;
-        delete rec;
-        rec = next;
+    for (int i = 0; i < kShardCount; ++i) {
+        Rec* rec = fShards[i].fHead;
+        while (rec) {
+            Rec* next = rec->fNext;
+            delete rec;
+            rec = next;
+        }
     }
-    delete fHash;
+    delete[] fShards;
+}
+
+// The hash table within each shard indexes by the low bits of the hash, so pick the shard with
+// the high bits.
+SkResourceCache::Shard* SkResourceCache::shardFor(const Key& key) const {
+    return &fShards[key.hash() >> (32 - kShardBits)];
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -115,16 +137,36 @@ SkResourceCache::~SkResourceCache() {
 bool SkResourceCache::find(const Key& key, FindVisitor visitor, void* context) {
     this->checkMessages();
 
-    if (auto found = fHash->find(key)) {
+    Shard* shard = this->shardFor(key);
+
+    {
+        SkAutoSharedMutexShared lock(shard->fLock);
+
+        Rec** found = shard->fHash.find(key);
+        if (!found) {
+            return false;
+        }
         Rec* rec = *found;
         if (visitor(*rec, context)) {
-            this->moveToHead(rec);  // for our LRU
+            rec->fAccessed.store(true, std::memory_order_relaxed);  // for our LRU
             return true;
-        } else {
-            this->remove(rec);  // stale
-            return false;
         }
     }
+
+    // Removing the stale rec needs the lock exclusively.  By then the stale rec may have been
+    // purged and another added under the same key, even at the same address, so visit whatever
+    // rec we find again rather than trusting what we saw under the shared lock.
+    SkAutoExclusive lock(shard->fLock);
+    Rec** found = shard->fHash.find(key);
+    if (!found) {
+        return false;
+    }
+    Rec* rec = *found;
+    if (visitor(*rec, context)) {
+        rec->fAccessed.store(true, std::memory_order_relaxed);  // for our LRU
+        return true;
+    }
+    this->remove(shard, rec);
     return false;
 }
 
@@ -144,44 +186,51 @@ void SkResourceCache::add(Rec* rec, void* payload) {
     this->checkMessages();
 
     SkASSERT(rec);
-    // See if we already have this key (racy inserts, etc.)
-    if (Rec** preexisting = fHash->find(rec->getKey())) {
-        Rec* prev = *preexisting;
-        if (prev->canBePurged()) {
-            // if it can be purged, the install may fail, so we have to remove it
-            this->remove(prev);
-        } else {
-            // if it cannot be purged, we reuse it and delete the new one
-            prev->postAddInstall(payload);
-            delete rec;
-            return;
+    Shard* shard = this->shardFor(rec->getKey());
+    {
+        SkAutoExclusive lock(shard->fLock);
+
+        // See if we already have this key (racy inserts, etc.)
+        if (Rec** preexisting = shard->fHash.find(rec->getKey())) {
+            Rec* prev = *preexisting;
+            if (prev->canBePurged()) {
+                // if it can be purged, the install may fail, so we have to remove it
+                this->remove(shard, prev);
+            } else {
+                // if it cannot be purged, we reuse it and delete the new one
+                prev->postAddInstall(payload);
+                delete rec;
+                return;
+            }
         }
-    }
 
-    this->addToHead(rec);
-    fHash->set(rec);
-    rec->postAddInstall(payload);
+        this->addToHead(shard, rec);
+        shard->fHash.set(rec);
+        rec->postAddInstall(payload);
 
-    if (gDumpCacheTransactions) {
-        SkString bytesStr, totalStr;
-        make_size_str(rec->bytesUsed(), &bytesStr);
-        make_size_str(fTotalBytesUsed, &totalStr);
-        SkDebugf("RC:    add %5s %12p key %08x -- total %5s, count %d\n",
-                 bytesStr.c_str(), rec, rec->getHash(), totalStr.c_str(), fCount);
+        if (gDumpCacheTransactions) {
+            SkString bytesStr, totalStr;
+            make_size_str(rec->bytesUsed(), &bytesStr);
+            make_size_str(fTotalBytesUsed, &totalStr);
+            SkDebugf("RC:    add %5s %12p key %08x -- total %5s, count %d\n",
+                     bytesStr.c_str(), rec, rec->getHash(), totalStr.c_str(), fCount.load());
+        }
     }
 
     // since the new rec may push us over-budget, we perform a purge check now
-    this->purgeAsNeeded();
+    this->purgeAsNeeded(false, SkToInt(shard - fShards));
 }
 
-void SkResourceCache::remove(Rec* rec) {
+void SkResourceCache::remove(Shard* shard, Rec* rec) {
     SkASSERT(rec->canBePurged());
     size_t used = rec->bytesUsed();
-    SkASSERT(used <= fTotalBytesUsed);
+    SkASSERT(used <= shard->fBytesUsed);
 
-    this->release(rec);
-    fHash->remove(rec->getKey());
+    this->release(shard, rec);
+    shard->fHash.remove(rec->getKey());
 
+    shard->fBytesUsed -= used;
+    shard->fCount -= 1;
     fTotalBytesUsed -= used;
     fCount -= 1;
 
@@ -192,13 +241,13 @@ void SkResourceCache::remove(Rec* rec) {
         make_size_str(used, &bytesStr);
         make_size_str(fTotalBytesUsed, &totalStr);
         SkDebugf("RC: remove %5s %12p key %08x -- total %5s, count %d\n",
-                 bytesStr.c_str(), rec, rec->getHash(), totalStr.c_str(), fCount);
+                 bytesStr.c_str(), rec, rec->getHash(), totalStr.c_str(), fCount.load());
     }
 
     delete rec;
 }
 
-void SkResourceCache::purgeAsNeeded(bool forcePurge) {
+void SkResourceCache::purgeAsNeeded(bool forcePurge, int firstShard) {
     size_t byteLimit;
     int    countLimit;
 
@@ -210,15 +259,42 @@ void SkResourceCache::purgeAsNeeded(bool forcePurge) {
         byteLimit = fTotalByteLimit;
     }
 
-    Rec* rec = fTail;
+    // First trim the shards holding more than their share of the budget, then, if the cache is
+    // still over budget, any shard.
+    const size_t shareByteLimits[] = { byteLimit / kShardCount, 0 };
+    const int    shareCountLimits[] = { countLimit / kShardCount, 0 };
+    for (int pass = 0; pass < 2; ++pass) {
+        for (int i = 0; i < kShardCount; ++i) {
+            if (!forcePurge && fTotalBytesUsed < byteLimit && fCount < countLimit) {
+                return;
+            }
+            Shard* shard = &fShards[(firstShard + i) % kShardCount];
+            SkAutoExclusive lock(shard->fLock);
+            this->purgeShard(shard, forcePurge, byteLimit, countLimit,
+                             shareByteLimits[pass], shareCountLimits[pass]);
+        }
+    }
+}
+
+void SkResourceCache::purgeShard(Shard* shard, bool forcePurge, size_t byteLimit, int countLimit,
+                                 size_t shardByteLimit, int shardCountLimit) {
+    // Walk from the tail. Unless we're forced to purge everything, recs that were hit since we
+    // last looked are moved to the head instead of being purged; the walk reaches them again
+    // after the rest of the shard. The head itself can't be revisited, so gets no second chance.
+    Rec* rec = shard->fTail;
     while (rec) {
         if (!forcePurge && fTotalBytesUsed < byteLimit && fCount < countLimit) {
             break;
         }
+        if (shard->fBytesUsed <= shardByteLimit && shard->fCount <= shardCountLimit) {
+            break;
+        }
 
         Rec* prev = rec->fPrev;
-        if (rec->canBePurged()) {
-            this->remove(rec);
+        if (!forcePurge && prev && rec->fAccessed.exchange(false, std::memory_order_relaxed)) {
+            this->moveToHead(shard, rec);
+        } else if (rec->canBePurged()) {
+            this->remove(shard, rec);
         }
         rec = prev;
     }
@@ -240,22 +316,27 @@ void SkResourceCache::purgeSharedID(uint64_t sharedID) {
     gPurgeCallCounter += 1;
     bool found = false;
 #endif
-    // go backwards, just like purgeAsNeeded, just to make the code similar.
-    // could iterate either direction and still be correct.
-    Rec* rec = fTail;
-    while (rec) {
-        Rec* prev = rec->fPrev;
-        if (rec->getKey().getSharedID() == sharedID) {
-            // even though the "src" is now dead, caches could still be in-flight, so
-            // we have to check if it can be removed.
-            if (rec->canBePurged()) {
-                this->remove(rec);
-            }
+    for (int i = 0; i < kShardCount; ++i) {
+        Shard* shard = &fShards[i];
+        SkAutoExclusive lock(shard->fLock);
+
+        // go backwards, just like purgeAsNeeded, just to make the code similar.
+        // could iterate either direction and still be correct.
+        Rec* rec = shard->fTail;
+        while (rec) {
+            Rec* prev = rec->fPrev;
+            if (rec->getKey().getSharedID() == sharedID) {
+                // even though the "src" is now dead, caches could still be in-flight, so
+                // we have to check if it can be removed.
+                if (rec->canBePurged()) {
+                    this->remove(shard, rec);
+                }
 #ifdef SK_TRACK_PURGE_SHAREDID_HITRATE
-            found = true;
+                found = true;
 #endif
+            }
+            rec = prev;
         }
-        rec = prev;
     }
 
 #ifdef SK_TRACK_PURGE_SHAREDID_HITRATE
@@ -269,20 +350,24 @@ void SkResourceCache::purgeSharedID(uint64_t sharedID) {
 }
 
 void SkResourceCache::visitAll(Visitor visitor, void* context) {
-    // go backwards, just like purgeAsNeeded, just to make the code similar.
-    // could iterate either direction and still be correct.
-    Rec* rec = fTail;
-    while (rec) {
-        visitor(*rec, context);
-        rec = rec->fPrev;
+    for (int i = 0; i < kShardCount; ++i) {
+        Shard* shard = &fShards[i];
+        SkAutoSharedMutexShared lock(shard->fLock);
+
+        // go backwards, just like purgeAsNeeded, just to make the code similar.
+        // could iterate either direction and still be correct.
+        Rec* rec = shard->fTail;
+        while (rec) {
+            visitor(*rec, context);
+            rec = rec->fPrev;
+        }
     }
 }
 
 ///////////////////////////////////////////////////////////////////////////////////////////////////
 
 size_t SkResourceCache::setTotalByteLimit(size_t newLimit) {
-    size_t prevLimit = fTotalByteLimit;
-    fTotalByteLimit = newLimit;
+    size_t prevLimit = fTotalByteLimit.exchange(newLimit);
     if (newLimit < prevLimit) {
         this->purgeAsNeeded();
     }
@@ -302,19 +387,19 @@ SkCachedData* SkResourceCache::newCachedData(size_t bytes) {
 
 ///////////////////////////////////////////////////////////////////////////////
 
-void SkResourceCache::release(Rec* rec) {
+void SkResourceCache::release(Shard* shard, Rec* rec) {
     Rec* prev = rec->fPrev;
     Rec* next = rec->fNext;
 
     if (!prev) {
-        SkASSERT(fHead == rec);
-        fHead = next;
+        SkASSERT(shard->fHead == rec);
+        shard->fHead = next;
     } else {
         prev->fNext = next;
     }
 
     if (!next) {
-        fTail = prev;
+        shard->fTail = prev;
     } else {
         next->fPrev = prev;
     }
@@ -322,77 +407,79 @@ void SkResourceCache::release(Rec* rec) {
     rec->fNext = rec->fPrev = nullptr;
 }
 
-void SkResourceCache::moveToHead(Rec* rec) {
-    if (fHead == rec) {
+void SkResourceCache::moveToHead(Shard* shard, Rec* rec) {
+    if (shard->fHead == rec) {
         return;
     }
 
-    SkASSERT(fHead);
-    SkASSERT(fTail);
+    SkASSERT(shard->fHead);
+    SkASSERT(shard->fTail);
 
-    this->validate();
+    this->validate(*shard);
 
-    this->release(rec);
+    this->release(shard, rec);
 
-    fHead->fPrev = rec;
-    rec->fNext = fHead;
-    fHead = rec;
+    shard->fHead->fPrev = rec;
+    rec->fNext = shard->fHead;
+    shard->fHead = rec;
 
-    this->validate();
+    this->validate(*shard);
 }
 
-void SkResourceCache::addToHead(Rec* rec) {
-    this->validate();
+void SkResourceCache::addToHead(Shard* shard, Rec* rec) {
+    this->validate(*shard);
 
     rec->fPrev = nullptr;
-    rec->fNext = fHead;
-    if (fHead) {
-        fHead->fPrev = rec;
+    rec->fNext = shard->fHead;
+    if (shard->fHead) {
+        shard->fHead->fPrev = rec;
     }
-    fHead = rec;
-    if (!fTail) {
-        fTail = rec;
+    shard->fHead = rec;
+    if (!shard->fTail) {
+        shard->fTail = rec;
     }
+    shard->fBytesUsed += rec->bytesUsed();
+    shard->fCount += 1;
     fTotalBytesUsed += rec->bytesUsed();
     fCount += 1;
 
-    this->validate();
+    this->validate(*shard);
 }
 
 ///////////////////////////////////////////////////////////////////////////////
 
 #ifdef SK_DEBUG
-void SkResourceCache::validate() const {
-    if (nullptr == fHead) {
-        SkASSERT(nullptr == fTail);
-        SkASSERT(0 == fTotalBytesUsed);
+void SkResourceCache::validate(const Shard& shard) const {
+    if (nullptr == shard.fHead) {
+        SkASSERT(nullptr == shard.fTail);
+        SkASSERT(0 == shard.fBytesUsed);
         return;
     }
 
-    if (fHead == fTail) {
-        SkASSERT(nullptr == fHead->fPrev);
-        SkASSERT(nullptr == fHead->fNext);
-        SkASSERT(fHead->bytesUsed() == fTotalBytesUsed);
+    if (shard.fHead == shard.fTail) {
+        SkASSERT(nullptr == shard.fHead->fPrev);
+        SkASSERT(nullptr == shard.fHead->fNext);
+        SkASSERT(shard.fHead->bytesUsed() == shard.fBytesUsed);
         return;
     }
 
-    SkASSERT(nullptr == fHead->fPrev);
-    SkASSERT(fHead->fNext);
-    SkASSERT(nullptr == fTail->fNext);
-    SkASSERT(fTail->fPrev);
+    SkASSERT(nullptr == shard.fHead->fPrev);
+    SkASSERT(shard.fHead->fNext);
+    SkASSERT(nullptr == shard.fTail->fNext);
+    SkASSERT(shard.fTail->fPrev);
 
     size_t used = 0;
     int count = 0;
-    const Rec* rec = fHead;
+    const Rec* rec = shard.fHead;
     while (rec) {
         count += 1;
         used += rec->bytesUsed();
-        SkASSERT(used <= fTotalBytesUsed);
+        SkASSERT(used <= shard.fBytesUsed);
         rec = rec->fNext;
     }
-    SkASSERT(fCount == count);
+    SkASSERT(shard.fCount == count);
 
-    rec = fTail;
+    rec = shard.fTail;
     while (rec) {
         SkASSERT(count > 0);
         count -= 1;
@@ -407,16 +494,12 @@ void SkResourceCache::validate() const {
 #endif
 
 void SkResourceCache::dump() const {
-    this->validate();
-
     SkDebugf("SkResourceCache: count=%d bytes=%d %s\n",
-             fCount, fTotalBytesUsed, fDiscardableFactory ? "discardable" : "malloc");
+             fCount.load(), fTotalBytesUsed.load(), fDiscardableFactory ? "discardable" : "malloc");
 }
 
 size_t SkResourceCache::setSingleAllocationByteLimit(size_t newLimit) {
-    size_t oldLimit = fSingleAllocationByteLimit;
-    fSingleAllocationByteLimit = newLimit;
-    return oldLimit;
+    return fSingleAllocationByteLimit.exchange(newLimit);
 }
 
 size_t SkResourceCache::getSingleAllocationByteLimit() const {
@@ -433,13 +516,19 @@ size_t SkResourceCache::getEffectiveSingleAllocationByteLimit() const {
         if (0 == limit) {
             limit = fTotalByteLimit;
         } else {
-            limit = SkTMin(limit, fTotalByteLimit);
+            limit = SkTMin<size_t>(limit, fTotalByteLimit);
         }
     }
     return limit;
 }
 
 void SkResourceCache::checkMessages() {
+    uint32_t postCount = gPurgeSharedIDPostCount.load(std::memory_order_acquire);
+    if (fCheckedPurgeSharedIDPostCount.exchange(postCount, std::memory_order_relaxed) ==
+        postCount) {
+        return;
+    }
+
     SkTArray<PurgeSharedIDMessage> msgs;
     fPurgeSharedIDInbox.poll(&msgs);
     for (int i = 0; i < msgs.count(); ++i) {
@@ -449,91 +538,76 @@ void SkResourceCache::checkMessages() {
 
 ///////////////////////////////////////////////////////////////////////////////
 
-SK_DECLARE_STATIC_MUTEX(gMutex);
-static SkResourceCache* gResourceCache = nullptr;
-
-/** Must hold gMutex when calling. */
+// The cache does its own locking, so the global instance only needs to be created safely.
 static SkResourceCache* get_cache() {
-    // gMutex is always held when this is called, so we don't need to be fancy in here.
-    gMutex.assertHeld();
-    if (nullptr == gResourceCache) {
+    static SkResourceCache* gResourceCache;
+    static SkOnce once;
+    once([] {
 #ifdef SK_USE_DISCARDABLE_SCALEDIMAGECACHE
         gResourceCache = new SkResourceCache(SkDiscardableMemory::Create);
 #else
         gResourceCache = new SkResourceCache(SK_DEFAULT_IMAGE_CACHE_LIMIT);
 #endif
-    }
+    });
     return gResourceCache;
 }
 
 size_t SkResourceCache::GetTotalBytesUsed() {
-    SkAutoMutexAcquire am(gMutex);
     return get_cache()->getTotalBytesUsed();
 }
 
 size_t SkResourceCache::GetTotalByteLimit() {
-    SkAutoMutexAcquire am(gMutex);
     return get_cache()->getTotalByteLimit();
 }
 
 size_t SkResourceCache::SetTotalByteLimit(size_t newLimit) {
-    SkAutoMutexAcquire am(gMutex);
     return get_cache()->setTotalByteLimit(newLimit);
 }
 
 SkResourceCache::DiscardableFactory SkResourceCache::GetDiscardableFactory() {
-    SkAutoMutexAcquire am(gMutex);
     return get_cache()->discardableFactory();
 }
 
 SkCachedData* SkResourceCache::NewCachedData(size_t bytes) {
-    SkAutoMutexAcquire am(gMutex);
     return get_cache()->newCachedData(bytes);
 }
 
 void SkResourceCache::Dump() {
-    SkAutoMutexAcquire am(gMutex);
     get_cache()->dump();
 }
 
 size_t SkResourceCache::SetSingleAllocationByteLimit(size_t size) {
-    SkAutoMutexAcquire am(gMutex);
     return get_cache()->setSingleAllocationByteLimit(size);
 }
 
 size_t SkResourceCache::GetSingleAllocationByteLimit() {
-    SkAutoMutexAcquire am(gMutex);
     return get_cache()->getSingleAllocationByteLimit();
 }
 
 size_t SkResourceCache::GetEffectiveSingleAllocationByteLimit() {
-    SkAutoMutexAcquire am(gMutex);
     return get_cache()->getEffectiveSingleAllocationByteLimit();
 }
 
 void SkResourceCache::PurgeAll() {
-    SkAutoMutexAcquire am(gMutex);
     return get_cache()->purgeAll();
 }
 
 bool SkResourceCache::Find(const Key& key, FindVisitor visitor, void* context) {
-    SkAutoMutexAcquire am(gMutex);
     return get_cache()->find(key, visitor, context);
 }
 
 void SkResourceCache::Add(Rec* rec, void* payload) {
-    SkAutoMutexAcquire am(gMutex);
     get_cache()->add(rec, payload);
 }
 
 void SkResourceCache::VisitAll(Visitor visitor, void* context) {
-    SkAutoMutexAcquire am(gMutex);
     get_cache()->visitAll(visitor, context);
 }
 
 void SkResourceCache::PostPurgeSharedID(uint64_t sharedID) {
     if (sharedID) {
         SkMessageBus<PurgeSharedIDMessage>::Post(PurgeSharedIDMessage(sharedID));
+        gPurgeSharedIDPostCount.fetch_add(1, std::memory_order_release);
     }
 }
 
@@ -12,6 +12,8 @@
 #include "SkMessageBus.h"
 #include "SkTDArray.h"
 
+#include <atomic>
+
 class SkCachedData;
 class SkDiscardableMemory;
 class SkTraceMemoryDump;
@@ -19,12 +21,13 @@ class SkTraceMemoryDump;
 /**
  *  Cache object for bitmaps (with possible scale in X Y as part of the key).
  *
- *  Multiple caches can be instantiated, but each instance is not implicitly
- *  thread-safe, so if a given instance is to be shared across threads, the
- *  caller must manage the access itself (e.g. via a mutex).
+ *  Each instance is thread-safe. Recs are striped over shards by key hash, each shard with its
+ *  own lock and LRU list, so threads working on unrelated keys rarely contend. Hits only take
+ *  their shard's lock shared, so concurrent finds (and their FindVisitors) may run in parallel.
+ *  Eviction is approximately LRU, giving recent hits a second chance before purging them.
  *
- *  As a convenience, a global instance is also defined, which can be safely
- *  access across threads via the static methods (e.g. FindAndLock, etc.).
+ *  As a convenience, a global instance is also defined, which can be accessed via the static
+ *  methods (e.g. Find, Add, etc.).
  */
 class SkResourceCache {
 public:
@@ -106,6 +109,9 @@ public:
         Rec*    fNext;
         Rec*    fPrev;
 
+        // Set by hits, which only hold their shard's lock shared and so cannot touch the LRU list.
+        std::atomic<bool> fAccessed{false};
+
         friend class SkResourceCache;
     };
 
@@ -257,36 +263,46 @@ public:
     void dump() const;
 
 private:
-    Rec*    fHead;
-    Rec*    fTail;
+    static constexpr int kShardBits = 4;
+    static constexpr int kShardCount = 1 << kShardBits;
 
     class Hash;
-    Hash*   fHash;
+    struct Shard;
+    Shard*  fShards;    // kShardCount of them
 
     DiscardableFactory  fDiscardableFactory;
 
-    size_t  fTotalBytesUsed;
-    size_t  fTotalByteLimit;
-    size_t  fSingleAllocationByteLimit;
-    int     fCount;
+    // The budgets apply across all the shards.
+    std::atomic<size_t> fTotalBytesUsed;
+    std::atomic<size_t> fTotalByteLimit;
+    std::atomic<size_t> fSingleAllocationByteLimit;
+    std::atomic<int>    fCount;
 
     SkMessageBus<PurgeSharedIDMessage>::Inbox fPurgeSharedIDInbox;
+    std::atomic<uint32_t> fCheckedPurgeSharedIDPostCount;
+
+    Shard* shardFor(const Key&) const;
 
     void checkMessages();
-    void purgeAsNeeded(bool forcePurge = false);
+    // Purges the shards, starting with firstShard, until the cache is within budget.
+    void purgeAsNeeded(bool forcePurge = false, int firstShard = 0);
+
+    // The following can only be called with the shard's lock held exclusively.
+    void purgeShard(Shard*, bool forcePurge, size_t byteLimit, int countLimit,
+                    size_t shardByteLimit, int shardCountLimit);
 
     // linklist management
-    void moveToHead(Rec*);
-    void addToHead(Rec*);
-    void release(Rec*);
-    void remove(Rec*);
+    void moveToHead(Shard*, Rec*);
+    void addToHead(Shard*, Rec*);
+    void release(Shard*, Rec*);
+    void remove(Shard*, Rec*);
 
     void init();    // called by constructors
 
 #ifdef SK_DEBUG
-    void validate() const;
+    void validate(const Shard&) const;
 #else
-    void validate() const {}
+    void validate(const Shard&) const {}
 #endif
 };
 #endif
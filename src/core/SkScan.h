@@ -77,6 +77,15 @@ public:
     static void AntiFillPath(const SkPath& path, const SkRasterClip& rc, SkBlitter* blitter) {
         AntiFillPath(path, rc, blitter, nullptr);
     }
+
+    // The scan converters AntiFillPath chooses between, once it has clipped the path. Tests call
+    // them directly to compare them without changing which one AntiFillPath picks.
+    static void AAAFillPath(const SkPath& path, SkBlitter* blitter, const SkIRect& pathIR,
+                            const SkIRect& clipBounds, bool forceRLE);
+    static void DAAFillPath(const SkPath& path, SkBlitter* blitter, const SkIRect& pathIR,
+                            const SkIRect& clipBounds, bool forceRLE, SkDAARecord* daaRecord);
+    static void SAAFillPath(const SkPath& path, SkBlitter* blitter, const SkIRect& pathIR,
+                            const SkIRect& clipBounds, bool forceRLE);
 private:
     friend class SkAAClip;
     friend class SkRegion;
@@ -94,12 +103,6 @@ private:
                               const SkRegion*, SkBlitter*);
     static void HairLineRgn(const SkPoint[], int count, const SkRegion*, SkBlitter*);
     static void AntiHairLineRgn(const SkPoint[], int count, const SkRegion*, SkBlitter*);
-    static void AAAFillPath(const SkPath& path, SkBlitter* blitter, const SkIRect& pathIR,
-                            const SkIRect& clipBounds, bool forceRLE);
-    static void DAAFillPath(const SkPath& path, SkBlitter* blitter, const SkIRect& pathIR,
-                            const SkIRect& clipBounds, bool forceRLE, SkDAARecord* daaRecord);
-    static void SAAFillPath(const SkPath& path, SkBlitter* blitter, const SkIRect& pathIR,
-                            const SkIRect& clipBounds, bool forceRLE);
 };
 
 /** Assign an SkXRect from a SkIRect, by promoting the src rect's coordinates
@@ -12,6 +12,7 @@
 #include "SkEdge.h"
 #include "SkEdgeBuilder.h"
 #include "SkGeometry.h"
+#include "SkOpts.h"
 #include "SkPath.h"
 #include "SkQuadClipper.h"
 #include "SkRasterClip.h"
@@ -478,18 +479,124 @@ void RunBasedAdditiveBlitter::blitAntiH(int x, int y, int width, const SkAlpha a
 int RunBasedAdditiveBlitter::getWidth() { return fWidth; }
 
 // This exists specifically for concave path filling.
-// In those cases, we can easily accumulate alpha greater than 0xFF.
-class SafeRLEAdditiveBlitter : public RunBasedAdditiveBlitter {
+// In those cases, we can easily accumulate alpha greater than 0xFF, and the edges of a row may come
+// in any order. Instead of splitting SkAlphaRuns, which walks the runs for every blit, we add alphas
+// into a dense row with saturating SIMD adds, and only turn that row into runs when we flush it.
+class DenseAdditiveBlitter : public AdditiveBlitter {
 public:
-    SafeRLEAdditiveBlitter(SkBlitter* realBlitter, const SkIRect& ir, const SkIRect& clipBounds,
-            bool isInverse) : RunBasedAdditiveBlitter(realBlitter, ir, clipBounds, isInverse) {}
+    DenseAdditiveBlitter(SkBlitter* realBlitter, const SkIRect& ir, const SkIRect& clipBounds,
+            bool isInverse);
+    ~DenseAdditiveBlitter() override;
+
+    SkBlitter* getRealBlitter(bool forceRealBlitter) override { return fRealBlitter; }
 
     void blitAntiH(int x, int y, const SkAlpha antialias[], int len) override;
     void blitAntiH(int x, int y, const SkAlpha alpha) override;
     void blitAntiH(int x, int y, int width, const SkAlpha alpha) override;
+
+    int getWidth() override { return fWidth; }
+
+    void flush_if_y_changed(SkFixed y, SkFixed nextY) override {
+        if (SkFixedFloorToInt(y) != SkFixedFloorToInt(nextY)) {
+            this->flush();
+        }
+    }
+
+private:
+    SkBlitter*  fRealBlitter;
+
+    int         fCurrY;
+    int         fWidth;
+    int         fLeft;
+    int         fTop;
+
+    // Coverage of row fCurrY, relative to fLeft. Only [fDirtyLeft, fDirtyRite) may be non-zero.
+    SkAutoTMalloc<SkAlpha> fCoverage;
+    int         fDirtyLeft;
+    int         fDirtyRite;
+
+    // Circular buffer of runs for the real blitter, as in RunBasedAdditiveBlitter.
+    int         fRunsToBuffer;
+    void*       fRunsBuffer;
+    int         fCurrentRun;
+
+    inline int getRunsSz() const { return (fWidth + 1 + (fWidth + 2)/2) * sizeof(int16_t); }
+
+    inline void markDirty(int x, int width) {
+        fDirtyLeft = SkTMin(fDirtyLeft, x);
+        fDirtyRite = SkTMax(fDirtyRite, x + width);
+    }
+
+    void flush();
+
+    inline void checkY(int y) {
+        if (y != fCurrY) {
+            this->flush();
+            fCurrY = y;
+        }
+    }
 };
 
-void SafeRLEAdditiveBlitter::blitAntiH(int x, int y, const SkAlpha antialias[], int len) {
+DenseAdditiveBlitter::DenseAdditiveBlitter(
+        SkBlitter* realBlitter, const SkIRect& ir, const SkIRect& clipBounds, bool isInverse) {
+    fRealBlitter = realBlitter;
+
+    SkIRect sectBounds;
+    if (isInverse) {
+        sectBounds = clipBounds;
+    } else {
+        if (!sectBounds.intersect(ir, clipBounds)) {
+            sectBounds.setEmpty();
+        }
+    }
+
+    fLeft = sectBounds.left();
+    fWidth = sectBounds.width();
+    fTop = sectBounds.top();
+    fCurrY = fTop - 1;
+
+    fCoverage.reset(fWidth);
+    sk_bzero(fCoverage.get(), fWidth);
+    fDirtyLeft = fWidth;
+    fDirtyRite = 0;
+
+    fRunsToBuffer = realBlitter->requestRowsPreserved();
+    fRunsBuffer = realBlitter->allocBlitMemory(fRunsToBuffer * this->getRunsSz());
+    fCurrentRun = 0;
+}
+
+DenseAdditiveBlitter::~DenseAdditiveBlitter() {
+    this->flush();
+}
+
+void DenseAdditiveBlitter::flush() {
+    if (fCurrY >= fTop && fDirtyLeft < fDirtyRite) {
+        int16_t* runs = reinterpret_cast<int16_t*>(
+                reinterpret_cast<uint8_t*>(fRunsBuffer) + fCurrentRun * this->getRunsSz());
+        SkAlpha* alphas = reinterpret_cast<SkAlpha*>(runs + fWidth + 1);
+
+        if (SkOpts::coverage_to_runs(alphas + fDirtyLeft, runs + fDirtyLeft,
+                                     fCoverage + fDirtyLeft, fDirtyRite - fDirtyLeft)) {
+            if (fDirtyLeft > 0) {
+                runs[0] = SkToS16(fDirtyLeft);
+                alphas[0] = 0;
+            }
+            if (fDirtyRite < fWidth) {
+                runs[fDirtyRite] = SkToS16(fWidth - fDirtyRite);
+                alphas[fDirtyRite] = 0;
+            }
+            runs[fWidth] = 0;
+            fRealBlitter->blitAntiH(fLeft, fCurrY, alphas, runs);
+            fCurrentRun = (fCurrentRun + 1) % fRunsToBuffer;
+        }
+        sk_bzero(fCoverage + fDirtyLeft, fDirtyRite - fDirtyLeft);
+        fDirtyLeft = fWidth;
+        fDirtyRite = 0;
+    }
+    fCurrY = fTop - 1;
+}
+
+void DenseAdditiveBlitter::blitAntiH(int x, int y, const SkAlpha antialias[], int len) {
     checkY(y);
     x -= fLeft;
 
@@ -499,54 +606,31 @@ void SafeRLEAdditiveBlitter::blitAntiH(int x, int y, const SkAlpha antialias[],
         x = 0;
     }
     len = SkTMin(len, fWidth - x);
-    SkASSERT(check(x, len));
-
-    if (x < fOffsetX) {
-        fOffsetX = 0;
+    if (len <= 0) {
+        return;
     }
 
-    fOffsetX = fRuns.add(x, 0, len, 0, 0, fOffsetX); // Break the run
-    for (int i = 0; i < len; i += fRuns.fRuns[x + i]) {
-        for (int j = 1; j < fRuns.fRuns[x + i]; j++) {
-            fRuns.fRuns[x + i + j] = 1;
-            fRuns.fAlpha[x + i + j] = fRuns.fAlpha[x + i];
-        }
-        fRuns.fRuns[x + i] = 1;
-    }
-    for (int i = 0; i < len; ++i) {
-        safelyAddAlpha(&fRuns.fAlpha[x + i], antialias[i]);
-    }
+    SkOpts::accumulate_coverage(fCoverage + x, antialias, len);
+    this->markDirty(x, len);
 }
 
-void SafeRLEAdditiveBlitter::blitAntiH(int x, int y, const SkAlpha alpha) {
+void DenseAdditiveBlitter::blitAntiH(int x, int y, const SkAlpha alpha) {
     checkY(y);
     x -= fLeft;
 
-    if (x < fOffsetX) {
-        fOffsetX = 0;
-    }
-
-    if (check(x, 1)) {
-        // Break the run
-        fOffsetX = fRuns.add(x, 0, 1, 0, 0, fOffsetX);
-        safelyAddAlpha(&fRuns.fAlpha[x], alpha);
+    if (x >= 0 && x < fWidth) {
+        safelyAddAlpha(&fCoverage[x], alpha);
+        this->markDirty(x, 1);
     }
 }
 
-void SafeRLEAdditiveBlitter::blitAntiH(int x, int y, int width, const SkAlpha alpha) {
+void DenseAdditiveBlitter::blitAntiH(int x, int y, int width, const SkAlpha alpha) {
     checkY(y);
     x -= fLeft;
 
-    if (x < fOffsetX) {
-        fOffsetX = 0;
-    }
-
-    if (check(x, width)) {
-        // Break the run
-        fOffsetX = fRuns.add(x, 0, width, 0, 0, fOffsetX);
-        for(int i = x; i < x + width; i += fRuns.fRuns[i]) {
-            safelyAddAlpha(&fRuns.fAlpha[i], alpha);
-        }
+    if (x >= 0 && x + width <= fWidth) {
+        SkOpts::add_coverage(fCoverage + x, alpha, width);
+        this->markDirty(x, width);
     }
 }
 
@@ -1706,17 +1790,17 @@ void SkScan::AAAFillPath(const SkPath& path, SkBlitter* blitter, const SkIRect&
         }
     } else if (!isInverse && path.isConvex()) {
         // If the filling area is convex (i.e., path.isConvex && !isInverse), our simpler
-        // aaa_walk_convex_edges won't generate alphas above 255. Hence we don't need
-        // SafeRLEAdditiveBlitter (which is slow due to clamping). The basic RLE blitter
+        // aaa_walk_convex_edges won't generate alphas above 255, and blits each row from left
+        // to right. Hence we don't need DenseAdditiveBlitter. The basic RLE blitter
         // RunBasedAdditiveBlitter would suffice.
         RunBasedAdditiveBlitter additiveBlitter(blitter, ir, clipBounds, isInverse);
         aaa_fill_path(path, clipBounds, &additiveBlitter, ir.fTop, ir.fBottom,
                 containedInClip, false, forceRLE);
     } else {
         // If the filling area might not be convex, the more involved aaa_walk_edges would
-        // be called and we have to clamp the alpha downto 255. The SafeRLEAdditiveBlitter
-        // does that at a cost of performance.
-        SafeRLEAdditiveBlitter additiveBlitter(blitter, ir, clipBounds, isInverse);
+        // be called and we have to clamp the alpha downto 255. The DenseAdditiveBlitter
+        // does that with saturating adds into a dense row.
+        DenseAdditiveBlitter additiveBlitter(blitter, ir, clipBounds, isInverse);
         aaa_fill_path(path, clipBounds, &additiveBlitter, ir.fTop, ir.fBottom,
                 containedInClip, false, forceRLE);
     }
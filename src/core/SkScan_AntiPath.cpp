@@ -637,11 +637,12 @@ static void compute_complexity(const SkPath& path, SkScalar& avgLength, SkScalar
     }
 }
 
-static bool ShouldUseDAA(const SkPath& path, SkScalar avgLength, SkScalar complexity) {
+static bool ShouldUseDAA(const SkPath& path, SkScalar avgLength, SkScalar complexity,
+                         const SkDAARecord* daaRecord) {
 #if defined(SK_DISABLE_DAA)
     return false;
 #else
-    if (gSkForceDeltaAA) {
+    if (gSkForceDeltaAA || (daaRecord && daaRecord->fForceDAA)) {
         return true;
     }
     if (!gSkUseDeltaAA || SkPathPriv::IsBadForDAA(path)) {
@@ -789,8 +790,12 @@ void SkScan::AntiFillPath(const SkPath& path, const SkRegion& origClip,
            return;
        }
     }
-    if (!daaRecord && rect_overflows_short_shift(clippedIR, SHIFT)) {
-        SkScan::FillPath(path, origClip, blitter);
+    if (rect_overflows_short_shift(clippedIR, SHIFT)) {
+        if (SkDAARecord::IsInitOnce(daaRecord)) {
+            SkDAARecord::SetEmpty(daaRecord);   // The draw phase fills it without anti-aliasing.
+        } else {
+            SkScan::FillPath(path, origClip, blitter);
+        }
         return;
     }
 
@@ -836,8 +841,12 @@ void SkScan::AntiFillPath(const SkPath& path, const SkRegion& origClip,
     SkScalar avgLength, complexity;
     compute_complexity(path, avgLength, complexity);
 
-    if (daaRecord || ShouldUseDAA(path, avgLength, complexity)) {
+    if (ShouldUseDAA(path, avgLength, complexity, daaRecord)) {
         SkScan::DAAFillPath(path, blitter, ir, clipRgn->getBounds(), forceRLE, daaRecord);
+    } else if (SkDAARecord::IsInitOnce(daaRecord)) {
+        // Another scan converter draws this path in the draw phase; there's nothing to prepare.
+        SkDAARecord::SetEmpty(daaRecord);
+        return;
     } else if (ShouldUseAAA(path, avgLength, complexity)) {
         // Do not use AAA if path is too complicated:
         // there won't be any speedup or significant visual improvement.
@@ -377,6 +377,10 @@ void SkScan::DAAFillPath(const SkPath& path, SkBlitter* blitter, const SkIRect&
                     alloc, clippedIR, forceRLE);
             gen_alpha_deltas(path, clippedIR, clipBounds, *deltaList, blitter, skipRect,
                              containedInClip);
+            if (isInitOnce) {
+                // Every tile blits this list concurrently, so finish writing to it now.
+                deltaList->sortForBlit(clipBounds.width());
+            }
             record->fList = deltaList;
         }
     }
@@ -385,7 +389,7 @@ void SkScan::DAAFillPath(const SkPath& path, SkBlitter* blitter, const SkIRect&
         SkASSERT(record->fType != SkDAARecord::Type::kToBeComputed);
         if (record->fType == SkDAARecord::Type::kMask) {
             blitter->blitMask(record->fMask, clippedIR);
-        } else {
+        } else if (record->fType == SkDAARecord::Type::kList) {
             blitter->blitCoverageDeltas(record->fList, clipBounds, isEvenOdd, isInverse, isConvex);
         }
     }
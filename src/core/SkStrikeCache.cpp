@@ -14,6 +14,7 @@
 #include "SkMutex.h"
 #include "SkStrike.h"
 #include "SkTemplates.h"
+#include "SkTo.h"
 #include "SkTraceMemoryDump.h"
 #include "SkTypeface.h"
 
@@ -127,11 +128,13 @@ bool operator == (decltype(nullptr), const SkStrikeCache::ExclusiveStrikePtr& rh
 }
 
 SkStrikeCache::~SkStrikeCache() {
-    Node* node = fHead;
-    while (node) {
-        Node* next = node->fNext;
-        delete node;
-        node = next;
+    for (Shard& shard : fShards) {
+        Node* node = shard.fHead;
+        while (node) {
+            Node* next = node->fNext;
+            delete node;
+            node = next;
+        }
     }
 }
 
@@ -308,13 +311,16 @@ void SkStrikeCache::attachNode(Node* node) {
     if (node == nullptr) {
         return;
     }
-    SkAutoExclusive ac(fLock);
+    Shard* shard = this->shardFor(node->fStrike.getDescriptor());
+    {
+        SkAutoExclusive ac(shard->fLock);
 
-    this->validate();
-    node->fStrike.validate();
+        this->validate(*shard);
+        node->fStrike.validate();
 
-    this->internalAttachToHead(node);
-    this->internalPurge();
+        this->internalAttachToHead(shard, node);
+    }
+    this->purge(0, SkToInt(shard - fShards));
 }
 
 SkExclusiveStrikePtr SkStrikeCache::findStrikeExclusive(const SkDescriptor& desc) {
@@ -322,11 +328,12 @@ SkExclusiveStrikePtr SkStrikeCache::findStrikeExclusive(const SkDescriptor& desc
 }
 
 auto SkStrikeCache::findAndDetachStrike(const SkDescriptor& desc) -> Node* {
-    SkAutoExclusive ac(fLock);
+    Shard* shard = this->shardFor(desc);
+    SkAutoExclusive ac(shard->fLock);
 
-    for (Node* node = internalGetHead(); node != nullptr; node = node->fNext) {
+    for (Node* node = shard->fHead; node != nullptr; node = node->fNext) {
         if (node->fStrike.getDescriptor() == desc) {
-            this->internalDetachCache(node);
+            this->internalDetachCache(shard, node);
             return node;
         }
     }
@@ -363,28 +370,31 @@ static bool loose_compare(const SkDescriptor& lhs, const SkDescriptor& rhs) {
 
 bool SkStrikeCache::desperationSearchForImage(const SkDescriptor& desc, SkGlyph* glyph,
                                               SkStrike* targetCache) {
-    SkAutoExclusive ac(fLock);
-
     SkGlyphID glyphID = glyph->getGlyphID();
     SkFixed targetSubX = glyph->getSubXFixed(),
             targetSubY = glyph->getSubYFixed();
 
-    for (Node* node = internalGetHead(); node != nullptr; node = node->fNext) {
-        if (loose_compare(node->fStrike.getDescriptor(), desc)) {
-            auto targetGlyphID = SkPackedGlyphID(glyphID, targetSubX, targetSubY);
-            if (node->fStrike.isGlyphCached(glyphID, targetSubX, targetSubY)) {
-                SkGlyph* fallback = node->fStrike.getRawGlyphByID(targetGlyphID);
-                // This desperate-match node may disappear as soon as we drop fLock, so we
-                // need to copy the glyph from node into this strike, including a
-                // deep copy of the mask.
-                targetCache->initializeGlyphFromFallback(glyph, *fallback);
-                return true;
-            }
+    // Loosely matching strikes have different descriptors, so they may live in any shard.
+    for (Shard& shard : fShards) {
+        SkAutoExclusive ac(shard.fLock);
+
+        for (Node* node = shard.fHead; node != nullptr; node = node->fNext) {
+            if (loose_compare(node->fStrike.getDescriptor(), desc)) {
+                auto targetGlyphID = SkPackedGlyphID(glyphID, targetSubX, targetSubY);
+                if (node->fStrike.isGlyphCached(glyphID, targetSubX, targetSubY)) {
+                    SkGlyph* fallback = node->fStrike.getRawGlyphByID(targetGlyphID);
+                    // This desperate-match node may disappear as soon as we drop the shard's
+                    // lock, so we need to copy the glyph from node into this strike, including
+                    // a deep copy of the mask.
+                    targetCache->initializeGlyphFromFallback(glyph, *fallback);
+                    return true;
+                }
 
-            // Look for any sub-pixel pos for this glyph, in case there is a pos mismatch.
-            if (const auto* fallback = node->fStrike.getCachedGlyphAnySubPix(glyphID)) {
-                targetCache->initializeGlyphFromFallback(glyph, *fallback);
-                return true;
+                // Look for any sub-pixel pos for this glyph, in case there is a pos mismatch.
+                if (const auto* fallback = node->fStrike.getCachedGlyphAnySubPix(glyphID)) {
+                    targetCache->initializeGlyphFromFallback(glyph, *fallback);
+                    return true;
+                }
             }
         }
     }
@@ -394,23 +404,25 @@ bool SkStrikeCache::desperationSearchForImage(const SkDescriptor& desc, SkGlyph*
 
 bool SkStrikeCache::desperationSearchForPath(
         const SkDescriptor& desc, SkGlyphID glyphID, SkPath* path) {
-    SkAutoExclusive ac(fLock);
-
     // The following is wrong there is subpixel positioning with paths...
     // Paths are only ever at sub-pixel position (0,0), so we can just try that directly rather
     // than try our packed position first then search all others on failure like for masks.
     //
     // This will have to search the sub-pixel positions too.
     // There is also a problem with accounting for cache size with shared path data.
-    for (Node* node = internalGetHead(); node != nullptr; node = node->fNext) {
-        if (loose_compare(node->fStrike.getDescriptor(), desc)) {
-            if (node->fStrike.isGlyphCached(glyphID, 0, 0)) {
-                SkGlyph* from = node->fStrike.getRawGlyphByID(SkPackedGlyphID(glyphID));
-                if (from->fPathData != nullptr) {
-                    // We can just copy the path out by value here, so no need to worry
-                    // about the lifetime of this desperate-match node.
-                    *path = from->fPathData->fPath;
-                    return true;
+    for (Shard& shard : fShards) {
+        SkAutoExclusive ac(shard.fLock);
+
+        for (Node* node = shard.fHead; node != nullptr; node = node->fNext) {
+            if (loose_compare(node->fStrike.getDescriptor(), desc)) {
+                if (node->fStrike.isGlyphCached(glyphID, 0, 0)) {
+                    SkGlyph* from = node->fStrike.getRawGlyphByID(SkPackedGlyphID(glyphID));
+                    if (from->fPathData != nullptr) {
+                        // We can just copy the path out by value here, so no need to worry
+                        // about the lifetime of this desperate-match node.
+                        *path = from->fPathData->fPath;
+                        return true;
+                    }
                 }
             }
         }
@@ -454,23 +466,19 @@ auto SkStrikeCache::createStrike(
 }
 
 void SkStrikeCache::purgeAll() {
-    SkAutoExclusive ac(fLock);
-    this->internalPurge(fTotalMemoryUsed);
+    this->purge(fTotalMemoryUsed.load());
 }
 
 size_t SkStrikeCache::getTotalMemoryUsed() const {
-    SkAutoExclusive ac(fLock);
-    return fTotalMemoryUsed;
+    return fTotalMemoryUsed.load();
 }
 
 int SkStrikeCache::getCacheCountUsed() const {
-    SkAutoExclusive ac(fLock);
-    return fCacheCount;
+    return fCacheCount.load();
 }
 
 int SkStrikeCache::getCacheCountLimit() const {
-    SkAutoExclusive ac(fLock);
-    return fCacheCountLimit;
+    return fCacheCountLimit.load();
 }
 
 size_t SkStrikeCache::setCacheSizeLimit(size_t newLimit) {
@@ -479,17 +487,13 @@ size_t SkStrikeCache::setCacheSizeLimit(size_t newLimit) {
         newLimit = minLimit;
     }
 
-    SkAutoExclusive ac(fLock);
-
-    size_t prevLimit = fCacheSizeLimit;
-    fCacheSizeLimit = newLimit;
-    this->internalPurge();
+    size_t prevLimit = fCacheSizeLimit.exchange(newLimit);
+    this->purge();
     return prevLimit;
 }
 
 size_t  SkStrikeCache::getCacheSizeLimit() const {
-    SkAutoExclusive ac(fLock);
-    return fCacheSizeLimit;
+    return fCacheSizeLimit.load();
 }
 
 int SkStrikeCache::setCacheCountLimit(int newCount) {
@@ -497,17 +501,13 @@ int SkStrikeCache::setCacheCountLimit(int newCount) {
         newCount = 0;
     }
 
-    SkAutoExclusive ac(fLock);
-
-    int prevCount = fCacheCountLimit;
-    fCacheCountLimit = newCount;
-    this->internalPurge();
+    int prevCount = fCacheCountLimit.exchange(newCount);
+    this->purge();
     return prevCount;
 }
 
 int SkStrikeCache::getCachePointSizeLimit() const {
-    SkAutoExclusive ac(fLock);
-    return fPointSizeLimit;
+    return fPointSizeLimit.load();
 }
 
 int SkStrikeCache::setCachePointSizeLimit(int newLimit) {
@@ -515,41 +515,44 @@ int SkStrikeCache::setCachePointSizeLimit(int newLimit) {
         newLimit = 0;
     }
 
-    SkAutoExclusive ac(fLock);
-
-    int prevLimit = fPointSizeLimit;
-    fPointSizeLimit = newLimit;
-    return prevLimit;
+    return fPointSizeLimit.exchange(newLimit);
 }
 
 void SkStrikeCache::forEachStrike(std::function<void(const SkStrike&)> visitor) const {
-    SkAutoExclusive ac(fLock);
+    for (const Shard& shard : fShards) {
+        SkAutoExclusive ac(shard.fLock);
 
-    this->validate();
+        this->validate(shard);
 
-    for (Node* node = this->internalGetHead(); node != nullptr; node = node->fNext) {
-        visitor(node->fStrike);
+        for (Node* node = shard.fHead; node != nullptr; node = node->fNext) {
+            visitor(node->fStrike);
+        }
     }
 }
 
-size_t SkStrikeCache::internalPurge(size_t minBytesNeeded) {
-    this->validate();
+size_t SkStrikeCache::purge(size_t minBytesNeeded, int firstShard) {
+    // The totals are read without any shard lock held, so they may be slightly stale. That only
+    // makes a purge a little early or late, which the next attach will correct.
+    size_t totalMemoryUsed = fTotalMemoryUsed.load(),
+           cacheSizeLimit  = fCacheSizeLimit.load();
+    int    cacheCount      = fCacheCount.load(),
+           cacheCountLimit = fCacheCountLimit.load();
 
     size_t bytesNeeded = 0;
-    if (fTotalMemoryUsed > fCacheSizeLimit) {
-        bytesNeeded = fTotalMemoryUsed - fCacheSizeLimit;
+    if (totalMemoryUsed > cacheSizeLimit) {
+        bytesNeeded = totalMemoryUsed - cacheSizeLimit;
     }
     bytesNeeded = SkTMax(bytesNeeded, minBytesNeeded);
     if (bytesNeeded) {
         // no small purges!
-        bytesNeeded = SkTMax(bytesNeeded, fTotalMemoryUsed >> 2);
+        bytesNeeded = SkTMax(bytesNeeded, totalMemoryUsed >> 2);
     }
 
     int countNeeded = 0;
-    if (fCacheCount > fCacheCountLimit) {
-        countNeeded = fCacheCount - fCacheCountLimit;
+    if (cacheCount > cacheCountLimit) {
+        countNeeded = cacheCount - cacheCountLimit;
         // no small purges!
-        countNeeded = SkMax32(countNeeded, fCacheCount >> 2);
+        countNeeded = SkMax32(countNeeded, cacheCount >> 2);
     }
 
     // early exit
@@ -560,64 +563,83 @@ size_t SkStrikeCache::internalPurge(size_t minBytesNeeded) {
     size_t  bytesFreed = 0;
     int     countFreed = 0;
 
+    // Each shard is purged in LRU order, starting with the shard that asked for the purge.
+    for (int i = 0; i < kShardCount && (bytesFreed < bytesNeeded || countFreed < countNeeded);
+         ++i) {
+        Shard* shard = &fShards[(firstShard + i) % kShardCount];
+        SkAutoExclusive ac(shard->fLock);
+        this->internalPurge(shard, bytesNeeded, countNeeded, &bytesFreed, &countFreed);
+    }
+
+#ifdef SPEW_PURGE_STATUS
+    if (countFreed) {
+        SkDebugf("purging %dK from font cache [%d entries]\n",
+                 (int)(bytesFreed >> 10), countFreed);
+    }
+#endif
+
+    return bytesFreed;
+}
+
+void SkStrikeCache::internalPurge(Shard* shard, size_t bytesNeeded, int countNeeded,
+                                  size_t* bytesFreed, int* countFreed) {
+    this->validate(*shard);
+
     // Start at the tail and proceed backwards deleting; the list is in LRU
     // order, with unimportant entries at the tail.
-    Node* node = this->internalGetTail();
-    while (node != nullptr && (bytesFreed < bytesNeeded || countFreed < countNeeded)) {
+    Node* node = shard->fTail;
+    while (node != nullptr && (*bytesFreed < bytesNeeded || *countFreed < countNeeded)) {
         Node* prev = node->fPrev;
 
         // Only delete if the strike is not pinned.
         if (node->fPinner == nullptr || node->fPinner->canDelete()) {
-            bytesFreed += node->fStrike.getMemoryUsed();
-            countFreed += 1;
-            this->internalDetachCache(node);
+            *bytesFreed += node->fStrike.getMemoryUsed();
+            *countFreed += 1;
+            this->internalDetachCache(shard, node);
             delete node;
         }
         node = prev;
     }
 
-    this->validate();
-
-#ifdef SPEW_PURGE_STATUS
-    if (countFreed) {
-        SkDebugf("purging %dK from font cache [%d entries]\n",
-                 (int)(bytesFreed >> 10), countFreed);
-    }
-#endif
-
-    return bytesFreed;
+    this->validate(*shard);
 }
 
-void SkStrikeCache::internalAttachToHead(Node* node) {
+void SkStrikeCache::internalAttachToHead(Shard* shard, Node* node) {
     SkASSERT(nullptr == node->fPrev && nullptr == node->fNext);
-    if (fHead) {
-        fHead->fPrev = node;
-        node->fNext = fHead;
+    if (shard->fHead) {
+        shard->fHead->fPrev = node;
+        node->fNext = shard->fHead;
     }
-    fHead = node;
+    shard->fHead = node;
 
-    if (fTail == nullptr) {
-        fTail = node;
+    if (shard->fTail == nullptr) {
+        shard->fTail = node;
     }
 
-    fCacheCount += 1;
-    fTotalMemoryUsed += node->fStrike.getMemoryUsed();
+    size_t memoryUsed = node->fStrike.getMemoryUsed();
+    shard->fCacheCount += 1;
+    shard->fMemoryUsed += memoryUsed;
+    fCacheCount.fetch_add(1, std::memory_order_relaxed);
+    fTotalMemoryUsed.fetch_add(memoryUsed, std::memory_order_relaxed);
 }
 
-void SkStrikeCache::internalDetachCache(Node* node) {
-    SkASSERT(fCacheCount > 0);
-    fCacheCount -= 1;
-    fTotalMemoryUsed -= node->fStrike.getMemoryUsed();
+void SkStrikeCache::internalDetachCache(Shard* shard, Node* node) {
+    SkASSERT(shard->fCacheCount > 0);
+    size_t memoryUsed = node->fStrike.getMemoryUsed();
+    shard->fCacheCount -= 1;
+    shard->fMemoryUsed -= memoryUsed;
+    fCacheCount.fetch_sub(1, std::memory_order_relaxed);
+    fTotalMemoryUsed.fetch_sub(memoryUsed, std::memory_order_relaxed);
 
     if (node->fPrev) {
         node->fPrev->fNext = node->fNext;
     } else {
-        fHead = node->fNext;
+        shard->fHead = node->fNext;
     }
     if (node->fNext) {
         node->fNext->fPrev = node->fPrev;
     } else {
-        fTail = node->fPrev;
+        shard->fTail = node->fPrev;
     }
     node->fPrev = node->fNext = nullptr;
 }
@@ -638,20 +660,27 @@ void SkStrikeCache::validateGlyphCacheDataSize() const {
 
 #ifdef SK_DEBUG
 void SkStrikeCache::validate() const {
+    for (const Shard& shard : fShards) {
+        SkAutoExclusive ac(shard.fLock);
+        this->validate(shard);
+    }
+}
+
+void SkStrikeCache::validate(const Shard& shard) const {
     size_t computedBytes = 0;
     int computedCount = 0;
 
-    const Node* node = fHead;
+    const Node* node = shard.fHead;
     while (node != nullptr) {
         computedBytes += node->fStrike.getMemoryUsed();
         computedCount += 1;
         node = node->fNext;
     }
 
-    SkASSERTF(fCacheCount == computedCount, "fCacheCount: %d, computedCount: %d", fCacheCount,
-              computedCount);
-    SkASSERTF(fTotalMemoryUsed == computedBytes, "fTotalMemoryUsed: %d, computedBytes: %d",
-              fTotalMemoryUsed, computedBytes);
+    SkASSERTF(shard.fCacheCount == computedCount, "fCacheCount: %d, computedCount: %d",
+              shard.fCacheCount, computedCount);
+    SkASSERTF(shard.fMemoryUsed == computedBytes, "fMemoryUsed: %d, computedBytes: %d",
+              shard.fMemoryUsed, computedBytes);
 }
 #endif
 
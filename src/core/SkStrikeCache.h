@@ -8,6 +8,7 @@
 #ifndef SkStrikeCache_DEFINED
 #define SkStrikeCache_DEFINED
 
+#include <atomic>
 #include <unordered_map>
 #include <unordered_set>
 
@@ -176,28 +177,49 @@ public:
 #endif
 
 private:
+    // Strikes are spread over shards by descriptor checksum. Each shard has its own lock and LRU
+    // list, so threads looking up different strikes rarely contend; the budgets are shared.
+    static constexpr int kShardCount = 16;
+
+    struct Shard {
+        mutable SkSpinlock fLock;
+        Node*              fHead{nullptr};
+        Node*              fTail{nullptr};
+        size_t             fMemoryUsed{0};
+        int32_t            fCacheCount{0};
+    };
+
+    Shard* shardFor(const SkDescriptor& desc) {
+        return &fShards[desc.getChecksum() % kShardCount];
+    }
 
-    // The following methods can only be called when mutex is already held.
-    Node* internalGetHead() const { return fHead; }
-    Node* internalGetTail() const { return fTail; }
-    void internalDetachCache(Node*);
-    void internalAttachToHead(Node*);
+    // The following methods can only be called when the shard's lock is already held.
+    void internalDetachCache(Shard*, Node*);
+    void internalAttachToHead(Shard*, Node*);
+    // Delete unpinned strikes from the tail of the shard until the amounts freed reach the
+    // amounts needed.
+    void internalPurge(Shard*, size_t bytesNeeded, int countNeeded,
+                       size_t* bytesFreed, int* countFreed);
 
     // Checkout budgets, modulated by the specified min-bytes-needed-to-purge,
-    // and attempt to purge caches to match.
+    // and attempt to purge caches to match, visiting the shards starting with firstShard.
     // Returns number of bytes freed.
-    size_t internalPurge(size_t minBytesNeeded = 0);
+    size_t purge(size_t minBytesNeeded = 0, int firstShard = 0);
 
     void forEachStrike(std::function<void(const SkStrike&)> visitor) const;
 
-    mutable SkSpinlock fLock;
-    Node*              fHead{nullptr};
-    Node*              fTail{nullptr};
-    size_t             fTotalMemoryUsed{0};
-    size_t             fCacheSizeLimit{SK_DEFAULT_FONT_CACHE_LIMIT};
-    int32_t            fCacheCountLimit{SK_DEFAULT_FONT_CACHE_COUNT_LIMIT};
-    int32_t            fCacheCount{0};
-    int32_t            fPointSizeLimit{SK_DEFAULT_FONT_CACHE_POINT_SIZE_LIMIT};
+#ifdef SK_DEBUG
+    void validate(const Shard&) const;
+#else
+    void validate(const Shard&) const {}
+#endif
+
+    Shard                fShards[kShardCount];
+    std::atomic<size_t>  fTotalMemoryUsed{0};
+    std::atomic<size_t>  fCacheSizeLimit{SK_DEFAULT_FONT_CACHE_LIMIT};
+    std::atomic<int32_t> fCacheCountLimit{SK_DEFAULT_FONT_CACHE_COUNT_LIMIT};
+    std::atomic<int32_t> fCacheCount{0};
+    std::atomic<int32_t> fPointSizeLimit{SK_DEFAULT_FONT_CACHE_POINT_SIZE_LIMIT};
 };
 
 using SkExclusiveStrikePtr = SkStrikeCache::ExclusiveStrikePtr;
@@ -0,0 +1,409 @@
+/*
+ * Copyright 2018 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "SkThreadedBMPDevice.h"
+
+#include "SkExecutor.h"
+#include "SkPath.h"
+#include "SkPathPriv.h"
+#include "SkRRect.h"
+#include "SkScan.h"
+#include "SkSpecialImage.h"
+#include "SkTaskGroup.h"
+
+#include <utility>
+#include <vector>
+
+// Each band is at least this tall, so tiny surfaces aren't split into slivers.
+static constexpr int kMinTileHeight = 64;
+// The default band height used when the caller doesn't ask for a tile count.
+static constexpr int kDefaultTileHeight = 256;
+// Larger devices need SkBitmapDevice's own SkDrawTiler to stay within SkFixed range.
+static constexpr int kMaxUntiledDim = 8192 - 1;
+
+SkThreadedBMPDevice::SkThreadedBMPDevice(const SkBitmap& bitmap,
+                                         const SkSurfaceProps& surfaceProps,
+                                         SkExecutor* executor, int tiles, DeltaAA deltaAA)
+        : INHERITED(bitmap, surfaceProps, nullptr, nullptr)
+        , fExecutor(executor)
+        , fDeltaAA(deltaAA) {
+    const int height = bitmap.height();
+    if (tiles <= 0) {
+        tiles = (height + kDefaultTileHeight - 1) / kDefaultTileHeight;
+    }
+    tiles = SkTMax(1, SkTMin(tiles, (height + kMinTileHeight - 1) / kMinTileHeight));
+
+    const int tileHeight = (height + tiles - 1) / tiles;
+    for (int top = 0; top < height; top += tileHeight) {
+        fTileBounds.push_back(SkIRect::MakeLTRB(0, top, bitmap.width(),
+                                                SkTMin(top + tileHeight, height)));
+    }
+    if (fTileBounds.empty()) {
+        fTileBounds.push_back(SkIRect::MakeWH(bitmap.width(), height));
+    }
+    fTileQueues.reset(fTileBounds.count());
+}
+
+SkThreadedBMPDevice::~SkThreadedBMPDevice() {
+    this->flush();
+}
+
+void SkThreadedBMPDevice::flush() {
+    if (fQueue.empty()) {
+        return;
+    }
+
+    SkPixmap dst;
+    if (fBitmap.peekPixels(&dst)) {
+        fBitmap.notifyPixelsChanged();
+        // Coverage deltas don't depend on the pixels, so they're all built before any tile is
+        // drawn, in whatever order the executor runs them.
+        if (fExecutor) {
+            SkTaskGroup tg(*fExecutor);
+            tg.batch(fDAAQueue.count(), [&](int i) { this->computeDAARecord(fDAAQueue[i], dst); });
+            tg.wait();
+            tg.batch(fTileBounds.count(), [&](int i) { this->drawTile(i, dst); });
+            tg.wait();
+        } else {
+            for (int index : fDAAQueue) {
+                this->computeDAARecord(index, dst);
+            }
+            for (int i = 0; i < fTileBounds.count(); ++i) {
+                this->drawTile(i, dst);
+            }
+        }
+    }
+
+    fQueue.reset();
+    for (auto& queue : fTileQueues) {
+        queue.rewind();
+    }
+    fDAAQueue.rewind();
+    fDAARows = 0;
+    fClipSnapshot = nullptr;
+    fAlloc.reset();
+}
+
+void SkThreadedBMPDevice::computeDAARecord(int index, const SkPixmap& dst) const {
+    const DrawElement& element = fQueue[index];
+    SkDraw draw;
+    draw.fDst = dst;
+    draw.fMatrix = &element.fMatrix;
+    draw.fRC = element.fRC;
+    draw.fDAARecord = element.fDAARecord;
+    element.fDrawFn(draw);   // Only fills in the record; blits nothing.
+}
+
+void SkThreadedBMPDevice::drawTile(int tile, const SkPixmap& dst) const {
+    const SkIRect& tileBounds = fTileBounds[tile];
+    for (int index : fTileQueues[tile]) {
+        const DrawElement& element = fQueue[index];
+        SkDraw draw;
+        draw.fDst = dst;
+        draw.fMatrix = &element.fMatrix;
+        draw.fRC = element.fRC;
+        draw.fBlitClip = &tileBounds;
+        draw.fDAARecord = element.fDAARecord;
+        element.fDrawFn(draw);
+    }
+}
+
+bool SkThreadedBMPDevice::canDefer(const SkPaint& paint) const {
+    // Layers of the canvas are plain SkBitmapDevices, and the coverage / giant-device cases need
+    // SkDrawTiler; all of those are rare enough that we just draw them serially.
+    return fSerialDrawDepth == 0 &&
+           !fCoverage &&
+           fBitmap.getPixels() &&
+           this->width() <= kMaxUntiledDim && this->height() <= kMaxUntiledDim &&
+           !paint.getImageFilter();
+}
+
+bool SkThreadedBMPDevice::computeDrawBounds(const SkRect* localBounds, const SkPaint& paint,
+                                            SkIRect* devBounds) const {
+    const SkRasterClip& rc = fRCStack.rc();
+    if (rc.isEmpty()) {
+        return false;
+    }
+
+    *devBounds = rc.getBounds();
+    if (localBounds && paint.canComputeFastBounds()) {
+        SkRect storage;
+        SkRect bounds = this->ctm().mapRect(paint.computeFastBounds(*localBounds, &storage));
+        if (bounds.isFinite()) {
+            // outset to have slop for antialiasing and hairlines
+            SkIRect ibounds = bounds.roundOut();
+            ibounds.outset(1, 1);
+            if (!devBounds->intersect(ibounds)) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+SkDAARecord* SkThreadedBMPDevice::makeDAARecord(const SkPath& path, const SkPaint& paint,
+                                                const SkIRect& devBounds) {
+#if defined(SK_DISABLE_DAA)
+    return nullptr;
+#else
+    // SkDraw would not use a record for these, so don't bother making one. Whether the path is
+    // filled or hairlined, and which scan converter fills it, is only known once SkDraw has
+    // stroked and transformed it; records it can't use are left empty.
+    if (!paint.isAntiAlias() || paint.getMaskFilter()) {
+        return nullptr;
+    }
+    const bool force = fDeltaAA == DeltaAA::kForce;
+    if (!force && !gSkForceDeltaAA && (!gSkUseDeltaAA || SkPathPriv::IsBadForDAA(path))) {
+        return nullptr;
+    }
+
+    fDAARows += devBounds.height();
+    return &fAlloc.make<DAARecordStorage>(force)->fRecord;
+#endif
+}
+
+void SkThreadedBMPDevice::queueDraw(const SkIRect& devBounds,
+                                    std::function<void(const SkDraw&)>&& drawFn,
+                                    SkDAARecord* daaRecord) {
+    if (!fClipSnapshot) {
+        fClipSnapshot = fAlloc.make<SkRasterClip>(fRCStack.rc());
+    }
+
+    const int index = fQueue.count();
+    fQueue.push_back({std::move(drawFn), this->ctm(), fClipSnapshot, daaRecord});
+    if (daaRecord) {
+        fDAAQueue.push_back(index);
+    }
+
+    // Our tiles are full-width bands of equal height (except perhaps the last).
+    const int tileHeight = fTileBounds[0].height();
+    const int first = devBounds.fTop / tileHeight,
+              last  = SkTMin((devBounds.fBottom - 1) / tileHeight, fTileBounds.count() - 1);
+    for (int i = first; i <= last; ++i) {
+        fTileQueues[i].push_back(index);
+    }
+
+    if (fQueue.count() >= kMaxQueuedDraws || fDAARows >= kMaxQueuedDAARows) {
+        this->flush();
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+void SkThreadedBMPDevice::drawPaint(const SkPaint& paint) {
+    SkIRect devBounds;
+    if (!this->canDefer(paint)) {
+        this->flush();
+        INHERITED::drawPaint(paint);
+    } else if (this->computeDrawBounds(nullptr, paint, &devBounds)) {
+        this->queueDraw(devBounds, [paint](const SkDraw& draw) {
+            draw.drawPaint(paint);
+        });
+    }
+}
+
+void SkThreadedBMPDevice::drawPoints(SkCanvas::PointMode mode, size_t count,
+                                     const SkPoint pts[], const SkPaint& paint) {
+    SkIRect devBounds;
+    if (!this->canDefer(paint)) {
+        this->flush();
+        INHERITED::drawPoints(mode, count, pts, paint);
+    } else if (this->computeDrawBounds(nullptr, paint, &devBounds)) {
+        std::vector<SkPoint> points(pts, pts + count);
+        this->queueDraw(devBounds, [mode, points, paint](const SkDraw& draw) {
+            draw.drawPoints(mode, points.size(), points.data(), paint, nullptr);
+        });
+    }
+}
+
+void SkThreadedBMPDevice::drawRect(const SkRect& r, const SkPaint& paint) {
+    SkIRect devBounds;
+    if (!this->canDefer(paint)) {
+        this->flush();
+        INHERITED::drawRect(r, paint);
+    } else if (this->computeDrawBounds(&r, paint, &devBounds)) {
+        this->queueDraw(devBounds, [r, paint](const SkDraw& draw) {
+            draw.drawRect(r, paint);
+        });
+    }
+}
+
+void SkThreadedBMPDevice::drawRRect(const SkRRect& rrect, const SkPaint& paint) {
+#ifdef SK_IGNORE_BLURRED_RRECT_OPT
+    INHERITED::drawRRect(rrect, paint);  // Calls our drawPath().
+#else
+    SkIRect devBounds;
+    if (!this->canDefer(paint)) {
+        this->flush();
+        INHERITED::drawRRect(rrect, paint);
+    } else if (this->computeDrawBounds(&rrect.getBounds(), paint, &devBounds)) {
+        this->queueDraw(devBounds, [rrect, paint](const SkDraw& draw) {
+            draw.drawRRect(rrect, paint);
+        });
+    }
+#endif
+}
+
+void SkThreadedBMPDevice::drawPath(const SkPath& path, const SkPaint& paint, bool pathIsMutable) {
+    SkIRect devBounds;
+    if (!this->canDefer(paint)) {
+        this->flush();
+        INHERITED::drawPath(path, paint, pathIsMutable);
+    } else if (this->computeDrawBounds(path.isInverseFillType() ? nullptr : &path.getBounds(),
+                                       paint, &devBounds)) {
+        // Every tile this path touches will read it concurrently, so make sure its lazily
+        // computed state is already filled in.
+        path.updateBoundsCache();
+        (void)path.getConvexity();
+        this->queueDraw(devBounds, [path, paint](const SkDraw& draw) {
+            draw.drawPath(path, paint);
+        }, this->makeDAARecord(path, paint, devBounds));
+    }
+}
+
+void SkThreadedBMPDevice::drawSprite(const SkBitmap& bitmap, int x, int y, const SkPaint& paint) {
+    SkIRect devBounds;
+    // A mutable bitmap could change before we draw it, so only defer immutable ones.
+    if (!this->canDefer(paint) || !bitmap.isImmutable()) {
+        this->flush();
+        INHERITED::drawSprite(bitmap, x, y, paint);
+    } else if (this->computeDrawBounds(nullptr, paint, &devBounds) &&
+               devBounds.intersect(SkIRect::MakeXYWH(x, y, bitmap.width(), bitmap.height()))) {
+        this->queueDraw(devBounds, [bitmap, x, y, paint](const SkDraw& draw) {
+            draw.drawSprite(bitmap, x, y, paint);
+        });
+    }
+}
+
+void SkThreadedBMPDevice::drawBitmap(const SkBitmap& bitmap, const SkMatrix& matrix,
+                                     const SkRect* dstOrNull, const SkPaint& paint) {
+    SkIRect devBounds;
+    if (!this->canDefer(paint) || !bitmap.isImmutable()) {
+        this->flush();
+        INHERITED::drawBitmap(bitmap, matrix, dstOrNull, paint);
+        return;
+    }
+
+    SkRect bounds;
+    if (dstOrNull) {
+        bounds = *dstOrNull;
+    } else {
+        matrix.mapRect(&bounds, SkRect::MakeIWH(bitmap.width(), bitmap.height()));
+    }
+    if (this->computeDrawBounds(&bounds, paint, &devBounds)) {
+        const bool hasDst = dstOrNull != nullptr;
+        const SkRect dst = hasDst ? *dstOrNull : SkRect::MakeEmpty();
+        this->queueDraw(devBounds, [bitmap, matrix, hasDst, dst, paint](const SkDraw& draw) {
+            draw.drawBitmap(bitmap, matrix, hasDst ? &dst : nullptr, paint);
+        });
+    }
+}
+
+void SkThreadedBMPDevice::drawBitmapRect(const SkBitmap& bitmap, const SkRect* src,
+                                         const SkRect& dst, const SkPaint& paint,
+                                         SkCanvas::SrcRectConstraint constraint) {
+    // SkBitmapDevice may wrap the bitmap in a shader that does not copy its pixels,
+    // then call our drawRect(); if the bitmap is mutable that must not be deferred.
+    if (bitmap.isImmutable()) {
+        INHERITED::drawBitmapRect(bitmap, src, dst, paint, constraint);
+    } else {
+        this->flush();
+        fSerialDrawDepth++;
+        INHERITED::drawBitmapRect(bitmap, src, dst, paint, constraint);
+        fSerialDrawDepth--;
+    }
+}
+
+void SkThreadedBMPDevice::drawGlyphRunList(const SkGlyphRunList& glyphRunList) {
+    this->flush();
+    INHERITED::drawGlyphRunList(glyphRunList);
+}
+
+void SkThreadedBMPDevice::drawVertices(const SkVertices* vertices, const SkVertices::Bone bones[],
+                                       int boneCount, SkBlendMode bmode, const SkPaint& paint) {
+    this->flush();
+    INHERITED::drawVertices(vertices, bones, boneCount, bmode, paint);
+}
+
+void SkThreadedBMPDevice::drawDevice(SkBaseDevice* device, int x, int y, const SkPaint& paint) {
+    this->flush();
+    fSerialDrawDepth++;
+    INHERITED::drawDevice(device, x, y, paint);
+    fSerialDrawDepth--;
+}
+
+void SkThreadedBMPDevice::drawSpecial(SkSpecialImage* src, int x, int y, const SkPaint& paint,
+                                      SkImage* clipImage, const SkMatrix& clipMatrix) {
+    this->flush();
+    fSerialDrawDepth++;
+    INHERITED::drawSpecial(src, x, y, paint, clipImage, clipMatrix);
+    fSerialDrawDepth--;
+}
+
+sk_sp<SkSpecialImage> SkThreadedBMPDevice::snapSpecial() {
+    this->flush();
+    return INHERITED::snapSpecial();
+}
+
+sk_sp<SkSpecialImage> SkThreadedBMPDevice::snapBackImage(const SkIRect& bounds) {
+    this->flush();
+    return INHERITED::snapBackImage(bounds);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+bool SkThreadedBMPDevice::onReadPixels(const SkPixmap& pm, int x, int y) {
+    this->flush();
+    return INHERITED::onReadPixels(pm, x, y);
+}
+
+bool SkThreadedBMPDevice::onWritePixels(const SkPixmap& pm, int x, int y) {
+    this->flush();
+    return INHERITED::onWritePixels(pm, x, y);
+}
+
+bool SkThreadedBMPDevice::onPeekPixels(SkPixmap* pmap) {
+    this->flush();
+    return INHERITED::onPeekPixels(pmap);
+}
+
+void SkThreadedBMPDevice::replaceBitmapBackendForRasterSurface(const SkBitmap& bm) {
+    this->flush();
+    INHERITED::replaceBitmapBackendForRasterSurface(bm);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+void SkThreadedBMPDevice::onRestore() {
+    INHERITED::onRestore();
+    fClipSnapshot = nullptr;
+}
+
+void SkThreadedBMPDevice::onClipRect(const SkRect& rect, SkClipOp op, bool aa) {
+    INHERITED::onClipRect(rect, op, aa);
+    fClipSnapshot = nullptr;
+}
+
+void SkThreadedBMPDevice::onClipRRect(const SkRRect& rrect, SkClipOp op, bool aa) {
+    INHERITED::onClipRRect(rrect, op, aa);
+    fClipSnapshot = nullptr;
+}
+
+void SkThreadedBMPDevice::onClipPath(const SkPath& path, SkClipOp op, bool aa) {
+    INHERITED::onClipPath(path, op, aa);
+    fClipSnapshot = nullptr;
+}
+
+void SkThreadedBMPDevice::onClipRegion(const SkRegion& rgn, SkClipOp op) {
+    INHERITED::onClipRegion(rgn, op);
+    fClipSnapshot = nullptr;
+}
+
+void SkThreadedBMPDevice::onSetDeviceClipRestriction(SkIRect* mutableClipRestriction) {
+    INHERITED::onSetDeviceClipRestriction(mutableClipRestriction);
+    fClipSnapshot = nullptr;
+}
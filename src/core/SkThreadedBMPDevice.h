@@ -0,0 +1,146 @@
+/*
+ * Copyright 2018 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#ifndef SkThreadedBMPDevice_DEFINED
+#define SkThreadedBMPDevice_DEFINED
+
+#include "SkArenaAlloc.h"
+#include "SkBitmapDevice.h"
+#include "SkCoverageDelta.h"
+#include "SkDraw.h"
+#include "SkTArray.h"
+#include "SkTDArray.h"
+
+#include <functional>
+
+class SkExecutor;
+
+/**
+ *  An SkBitmapDevice that splits its pixels into horizontal bands (tiles) and rasterizes them
+ *  concurrently on an SkExecutor.
+ *
+ *  Draws are not executed immediately. Each draw captures its paint, geometry, matrix and clip,
+ *  computes conservative device bounds, and is binned into every tile those bounds touch. When
+ *  the pixels are needed (flush(), any pixel access, or a draw we can't defer) each tile replays
+ *  its bin in order on the executor. Every replay draws with the original clip and matrix and only
+ *  restricts blitting to its tile (SkDraw::fBlitClip), so the result is identical to drawing
+ *  through a plain SkBitmapDevice.
+ *
+ *  Antialiased path fills that use Delta AA are drawn in two phases. First the coverage deltas of
+ *  all queued paths are built concurrently, one SkDAARecord per path, with no regard for tiles.
+ *  Then each tile replays its bin, blitting its own rows of those records. Scan conversion is thus
+ *  done once per path rather than once per tile, and only blitting has to happen in draw order.
+ *
+ *  Text, vertices, layers and image filters are not deferred: they flush and draw serially.
+ */
+class SkThreadedBMPDevice : public SkBitmapDevice {
+public:
+    // Which antialiased path fills use Delta AA.
+    enum class DeltaAA {
+        kDefault,   // Those SkBitmapDevice would use it for, so our pixels match its pixels.
+        kForce,     // All of them, as gSkForceDeltaAA does.
+    };
+
+    // If executor is nullptr, the tiles are replayed one after another on the calling thread.
+    // If tiles <= 0, a tile count is chosen from the bitmap height.
+    SkThreadedBMPDevice(const SkBitmap& bitmap, const SkSurfaceProps& surfaceProps,
+                        SkExecutor* executor, int tiles = 0, DeltaAA deltaAA = DeltaAA::kDefault);
+    ~SkThreadedBMPDevice() override;
+
+    void flush() override;
+
+    int tileCount() const { return fTileBounds.count(); }
+
+protected:
+    void drawPaint(const SkPaint& paint) override;
+    void drawPoints(SkCanvas::PointMode mode, size_t count,
+                    const SkPoint[], const SkPaint& paint) override;
+    void drawRect(const SkRect& r, const SkPaint& paint) override;
+    void drawRRect(const SkRRect& rr, const SkPaint& paint) override;
+    void drawPath(const SkPath&, const SkPaint&, bool pathIsMutable) override;
+    void drawSprite(const SkBitmap&, int x, int y, const SkPaint&) override;
+    void drawBitmapRect(const SkBitmap&, const SkRect*, const SkRect&,
+                        const SkPaint&, SkCanvas::SrcRectConstraint) override;
+    void drawBitmap(const SkBitmap&, const SkMatrix&, const SkRect* dstOrNull,
+                    const SkPaint&) override;
+
+    // These are not deferred.
+    void drawGlyphRunList(const SkGlyphRunList& glyphRunList) override;
+    void drawVertices(const SkVertices*, const SkVertices::Bone bones[], int boneCount, SkBlendMode,
+                      const SkPaint& paint) override;
+    void drawDevice(SkBaseDevice*, int x, int y, const SkPaint&) override;
+    void drawSpecial(SkSpecialImage*, int x, int y, const SkPaint&,
+                     SkImage*, const SkMatrix&) override;
+    sk_sp<SkSpecialImage> snapSpecial() override;
+    sk_sp<SkSpecialImage> snapBackImage(const SkIRect&) override;
+
+    bool onReadPixels(const SkPixmap&, int x, int y) override;
+    bool onWritePixels(const SkPixmap&, int, int) override;
+    bool onPeekPixels(SkPixmap*) override;
+
+    // Clip changes invalidate our snapshot of the current clip.
+    void onRestore() override;
+    void onClipRect(const SkRect& rect, SkClipOp, bool aa) override;
+    void onClipRRect(const SkRRect& rrect, SkClipOp, bool aa) override;
+    void onClipPath(const SkPath& path, SkClipOp, bool aa) override;
+    void onClipRegion(const SkRegion& deviceRgn, SkClipOp) override;
+    void onSetDeviceClipRestriction(SkIRect* mutableClipRestriction) override;
+
+private:
+    struct DrawElement {
+        std::function<void(const SkDraw&)> fDrawFn;
+        SkMatrix                           fMatrix;
+        const SkRasterClip*                fRC;          // owned by fAlloc
+        SkDAARecord*                       fDAARecord;   // owned by fAlloc; may be nullptr
+    };
+
+    // Each record allocates its deltas from its own arena, so records can be built concurrently.
+    struct DAARecordStorage {
+        explicit DAARecordStorage(bool forceDAA) : fRecord(&fAlloc, forceDAA) {}
+
+        SkArenaAlloc fAlloc{4096};
+        SkDAARecord  fRecord;
+    };
+
+    // Draws queued but not yet replayed are bounded so memory doesn't grow without limit.
+    static constexpr int kMaxQueuedDraws = 1 << 14;
+    // So are the rows Delta AA records may cover, since their deltas stay alive until flush().
+    static constexpr int kMaxQueuedDAARows = 1 << 16;
+
+    void replaceBitmapBackendForRasterSurface(const SkBitmap&) override;
+
+    // Returns false if the draw should be done serially right now.
+    bool canDefer(const SkPaint& paint) const;
+
+    // Computes the device bounds of a draw, or returns false if it draws nothing.
+    // A null localBounds means the draw may touch anything inside the clip.
+    bool computeDrawBounds(const SkRect* localBounds, const SkPaint& paint,
+                           SkIRect* devBounds) const;
+
+    // Returns a record to draw a path with through Delta AA, or nullptr to draw it normally.
+    SkDAARecord* makeDAARecord(const SkPath& path, const SkPaint& paint, const SkIRect& devBounds);
+
+    void queueDraw(const SkIRect& devBounds, std::function<void(const SkDraw&)>&& drawFn,
+                   SkDAARecord* daaRecord = nullptr);
+    void computeDAARecord(int index, const SkPixmap& dst) const;
+    void drawTile(int tile, const SkPixmap& dst) const;
+
+    SkExecutor*                 fExecutor;
+    const DeltaAA               fDeltaAA;
+    SkTArray<SkIRect>           fTileBounds;
+    SkTArray<SkTDArray<int>>    fTileQueues;   // indices into fQueue, in draw order
+    SkTArray<DrawElement>       fQueue;
+    SkTDArray<int>              fDAAQueue;     // indices into fQueue of draws with DAA records
+    int                         fDAARows = 0;  // rows covered by the draws in fDAAQueue
+    const SkRasterClip*         fClipSnapshot = nullptr;
+    int                         fSerialDrawDepth = 0;
+    SkArenaAlloc                fAlloc{4096};
+
+    typedef SkBitmapDevice INHERITED;
+};
+
+#endif
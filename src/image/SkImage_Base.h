@@ -76,6 +76,18 @@ public:
     // but only inspect them (or encode them).
     virtual bool getROPixels(SkBitmap*, CachingHint = kAllow_CachingHint) const = 0;
 
+    // Returns the smallest dimensions, at least scale times our own, that getScaledROPixels()
+    // can produce more cheaply than getROPixels() followed by a downscale.  Images that have no
+    // such size return their own dimensions.
+    virtual SkISize scaledDimensions(float scale) const { return this->dimensions(); }
+
+    // Like getROPixels(), but returns a copy decoded at size, which came from scaledDimensions().
+    virtual bool getScaledROPixels(SkBitmap* bitmap, const SkISize& size,
+                                   CachingHint chint = kAllow_CachingHint) const {
+        SkASSERT(size == this->dimensions());
+        return this->getROPixels(bitmap, chint);
+    }
+
     virtual sk_sp<SkImage> onMakeSubset(GrRecordingContext*, const SkIRect&) const = 0;
 
     virtual sk_sp<SkCachedData> getPlanes(SkYUVASizeInfo*, SkYUVAIndex[4],
@@ -214,6 +214,49 @@ bool SkImage_Lazy::getROPixels(SkBitmap* bitmap, SkImage::CachingHint chint) con
     return true;
 }
 
+SkISize SkImage_Lazy::scaledDimensions(float scale) const {
+    ScopedGenerator generator(fSharedGenerator);
+    // Only whole images can be decoded at a reduced size.
+    if (fInfo.dimensions() != generator->getInfo().dimensions()) {
+        return fInfo.dimensions();
+    }
+    return generator->getScaledDimensions(scale);
+}
+
+bool SkImage_Lazy::getScaledROPixels(SkBitmap* bitmap, const SkISize& size,
+                                     SkImage::CachingHint chint) const {
+    if (size == fInfo.dimensions()) {
+        return this->getROPixels(bitmap, chint);
+    }
+    SkASSERT(fOrigin.isZero());
+
+    auto desc = SkBitmapCacheDesc::Make(this, size);
+    if (SkBitmapCache::Find(desc, bitmap)) {
+        return true;
+    }
+
+    const SkImageInfo info = fInfo.makeWH(size.width(), size.height());
+    if (SkImage::kAllow_CachingHint == chint) {
+        SkPixmap pmap;
+        SkBitmapCache::RecPtr cacheRec = SkBitmapCache::Alloc(desc, info, &pmap);
+        if (!cacheRec ||
+            !ScopedGenerator(fSharedGenerator)->getPixels(pmap.info(), pmap.writable_addr(),
+                                                          pmap.rowBytes())) {
+            return false;
+        }
+        SkBitmapCache::Add(std::move(cacheRec), bitmap);
+        this->notifyAddedToRasterCache();
+    } else {
+        if (!bitmap->tryAllocPixels(info) ||
+            !ScopedGenerator(fSharedGenerator)->getPixels(bitmap->info(), bitmap->getPixels(),
+                                                          bitmap->rowBytes())) {
+            return false;
+        }
+        bitmap->setImmutable();
+    }
+    return true;
+}
+
 //////////////////////////////////////////////////////////////////////////////////////////////////
 
 bool SkImage_Lazy::onReadPixels(const SkImageInfo& dstInfo, void* dstPixels, size_t dstRB,
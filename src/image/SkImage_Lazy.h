@@ -55,6 +55,8 @@ public:
     sk_sp<SkData> onRefEncoded() const override;
     sk_sp<SkImage> onMakeSubset(GrRecordingContext*, const SkIRect&) const override;
     bool getROPixels(SkBitmap*, CachingHint) const override;
+    SkISize scaledDimensions(float scale) const override;
+    bool getScaledROPixels(SkBitmap*, const SkISize&, CachingHint) const override;
     bool onIsLazyGenerated() const override { return true; }
     sk_sp<SkImage> onMakeColorTypeAndColorSpace(GrRecordingContext*,
                                                 SkColorType, sk_sp<SkColorSpace>) const override;
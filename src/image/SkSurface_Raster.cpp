@@ -11,13 +11,15 @@
 #include "SkCanvas.h"
 #include "SkDevice.h"
 #include "SkMallocPixelRef.h"
+#include "SkThreadedBMPDevice.h"
 
 class SkSurface_Raster : public SkSurface_Base {
 public:
     SkSurface_Raster(const SkImageInfo&, void*, size_t rb,
                      void (*releaseProc)(void* pixels, void* context), void* context,
                      const SkSurfaceProps*);
-    SkSurface_Raster(const SkImageInfo& info, sk_sp<SkPixelRef>, const SkSurfaceProps*);
+    SkSurface_Raster(const SkImageInfo& info, sk_sp<SkPixelRef>, const SkSurfaceProps*,
+                     SkExecutor* executor = nullptr, int tiles = 0);
 
     SkCanvas* onNewCanvas() override;
     sk_sp<SkSurface> onNewSurface(const SkImageInfo&) override;
@@ -28,9 +30,14 @@ public:
     void onRestoreBackingMutability() override;
 
 private:
+    // Completes any drawing our canvas has deferred before we touch fBitmap directly.
+    void flushCanvas();
+
     SkBitmap    fBitmap;
     size_t      fRowBytes;
     bool        fWeOwnThePixels;
+    SkExecutor* fExecutor = nullptr;    // if set, our canvas is threaded
+    int         fTiles = 0;
 
     typedef SkSurface_Base INHERITED;
 };
@@ -78,8 +85,10 @@ SkSurface_Raster::SkSurface_Raster(const SkImageInfo& info, void* pixels, size_t
 }
 
 SkSurface_Raster::SkSurface_Raster(const SkImageInfo& info, sk_sp<SkPixelRef> pr,
-                                   const SkSurfaceProps* props)
+                                   const SkSurfaceProps* props, SkExecutor* executor, int tiles)
     : INHERITED(pr->width(), pr->height(), props)
+    , fExecutor(executor)
+    , fTiles(tiles)
 {
     fBitmap.setInfo(info, pr->rowBytes());
     fRowBytes = pr->rowBytes(); // we track this, so that subsequent re-allocs will match
@@ -87,7 +96,21 @@ SkSurface_Raster::SkSurface_Raster(const SkImageInfo& info, sk_sp<SkPixelRef> pr
     fWeOwnThePixels = true;
 }
 
-SkCanvas* SkSurface_Raster::onNewCanvas() { return new SkCanvas(fBitmap, this->props()); }
+SkCanvas* SkSurface_Raster::onNewCanvas() {
+    if (fExecutor) {
+        return new SkCanvas(sk_make_sp<SkThreadedBMPDevice>(fBitmap, this->props(),
+                                                            fExecutor, fTiles));
+    }
+    return new SkCanvas(fBitmap, this->props());
+}
+
+void SkSurface_Raster::flushCanvas() {
+    if (fExecutor) {
+        if (SkCanvas* canvas = this->getCachedCanvas()) {
+            canvas->flush();
+        }
+    }
+}
 
 sk_sp<SkSurface> SkSurface_Raster::onNewSurface(const SkImageInfo& info) {
     return SkSurface::MakeRaster(info, &this->props());
@@ -95,10 +118,12 @@ sk_sp<SkSurface> SkSurface_Raster::onNewSurface(const SkImageInfo& info) {
 
 void SkSurface_Raster::onDraw(SkCanvas* canvas, SkScalar x, SkScalar y,
                               const SkPaint* paint) {
+    this->flushCanvas();
     canvas->drawBitmap(fBitmap, x, y, paint);
 }
 
 sk_sp<SkImage> SkSurface_Raster::onNewImageSnapshot(const SkIRect* subset) {
+    this->flushCanvas();
     if (subset) {
         SkASSERT(SkIRect::MakeWH(fBitmap.width(), fBitmap.height()).contains(*subset));
         SkBitmap dst;
@@ -125,6 +150,7 @@ sk_sp<SkImage> SkSurface_Raster::onNewImageSnapshot(const SkIRect* subset) {
 }
 
 void SkSurface_Raster::onWritePixels(const SkPixmap& src, int x, int y) {
+    this->flushCanvas();
     fBitmap.writePixels(src, x, y);
 }
 
@@ -199,6 +225,19 @@ sk_sp<SkSurface> SkSurface::MakeRaster(const SkImageInfo& info, size_t rowBytes,
     return sk_make_sp<SkSurface_Raster>(info, std::move(pr), props);
 }
 
+sk_sp<SkSurface> SkSurface::MakeRasterThreaded(const SkImageInfo& info, SkExecutor* executor,
+                                               int tiles, const SkSurfaceProps* props) {
+    if (!executor || !SkSurfaceValidateRasterInfo(info)) {
+        return nullptr;
+    }
+
+    sk_sp<SkPixelRef> pr = SkMallocPixelRef::MakeZeroed(info, 0);
+    if (!pr) {
+        return nullptr;
+    }
+    return sk_make_sp<SkSurface_Raster>(info, std::move(pr), props, executor, tiles);
+}
+
 sk_sp<SkSurface> SkSurface::MakeRasterN32Premul(int width, int height,
                                                 const SkSurfaceProps* surfaceProps) {
     return MakeRaster(SkImageInfo::MakeN32Premul(width, height), surfaceProps);
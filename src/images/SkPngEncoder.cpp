@@ -16,9 +16,12 @@
 #include "SkString.h"
 #include "SkPngEncoder.h"
 #include "SkPngPriv.h"
+#include "SkTaskGroup.h"
+#include <atomic>
 #include <vector>
 
 #include "png.h"
+#include "zlib.h"
 
 static_assert(PNG_FILTER_NONE  == (int)SkPngEncoder::FilterFlag::kNone,  "Skia libpng filter err.");
 static_assert(PNG_FILTER_SUB   == (int)SkPngEncoder::FilterFlag::kSub,   "Skia libpng filter err.");
@@ -62,6 +65,20 @@ public:
     png_infop infoPtr() { return fInfoPtr; }
     int pngBytesPerPixel() const { return fPngBytesPerPixel; }
     transform_scanline_proc proc() const { return fProc; }
+    SkExecutor* executor() const { return fExecutor; }
+
+    /*
+     * Filters and compresses rows [top, top + count) of src in chunks on fExecutor, leaving
+     * them for writeIDATs().  Returns false if compression fails.
+     */
+    bool compressRowsInParallel(const SkPixmap& src, int top, int count);
+
+    /*
+     * Writes out what compressRowsInParallel() left as IDAT chunks.  Bypasses libpng's row
+     * writing entirely, so after the last rows this also writes the IEND chunk.  Like other
+     * libpng calls, this may longjmp(), so it owns nothing on the stack.
+     */
+    void writeIDATs();
 
     ~SkPngEncoderMgr() {
         png_destroy_write_struct(&fPngPtr, &fInfoPtr);
@@ -78,6 +95,18 @@ private:
     png_infop               fInfoPtr;
     int                     fPngBytesPerPixel;
     transform_scanline_proc fProc;
+    int                     fFilters;
+    int                     fZLibLevel;
+    SkExecutor*             fExecutor = nullptr;
+
+    // Carried from one call to compressRowsInParallel() to the next.
+    std::vector<uint8_t>    fPrevRow;     // Last row written, unfiltered.
+    std::vector<uint8_t>    fWindow;      // Up to the last 32K of filtered data.
+    uLong                   fAdler = 1;   // Of all the filtered data so far; 1 when empty.
+
+    // From compressRowsInParallel() to writeIDATs().
+    std::vector<std::vector<uint8_t>> fIDATs;
+    bool                              fLastIDATs = false;
 };
 
 std::unique_ptr<SkPngEncoderMgr> SkPngEncoderMgr::Make(SkWStream* stream) {
@@ -201,6 +230,10 @@ bool SkPngEncoderMgr::setHeader(const SkImageInfo& srcInfo, const SkPngEncoder::
     SkASSERT(zlibLevel == options.fZLibLevel);
     png_set_compression_level(fPngPtr, zlibLevel);
 
+    fFilters = filters;
+    fZLibLevel = zlibLevel;
+    fExecutor = options.fExecutor;
+
     // Set comments in tEXt chunk
     const sk_sp<SkDataTable>& comments = options.fComments;
     if (comments != nullptr) {
@@ -372,6 +405,253 @@ void SkPngEncoderMgr::chooseProc(const SkImageInfo& srcInfo) {
     fProc = choose_proc(srcInfo);
 }
 
+// Chunks are sized so that each is worth a task, but a large image still has plenty of them.
+static constexpr size_t kChunkBytes = 256 * 1024;
+static constexpr size_t kWindowBytes = 32 * 1024;
+
+static inline uint8_t paeth(int a, int b, int c) {
+    int p = a + b - c;
+    int pa = SkTAbs(p - a),
+        pb = SkTAbs(p - b),
+        pc = SkTAbs(p - c);
+    if (pa <= pb && pa <= pc) {
+        return a;
+    }
+    return pb <= pc ? b : c;
+}
+
+// Applies one of the five png filters to row, writing the filter type byte and then the row.
+static void apply_filter(int type, uint8_t* dst, const uint8_t* row, const uint8_t* prev,
+                         size_t rowBytes, int bpp) {
+    *dst++ = type;
+    const size_t n = SkTMin(rowBytes, (size_t)bpp);
+    switch (type) {
+        case 0:
+            memcpy(dst, row, rowBytes);
+            break;
+        case 1:
+            memcpy(dst, row, n);
+            for (size_t i = n; i < rowBytes; i++) {
+                dst[i] = row[i] - row[i - bpp];
+            }
+            break;
+        case 2:
+            for (size_t i = 0; i < rowBytes; i++) {
+                dst[i] = row[i] - prev[i];
+            }
+            break;
+        case 3:
+            for (size_t i = 0; i < n; i++) {
+                dst[i] = row[i] - (prev[i] >> 1);
+            }
+            for (size_t i = n; i < rowBytes; i++) {
+                dst[i] = row[i] - ((row[i - bpp] + prev[i]) >> 1);
+            }
+            break;
+        default:
+            for (size_t i = 0; i < n; i++) {
+                dst[i] = row[i] - prev[i];  // paeth(0, b, 0) is always b.
+            }
+            for (size_t i = n; i < rowBytes; i++) {
+                dst[i] = row[i] - paeth(row[i - bpp], prev[i], prev[i - bpp]);
+            }
+            break;
+    }
+}
+
+// Like libpng, when more than one filter is allowed, picks the one whose output has the
+// smallest sum of absolute (signed) values, and when none is, uses no filter.  scratch must
+// hold rowBytes + 1 bytes.
+static void filter_row(int filters, uint8_t* dst, const uint8_t* row, const uint8_t* prev,
+                       size_t rowBytes, int bpp, uint8_t* scratch) {
+    static const int kFlags[] = { PNG_FILTER_NONE, PNG_FILTER_SUB, PNG_FILTER_UP,
+                                  PNG_FILTER_AVG,  PNG_FILTER_PAETH };
+    if (0 == filters) {
+        filters = PNG_FILTER_NONE;
+    }
+    uint64_t best = UINT64_MAX;
+    uint8_t* bestRow = nullptr;
+    uint8_t* trial = scratch;
+    for (int type = 0; type < 5; type++) {
+        if (!(filters & kFlags[type])) {
+            continue;
+        }
+        if (filters == kFlags[type]) {
+            apply_filter(type, dst, row, prev, rowBytes, bpp);
+            return;
+        }
+        apply_filter(type, trial, row, prev, rowBytes, bpp);
+        uint64_t sum = 0;
+        for (size_t i = 1; i <= rowBytes; i++) {
+            sum += SkTAbs((int)(int8_t)trial[i]);
+        }
+        if (sum < best) {
+            // Keep this row and filter the next candidate into whichever buffer is free.
+            best = sum;
+            bestRow = trial;
+            trial = (trial == scratch) ? dst : scratch;
+        }
+    }
+    if (bestRow && bestRow != dst) {
+        memcpy(dst, bestRow, rowBytes + 1);
+    }
+}
+
+// Compresses one chunk as raw deflate data that ends on a byte boundary, so that chunks can
+// be concatenated.  Only the last chunk of the image finishes the stream.
+static bool deflate_chunk(const std::vector<uint8_t>& src, const uint8_t* dict, size_t dictLen,
+                          int level, int strategy, bool last, std::vector<uint8_t>* dst) {
+    z_stream zs;
+    memset(&zs, 0, sizeof(zs));
+    if (Z_OK != deflateInit2(&zs, level, Z_DEFLATED, -MAX_WBITS, 8, strategy)) {
+        return false;
+    }
+    if (dictLen > 0 && Z_OK != deflateSetDictionary(&zs, dict, dictLen)) {
+        deflateEnd(&zs);
+        return false;
+    }
+    dst->resize(deflateBound(&zs, src.size()) + 16);
+    zs.next_in = const_cast<Bytef*>(src.data());
+    zs.avail_in = src.size();
+    int flush = last ? Z_FINISH : Z_SYNC_FLUSH;
+    for (;;) {
+        zs.next_out = dst->data() + zs.total_out;
+        zs.avail_out = dst->size() - zs.total_out;
+        int result = deflate(&zs, flush);
+        if (last ? Z_STREAM_END == result : (Z_OK == result && zs.avail_out > 0)) {
+            break;
+        }
+        if (Z_OK != result && Z_BUF_ERROR != result) {
+            deflateEnd(&zs);
+            return false;
+        }
+        dst->resize(dst->size() * 2);
+    }
+    dst->resize(zs.total_out);
+    deflateEnd(&zs);
+    return true;
+}
+
+bool SkPngEncoderMgr::compressRowsInParallel(const SkPixmap& src, int top, int count) {
+    const int width = src.width();
+    const int srcBpp = SkColorTypeBytesPerPixel(src.colorType());
+    // Usually the rows we transform are exactly what goes in the png, but libpng strips the
+    // unused alpha of opaque F16 itself (see writeInfo()).  We drop those bytes here instead.
+    const int pngBpp = png_get_channels(fPngPtr, fInfoPtr) *
+                       png_get_bit_depth(fPngPtr, fInfoPtr) / 8;
+    const size_t rowBytes = (size_t)width * pngBpp;
+    const bool lastRows = top + count == src.height();
+    if (fPrevRow.empty()) {
+        fPrevRow.resize(rowBytes, 0);
+    }
+
+    const int rowsPerChunk = SkTMax(1, (int)(kChunkBytes / rowBytes));
+    const int chunkCount = (count + rowsPerChunk - 1) / rowsPerChunk;
+    std::vector<std::vector<uint8_t>> filtered(chunkCount), compressed(chunkCount);
+    std::vector<uLong> adlers(chunkCount);
+
+    // Transforms row y of src into dst in png's layout.
+    auto transform = [&](int y, uint8_t* dst, uint8_t* tmp) {
+        uint8_t* out = fPngBytesPerPixel == pngBpp ? dst : tmp;
+        fProc((char*)out, (const char*)src.addr(0, y), width, srcBpp);
+        if (out != dst) {
+            for (int x = 0; x < width; x++) {
+                memcpy(dst + x * pngBpp, tmp + x * fPngBytesPerPixel, pngBpp);
+            }
+        }
+    };
+
+    SkTaskGroup tasks(*fExecutor);
+    tasks.batch(chunkCount, [&](int chunk) {
+        const int y0 = top + chunk * rowsPerChunk,
+                  y1 = SkTMin(y0 + rowsPerChunk, top + count);
+        std::vector<uint8_t> rows(2 * rowBytes),
+                             tmp(width * fPngBytesPerPixel),
+                             scratch(rowBytes + 1);
+        uint8_t* prev = rows.data();
+        uint8_t* curr = rows.data() + rowBytes;
+        if (y0 == top) {
+            memcpy(prev, fPrevRow.data(), rowBytes);
+        } else {
+            transform(y0 - 1, prev, tmp.data());
+        }
+
+        std::vector<uint8_t>& out = filtered[chunk];
+        out.resize((y1 - y0) * (rowBytes + 1));
+        for (int y = y0; y < y1; y++) {
+            transform(y, curr, tmp.data());
+            filter_row(fFilters, out.data() + (y - y0) * (rowBytes + 1), curr, prev, rowBytes,
+                       pngBpp, scratch.data());
+            std::swap(prev, curr);
+        }
+        adlers[chunk] = adler32(adler32(0, Z_NULL, 0), out.data(), out.size());
+    });
+    tasks.wait();
+
+    // Each chunk starts compressing with the data before it as its dictionary, which gets
+    // back most of what splitting costs.
+    const int strategy = PNG_FILTER_NONE == fFilters ? Z_DEFAULT_STRATEGY : Z_FILTERED;
+    std::atomic<bool> success{true};
+    tasks.batch(chunkCount, [&](int chunk) {
+        const std::vector<uint8_t>& before = chunk > 0 ? filtered[chunk - 1] : fWindow;
+        const size_t dictLen = SkTMin(before.size(), kWindowBytes);
+        if (!deflate_chunk(filtered[chunk], before.data() + before.size() - dictLen, dictLen,
+                           fZLibLevel, strategy, lastRows && chunk == chunkCount - 1,
+                           &compressed[chunk])) {
+            success = false;
+        }
+    });
+    tasks.wait();
+    if (!success) {
+        return false;
+    }
+
+    if (top == 0) {
+        // The zlib header: deflate with a 32K window, and the level as a hint.
+        const uint8_t cmf = 0x78;
+        const int flevel = fZLibLevel < 2 ? 0 : fZLibLevel < 6 ? 1 : fZLibLevel == 6 ? 2 : 3;
+        uint8_t flg = flevel << 6;
+        flg += 31 - ((cmf << 8) + flg) % 31;
+        compressed[0].insert(compressed[0].begin(), { cmf, flg });
+    }
+    for (int chunk = 0; chunk < chunkCount; chunk++) {
+        fAdler = adler32_combine(fAdler, adlers[chunk], filtered[chunk].size());
+    }
+    if (lastRows) {
+        uint8_t adler[] = { (uint8_t)(fAdler >> 24), (uint8_t)(fAdler >> 16),
+                            (uint8_t)(fAdler >>  8), (uint8_t)(fAdler >>  0) };
+        compressed.back().insert(compressed.back().end(), adler, adler + 4);
+    }
+    fIDATs = std::move(compressed);
+    fLastIDATs = lastRows;
+    if (lastRows) {
+        return true;
+    }
+
+    // Remember what the next call needs to continue the stream.
+    std::vector<uint8_t> tmp(width * fPngBytesPerPixel);
+    transform(top + count - 1, fPrevRow.data(), tmp.data());
+    for (const std::vector<uint8_t>& data : filtered) {
+        fWindow.insert(fWindow.end(), data.begin(), data.end());
+    }
+    if (fWindow.size() > kWindowBytes) {
+        fWindow.erase(fWindow.begin(), fWindow.end() - kWindowBytes);
+    }
+    return true;
+}
+
+void SkPngEncoderMgr::writeIDATs() {
+    for (const std::vector<uint8_t>& data : fIDATs) {
+        if (!data.empty()) {
+            png_write_chunk(fPngPtr, (png_const_bytep)"IDAT", data.data(), data.size());
+        }
+    }
+    if (fLastIDATs) {
+        png_write_chunk(fPngPtr, (png_const_bytep)"IEND", nullptr, 0);
+    }
+    fIDATs.clear();
+}
+
 std::unique_ptr<SkEncoder> SkPngEncoder::Make(SkWStream* dst, const SkPixmap& src,
                                               const Options& options) {
     if (!SkPixmapIsValid(src)) {
@@ -412,6 +692,15 @@ bool SkPngEncoder::onEncodeRows(int numRows) {
         return false;
     }
 
+    if (fEncoderMgr->executor()) {
+        if (!fEncoderMgr->compressRowsInParallel(fSrc, fCurrRow, numRows)) {
+            return false;
+        }
+        fEncoderMgr->writeIDATs();
+        fCurrRow += numRows;
+        return true;
+    }
+
     const void* srcRow = fSrc.addr(0, fCurrRow);
     for (int y = 0; y < numRows; y++) {
         fEncoderMgr->proc()((char*)fStorage.get(),
@@ -38,6 +38,19 @@
     }
 #endif
 
+#if SK_CPU_SSE_LEVEL >= SK_CPU_SSE_LEVEL_AVX512
+    // The same math as SkPMSrcOver_SSE2(), 16 pixels at a time.
+    static inline __m512i SkPMSrcOver_SKX(const __m512i& src, const __m512i& dst) {
+        const __m512i mask  = _mm512_set1_epi32(0xFF00FF),
+                      scale = _mm512_sub_epi32(_mm512_set1_epi32(256), _mm512_srli_epi32(src, 24)),
+                      s     = _mm512_or_si512(_mm512_slli_epi32(scale, 16), scale);
+
+        __m512i rb = _mm512_srli_epi16(_mm512_mullo_epi16(_mm512_and_si512(mask, dst), s), 8),
+                ag = _mm512_andnot_si512(mask, _mm512_mullo_epi16(_mm512_srli_epi16(dst, 8), s));
+        return _mm512_add_epi32(src, _mm512_or_si512(rb, ag));
+    }
+#endif
+
 namespace SK_OPTS_NS {
 
 #if defined(SK_ARM_HAS_NEON)
@@ -84,7 +97,26 @@ void blit_row_s32a_opaque(SkPMColor* dst, const SkPMColor* src, int len, U8CPU a
     SkASSERT(alpha == 0xFF);
     sk_msan_assert_initialized(src, src+len);
 
-#if SK_CPU_SSE_LEVEL >= SK_CPU_SSE_LEVEL_SSE41
+#if SK_CPU_SSE_LEVEL >= SK_CPU_SSE_LEVEL_AVX512
+    const auto alphaMask = _mm512_set1_epi32(0xFF000000);
+    while (len >= 16) {
+        auto s = _mm512_loadu_si512(src);
+
+        if (0 == _mm512_test_epi32_mask(s, alphaMask)) {
+            // All 16 source pixels are transparent.  Nothing to do.
+        } else if (0xFFFF == _mm512_cmpeq_epi32_mask(_mm512_and_si512(s, alphaMask), alphaMask)) {
+            // All 16 source pixels are opaque.  SrcOver becomes Src.
+            _mm512_storeu_si512(dst, s);
+        } else {
+            // Do SrcOver, matching the SSE code below bit for bit.
+            _mm512_storeu_si512(dst, SkPMSrcOver_SKX(s, _mm512_loadu_si512(dst)));
+        }
+        src += 16;
+        dst += 16;
+        len -= 16;
+    }
+
+#elif SK_CPU_SSE_LEVEL >= SK_CPU_SSE_LEVEL_SSE41
     while (len >= 16) {
         // Load 16 source pixels.
         auto s0 = _mm_loadu_si128((const __m128i*)(src) + 0),
@@ -0,0 +1,407 @@
+/*
+ * Copyright 2018 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#ifndef SkBoxBlur_opts_DEFINED
+#define SkBoxBlur_opts_DEFINED
+
+#include "SkNx.h"
+#include "SkTemplates.h"
+
+#include <math.h>
+#include <string.h>
+
+#if SK_CPU_SSE_LEVEL >= SK_CPU_SSE_LEVEL_SSE2
+    #include <immintrin.h>
+#elif defined(SK_ARM_HAS_NEON)
+    #include <arm_neon.h>
+#endif
+
+// These are the passes of SkBoxBlur.  box_blur_columns() blurs down the byte columns of an image,
+// sixteen columns at a time, so 8888 pixels are just four columns each.  To blur across rows,
+// SkBoxBlur transposes first with transpose8() or transpose32(), which work in square blocks.
+
+namespace SK_OPTS_NS {
+
+static constexpr int kBoxBlurBufferBytes = 1024 * 1024,
+                     kBoxBlurMaxStrips   = 256;
+
+// Sixteen 32-bit sums, one for each byte column of a strip.
+#if SK_CPU_SSE_LEVEL >= SK_CPU_SSE_LEVEL_AVX2
+    struct BoxSums {
+        __m256i lo, hi;
+
+        static BoxSums Load(const uint8_t* p) {
+            __m128i bytes = _mm_loadu_si128((const __m128i*)p);
+            return { _mm256_cvtepu8_epi32(bytes), _mm256_cvtepu8_epi32(_mm_srli_si128(bytes, 8)) };
+        }
+        static BoxSums Splat(uint32_t v) {
+            return { _mm256_set1_epi32(v), _mm256_set1_epi32(v) };
+        }
+
+        void operator+=(const BoxSums& o) {
+            lo = _mm256_add_epi32(lo, o.lo);
+            hi = _mm256_add_epi32(hi, o.hi);
+        }
+        void operator-=(const BoxSums& o) {
+            lo = _mm256_sub_epi32(lo, o.lo);
+            hi = _mm256_sub_epi32(hi, o.hi);
+        }
+
+        // Stores the high 32 bits of each sum times m, which SkBoxBlur's weights keep in 0-255.
+        // With roundProduct, the product is rounded to nearest instead of truncated.
+        void storeMulHi(uint32_t m, bool roundProduct, uint8_t* p) const {
+            const __m256i w    = _mm256_set1_epi32(m),
+                          half = _mm256_set1_epi64x(roundProduct ? 1u << 31 : 0);
+            auto mulHi = [&](__m256i v) {
+                __m256i even = _mm256_srli_epi64(_mm256_add_epi64(_mm256_mul_epu32(v, w), half),
+                                                 32),
+                        odd  = _mm256_add_epi64(_mm256_mul_epu32(_mm256_srli_epi64(v, 32), w),
+                                                half);
+                return _mm256_blend_epi32(even, odd, 0xAA);
+            };
+            // packus works within 128-bit lanes, so put the 16-bit halves back in order.
+            __m256i words = _mm256_permute4x64_epi64(_mm256_packus_epi32(mulHi(lo), mulHi(hi)),
+                                                     0xD8);
+            _mm_storeu_si128((__m128i*)p, _mm_packus_epi16(_mm256_castsi256_si128(words),
+                                                           _mm256_extracti128_si256(words, 1)));
+        }
+    };
+#elif SK_CPU_SSE_LEVEL >= SK_CPU_SSE_LEVEL_SSE2
+    struct BoxSums {
+        __m128i v[4];
+
+        static BoxSums Load(const uint8_t* p) {
+            const __m128i bytes = _mm_loadu_si128((const __m128i*)p),
+                          zero  = _mm_setzero_si128(),
+                          lo    = _mm_unpacklo_epi8(bytes, zero),
+                          hi    = _mm_unpackhi_epi8(bytes, zero);
+            return {{ _mm_unpacklo_epi16(lo, zero), _mm_unpackhi_epi16(lo, zero),
+                      _mm_unpacklo_epi16(hi, zero), _mm_unpackhi_epi16(hi, zero) }};
+        }
+        static BoxSums Splat(uint32_t v) {
+            const __m128i s = _mm_set1_epi32(v);
+            return {{ s, s, s, s }};
+        }
+
+        void operator+=(const BoxSums& o) {
+            v[0] = _mm_add_epi32(v[0], o.v[0]);
+            v[1] = _mm_add_epi32(v[1], o.v[1]);
+            v[2] = _mm_add_epi32(v[2], o.v[2]);
+            v[3] = _mm_add_epi32(v[3], o.v[3]);
+        }
+        void operator-=(const BoxSums& o) {
+            v[0] = _mm_sub_epi32(v[0], o.v[0]);
+            v[1] = _mm_sub_epi32(v[1], o.v[1]);
+            v[2] = _mm_sub_epi32(v[2], o.v[2]);
+            v[3] = _mm_sub_epi32(v[3], o.v[3]);
+        }
+
+        // Stores the high 32 bits of each sum times m, which SkBoxBlur's weights keep in 0-255.
+        // With roundProduct, the product is rounded to nearest instead of truncated.
+        void storeMulHi(uint32_t m, bool roundProduct, uint8_t* p) const {
+            const __m128i w    = _mm_set1_epi32(m),
+                          half = _mm_set1_epi64x(roundProduct ? 1u << 31 : 0),
+                          odds = _mm_set_epi32(~0, 0, ~0, 0);
+            auto mulHi = [&](__m128i v) {
+                __m128i even = _mm_srli_epi64(_mm_add_epi64(_mm_mul_epu32(v, w), half), 32),
+                        odd  = _mm_add_epi64(_mm_mul_epu32(_mm_srli_epi64(v, 32), w), half);
+                return _mm_or_si128(even, _mm_and_si128(odd, odds));
+            };
+            _mm_storeu_si128((__m128i*)p,
+                             _mm_packus_epi16(_mm_packs_epi32(mulHi(v[0]), mulHi(v[1])),
+                                              _mm_packs_epi32(mulHi(v[2]), mulHi(v[3]))));
+        }
+    };
+#else
+    struct BoxSums {
+        Sk4u v[4];
+
+        static BoxSums Load(const uint8_t* p) {
+            return {{ SkNx_cast<uint32_t>(Sk4b::Load(p +  0)),
+                      SkNx_cast<uint32_t>(Sk4b::Load(p +  4)),
+                      SkNx_cast<uint32_t>(Sk4b::Load(p +  8)),
+                      SkNx_cast<uint32_t>(Sk4b::Load(p + 12)) }};
+        }
+        static BoxSums Splat(uint32_t v) {
+            return {{ Sk4u(v), Sk4u(v), Sk4u(v), Sk4u(v) }};
+        }
+
+        void operator+=(const BoxSums& o) {
+            for (int i = 0; i < 4; i++) { v[i] += o.v[i]; }
+        }
+        void operator-=(const BoxSums& o) {
+            for (int i = 0; i < 4; i++) { v[i] -= o.v[i]; }
+        }
+
+        // Stores the high 32 bits of each sum times m, which SkBoxBlur's weights keep in 0-255.
+        // With roundProduct, the product is rounded to nearest instead of truncated, which
+        // carries the top bit of its low half.
+        void storeMulHi(uint32_t m, bool roundProduct, uint8_t* p) const {
+            for (int i = 0; i < 4; i++) {
+                Sk4u hi = v[i].mulHi(m);
+                if (roundProduct) {
+                    hi += (v[i] * Sk4u(m)) >> 31;
+                }
+                SkNx_cast<uint8_t>(hi).store(p + 4*i);
+            }
+        }
+    };
+#endif
+
+// Runs three box blurs of the given window down each of the width byte columns of src.  Row 0 of
+// src lands on row srcTop of dst, and all dstH rows of dst are written.  This is the same
+// arithmetic as SkBlurImageFilter and SkMaskBlurFilter always used: all three passes run at
+// once, keeping their trailing edges in circular buffers, and only the final sum is rounded.
+// SkBlurImageFilter added half the divisor to it before scaling, and SkMaskBlurFilter rounded
+// the scaled product instead (roundProduct).  The two differ by 1 now and then.
+static void box_blur_columns(const uint8_t* src, size_t srcRB, int srcH, int srcTop,
+                             uint8_t* dst, size_t dstRB, int dstH, int width, int window,
+                             bool roundProduct) {
+    SkASSERT(2 <= window && window <= 255);
+
+    // An even window takes two passes that window wide and a third one pixel wider.
+    const int pass0  = window - 1,
+              pass2  = (window & 1) ? window - 1 : window,
+              border = (window & 1) ? 3 * ((window - 1) / 2) : 3 * (window / 2) - 1;
+    const uint32_t divisor = (window & 1) ? window * window * window
+                                          : window * window * (window + 1);
+    const uint32_t weight = static_cast<uint32_t>(round(1.0 / divisor * (1ull << 32))),
+                   half   = roundProduct ? 0 : (divisor + 1) / 2;
+
+    // Output row d takes in src row d - srcStart, and nothing past the end of src reaches
+    // output rows from zeroStart on.
+    const int srcStart  = srcTop - border,
+              zeroStart = SkTMin(dstH, srcStart + srcH + 2 * border);
+
+    // Strips run side by side, a row at a time, so that each row is read and written in long
+    // runs rather than a page apart.  As many run at once as keep their circular buffers (which
+    // are read in order) to about a megabyte.
+    const int bufferCount = 2 * pass0 + pass2,
+              maxStrips   = SkTPin(kBoxBlurBufferBytes / (bufferCount * (int)sizeof(BoxSums)),
+                                   1, kBoxBlurMaxStrips);
+
+    // malloc() may not align BoxSums well enough for AVX2.
+    SkAutoTMalloc<uint8_t> storage(maxStrips * (bufferCount + 3) * sizeof(BoxSums)
+                                   + alignof(BoxSums));
+    auto buffer = reinterpret_cast<BoxSums*>(
+            ((uintptr_t)storage.get() + alignof(BoxSums) - 1) & ~(alignof(BoxSums) - 1));
+    for (int x = 0; x < width; x += 16 * maxStrips) {
+        const int strips = SkTMin(maxStrips, (width - x + 15) / 16),
+                  n      = SkTMin(16 * strips, width - x);
+        const uint8_t* s = src + x;
+              uint8_t* d = dst + x;
+
+        // Each buffer holds a row of strips at each cursor position.
+        BoxSums* buffer0 = buffer;
+        BoxSums* buffer1 = buffer0 + pass0 * strips;
+        BoxSums* buffer2 = buffer1 + pass0 * strips;
+        BoxSums* sums    = buffer2 + pass2 * strips;
+        memset((void*)buffer0, 0, bufferCount * strips * sizeof(BoxSums));
+        for (int i = 0; i < strips; i++) {
+            sums[3*i + 0] = BoxSums::Splat(0);
+            sums[3*i + 1] = BoxSums::Splat(0);
+            sums[3*i + 2] = BoxSums::Splat(half);
+        }
+
+        // Rows above where src starts to reach are clear.
+        for (int y = 0; y < SkTMin(srcStart, zeroStart); y++) {
+            memset(d + y * dstRB, 0, n);
+        }
+
+        // Take in src rows, and those past its end, until no more reach dst.  Rows of src that
+        // reach above dst just prime the sums.
+        int cursor01 = 0,
+            cursor2  = 0;
+        for (int srcY = 0; srcY + srcStart < zeroStart; srcY++) {
+            const uint8_t* srcRow = srcY < srcH ? s + srcY * srcRB : nullptr;
+                  uint8_t* dstRow = srcY + srcStart >= 0 ? d + (srcY + srcStart) * dstRB
+                                                         : nullptr;
+            BoxSums* b0 = buffer0 + cursor01 * strips;
+            BoxSums* b1 = buffer1 + cursor01 * strips;
+            BoxSums* b2 = buffer2 + cursor2  * strips;
+            for (int i = 0; i < strips; i++) {
+                // A partial strip at the end goes through a 16 byte copy.
+                const int bytes = SkTMin(16, n - 16 * i);
+                uint8_t tail[16];
+
+                BoxSums leadingEdge = BoxSums::Splat(0);
+                if (srcRow && bytes == 16) {
+                    leadingEdge = BoxSums::Load(srcRow + 16 * i);
+                } else if (srcRow) {
+                    memset(tail, 0, sizeof(tail));
+                    memcpy(tail, srcRow + 16 * i, bytes);
+                    leadingEdge = BoxSums::Load(tail);
+                }
+
+                BoxSums* sum = sums + 3 * i;
+                sum[0] += leadingEdge;
+                sum[1] += sum[0];
+                sum[2] += sum[1];
+                if (dstRow && bytes == 16) {
+                    sum[2].storeMulHi(weight, roundProduct, dstRow + 16 * i);
+                } else if (dstRow) {
+                    sum[2].storeMulHi(weight, roundProduct, tail);
+                    memcpy(dstRow + 16 * i, tail, bytes);
+                }
+
+                sum[2] -= b2[i];
+                b2[i] = sum[1];
+                sum[1] -= b1[i];
+                b1[i] = sum[0];
+                sum[0] -= b0[i];
+                b0[i] = leadingEdge;
+            }
+            cursor2  = cursor2  + 1 < pass2 ? cursor2  + 1 : 0;
+            cursor01 = cursor01 + 1 < pass0 ? cursor01 + 1 : 0;
+        }
+
+        for (int y = SkTMax(0, zeroStart); y < dstH; y++) {
+            memset(d + y * dstRB, 0, n);
+        }
+    }
+}
+
+// dst[x][y] = src[y][x], for the w x h pixels of src.
+static void transpose8(uint8_t* dst, size_t dstRB, const uint8_t* src, size_t srcRB,
+                       int w, int h) {
+    int y = 0;
+    for (; y + 8 <= h; y += 8) {
+        const uint8_t* s = src + y * srcRB;
+        int x = 0;
+        for (; x + 8 <= w; x += 8) {
+            uint8_t* d = dst + x * dstRB + y;
+        #if SK_CPU_SSE_LEVEL >= SK_CPU_SSE_LEVEL_SSE2
+            auto row = [&](int i) { return _mm_loadl_epi64((const __m128i*)(s + i*srcRB + x)); };
+            // Interleave pairs of rows, then pairs of those, and so on.
+            __m128i r01 = _mm_unpacklo_epi8(row(0), row(1)),
+                    r23 = _mm_unpacklo_epi8(row(2), row(3)),
+                    r45 = _mm_unpacklo_epi8(row(4), row(5)),
+                    r67 = _mm_unpacklo_epi8(row(6), row(7));
+            __m128i lo03 = _mm_unpacklo_epi16(r01, r23),    // columns 0-3 of rows 0-3
+                    hi03 = _mm_unpackhi_epi16(r01, r23),    // columns 4-7 of rows 0-3
+                    lo47 = _mm_unpacklo_epi16(r45, r67),
+                    hi47 = _mm_unpackhi_epi16(r45, r67);
+            __m128i c01 = _mm_unpacklo_epi32(lo03, lo47),
+                    c23 = _mm_unpackhi_epi32(lo03, lo47),
+                    c45 = _mm_unpacklo_epi32(hi03, hi47),
+                    c67 = _mm_unpackhi_epi32(hi03, hi47);
+            auto store2 = [&](int i, __m128i c) {
+                _mm_storel_epi64((__m128i*)(d + (i+0)*dstRB), c);
+                _mm_storel_epi64((__m128i*)(d + (i+1)*dstRB), _mm_srli_si128(c, 8));
+            };
+            store2(0, c01);
+            store2(2, c23);
+            store2(4, c45);
+            store2(6, c67);
+        #elif defined(SK_ARM_HAS_NEON)
+            auto row = [&](int i) { return vld1_u8(s + i*srcRB + x); };
+            // Transpose 2x2 blocks of bytes, then of 16-bit pairs, then of 32-bit quads.
+            uint8x8x2_t r01 = vtrn_u8(row(0), row(1)),
+                        r23 = vtrn_u8(row(2), row(3)),
+                        r45 = vtrn_u8(row(4), row(5)),
+                        r67 = vtrn_u8(row(6), row(7));
+            uint16x4x2_t e03 = vtrn_u16(vreinterpret_u16_u8(r01.val[0]),
+                                        vreinterpret_u16_u8(r23.val[0])),
+                         o03 = vtrn_u16(vreinterpret_u16_u8(r01.val[1]),
+                                        vreinterpret_u16_u8(r23.val[1])),
+                         e47 = vtrn_u16(vreinterpret_u16_u8(r45.val[0]),
+                                        vreinterpret_u16_u8(r67.val[0])),
+                         o47 = vtrn_u16(vreinterpret_u16_u8(r45.val[1]),
+                                        vreinterpret_u16_u8(r67.val[1]));
+            uint32x2x2_t c04 = vtrn_u32(vreinterpret_u32_u16(e03.val[0]),
+                                        vreinterpret_u32_u16(e47.val[0])),
+                         c26 = vtrn_u32(vreinterpret_u32_u16(e03.val[1]),
+                                        vreinterpret_u32_u16(e47.val[1])),
+                         c15 = vtrn_u32(vreinterpret_u32_u16(o03.val[0]),
+                                        vreinterpret_u32_u16(o47.val[0])),
+                         c37 = vtrn_u32(vreinterpret_u32_u16(o03.val[1]),
+                                        vreinterpret_u32_u16(o47.val[1]));
+            vst1_u8(d + 0*dstRB, vreinterpret_u8_u32(c04.val[0]));
+            vst1_u8(d + 1*dstRB, vreinterpret_u8_u32(c15.val[0]));
+            vst1_u8(d + 2*dstRB, vreinterpret_u8_u32(c26.val[0]));
+            vst1_u8(d + 3*dstRB, vreinterpret_u8_u32(c37.val[0]));
+            vst1_u8(d + 4*dstRB, vreinterpret_u8_u32(c04.val[1]));
+            vst1_u8(d + 5*dstRB, vreinterpret_u8_u32(c15.val[1]));
+            vst1_u8(d + 6*dstRB, vreinterpret_u8_u32(c26.val[1]));
+            vst1_u8(d + 7*dstRB, vreinterpret_u8_u32(c37.val[1]));
+        #else
+            for (int i = 0; i < 8; i++) {
+                for (int j = 0; j < 8; j++) {
+                    d[i*dstRB + j] = s[j*srcRB + x + i];
+                }
+            }
+        #endif
+        }
+        for (; x < w; x++) {
+            for (int j = 0; j < 8; j++) {
+                dst[x*dstRB + y + j] = s[j*srcRB + x];
+            }
+        }
+    }
+    for (; y < h; y++) {
+        for (int x = 0; x < w; x++) {
+            dst[x*dstRB + y] = src[y*srcRB + x];
+        }
+    }
+}
+
+static void transpose32(uint32_t* dst, size_t dstRB, const uint32_t* src, size_t srcRB,
+                        int w, int h) {
+    auto srcRow = [&](int y) { return (const uint32_t*)((const char*)src + y * srcRB); };
+    auto dstRow = [&](int x) { return       (uint32_t*)(      (char*)dst + x * dstRB); };
+
+    int y = 0;
+    for (; y + 4 <= h; y += 4) {
+        int x = 0;
+        for (; x + 4 <= w; x += 4) {
+        #if SK_CPU_SSE_LEVEL >= SK_CPU_SSE_LEVEL_SSE2
+            auto row = [&](int i) { return _mm_loadu_si128((const __m128i*)(srcRow(y+i) + x)); };
+            __m128i r0 = row(0), r1 = row(1), r2 = row(2), r3 = row(3);
+            __m128i lo01 = _mm_unpacklo_epi32(r0, r1),    // columns 0 and 1 of rows 0 and 1
+                    lo23 = _mm_unpacklo_epi32(r2, r3),
+                    hi01 = _mm_unpackhi_epi32(r0, r1),    // columns 2 and 3 of rows 0 and 1
+                    hi23 = _mm_unpackhi_epi32(r2, r3);
+            _mm_storeu_si128((__m128i*)(dstRow(x+0) + y), _mm_unpacklo_epi64(lo01, lo23));
+            _mm_storeu_si128((__m128i*)(dstRow(x+1) + y), _mm_unpackhi_epi64(lo01, lo23));
+            _mm_storeu_si128((__m128i*)(dstRow(x+2) + y), _mm_unpacklo_epi64(hi01, hi23));
+            _mm_storeu_si128((__m128i*)(dstRow(x+3) + y), _mm_unpackhi_epi64(hi01, hi23));
+        #elif defined(SK_ARM_HAS_NEON)
+            auto row = [&](int i) { return vld1q_u32(srcRow(y+i) + x); };
+            uint32x4x2_t r01 = vtrnq_u32(row(0), row(1)),  // columns 0 and 2, then 1 and 3
+                         r23 = vtrnq_u32(row(2), row(3));
+            vst1q_u32(dstRow(x+0) + y, vcombine_u32(vget_low_u32 (r01.val[0]),
+                                                    vget_low_u32 (r23.val[0])));
+            vst1q_u32(dstRow(x+1) + y, vcombine_u32(vget_low_u32 (r01.val[1]),
+                                                    vget_low_u32 (r23.val[1])));
+            vst1q_u32(dstRow(x+2) + y, vcombine_u32(vget_high_u32(r01.val[0]),
+                                                    vget_high_u32(r23.val[0])));
+            vst1q_u32(dstRow(x+3) + y, vcombine_u32(vget_high_u32(r01.val[1]),
+                                                    vget_high_u32(r23.val[1])));
+        #else
+            for (int i = 0; i < 4; i++) {
+                for (int j = 0; j < 4; j++) {
+                    dstRow(x+i)[y+j] = srcRow(y+j)[x+i];
+                }
+            }
+        #endif
+        }
+        for (; x < w; x++) {
+            for (int j = 0; j < 4; j++) {
+                dstRow(x)[y+j] = srcRow(y+j)[x];
+            }
+        }
+    }
+    for (; y < h; y++) {
+        for (int x = 0; x < w; x++) {
+            dstRow(x)[y] = srcRow(y)[x];
+        }
+    }
+}
+
+}  // namespace SK_OPTS_NS
+
+#endif//SkBoxBlur_opts_DEFINED
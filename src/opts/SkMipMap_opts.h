@@ -0,0 +1,258 @@
+/*
+ * Copyright 2018 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#ifndef SkMipMap_opts_DEFINED
+#define SkMipMap_opts_DEFINED
+
+#include "SkHalf.h"
+#include "SkNx.h"
+
+#if SK_CPU_SSE_LEVEL >= SK_CPU_SSE_LEVEL_SSE2
+    #include <immintrin.h>
+#elif defined(SK_ARM_HAS_NEON)
+    #include <arm_neon.h>
+#endif
+
+// These are the mipmap filters SkMipMap uses for the overwhelmingly common cases: even sources
+// (a 2x2 box filter) and odd ones (a 3x3 triangle filter).  Each writes count dst pixels, reading
+// two or three src rows srcRB bytes apart.  The results match SkMipMap's portable filters exactly.
+
+namespace SK_OPTS_NS {
+
+static void downsample_2_2_8888(void* dst, const void* src, size_t srcRB, int count) {
+    auto p0 = static_cast<const uint32_t*>(src);
+    auto p1 = (const uint32_t*)((const char*)p0 + srcRB);
+    auto d  = static_cast<uint32_t*>(dst);
+
+#if SK_CPU_SSE_LEVEL >= SK_CPU_SSE_LEVEL_SSE2
+    const __m128i zero = _mm_setzero_si128();
+    // Sums four pixels from each row into two 2x2 blocks, 16 bits per channel.
+    auto sum_blocks = [&](const uint32_t* r0, const uint32_t* r1) {
+        __m128i a = _mm_loadu_si128((const __m128i*)r0),
+                b = _mm_loadu_si128((const __m128i*)r1);
+        __m128i px01 = _mm_add_epi16(_mm_unpacklo_epi8(a, zero), _mm_unpacklo_epi8(b, zero)),
+                px23 = _mm_add_epi16(_mm_unpackhi_epi8(a, zero), _mm_unpackhi_epi8(b, zero));
+        return _mm_add_epi16(_mm_unpacklo_epi64(px01, px23), _mm_unpackhi_epi64(px01, px23));
+    };
+    while (count >= 4) {
+        __m128i lo = sum_blocks(p0 + 0, p1 + 0),
+                hi = sum_blocks(p0 + 4, p1 + 4);
+        _mm_storeu_si128((__m128i*)d, _mm_packus_epi16(_mm_srli_epi16(lo, 2),
+                                                       _mm_srli_epi16(hi, 2)));
+        p0 += 8;
+        p1 += 8;
+        d  += 4;
+        count -= 4;
+    }
+#elif defined(SK_ARM_HAS_NEON)
+    while (count >= 8) {
+        // Load 16 pixels from each row, one channel per register, and add neighboring pairs.
+        uint8x16x4_t r0 = vld4q_u8((const uint8_t*)p0),
+                     r1 = vld4q_u8((const uint8_t*)p1);
+        uint8x8x4_t px;
+        for (int c = 0; c < 4; c++) {
+            px.val[c] = vshrn_n_u16(vpadalq_u8(vpaddlq_u8(r0.val[c]), r1.val[c]), 2);
+        }
+        vst4_u8((uint8_t*)d, px);
+        p0 += 16;
+        p1 += 16;
+        d  += 8;
+        count -= 8;
+    }
+#endif
+
+    auto expand = [](const uint32_t* p) { return SkNx_cast<uint16_t>(Sk4b::Load(p)); };
+    for (; count > 0; count--) {
+        Sk4h c = expand(p0) + expand(p1) + expand(p0 + 1) + expand(p1 + 1);
+        SkNx_cast<uint8_t>(c >> 2).store(d);
+        p0 += 2;
+        p1 += 2;
+        d  += 1;
+    }
+}
+
+static void downsample_3_3_8888(void* dst, const void* src, size_t srcRB, int count) {
+    auto p0 = static_cast<const uint32_t*>(src);
+    auto p1 = (const uint32_t*)((const char*)p0 + srcRB);
+    auto p2 = (const uint32_t*)((const char*)p1 + srcRB);
+    auto d  = static_cast<uint32_t*>(dst);
+
+#if SK_CPU_SSE_LEVEL >= SK_CPU_SSE_LEVEL_SSE2
+    const __m128i zero = _mm_setzero_si128();
+    // Filters each column vertically (1,2,1), 16 bits per channel.
+    auto column_lo = [&](__m128i a, __m128i b, __m128i c) {
+        return _mm_add_epi16(_mm_add_epi16(_mm_unpacklo_epi8(a, zero),
+                                           _mm_unpacklo_epi8(c, zero)),
+                             _mm_slli_epi16(_mm_unpacklo_epi8(b, zero), 1));
+    };
+    auto column_hi = [&](__m128i a, __m128i b, __m128i c) {
+        return _mm_add_epi16(_mm_add_epi16(_mm_unpackhi_epi8(a, zero),
+                                           _mm_unpackhi_epi8(c, zero)),
+                             _mm_slli_epi16(_mm_unpackhi_epi8(b, zero), 1));
+    };
+    auto load = [](const uint32_t* p) { return _mm_loadu_si128((const __m128i*)p); };
+    while (count >= 4) {
+        // Four dst pixels need src columns 0-8.
+        __m128i a0 = load(p0 + 0), b0 = load(p1 + 0), c0 = load(p2 + 0),
+                a1 = load(p0 + 4), b1 = load(p1 + 4), c1 = load(p2 + 4),
+                a2 = _mm_cvtsi32_si128(p0[8]),
+                b2 = _mm_cvtsi32_si128(p1[8]),
+                c2 = _mm_cvtsi32_si128(p2[8]);
+        __m128i v01 = column_lo(a0, b0, c0), v23 = column_hi(a0, b0, c0),
+                v45 = column_lo(a1, b1, c1), v67 = column_hi(a1, b1, c1),
+                v8  = column_lo(a2, b2, c2);
+
+        // Then filter horizontally (1,2,1): dst[i] = v[2i] + 2*v[2i+1] + v[2i+2].
+        __m128i lo = _mm_add_epi16(_mm_add_epi16(_mm_unpacklo_epi64(v01, v23),
+                                                 _mm_unpacklo_epi64(v23, v45)),
+                                   _mm_slli_epi16(_mm_unpackhi_epi64(v01, v23), 1)),
+                hi = _mm_add_epi16(_mm_add_epi16(_mm_unpacklo_epi64(v45, v67),
+                                                 _mm_unpacklo_epi64(v67, v8)),
+                                   _mm_slli_epi16(_mm_unpackhi_epi64(v45, v67), 1));
+        _mm_storeu_si128((__m128i*)d, _mm_packus_epi16(_mm_srli_epi16(lo, 4),
+                                                       _mm_srli_epi16(hi, 4)));
+        p0 += 8;
+        p1 += 8;
+        p2 += 8;
+        d  += 4;
+        count -= 4;
+    }
+#endif
+
+    auto column = [](const uint32_t* a, const uint32_t* b, const uint32_t* c) {
+        Sk4h mid = SkNx_cast<uint16_t>(Sk4b::Load(b));
+        return SkNx_cast<uint16_t>(Sk4b::Load(a)) + mid + mid + SkNx_cast<uint16_t>(Sk4b::Load(c));
+    };
+    for (; count > 0; count--) {
+        Sk4h c = column(p0, p1, p2) + (column(p0 + 1, p1 + 1, p2 + 1) << 1)
+               + column(p0 + 2, p1 + 2, p2 + 2);
+        SkNx_cast<uint8_t>(c >> 4).store(d);
+        p0 += 2;
+        p1 += 2;
+        p2 += 2;
+        d  += 1;
+    }
+}
+
+static void downsample_2_2_a8(void* dst, const void* src, size_t srcRB, int count) {
+    auto p0 = static_cast<const uint8_t*>(src);
+    auto p1 = p0 + srcRB;
+    auto d  = static_cast<uint8_t*>(dst);
+
+#if SK_CPU_SSE_LEVEL >= SK_CPU_SSE_LEVEL_SSE2
+    const __m128i lowBytes = _mm_set1_epi16(0x00FF);
+    while (count >= 8) {
+        __m128i a = _mm_loadu_si128((const __m128i*)p0),
+                b = _mm_loadu_si128((const __m128i*)p1);
+        // Each 16-bit lane holds a horizontal pair; add its two bytes from both rows.
+        __m128i sum = _mm_add_epi16(_mm_add_epi16(_mm_and_si128(a, lowBytes), _mm_srli_epi16(a, 8)),
+                                    _mm_add_epi16(_mm_and_si128(b, lowBytes), _mm_srli_epi16(b, 8)));
+        _mm_storel_epi64((__m128i*)d, _mm_packus_epi16(_mm_srli_epi16(sum, 2), sum));
+        p0 += 16;
+        p1 += 16;
+        d  += 8;
+        count -= 8;
+    }
+#elif defined(SK_ARM_HAS_NEON)
+    while (count >= 8) {
+        uint16x8_t sum = vpadalq_u8(vpaddlq_u8(vld1q_u8(p0)), vld1q_u8(p1));
+        vst1_u8(d, vshrn_n_u16(sum, 2));
+        p0 += 16;
+        p1 += 16;
+        d  += 8;
+        count -= 8;
+    }
+#endif
+
+    for (; count > 0; count--) {
+        *d++ = (uint8_t)((p0[0] + p0[1] + p1[0] + p1[1]) >> 2);
+        p0 += 2;
+        p1 += 2;
+    }
+}
+
+static void downsample_3_3_a8(void* dst, const void* src, size_t srcRB, int count) {
+    auto p0 = static_cast<const uint8_t*>(src);
+    auto p1 = p0 + srcRB;
+    auto p2 = p1 + srcRB;
+    auto d  = static_cast<uint8_t*>(dst);
+
+#if SK_CPU_SSE_LEVEL >= SK_CPU_SSE_LEVEL_SSE2
+    const __m128i lowBytes = _mm_set1_epi16(0x00FF);
+    while (count >= 8) {
+        // Eight dst pixels need src columns 0-16.  Filter each column vertically (1,2,1)...
+        __m128i a = _mm_loadu_si128((const __m128i*)p0),
+                b = _mm_loadu_si128((const __m128i*)p1),
+                c = _mm_loadu_si128((const __m128i*)p2);
+        __m128i even = _mm_add_epi16(_mm_add_epi16(_mm_and_si128(a, lowBytes),
+                                                   _mm_and_si128(c, lowBytes)),
+                                     _mm_slli_epi16(_mm_and_si128(b, lowBytes), 1)),
+                odd  = _mm_add_epi16(_mm_add_epi16(_mm_srli_epi16(a, 8), _mm_srli_epi16(c, 8)),
+                                     _mm_slli_epi16(_mm_srli_epi16(b, 8), 1));
+        int last = p0[16] + 2*p1[16] + p2[16];
+        __m128i next = _mm_insert_epi16(_mm_srli_si128(even, 2), last, 7);
+
+        // ...then horizontally: dst[i] = even[i] + 2*odd[i] + even[i+1].
+        __m128i sum = _mm_add_epi16(_mm_add_epi16(even, next), _mm_slli_epi16(odd, 1));
+        _mm_storel_epi64((__m128i*)d, _mm_packus_epi16(_mm_srli_epi16(sum, 4), sum));
+        p0 += 16;
+        p1 += 16;
+        p2 += 16;
+        d  += 8;
+        count -= 8;
+    }
+#endif
+
+    auto column = [&](int x) { return p0[x] + 2*p1[x] + p2[x]; };
+    for (; count > 0; count--) {
+        *d++ = (uint8_t)((column(0) + 2*column(1) + column(2)) >> 4);
+        p0 += 2;
+        p1 += 2;
+        p2 += 2;
+    }
+}
+
+// F16 already filters a whole pixel per Sk4f; these keep SkMipMap's exact order of operations.
+static void downsample_2_2_f16(void* dst, const void* src, size_t srcRB, int count) {
+    auto p0 = static_cast<const uint64_t*>(src);
+    auto p1 = (const uint64_t*)((const char*)p0 + srcRB);
+    auto d  = static_cast<uint64_t*>(dst);
+
+    for (int i = 0; i < count; i++) {
+        Sk4f c = SkHalfToFloat_finite_ftz(p0[0]) + SkHalfToFloat_finite_ftz(p1[0])
+               + SkHalfToFloat_finite_ftz(p0[1]) + SkHalfToFloat_finite_ftz(p1[1]);
+        SkFloatToHalf_finite_ftz(c * (1.0f / 4)).store(d + i);
+        p0 += 2;
+        p1 += 2;
+    }
+}
+
+static void downsample_3_3_f16(void* dst, const void* src, size_t srcRB, int count) {
+    auto p0 = static_cast<const uint64_t*>(src);
+    auto p1 = (const uint64_t*)((const char*)p0 + srcRB);
+    auto p2 = (const uint64_t*)((const char*)p1 + srcRB);
+    auto d  = static_cast<uint64_t*>(dst);
+
+    auto column = [&](int x) {
+        Sk4f mid = SkHalfToFloat_finite_ftz(p1[x]);
+        return SkHalfToFloat_finite_ftz(p0[x]) + mid + mid + SkHalfToFloat_finite_ftz(p2[x]);
+    };
+    Sk4f c = column(0);
+    for (int i = 0; i < count; i++) {
+        Sk4f a = c,
+             b = column(1) * 2;
+        c = column(2);
+        SkFloatToHalf_finite_ftz((a + b + c) * (1.0f / 16)).store(d + i);
+        p0 += 2;
+        p1 += 2;
+        p2 += 2;
+    }
+}
+
+}  // namespace SK_OPTS_NS
+
+#endif  // SkMipMap_opts_DEFINED
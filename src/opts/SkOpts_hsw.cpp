@@ -8,7 +8,9 @@
 #include "SkOpts.h"
 
 #define SK_OPTS_NS hsw
+#include "SkBoxBlur_opts.h"
 #include "SkRasterPipeline_opts.h"
+#include "SkSwizzler_opts.h"
 #include "SkUtils_opts.h"
 
 namespace SkOpts {
@@ -24,5 +26,12 @@ namespace SkOpts {
         just_return_lowp = (StageFn)SK_OPTS_NS::lowp::just_return;
         start_pipeline_lowp = SK_OPTS_NS::lowp::start_pipeline;
     #undef M
+
+        RGBA_to_BGRA   = SK_OPTS_NS::RGBA_to_BGRA;
+        RGBA_to_rgbA   = SK_OPTS_NS::RGBA_to_rgbA;
+        RGBA_to_bgrA   = SK_OPTS_NS::RGBA_to_bgrA;
+        index_to_8888  = SK_OPTS_NS::index_to_8888;
+
+        box_blur_columns = SK_OPTS_NS::box_blur_columns;
     }
 }
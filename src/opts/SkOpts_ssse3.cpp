@@ -27,6 +27,15 @@ namespace SkOpts {
         grayA_to_rgbA         = ssse3::grayA_to_rgbA;
         inverted_CMYK_to_RGB1 = ssse3::inverted_CMYK_to_RGB1;
         inverted_CMYK_to_BGR1 = ssse3::inverted_CMYK_to_BGR1;
+        RGB16_to_RGB1         = ssse3::RGB16_to_RGB1;
+        RGB16_to_BGR1         = ssse3::RGB16_to_BGR1;
+        RGBA16_to_RGBA        = ssse3::RGBA16_to_RGBA;
+        RGBA16_to_BGRA        = ssse3::RGBA16_to_BGRA;
+        RGBA16_to_rgbA        = ssse3::RGBA16_to_rgbA;
+        RGBA16_to_bgrA        = ssse3::RGBA16_to_bgrA;
+        RGB_to_565            = ssse3::RGB_to_565;
+        BGR_to_565            = ssse3::BGR_to_565;
+        RGB16_to_565          = ssse3::RGB16_to_565;
 
         S32_alpha_D32_filter_DX  = ssse3::S32_alpha_D32_filter_DX;
     }
@@ -2256,6 +2256,45 @@ STAGE(bilerp_clamp_8888, const SkRasterPipeline_GatherCtx* ctx) {
     }
 }
 
+// ~~~~~~ Fused stages ~~~~~~ //
+
+// SkRasterPipeline substitutes these for common sequences of stages, saving the calls between
+// them.  Each runs its stages back to back, and they read their contexts from the program in
+// order, just as they would have unfused.
+#define FUSE(st) st##_k(Ctx{c.program}, dx,dy,tail, r,g,b,a, dr,dg,db,da)
+
+STAGE(seed_shader_matrix_translate, Ctx c) {
+    FUSE(seed_shader);
+    FUSE(matrix_translate);
+}
+STAGE(seed_shader_matrix_scale_translate, Ctx c) {
+    FUSE(seed_shader);
+    FUSE(matrix_scale_translate);
+}
+STAGE(seed_shader_matrix_2x3, Ctx c) {
+    FUSE(seed_shader);
+    FUSE(matrix_2x3);
+}
+STAGE(gather_8888_srcover_rgba_8888, Ctx c) {
+    FUSE(gather_8888);
+    FUSE(srcover_rgba_8888);
+}
+STAGE(bilerp_clamp_8888_srcover_rgba_8888, Ctx c) {
+    FUSE(bilerp_clamp_8888);
+    FUSE(srcover_rgba_8888);
+}
+STAGE(load_8888_srcover_rgba_8888, Ctx c) {
+    FUSE(load_8888);
+    FUSE(srcover_rgba_8888);
+}
+STAGE(load_8888_dst_srcover_store_8888, Ctx c) {
+    FUSE(load_8888_dst);
+    FUSE(srcover);
+    FUSE(store_8888);
+}
+
+#undef FUSE
+
 namespace lowp {
 #if defined(JUMPER_IS_SCALAR) || defined(SK_DISABLE_LOWP_RASTER_PIPELINE)
     // If we're not compiled by Clang, or otherwise switched into scalar mode (old Clang, manually),
@@ -3276,6 +3315,219 @@ STAGE_GG(xy_to_radius, Ctx::None) {
     x = sqrt_(x*x + y*y);
 }
 
+// Please see https://skia.org/dev/design/conical for how our 2pt conical shader works.
+// These are all exactly the float stages above, working on t == x.
+
+STAGE_GG(negate_x, Ctx::None) { x = -x; }
+
+STAGE_GG(xy_to_2pt_conical_strip, const SkRasterPipeline_2PtConicalCtx* ctx) {
+    x = x + sqrt_(ctx->fP0 - y*y);  // ctx->fP0 = r0 * r0
+}
+STAGE_GG(xy_to_2pt_conical_focal_on_circle, Ctx::None) {
+    x = x + y*y / x;  // (x^2 + y^2) / x
+}
+STAGE_GG(xy_to_2pt_conical_well_behaved, const SkRasterPipeline_2PtConicalCtx* ctx) {
+    x = sqrt_(x*x + y*y) - x * ctx->fP0;  // ctx->fP0 = 1/r1
+}
+STAGE_GG(xy_to_2pt_conical_greater, const SkRasterPipeline_2PtConicalCtx* ctx) {
+    x = sqrt_(x*x - y*y) - x * ctx->fP0;  // ctx->fP0 = 1/r1
+}
+STAGE_GG(xy_to_2pt_conical_smaller, const SkRasterPipeline_2PtConicalCtx* ctx) {
+    x = -sqrt_(x*x - y*y) - x * ctx->fP0;  // ctx->fP0 = 1/r1
+}
+
+STAGE_GG(alter_2pt_conical_compensate_focal, const SkRasterPipeline_2PtConicalCtx* ctx) {
+    x = x + ctx->fP1;  // ctx->fP1 = f
+}
+STAGE_GG(alter_2pt_conical_unswap, Ctx::None) {
+    x = 1 - x;
+}
+
+STAGE_GG(mask_2pt_conical_nan, SkRasterPipeline_2PtConicalCtx* c) {
+    auto is_degenerate = (x != x);  // NaN
+    x = if_then_else(is_degenerate, F(0), x);
+    unaligned_store(&c->fMask, cond_to_mask_16(!is_degenerate));
+}
+STAGE_GG(mask_2pt_conical_degenerates, SkRasterPipeline_2PtConicalCtx* c) {
+    auto is_degenerate = (x <= 0) | (x != x);
+    x = if_then_else(is_degenerate, F(0), x);
+    unaligned_store(&c->fMask, cond_to_mask_16(!is_degenerate));
+}
+STAGE_PP(apply_vector_mask, const uint32_t* ctx) {
+    // The mask_2pt_conical_ stages above store 16-bit masks.
+    const U16 mask = unaligned_load<U16>(ctx);
+    r = r & mask;
+    g = g & mask;
+    b = b & mask;
+    a = a & mask;
+}
+
+// ~~~~~~ Image tiling and filtering ~~~~~~ //
+
+// These are just like their float counterparts, so the gather stages see the same coordinates.
+SI F exclusive_repeat(F v, const SkRasterPipeline_TileCtx* ctx) {
+    return v - floor_(v*ctx->invScale)*ctx->scale;
+}
+SI F exclusive_mirror(F v, const SkRasterPipeline_TileCtx* ctx) {
+    auto limit = ctx->scale;
+    auto invLimit = ctx->invScale;
+    return abs_( (v-limit) - (limit+limit)*floor_((v-limit)*(invLimit*0.5f)) - limit );
+}
+STAGE_GG(repeat_x, const SkRasterPipeline_TileCtx* ctx) { x = exclusive_repeat(x, ctx); }
+STAGE_GG(repeat_y, const SkRasterPipeline_TileCtx* ctx) { y = exclusive_repeat(y, ctx); }
+STAGE_GG(mirror_x, const SkRasterPipeline_TileCtx* ctx) { x = exclusive_mirror(x, ctx); }
+STAGE_GG(mirror_y, const SkRasterPipeline_TileCtx* ctx) { y = exclusive_mirror(y, ctx); }
+
+// Filter weights are 2.14 fixed point, so a bicubic's 16 products of a [0,255] sample and its
+// weight sum comfortably in 32 bits, negative lobes and all.  dr,dg,db,da can't hold those sums,
+// so accumulate() keeps them in ctx->sum and writes the sum so far, rounded and clamped to
+// [0,255], into dr,dg,db,da.  That's the filtered color once the last sample is in.
+static const int kFilterBits = 14;
+
+SI I32 if_then_else(I32 c, I32 t, I32 e) { return (t & c) | (e & ~c); }
+
+STAGE_GG(save_xy, SkRasterPipeline_SamplerCtx* c) {
+    F fx = fract(x + 0.5f),
+      fy = fract(y + 0.5f);
+
+    unaligned_store(c->x,  x);
+    unaligned_store(c->y,  y);
+    unaligned_store(c->fx, fx);
+    unaligned_store(c->fy, fy);
+
+    memset(c->sum, 0, sizeof(c->sum));
+}
+
+STAGE_PP(accumulate, SkRasterPipeline_SamplerCtx* c) {
+    F scale = unaligned_load<F>(c->scalex)
+            * unaligned_load<F>(c->scaley);
+    I32 weight = cast<I32>(scale * (1<<kFilterBits) + 0.5f);
+
+    auto accumulate_channel = [&](U16 v, int32_t* sum) -> U16 {
+        I32 s = unaligned_load<I32>(sum) + cast<I32>(v) * weight;
+        unaligned_store(sum, s);
+
+        I32 rounded = (s + (1<<(kFilterBits-1))) >> kFilterBits;
+        rounded = if_then_else(rounded <   0, I32(  0), rounded);
+        rounded = if_then_else(rounded > 255, I32(255), rounded);
+        return cast<U16>(rounded);
+    };
+    dr = accumulate_channel(r, c->sum[0]);
+    dg = accumulate_channel(g, c->sum[1]);
+    db = accumulate_channel(b, c->sum[2]);
+    da = accumulate_channel(a, c->sum[3]);
+}
+
+template <int kScale>
+SI void bilinear_x(SkRasterPipeline_SamplerCtx* ctx, F* x) {
+    *x = unaligned_load<F>(ctx->x) + (kScale * 0.5f);
+    F fx = unaligned_load<F>(ctx->fx);
+
+    F scalex;
+    if (kScale == -1) { scalex = 1.0f - fx; }
+    if (kScale == +1) { scalex =        fx; }
+    unaligned_store(ctx->scalex, scalex);
+}
+template <int kScale>
+SI void bilinear_y(SkRasterPipeline_SamplerCtx* ctx, F* y) {
+    *y = unaligned_load<F>(ctx->y) + (kScale * 0.5f);
+    F fy = unaligned_load<F>(ctx->fy);
+
+    F scaley;
+    if (kScale == -1) { scaley = 1.0f - fy; }
+    if (kScale == +1) { scaley =        fy; }
+    unaligned_store(ctx->scaley, scaley);
+}
+
+STAGE_GG(bilinear_nx, SkRasterPipeline_SamplerCtx* ctx) { bilinear_x<-1>(ctx, &x); }
+STAGE_GG(bilinear_px, SkRasterPipeline_SamplerCtx* ctx) { bilinear_x<+1>(ctx, &x); }
+STAGE_GG(bilinear_ny, SkRasterPipeline_SamplerCtx* ctx) { bilinear_y<-1>(ctx, &y); }
+STAGE_GG(bilinear_py, SkRasterPipeline_SamplerCtx* ctx) { bilinear_y<+1>(ctx, &y); }
+
+SI F bicubic_near(F t) {
+    // 1/18 + 9/18t + 27/18t^2 - 21/18t^3 == t ( t ( -21/18t + 27/18) + 9/18) + 1/18
+    return mad(t, mad(t, mad((-21/18.0f), t, (27/18.0f)), (9/18.0f)), (1/18.0f));
+}
+SI F bicubic_far(F t) {
+    // 0/18 + 0/18*t - 6/18t^2 + 7/18t^3 == t^2 (7/18t - 6/18)
+    return (t*t)*mad((7/18.0f), t, (-6/18.0f));
+}
+
+template <int kScale>
+SI void bicubic_x(SkRasterPipeline_SamplerCtx* ctx, F* x) {
+    *x = unaligned_load<F>(ctx->x) + (kScale * 0.5f);
+    F fx = unaligned_load<F>(ctx->fx);
+
+    F scalex;
+    if (kScale == -3) { scalex = bicubic_far (1.0f - fx); }
+    if (kScale == -1) { scalex = bicubic_near(1.0f - fx); }
+    if (kScale == +1) { scalex = bicubic_near(       fx); }
+    if (kScale == +3) { scalex = bicubic_far (       fx); }
+    unaligned_store(ctx->scalex, scalex);
+}
+template <int kScale>
+SI void bicubic_y(SkRasterPipeline_SamplerCtx* ctx, F* y) {
+    *y = unaligned_load<F>(ctx->y) + (kScale * 0.5f);
+    F fy = unaligned_load<F>(ctx->fy);
+
+    F scaley;
+    if (kScale == -3) { scaley = bicubic_far (1.0f - fy); }
+    if (kScale == -1) { scaley = bicubic_near(1.0f - fy); }
+    if (kScale == +1) { scaley = bicubic_near(       fy); }
+    if (kScale == +3) { scaley = bicubic_far (       fy); }
+    unaligned_store(ctx->scaley, scaley);
+}
+
+STAGE_GG(bicubic_n3x, SkRasterPipeline_SamplerCtx* ctx) { bicubic_x<-3>(ctx, &x); }
+STAGE_GG(bicubic_n1x, SkRasterPipeline_SamplerCtx* ctx) { bicubic_x<-1>(ctx, &x); }
+STAGE_GG(bicubic_p1x, SkRasterPipeline_SamplerCtx* ctx) { bicubic_x<+1>(ctx, &x); }
+STAGE_GG(bicubic_p3x, SkRasterPipeline_SamplerCtx* ctx) { bicubic_x<+3>(ctx, &x); }
+
+STAGE_GG(bicubic_n3y, SkRasterPipeline_SamplerCtx* ctx) { bicubic_y<-3>(ctx, &y); }
+STAGE_GG(bicubic_n1y, SkRasterPipeline_SamplerCtx* ctx) { bicubic_y<-1>(ctx, &y); }
+STAGE_GG(bicubic_p1y, SkRasterPipeline_SamplerCtx* ctx) { bicubic_y<+1>(ctx, &y); }
+STAGE_GG(bicubic_p3y, SkRasterPipeline_SamplerCtx* ctx) { bicubic_y<+3>(ctx, &y); }
+
+// ~~~~~~ Color matrices and unpremul ~~~~~~ //
+
+// Our 8-bit lanes can't hold values outside [0,1], so these do their math in float and clamp.
+SI F       to_F(U16 v) { return cast<F>(v) * (1/255.0f); }
+SI U16 from_F_01(F v)  { return cast<U16>(clamp_01(v) * 255.0f + 0.5f); }
+
+STAGE_PP(matrix_3x3, const float* m) {
+    F R = to_F(r), G = to_F(g), B = to_F(b);
+    r = from_F_01(mad(R,m[0], mad(G,m[3], B*m[6])));
+    g = from_F_01(mad(R,m[1], mad(G,m[4], B*m[7])));
+    b = from_F_01(mad(R,m[2], mad(G,m[5], B*m[8])));
+}
+STAGE_PP(matrix_3x4, const float* m) {
+    F R = to_F(r), G = to_F(g), B = to_F(b);
+    r = from_F_01(mad(R,m[0], mad(G,m[3], mad(B,m[6], m[ 9]))));
+    g = from_F_01(mad(R,m[1], mad(G,m[4], mad(B,m[7], m[10]))));
+    b = from_F_01(mad(R,m[2], mad(G,m[5], mad(B,m[8], m[11]))));
+}
+STAGE_PP(matrix_4x5, const float* m) {
+    F R = to_F(r), G = to_F(g), B = to_F(b), A = to_F(a);
+    r = from_F_01(mad(R,m[0], mad(G,m[4], mad(B,m[ 8], mad(A,m[12], m[16])))));
+    g = from_F_01(mad(R,m[1], mad(G,m[5], mad(B,m[ 9], mad(A,m[13], m[17])))));
+    b = from_F_01(mad(R,m[2], mad(G,m[6], mad(B,m[10], mad(A,m[14], m[18])))));
+    a = from_F_01(mad(R,m[3], mad(G,m[7], mad(B,m[11], mad(A,m[15], m[19])))));
+}
+STAGE_GP(matrix_4x3, const float* m) {
+    r = from_F_01(mad(x, m[0], mad(y, m[4], m[ 8])));
+    g = from_F_01(mad(x, m[1], mad(y, m[5], m[ 9])));
+    b = from_F_01(mad(x, m[2], mad(y, m[6], m[10])));
+    a = from_F_01(mad(x, m[3], mad(y, m[7], m[11])));
+}
+
+STAGE_PP(unpremul, Ctx::None) {
+    F A = cast<F>(a),
+      scale = if_then_else(A == 0, F(0), 1.0f / A);
+    r = from_F_01(cast<F>(r) * scale);
+    g = from_F_01(cast<F>(g) * scale);
+    b = from_F_01(cast<F>(b) * scale);
+}
+
 // ~~~~~~ Compound stages ~~~~~~ //
 
 STAGE_PP(srcover_rgba_8888, const SkRasterPipeline_MemoryCtx* ctx) {
@@ -3356,6 +3608,51 @@ STAGE_GP(bilerp_clamp_8888, const SkRasterPipeline_GatherCtx* ctx) {
 }
 #endif
 
+// ~~~~~~ Fused stages ~~~~~~ //
+
+// Just like the float fused stages, calling each stage's kernel the way its STAGE_ macro would.
+#define FUSE_GG(st) st##_k(Ctx{c.program}, dx,dy,tail, x,y, 0,0,0,0, 0,0,0,0)
+#define FUSE_GP(st) st##_k(Ctx{c.program}, dx,dy,tail, x,y, r,g,b,a, dr,dg,db,da)
+#define FUSE_PP(st) st##_k(Ctx{c.program}, dx,dy,tail, 0,0, r,g,b,a, dr,dg,db,da)
+
+STAGE_GG(seed_shader_matrix_translate, Ctx c) {
+    FUSE_GG(seed_shader);
+    FUSE_GG(matrix_translate);
+}
+STAGE_GG(seed_shader_matrix_scale_translate, Ctx c) {
+    FUSE_GG(seed_shader);
+    FUSE_GG(matrix_scale_translate);
+}
+STAGE_GG(seed_shader_matrix_2x3, Ctx c) {
+    FUSE_GG(seed_shader);
+    FUSE_GG(matrix_2x3);
+}
+STAGE_GP(gather_8888_srcover_rgba_8888, Ctx c) {
+    FUSE_GP(gather_8888);
+    FUSE_GP(srcover_rgba_8888);
+}
+#if defined(SK_DISABLE_LOWP_BILERP_CLAMP_CLAMP_STAGE)
+    static void(*bilerp_clamp_8888_srcover_rgba_8888)(void) = nullptr;
+#else
+STAGE_GP(bilerp_clamp_8888_srcover_rgba_8888, Ctx c) {
+    FUSE_GP(bilerp_clamp_8888);
+    FUSE_GP(srcover_rgba_8888);
+}
+#endif
+STAGE_PP(load_8888_srcover_rgba_8888, Ctx c) {
+    FUSE_PP(load_8888);
+    FUSE_PP(srcover_rgba_8888);
+}
+STAGE_PP(load_8888_dst_srcover_store_8888, Ctx c) {
+    FUSE_PP(load_8888_dst);
+    FUSE_PP(srcover);
+    FUSE_PP(store_8888);
+}
+
+#undef FUSE_GG
+#undef FUSE_GP
+#undef FUSE_PP
+
 // Now we'll add null stand-ins for stages we haven't implemented in lowp.
 // If a pipeline uses these stages, it'll boot it out of lowp into highp.
 #define NOT_IMPLEMENTED(st) static void (*st)(void) = nullptr;
@@ -3366,11 +3663,10 @@ STAGE_GP(bilerp_clamp_8888, const SkRasterPipeline_GatherCtx* ctx) {
     NOT_IMPLEMENTED(store_dst)
     NOT_IMPLEMENTED(unbounded_set_rgb)
     NOT_IMPLEMENTED(unbounded_uniform_color)
-    NOT_IMPLEMENTED(unpremul)
-    NOT_IMPLEMENTED(dither)  // TODO
+    NOT_IMPLEMENTED(dither)        // Rounds away to nothing in 8-bit lanes.
     NOT_IMPLEMENTED(from_srgb)
     NOT_IMPLEMENTED(to_srgb)
-    NOT_IMPLEMENTED(load_f16)
+    NOT_IMPLEMENTED(load_f16)      // Would clamp extended range colors to [0,1].
     NOT_IMPLEMENTED(load_f16_dst)
     NOT_IMPLEMENTED(store_f16)
     NOT_IMPLEMENTED(gather_f16)
@@ -3391,44 +3687,11 @@ STAGE_GP(bilerp_clamp_8888, const SkRasterPipeline_GatherCtx* ctx) {
     NOT_IMPLEMENTED(saturation)
     NOT_IMPLEMENTED(color)
     NOT_IMPLEMENTED(luminosity)
-    NOT_IMPLEMENTED(matrix_3x3)
-    NOT_IMPLEMENTED(matrix_3x4)
-    NOT_IMPLEMENTED(matrix_4x5)  // TODO
-    NOT_IMPLEMENTED(matrix_4x3)  // TODO
     NOT_IMPLEMENTED(parametric)
     NOT_IMPLEMENTED(gamma)
     NOT_IMPLEMENTED(rgb_to_hsl)
     NOT_IMPLEMENTED(hsl_to_rgb)
     NOT_IMPLEMENTED(gauss_a_to_rgba)  // TODO
-    NOT_IMPLEMENTED(mirror_x)         // TODO
-    NOT_IMPLEMENTED(repeat_x)         // TODO
-    NOT_IMPLEMENTED(mirror_y)         // TODO
-    NOT_IMPLEMENTED(repeat_y)         // TODO
-    NOT_IMPLEMENTED(negate_x)
-    NOT_IMPLEMENTED(bilinear_nx)      // TODO
-    NOT_IMPLEMENTED(bilinear_ny)      // TODO
-    NOT_IMPLEMENTED(bilinear_px)      // TODO
-    NOT_IMPLEMENTED(bilinear_py)      // TODO
-    NOT_IMPLEMENTED(bicubic_n3x)      // TODO
-    NOT_IMPLEMENTED(bicubic_n1x)      // TODO
-    NOT_IMPLEMENTED(bicubic_p1x)      // TODO
-    NOT_IMPLEMENTED(bicubic_p3x)      // TODO
-    NOT_IMPLEMENTED(bicubic_n3y)      // TODO
-    NOT_IMPLEMENTED(bicubic_n1y)      // TODO
-    NOT_IMPLEMENTED(bicubic_p1y)      // TODO
-    NOT_IMPLEMENTED(bicubic_p3y)      // TODO
-    NOT_IMPLEMENTED(save_xy)          // TODO
-    NOT_IMPLEMENTED(accumulate)       // TODO
-    NOT_IMPLEMENTED(xy_to_2pt_conical_well_behaved)
-    NOT_IMPLEMENTED(xy_to_2pt_conical_strip)
-    NOT_IMPLEMENTED(xy_to_2pt_conical_focal_on_circle)
-    NOT_IMPLEMENTED(xy_to_2pt_conical_smaller)
-    NOT_IMPLEMENTED(xy_to_2pt_conical_greater)
-    NOT_IMPLEMENTED(alter_2pt_conical_compensate_focal)
-    NOT_IMPLEMENTED(alter_2pt_conical_unswap)
-    NOT_IMPLEMENTED(mask_2pt_conical_nan)
-    NOT_IMPLEMENTED(mask_2pt_conical_degenerates)
-    NOT_IMPLEMENTED(apply_vector_mask)
 #undef NOT_IMPLEMENTED
 
 #endif//defined(JUMPER_IS_SCALAR) controlling whether we build lowp stages
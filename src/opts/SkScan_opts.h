@@ -0,0 +1,107 @@
+/*
+ * Copyright 2018 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#ifndef SkScan_opts_DEFINED
+#define SkScan_opts_DEFINED
+
+#include "SkColor.h"
+#include "SkNx.h"
+#include "SkTo.h"
+
+#include <string.h>
+
+#if SK_CPU_SSE_LEVEL >= SK_CPU_SSE_LEVEL_SSE2
+    #include <immintrin.h>
+#endif
+
+// Analytic AA accumulates the coverage of a pixel row in a dense row of alphas, then blits it as
+// runs.  Adds saturate at 0xFF, which is also what the overflow check in SkAlphaRuns does for the
+// sums of at most 0x100 that convex paths can make.
+
+namespace SK_OPTS_NS {
+
+static void accumulate_coverage(SkAlpha dst[], const SkAlpha src[], int count) {
+    while (count >= 16) {
+        Sk16b::Load(dst).saturatedAdd(Sk16b::Load(src)).store(dst);
+        dst   += 16;
+        src   += 16;
+        count -= 16;
+    }
+    for (; count > 0; count--) {
+        *dst = SkTMin(0xFF, *dst + *src++);
+        dst++;
+    }
+}
+
+static void add_coverage(SkAlpha dst[], SkAlpha alpha, int count) {
+    const Sk16b a(alpha);
+    while (count >= 16) {
+        Sk16b::Load(dst).saturatedAdd(a).store(dst);
+        dst   += 16;
+        count -= 16;
+    }
+    for (; count > 0; count--) {
+        *dst = SkTMin(0xFF, *dst + alpha);
+        dst++;
+    }
+}
+
+// How many of the count alphas starting at p equal p[0].
+static inline int uniform_prefix(const SkAlpha* p, int count) {
+    int n = 1;
+#if SK_CPU_SSE_LEVEL >= SK_CPU_SSE_LEVEL_SSE2
+    const __m128i splat = _mm_set1_epi8((char)p[0]);
+    while (n + 16 <= count &&
+           0xFFFF == _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_loadu_si128((const __m128i*)(p + n)),
+                                                      splat))) {
+        n += 16;
+    }
+#else
+    const uint64_t splat = p[0] * 0x0101010101010101ull;
+    uint64_t bytes;
+    while (n + 8 <= count && (memcpy(&bytes, p + n, 8), bytes == splat)) {
+        n += 8;
+    }
+#endif
+    while (n < count && p[n] == p[0]) {
+        n++;
+    }
+    return n;
+}
+
+// Snaps coverage close to 0 or 0xFF to it, since blitting those is much faster, then writes the
+// row as runs in the format of SkAlphaRuns, without the terminating zero.  Returns false if the
+// whole row snapped to 0.  The coverage is snapped in place.
+static bool coverage_to_runs(SkAlpha alphas[], int16_t runs[], SkAlpha coverage[], int count) {
+    const Sk16b lo(8), hi(248), zero(0), opaque(0xFF);
+    SkAlpha* c = coverage;
+    int n = count;
+    while (n >= 16) {
+        Sk16b v = Sk16b::Load(c);
+        (v < lo).thenElse(zero, (v < hi).thenElse(v, opaque)).store(c);
+        c += 16;
+        n -= 16;
+    }
+    for (; n > 0; n--) {
+        *c = *c < 8 ? 0 : *c > 247 ? 0xFF : *c;
+        c++;
+    }
+
+    bool visible = false;
+    for (int x = 0; x < count;) {
+        int len = uniform_prefix(coverage + x, count - x);
+        alphas[x] = coverage[x];
+        runs[x]   = SkToS16(len);
+        visible |= coverage[x] != 0;
+        x += len;
+    }
+    return visible;
+}
+
+}  // namespace SK_OPTS_NS
+
+#endif//SkScan_opts_DEFINED
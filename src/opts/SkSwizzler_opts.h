@@ -158,6 +158,133 @@ static void inverted_CMYK_to_BGR1_portable(uint32_t* dst, const uint32_t* src, i
     }
 }
 
+// 16-bit sources are big-endian, as PNG stores them, so the high byte of each channel comes first.
+
+static void RGB16_to_RGB1_portable(uint32_t dst[], const uint8_t* src, int count) {
+    for (int i = 0; i < count; i++) {
+        uint8_t r = src[0],
+                g = src[2],
+                b = src[4];
+        src += 6;
+        dst[i] = (uint32_t)0xFF << 24
+               | (uint32_t)b    << 16
+               | (uint32_t)g    <<  8
+               | (uint32_t)r    <<  0;
+    }
+}
+
+static void RGB16_to_BGR1_portable(uint32_t dst[], const uint8_t* src, int count) {
+    for (int i = 0; i < count; i++) {
+        uint8_t r = src[0],
+                g = src[2],
+                b = src[4];
+        src += 6;
+        dst[i] = (uint32_t)0xFF << 24
+               | (uint32_t)r    << 16
+               | (uint32_t)g    <<  8
+               | (uint32_t)b    <<  0;
+    }
+}
+
+static void RGBA16_to_RGBA_portable(uint32_t dst[], const uint8_t* src, int count) {
+    for (int i = 0; i < count; i++) {
+        uint8_t r = src[0],
+                g = src[2],
+                b = src[4],
+                a = src[6];
+        src += 8;
+        dst[i] = (uint32_t)a << 24
+               | (uint32_t)b << 16
+               | (uint32_t)g <<  8
+               | (uint32_t)r <<  0;
+    }
+}
+
+static void RGBA16_to_BGRA_portable(uint32_t dst[], const uint8_t* src, int count) {
+    for (int i = 0; i < count; i++) {
+        uint8_t r = src[0],
+                g = src[2],
+                b = src[4],
+                a = src[6];
+        src += 8;
+        dst[i] = (uint32_t)a << 24
+               | (uint32_t)r << 16
+               | (uint32_t)g <<  8
+               | (uint32_t)b <<  0;
+    }
+}
+
+static void RGBA16_to_rgbA_portable(uint32_t dst[], const uint8_t* src, int count) {
+    for (int i = 0; i < count; i++) {
+        uint8_t r = src[0],
+                g = src[2],
+                b = src[4],
+                a = src[6];
+        src += 8;
+        b = (b*a+127)/255;
+        g = (g*a+127)/255;
+        r = (r*a+127)/255;
+        dst[i] = (uint32_t)a << 24
+               | (uint32_t)b << 16
+               | (uint32_t)g <<  8
+               | (uint32_t)r <<  0;
+    }
+}
+
+static void RGBA16_to_bgrA_portable(uint32_t dst[], const uint8_t* src, int count) {
+    for (int i = 0; i < count; i++) {
+        uint8_t r = src[0],
+                g = src[2],
+                b = src[4],
+                a = src[6];
+        src += 8;
+        b = (b*a+127)/255;
+        g = (g*a+127)/255;
+        r = (r*a+127)/255;
+        dst[i] = (uint32_t)a << 24
+               | (uint32_t)r << 16
+               | (uint32_t)g <<  8
+               | (uint32_t)b <<  0;
+    }
+}
+
+static void RGB_to_565_portable(uint16_t dst[], const uint8_t* src, int count) {
+    for (int i = 0; i < count; i++) {
+        dst[i] = SkPack888ToRGB16(src[0], src[1], src[2]);
+        src += 3;
+    }
+}
+
+static void BGR_to_565_portable(uint16_t dst[], const uint8_t* src, int count) {
+    for (int i = 0; i < count; i++) {
+        dst[i] = SkPack888ToRGB16(src[2], src[1], src[0]);
+        src += 3;
+    }
+}
+
+static void RGB16_to_565_portable(uint16_t dst[], const uint8_t* src, int count) {
+    for (int i = 0; i < count; i++) {
+        dst[i] = SkPack888ToRGB16(src[0], src[2], src[4]);
+        src += 6;
+    }
+}
+
+static void index_to_8888_portable(uint32_t dst[], const uint8_t* src, int count,
+                                   const uint32_t table[]) {
+    while (count >= 4) {
+        dst[0] = table[src[0]];
+        dst[1] = table[src[1]];
+        dst[2] = table[src[2]];
+        dst[3] = table[src[3]];
+        src += 4;
+        dst += 4;
+        count -= 4;
+    }
+    for (int i = 0; i < count; i++) {
+        dst[i] = table[src[i]];
+    }
+}
+
 #if defined(SK_ARM_HAS_NEON)
 
 // Rounded divide by 255, (x + 127) / 255
@@ -477,6 +604,161 @@ static void inverted_cmyk_to(uint32_t* dst, const uint32_t* src, int count) {
     inverted_cmyk_to<kBGR1>(dst, src, count);
 }
 
+// Narrowing each big-endian 16-bit channel, loaded as little-endian, keeps its high byte.
+
+template <bool kSwapRB>
+static void strip16_insert_alpha_should_swaprb(uint32_t dst[], const uint8_t* src, int count) {
+    while (count >= 8) {
+        // Load 8 pixels.
+        uint16x8x3_t rgb = vld3q_u16((const uint16_t*) src);
+
+        // Keep the high byte of each channel, insert an opaque alpha and swap if needed.
+        uint8x8x4_t rgba;
+        if (kSwapRB) {
+            rgba.val[0] = vmovn_u16(rgb.val[2]);
+            rgba.val[2] = vmovn_u16(rgb.val[0]);
+        } else {
+            rgba.val[0] = vmovn_u16(rgb.val[0]);
+            rgba.val[2] = vmovn_u16(rgb.val[2]);
+        }
+        rgba.val[1] = vmovn_u16(rgb.val[1]);
+        rgba.val[3] = vdup_n_u8(0xFF);
+
+        // Store 8 pixels.
+        vst4_u8((uint8_t*) dst, rgba);
+        src += 8*6;
+        dst += 8;
+        count -= 8;
+    }
+
+    auto proc = kSwapRB ? RGB16_to_BGR1_portable : RGB16_to_RGB1_portable;
+    proc(dst, src, count);
+}
+
+/*not static*/ inline void RGB16_to_RGB1(uint32_t dst[], const uint8_t* src, int count) {
+    strip16_insert_alpha_should_swaprb<false>(dst, src, count);
+}
+
+/*not static*/ inline void RGB16_to_BGR1(uint32_t dst[], const uint8_t* src, int count) {
+    strip16_insert_alpha_should_swaprb<true>(dst, src, count);
+}
+
+template <bool kSwapRB, bool kPremul>
+static void strip16_should_swapRB_premul(uint32_t dst[], const uint8_t* src, int count) {
+    while (count >= 8) {
+        // Load 8 pixels.
+        uint16x8x4_t rgba16 = vld4q_u16((const uint16_t*) src);
+
+        uint8x8_t r = vmovn_u16(rgba16.val[0]),
+                  g = vmovn_u16(rgba16.val[1]),
+                  b = vmovn_u16(rgba16.val[2]),
+                  a = vmovn_u16(rgba16.val[3]);
+
+        // Premultiply if requested.
+        if (kPremul) {
+            r = scale(r, a);
+            g = scale(g, a);
+            b = scale(b, a);
+        }
+
+        // Store 8 pixels.
+        uint8x8x4_t rgba;
+        if (kSwapRB) {
+            rgba.val[0] = b;
+            rgba.val[2] = r;
+        } else {
+            rgba.val[0] = r;
+            rgba.val[2] = b;
+        }
+        rgba.val[1] = g;
+        rgba.val[3] = a;
+        vst4_u8((uint8_t*) dst, rgba);
+        src += 8*8;
+        dst += 8;
+        count -= 8;
+    }
+
+    auto proc = kPremul ? (kSwapRB ? RGBA16_to_bgrA_portable : RGBA16_to_rgbA_portable)
+                        : (kSwapRB ? RGBA16_to_BGRA_portable : RGBA16_to_RGBA_portable);
+    proc(dst, src, count);
+}
+
+/*not static*/ inline void RGBA16_to_RGBA(uint32_t dst[], const uint8_t* src, int count) {
+    strip16_should_swapRB_premul<false, false>(dst, src, count);
+}
+
+/*not static*/ inline void RGBA16_to_BGRA(uint32_t dst[], const uint8_t* src, int count) {
+    strip16_should_swapRB_premul<true, false>(dst, src, count);
+}
+
+/*not static*/ inline void RGBA16_to_rgbA(uint32_t dst[], const uint8_t* src, int count) {
+    strip16_should_swapRB_premul<false, true>(dst, src, count);
+}
+
+/*not static*/ inline void RGBA16_to_bgrA(uint32_t dst[], const uint8_t* src, int count) {
+    strip16_should_swapRB_premul<true, true>(dst, src, count);
+}
+
+// Pack 8 pixels of 8-bit channels to 565.
+static uint16x8_t pack_565(uint8x8_t r, uint8x8_t g, uint8x8_t b) {
+    uint16x8_t r16 = vshlq_n_u16(vmovl_u8(vshr_n_u8(r, 3)), SK_R16_SHIFT),
+               g16 = vshlq_n_u16(vmovl_u8(vshr_n_u8(g, 2)), SK_G16_SHIFT),
+               b16 = vshlq_n_u16(vmovl_u8(vshr_n_u8(b, 3)), SK_B16_SHIFT);
+    return vorrq_u16(vorrq_u16(r16, g16), b16);
+}
+
+template <bool kSwapRB>
+static void RGB_to_565_should_swaprb(uint16_t dst[], const uint8_t* src, int count) {
+    while (count >= 8) {
+        // Load 8 pixels.
+        uint8x8x3_t rgb = vld3_u8(src);
+
+        // Store 8 pixels.
+        if (kSwapRB) {
+            vst1q_u16(dst, pack_565(rgb.val[2], rgb.val[1], rgb.val[0]));
+        } else {
+            vst1q_u16(dst, pack_565(rgb.val[0], rgb.val[1], rgb.val[2]));
+        }
+        src += 8*3;
+        dst += 8;
+        count -= 8;
+    }
+
+    auto proc = kSwapRB ? BGR_to_565_portable : RGB_to_565_portable;
+    proc(dst, src, count);
+}
+
+/*not static*/ inline void RGB_to_565(uint16_t dst[], const uint8_t* src, int count) {
+    RGB_to_565_should_swaprb<false>(dst, src, count);
+}
+
+/*not static*/ inline void BGR_to_565(uint16_t dst[], const uint8_t* src, int count) {
+    RGB_to_565_should_swaprb<true>(dst, src, count);
+}
+
+/*not static*/ inline void RGB16_to_565(uint16_t dst[], const uint8_t* src, int count) {
+    while (count >= 8) {
+        // Load 8 pixels.
+        uint16x8x3_t rgb = vld3q_u16((const uint16_t*) src);
+
+        // Store 8 pixels.
+        vst1q_u16(dst, pack_565(vmovn_u16(rgb.val[0]),
+                                vmovn_u16(rgb.val[1]),
+                                vmovn_u16(rgb.val[2])));
+        src += 8*6;
+        dst += 8;
+        count -= 8;
+    }
+
+    RGB16_to_565_portable(dst, src, count);
+}
+
+// NEON has no gather; the unrolled table lookup is as fast as we can do.
+/*not static*/ inline void index_to_8888(uint32_t dst[], const uint8_t* src, int count,
+                                         const uint32_t table[]) {
+    index_to_8888_portable(dst, src, count, table);
+}
+
 #elif SK_CPU_SSE_LEVEL >= SK_CPU_SSE_LEVEL_SSSE3
 
 // Scale a byte by another.
@@ -489,47 +771,106 @@ static __m128i scale(__m128i x, __m128i y) {
     return _mm_mulhi_epu16(_mm_add_epi16(_mm_mullo_epi16(x, y), _128), _257);
 }
 
+// Premultiply 8 pixels, 4 in lo and 4 in hi, swapping R and B if requested.
 template <bool kSwapRB>
-static void premul_should_swapRB(uint32_t* dst, const uint32_t* src, int count) {
+static void premul8(__m128i* lo, __m128i* hi) {
+    const __m128i zeros = _mm_setzero_si128();
+    __m128i planar;
+    if (kSwapRB) {
+        planar = _mm_setr_epi8(2,6,10,14, 1,5,9,13, 0,4,8,12, 3,7,11,15);
+    } else {
+        planar = _mm_setr_epi8(0,4,8,12, 1,5,9,13, 2,6,10,14, 3,7,11,15);
+    }
 
-    auto premul8 = [](__m128i* lo, __m128i* hi) {
-        const __m128i zeros = _mm_setzero_si128();
-        __m128i planar;
-        if (kSwapRB) {
-            planar = _mm_setr_epi8(2,6,10,14, 1,5,9,13, 0,4,8,12, 3,7,11,15);
-        } else {
-            planar = _mm_setr_epi8(0,4,8,12, 1,5,9,13, 2,6,10,14, 3,7,11,15);
-        }
+    // Swizzle the pixels to 8-bit planar.
+    *lo = _mm_shuffle_epi8(*lo, planar);                      // rrrrgggg bbbbaaaa
+    *hi = _mm_shuffle_epi8(*hi, planar);                      // RRRRGGGG BBBBAAAA
+    __m128i rg = _mm_unpacklo_epi32(*lo, *hi),                // rrrrRRRR ggggGGGG
+            ba = _mm_unpackhi_epi32(*lo, *hi);                // bbbbBBBB aaaaAAAA
+
+    // Unpack to 16-bit planar.
+    __m128i r = _mm_unpacklo_epi8(rg, zeros),                 // r_r_r_r_ R_R_R_R_
+            g = _mm_unpackhi_epi8(rg, zeros),                 // g_g_g_g_ G_G_G_G_
+            b = _mm_unpacklo_epi8(ba, zeros),                 // b_b_b_b_ B_B_B_B_
+            a = _mm_unpackhi_epi8(ba, zeros);                 // a_a_a_a_ A_A_A_A_
+
+    // Premultiply!
+    r = scale(r, a);
+    g = scale(g, a);
+    b = scale(b, a);
+
+    // Repack into interlaced pixels.
+    rg = _mm_or_si128(r, _mm_slli_epi16(g, 8));               // rgrgrgrg RGRGRGRG
+    ba = _mm_or_si128(b, _mm_slli_epi16(a, 8));               // babababa BABABABA
+    *lo = _mm_unpacklo_epi16(rg, ba);                         // rgbargba rgbargba
+    *hi = _mm_unpackhi_epi16(rg, ba);                         // RGBARGBA RGBARGBA
+}
 
-        // Swizzle the pixels to 8-bit planar.
-        *lo = _mm_shuffle_epi8(*lo, planar);                      // rrrrgggg bbbbaaaa
-        *hi = _mm_shuffle_epi8(*hi, planar);                      // RRRRGGGG BBBBAAAA
-        __m128i rg = _mm_unpacklo_epi32(*lo, *hi),                // rrrrRRRR ggggGGGG
-                ba = _mm_unpackhi_epi32(*lo, *hi);                // bbbbBBBB aaaaAAAA
+#if SK_CPU_SSE_LEVEL >= SK_CPU_SSE_LEVEL_AVX2
+// Same as scale() and premul8(), on 16 pixels.  Every step stays within its 128-bit lane, so
+// each lane of lo and hi is premultiplied just like premul8() would.
+static __m256i scale(__m256i x, __m256i y) {
+    const __m256i _128 = _mm256_set1_epi16(128);
+    const __m256i _257 = _mm256_set1_epi16(257);
+    return _mm256_mulhi_epu16(_mm256_add_epi16(_mm256_mullo_epi16(x, y), _128), _257);
+}
 
-        // Unpack to 16-bit planar.
-        __m128i r = _mm_unpacklo_epi8(rg, zeros),                 // r_r_r_r_ R_R_R_R_
-                g = _mm_unpackhi_epi8(rg, zeros),                 // g_g_g_g_ G_G_G_G_
-                b = _mm_unpacklo_epi8(ba, zeros),                 // b_b_b_b_ B_B_B_B_
-                a = _mm_unpackhi_epi8(ba, zeros);                 // a_a_a_a_ A_A_A_A_
+template <bool kSwapRB>
+static void premul16(__m256i* lo, __m256i* hi) {
+    const __m256i zeros = _mm256_setzero_si256();
+    __m256i planar;
+    if (kSwapRB) {
+        planar = _mm256_setr_epi8(2,6,10,14, 1,5,9,13, 0,4,8,12, 3,7,11,15,
+                                  2,6,10,14, 1,5,9,13, 0,4,8,12, 3,7,11,15);
+    } else {
+        planar = _mm256_setr_epi8(0,4,8,12, 1,5,9,13, 2,6,10,14, 3,7,11,15,
+                                  0,4,8,12, 1,5,9,13, 2,6,10,14, 3,7,11,15);
+    }
 
-        // Premultiply!
-        r = scale(r, a);
-        g = scale(g, a);
-        b = scale(b, a);
+    *lo = _mm256_shuffle_epi8(*lo, planar);
+    *hi = _mm256_shuffle_epi8(*hi, planar);
+    __m256i rg = _mm256_unpacklo_epi32(*lo, *hi),
+            ba = _mm256_unpackhi_epi32(*lo, *hi);
 
-        // Repack into interlaced pixels.
-        rg = _mm_or_si128(r, _mm_slli_epi16(g, 8));               // rgrgrgrg RGRGRGRG
-        ba = _mm_or_si128(b, _mm_slli_epi16(a, 8));               // babababa BABABABA
-        *lo = _mm_unpacklo_epi16(rg, ba);                         // rgbargba rgbargba
-        *hi = _mm_unpackhi_epi16(rg, ba);                         // RGBARGBA RGBARGBA
-    };
+    __m256i r = _mm256_unpacklo_epi8(rg, zeros),
+            g = _mm256_unpackhi_epi8(rg, zeros),
+            b = _mm256_unpacklo_epi8(ba, zeros),
+            a = _mm256_unpackhi_epi8(ba, zeros);
+
+    r = scale(r, a);
+    g = scale(g, a);
+    b = scale(b, a);
+
+    rg = _mm256_or_si256(r, _mm256_slli_epi16(g, 8));
+    ba = _mm256_or_si256(b, _mm256_slli_epi16(a, 8));
+    *lo = _mm256_unpacklo_epi16(rg, ba);
+    *hi = _mm256_unpackhi_epi16(rg, ba);
+}
+#endif
+
+template <bool kSwapRB>
+static void premul_should_swapRB(uint32_t* dst, const uint32_t* src, int count) {
+#if SK_CPU_SSE_LEVEL >= SK_CPU_SSE_LEVEL_AVX2
+    while (count >= 16) {
+        __m256i lo = _mm256_loadu_si256((const __m256i*) (src + 0)),
+                hi = _mm256_loadu_si256((const __m256i*) (src + 8));
+
+        premul16<kSwapRB>(&lo, &hi);
+
+        _mm256_storeu_si256((__m256i*) (dst + 0), lo);
+        _mm256_storeu_si256((__m256i*) (dst + 8), hi);
+
+        src += 16;
+        dst += 16;
+        count -= 16;
+    }
+#endif
 
     while (count >= 8) {
         __m128i lo = _mm_loadu_si128((const __m128i*) (src + 0)),
                 hi = _mm_loadu_si128((const __m128i*) (src + 4));
 
-        premul8(&lo, &hi);
+        premul8<kSwapRB>(&lo, &hi);
 
         _mm_storeu_si128((__m128i*) (dst + 0), lo);
         _mm_storeu_si128((__m128i*) (dst + 4), hi);
@@ -543,7 +884,7 @@ static void premul_should_swapRB(uint32_t* dst, const uint32_t* src, int count)
         __m128i lo = _mm_loadu_si128((const __m128i*) src),
                 hi = _mm_setzero_si128();
 
-        premul8(&lo, &hi);
+        premul8<kSwapRB>(&lo, &hi);
 
         _mm_storeu_si128((__m128i*) dst, lo);
 
@@ -568,6 +909,19 @@ static void premul_should_swapRB(uint32_t* dst, const uint32_t* src, int count)
 /*not static*/ inline void RGBA_to_BGRA(uint32_t* dst, const uint32_t* src, int count) {
     const __m128i swapRB = _mm_setr_epi8(2,1,0,3, 6,5,4,7, 10,9,8,11, 14,13,12,15);
 
+#if SK_CPU_SSE_LEVEL >= SK_CPU_SSE_LEVEL_AVX2
+    const __m256i swapRB256 = _mm256_broadcastsi128_si256(swapRB);
+    while (count >= 8) {
+        __m256i rgba = _mm256_loadu_si256((const __m256i*) src);
+        __m256i bgra = _mm256_shuffle_epi8(rgba, swapRB256);
+        _mm256_storeu_si256((__m256i*) dst, bgra);
+
+        src += 8;
+        dst += 8;
+        count -= 8;
+    }
+#endif
+
     while (count >= 4) {
         __m128i rgba = _mm_loadu_si128((const __m128i*) src);
         __m128i bgra = _mm_shuffle_epi8(rgba, swapRB);
@@ -774,6 +1128,204 @@ static void inverted_cmyk_to(uint32_t* dst, const uint32_t* src, int count) {
     inverted_cmyk_to<kBGR1>(dst, src, count);
 }
 
+// Keep the high byte of each big-endian channel of 4 RGB16 pixels, and insert an opaque alpha.
+template <bool kSwapRB>
+static void strip16_insert_alpha_should_swaprb(uint32_t dst[], const uint8_t* src, int count) {
+    const __m128i alphaMask = _mm_set1_epi32(0xFF000000);
+    const int8_t X = -1; // Zeroes the byte.
+    __m128i expandLo, expandHi;
+    if (kSwapRB) {
+        expandLo = _mm_setr_epi8(4,2,0,X, 10,8,6,X, X,X,X,X, X,X,X,X);
+        expandHi = _mm_setr_epi8(X,X,X,X, X,X,X,X, 8,6,4,X, 14,12,10,X);
+    } else {
+        expandLo = _mm_setr_epi8(0,2,4,X, 6,8,10,X, X,X,X,X, X,X,X,X);
+        expandHi = _mm_setr_epi8(X,X,X,X, X,X,X,X, 4,6,8,X, 10,12,14,X);
+    }
+
+    while (count >= 4) {
+        // 4 pixels are 24 bytes, so the second load overlaps the first by 8.
+        __m128i lo = _mm_loadu_si128((const __m128i*) (src + 0)),
+                hi = _mm_loadu_si128((const __m128i*) (src + 8));
+
+        __m128i rgba = _mm_or_si128(_mm_or_si128(_mm_shuffle_epi8(lo, expandLo),
+                                                 _mm_shuffle_epi8(hi, expandHi)),
+                                    alphaMask);
+
+        _mm_storeu_si128((__m128i*) dst, rgba);
+
+        src += 4*6;
+        dst += 4;
+        count -= 4;
+    }
+
+    auto proc = kSwapRB ? RGB16_to_BGR1_portable : RGB16_to_RGB1_portable;
+    proc(dst, src, count);
+}
+
+/*not static*/ inline void RGB16_to_RGB1(uint32_t dst[], const uint8_t* src, int count) {
+    strip16_insert_alpha_should_swaprb<false>(dst, src, count);
+}
+
+/*not static*/ inline void RGB16_to_BGR1(uint32_t dst[], const uint8_t* src, int count) {
+    strip16_insert_alpha_should_swaprb<true>(dst, src, count);
+}
+
+// Keep the high byte of each big-endian channel of 4 RGBA16 pixels.
+static __m128i strip16(const uint8_t* src) {
+    const int8_t X = -1;
+    const __m128i loBytes = _mm_setr_epi8(0,2,4,6, 8,10,12,14, X,X,X,X, X,X,X,X),
+                  hiBytes = _mm_setr_epi8(X,X,X,X, X,X,X,X, 0,2,4,6, 8,10,12,14);
+
+    __m128i lo = _mm_loadu_si128((const __m128i*) (src +  0)),
+            hi = _mm_loadu_si128((const __m128i*) (src + 16));
+    return _mm_or_si128(_mm_shuffle_epi8(lo, loBytes), _mm_shuffle_epi8(hi, hiBytes));
+}
+
+template <bool kSwapRB, bool kPremul>
+static void strip16_should_swapRB_premul(uint32_t dst[], const uint8_t* src, int count) {
+    const __m128i swapRB = _mm_setr_epi8(2,1,0,3, 6,5,4,7, 10,9,8,11, 14,13,12,15);
+
+    auto convert8 = [&](__m128i* lo, __m128i* hi) {
+        if (kPremul) {
+            premul8<kSwapRB>(lo, hi);
+        } else if (kSwapRB) {
+            *lo = _mm_shuffle_epi8(*lo, swapRB);
+            *hi = _mm_shuffle_epi8(*hi, swapRB);
+        }
+    };
+
+    while (count >= 8) {
+        __m128i lo = strip16(src +  0),
+                hi = strip16(src + 32);
+
+        convert8(&lo, &hi);
+
+        _mm_storeu_si128((__m128i*) (dst + 0), lo);
+        _mm_storeu_si128((__m128i*) (dst + 4), hi);
+
+        src += 8*8;
+        dst += 8;
+        count -= 8;
+    }
+
+    if (count >= 4) {
+        __m128i lo = strip16(src),
+                hi = _mm_setzero_si128();
+
+        convert8(&lo, &hi);
+
+        _mm_storeu_si128((__m128i*) dst, lo);
+
+        src += 4*8;
+        dst += 4;
+        count -= 4;
+    }
+
+    auto proc = kPremul ? (kSwapRB ? RGBA16_to_bgrA_portable : RGBA16_to_rgbA_portable)
+                        : (kSwapRB ? RGBA16_to_BGRA_portable : RGBA16_to_RGBA_portable);
+    proc(dst, src, count);
+}
+
+/*not static*/ inline void RGBA16_to_RGBA(uint32_t dst[], const uint8_t* src, int count) {
+    strip16_should_swapRB_premul<false, false>(dst, src, count);
+}
+
+/*not static*/ inline void RGBA16_to_BGRA(uint32_t dst[], const uint8_t* src, int count) {
+    strip16_should_swapRB_premul<true, false>(dst, src, count);
+}
+
+/*not static*/ inline void RGBA16_to_rgbA(uint32_t dst[], const uint8_t* src, int count) {
+    strip16_should_swapRB_premul<false, true>(dst, src, count);
+}
+
+/*not static*/ inline void RGBA16_to_bgrA(uint32_t dst[], const uint8_t* src, int count) {
+    strip16_should_swapRB_premul<true, true>(dst, src, count);
+}
+
+// Pack 4 RGBX pixels to 565, returned in the low 64 bits.
+static __m128i pack_565(__m128i rgbx) {
+    const int8_t X = -1;
+    __m128i r = _mm_slli_epi32(_mm_and_si128(rgbx, _mm_set1_epi32(0xF8)), SK_R16_SHIFT - 3),
+            g = _mm_and_si128(_mm_srli_epi32(rgbx, 8 + 2 - SK_G16_SHIFT),
+                              _mm_set1_epi32(SK_G16_MASK << SK_G16_SHIFT)),
+            b = _mm_and_si128(_mm_srli_epi32(rgbx, 16 + 3 - SK_B16_SHIFT),
+                              _mm_set1_epi32(SK_B16_MASK << SK_B16_SHIFT));
+    __m128i rgb = _mm_or_si128(_mm_or_si128(r, g), b);
+    return _mm_shuffle_epi8(rgb, _mm_setr_epi8(0,1,4,5, 8,9,12,13, X,X,X,X, X,X,X,X));
+}
+
+template <bool kSwapRB>
+static void RGB_to_565_should_swaprb(uint16_t dst[], const uint8_t* src, int count) {
+    const int8_t X = -1;
+    __m128i expand;
+    if (kSwapRB) {
+        expand = _mm_setr_epi8(2,1,0,X, 5,4,3,X, 8,7,6,X, 11,10,9,X);
+    } else {
+        expand = _mm_setr_epi8(0,1,2,X, 3,4,5,X, 6,7,8,X, 9,10,11,X);
+    }
+
+    while (count >= 6) {
+        // As in insert_alpha_should_swaprb(), only the first four pixels of the load are used.
+        __m128i rgb = _mm_loadu_si128((const __m128i*) src);
+
+        _mm_storel_epi64((__m128i*) dst, pack_565(_mm_shuffle_epi8(rgb, expand)));
+
+        src += 4*3;
+        dst += 4;
+        count -= 4;
+    }
+
+    auto proc = kSwapRB ? BGR_to_565_portable : RGB_to_565_portable;
+    proc(dst, src, count);
+}
+
+/*not static*/ inline void RGB_to_565(uint16_t dst[], const uint8_t* src, int count) {
+    RGB_to_565_should_swaprb<false>(dst, src, count);
+}
+
+/*not static*/ inline void BGR_to_565(uint16_t dst[], const uint8_t* src, int count) {
+    RGB_to_565_should_swaprb<true>(dst, src, count);
+}
+
+/*not static*/ inline void RGB16_to_565(uint16_t dst[], const uint8_t* src, int count) {
+    const int8_t X = -1;
+    const __m128i expandLo = _mm_setr_epi8(0,2,4,X, 6,8,10,X, X,X,X,X, X,X,X,X),
+                  expandHi = _mm_setr_epi8(X,X,X,X, X,X,X,X, 4,6,8,X, 10,12,14,X);
+
+    while (count >= 4) {
+        __m128i lo = _mm_loadu_si128((const __m128i*) (src + 0)),
+                hi = _mm_loadu_si128((const __m128i*) (src + 8));
+
+        __m128i rgbx = _mm_or_si128(_mm_shuffle_epi8(lo, expandLo),
+                                    _mm_shuffle_epi8(hi, expandHi));
+        _mm_storel_epi64((__m128i*) dst, pack_565(rgbx));
+
+        src += 4*6;
+        dst += 4;
+        count -= 4;
+    }
+
+    RGB16_to_565_portable(dst, src, count);
+}
+
+/*not static*/ inline void index_to_8888(uint32_t dst[], const uint8_t* src, int count,
+                                         const uint32_t table[]) {
+#if SK_CPU_SSE_LEVEL >= SK_CPU_SSE_LEVEL_AVX2
+    while (count >= 8) {
+        __m256i indices = _mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i*) src));
+        __m256i colors  = _mm256_i32gather_epi32((const int*) table, indices, 4);
+        _mm256_storeu_si256((__m256i*) dst, colors);
+
+        src += 8;
+        dst += 8;
+        count -= 8;
+    }
+#endif
+
+    // Before AVX2 there is no gather, and the unrolled table lookup is as fast as we can do.
+    index_to_8888_portable(dst, src, count, table);
+}
+
 #else
 
 /*not static*/ inline void RGBA_to_rgbA(uint32_t* dst, const uint32_t* src, int count) {
@@ -816,6 +1368,47 @@ static void inverted_cmyk_to(uint32_t* dst, const uint32_t* src, int count) {
     inverted_CMYK_to_BGR1_portable(dst, src, count);
 }
 
+/*not static*/ inline void RGB16_to_RGB1(uint32_t dst[], const uint8_t* src, int count) {
+    RGB16_to_RGB1_portable(dst, src, count);
+}
+
+/*not static*/ inline void RGB16_to_BGR1(uint32_t dst[], const uint8_t* src, int count) {
+    RGB16_to_BGR1_portable(dst, src, count);
+}
+
+/*not static*/ inline void RGBA16_to_RGBA(uint32_t dst[], const uint8_t* src, int count) {
+    RGBA16_to_RGBA_portable(dst, src, count);
+}
+
+/*not static*/ inline void RGBA16_to_BGRA(uint32_t dst[], const uint8_t* src, int count) {
+    RGBA16_to_BGRA_portable(dst, src, count);
+}
+
+/*not static*/ inline void RGBA16_to_rgbA(uint32_t dst[], const uint8_t* src, int count) {
+    RGBA16_to_rgbA_portable(dst, src, count);
+}
+
+/*not static*/ inline void RGBA16_to_bgrA(uint32_t dst[], const uint8_t* src, int count) {
+    RGBA16_to_bgrA_portable(dst, src, count);
+}
+
+/*not static*/ inline void RGB_to_565(uint16_t dst[], const uint8_t* src, int count) {
+    RGB_to_565_portable(dst, src, count);
+}
+
+/*not static*/ inline void BGR_to_565(uint16_t dst[], const uint8_t* src, int count) {
+    BGR_to_565_portable(dst, src, count);
+}
+
+/*not static*/ inline void RGB16_to_565(uint16_t dst[], const uint8_t* src, int count) {
+    RGB16_to_565_portable(dst, src, count);
+}
+
+/*not static*/ inline void index_to_8888(uint32_t dst[], const uint8_t* src, int count,
+                                         const uint32_t table[]) {
+    index_to_8888_portable(dst, src, count, table);
+}
+
 #endif
 
 }
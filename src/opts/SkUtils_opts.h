@@ -11,8 +11,32 @@
 #include <stdint.h>
 #include "SkNx.h"
 
+#if defined(SK_CPU_SSE_LEVEL) && SK_CPU_SSE_LEVEL >= SK_CPU_SSE_LEVEL_AVX512
+    #include <immintrin.h>
+#endif
+
 namespace SK_OPTS_NS {
 
+#if defined(SK_CPU_SSE_LEVEL) && SK_CPU_SSE_LEVEL >= SK_CPU_SSE_LEVEL_AVX512
+    // SkNx has no 512-bit types, so we splat and store whole zmm registers ourselves.
+    static inline __m512i splat512(uint16_t v) { return _mm512_set1_epi16((short)v); }
+    static inline __m512i splat512(uint32_t v) { return _mm512_set1_epi32((int)v); }
+    static inline __m512i splat512(uint64_t v) { return _mm512_set1_epi64((long long)v); }
+
+    template <typename T>
+    static void memsetT(T buffer[], T value, int count) {
+        static const int N = 64 / sizeof(T);
+        const __m512i splat = splat512(value);
+        while (count >= N) {
+            _mm512_storeu_si512(buffer, splat);
+            buffer += N;
+            count  -= N;
+        }
+        while (count --> 0) {
+            *buffer++ = value;
+        }
+    }
+#else
     template <typename T>
     static void memsetT(T buffer[], T value, int count) {
     #if defined(SK_CPU_SSE_LEVEL) && SK_CPU_SSE_LEVEL >= SK_CPU_SSE_LEVEL_AVX
@@ -29,6 +53,7 @@ namespace SK_OPTS_NS {
             *buffer++ = value;
         }
     }
+#endif
 
     /*not static*/ inline void memset16(uint16_t buffer[], uint16_t value, int count) {
         memsetT(buffer, value, count);
@@ -11,6 +11,10 @@
 #include "SkPathPriv.h"
 #include "SkPathOps.h"
 #include "SkPathOpsCommon.h"
+#include "SkTaskGroup.h"
+
+#include <algorithm>
+#include <atomic>
 
 static bool one_contour(const SkPath& path) {
     SkSTArenaAlloc<256> allocator;
@@ -146,6 +150,18 @@ bool SkOpBuilder::resolve(SkPath* result) {
             } else if (firstDir != dir) {
                 ReversePath(test);
             }
+            // A convex path must not overlap an earlier path that is not convex either.
+            const SkRect& testBounds = test->getBounds();
+            for (int inner = 0; inner < index; ++inner) {
+                if (!fPathRefs[inner].isConvex() &&
+                        SkRect::Intersects(fPathRefs[inner].getBounds(), testBounds)) {
+                    allUnion = false;
+                    break;
+                }
+            }
+            if (!allUnion) {
+                break;
+            }
             continue;
         }
         // If the path is not convex but its bounds do not intersect the others, simplify is enough.
@@ -193,3 +209,114 @@ bool SkOpBuilder::resolve(SkPath* result) {
     }
     return success;
 }
+
+static int find_cluster(SkTDArray<int>& parent, int index) {
+    while (parent[index] != index) {
+        parent[index] = parent[parent[index]];
+        index = parent[index];
+    }
+    return index;
+}
+
+// Unlike SkRect::Intersects(), counts rects that only share an edge, so that paths which abut
+// are unioned together.
+static bool touches(const SkRect& a, const SkRect& b) {
+    return a.fLeft <= b.fRight && b.fLeft <= a.fRight &&
+           a.fTop <= b.fBottom && b.fTop <= a.fBottom;
+}
+
+bool SkOpBuilder::resolve(SkPath* result, SkExecutor* executor) {
+    int count = fOps.count();
+    for (int index = 0; index < count; ++index) {
+        const SkPath& path = fPathRefs[index];
+        if (kUnion_SkPathOp != fOps[index] || path.isInverseFillType() || !path.isFinite()) {
+            return this->resolve(result);
+        }
+    }
+
+    // Sweep the bounds from left to right, joining paths that touch into clusters.
+    SkTDArray<int> order;
+    for (int index = 0; index < count; ++index) {
+        if (!fPathRefs[index].isEmpty()) {
+            *order.append() = index;
+        }
+    }
+    std::sort(order.begin(), order.end(), [this](int a, int b) {
+        return fPathRefs[a].getBounds().fLeft < fPathRefs[b].getBounds().fLeft;
+    });
+    SkTDArray<int> parent;
+    parent.setCount(count);
+    for (int index = 0; index < count; ++index) {
+        parent[index] = index;
+    }
+    SkTDArray<int> active;
+    for (int index : order) {
+        const SkRect& bounds = fPathRefs[index].getBounds();
+        int live = 0;
+        for (int other : active) {
+            const SkRect& otherBounds = fPathRefs[other].getBounds();
+            if (otherBounds.fRight < bounds.fLeft) {
+                continue;  // Nothing later in the sweep can touch it either.
+            }
+            active[live++] = other;
+            if (touches(bounds, otherBounds)) {
+                parent[find_cluster(parent, other)] = find_cluster(parent, index);
+            }
+        }
+        active.setCount(live);
+        *active.append() = index;
+    }
+
+    // Gather each cluster's paths, keeping the order they were added in.
+    SkTArray<SkOpBuilder> clusters;
+    SkTDArray<int> clusterOf;
+    clusterOf.setCount(count);
+    for (int index = 0; index < count; ++index) {
+        clusterOf[index] = -1;
+    }
+    for (int index = 0; index < count; ++index) {
+        if (fPathRefs[index].isEmpty()) {
+            continue;
+        }
+        int root = find_cluster(parent, index);
+        if (clusterOf[root] < 0) {
+            clusterOf[root] = clusters.count();
+            clusters.push_back();
+        }
+        clusters[clusterOf[root]].add(fPathRefs[index], kUnion_SkPathOp);
+    }
+    if (clusters.count() <= 1) {
+        return this->resolve(result);
+    }
+    reset();
+
+    SkTArray<SkPath> products(clusters.count());
+    products.push_back_n(clusters.count());
+    std::atomic<bool> success{true};
+    auto resolveCluster = [&](int index) {
+        if (!clusters[index].resolve(&products[index])) {
+            success = false;
+        }
+    };
+    if (executor) {
+        SkTaskGroup(*executor).batch(clusters.count(), resolveCluster);
+    } else {
+        for (int index = 0; index < clusters.count(); ++index) {
+            resolveCluster(index);
+        }
+    }
+    if (!success) {
+        // As resolve() does on failure, leave *result as it was: only the products were written.
+        return false;
+    }
+
+    // The clusters do not overlap, so their union is just all their contours together.
+    SkPath sum;
+    sum.setFillType(SkPath::kEvenOdd_FillType);
+    for (const SkPath& product : products) {
+        SkASSERT(!product.isInverseFillType());
+        sum.addPath(product);
+    }
+    *result = sum;
+    return true;
+}
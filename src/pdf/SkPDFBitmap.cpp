@@ -136,12 +136,9 @@ static void do_deflated_alpha(const SkPixmap& pm, SkPDFDocument* doc, SkPDFIndir
 
 static void do_deflated_image(const SkPixmap& pm,
                               SkPDFDocument* doc,
-                              bool isOpaque,
-                              SkPDFIndirectReference ref) {
-    SkPDFIndirectReference sMask;
-    if (!isOpaque) {
-        sMask = doc->reserveRef();
-    }
+                              SkPDFIndirectReference ref,
+                              SkPDFIndirectReference sMask) {
+    bool isOpaque = !sMask;
     SkDynamicMemoryWStream buffer;
     SkDeflateWStream deflateWStream(&buffer);
     const char* colorSpace = "DeviceGray";
@@ -245,28 +242,48 @@ static SkBitmap to_pixels(const SkImage* image) {
     return bm;
 }
 
+// Every reserved reference has to be emitted, so fill in a soft mask the image didn't need.
+static void emit_unused_mask(SkPDFDocument* doc, SkPDFIndirectReference sMask) {
+    if (sMask) {
+        doc->emit(SkPDFDict(), sMask);
+    }
+}
+
 void serialize_image(const SkImage* img,
                      int encodingQuality,
                      SkPDFDocument* doc,
-                     SkPDFIndirectReference ref) {
+                     SkPDFIndirectReference ref,
+                     SkPDFIndirectReference sMask) {
     SkASSERT(img);
     SkASSERT(doc);
     SkASSERT(encodingQuality >= 0);
     SkISize dimensions = img->dimensions();
     sk_sp<SkData> data = img->refEncodedData();
     if (data && do_jpeg(std::move(data), doc, dimensions, ref)) {
+        emit_unused_mask(doc, sMask);
         return;
     }
     SkBitmap bm = to_pixels(img);
     SkPixmap pm = bm.pixmap();
     bool isOpaque = pm.isOpaque() || pm.computeIsOpaque();
+    SkASSERT(isOpaque || sMask);
+    if (isOpaque) {
+        emit_unused_mask(doc, sMask);
+        sMask = SkPDFIndirectReference();
+    }
     if (encodingQuality <= 100 && isOpaque) {
         sk_sp<SkData> data = img->encodeToData(SkEncodedImageFormat::kJPEG, encodingQuality);
         if (data && do_jpeg(std::move(data), doc, dimensions, ref)) {
             return;
         }
     }
-    do_deflated_image(pm, doc, isOpaque, ref);
+    do_deflated_image(pm, doc, ref, sMask);
+}
+
+// Decoded images may only find out they are opaque by looking at every pixel.
+static bool is_known_opaque(const SkImage* img) {
+    SkPixmap pm;
+    return img->isOpaque() || (img->peekPixels(&pm) && pm.computeIsOpaque());
 }
 
 SkPDFIndirectReference SkPDFSerializeImage(const SkImage* img,
@@ -275,16 +292,24 @@ SkPDFIndirectReference SkPDFSerializeImage(const SkImage* img,
     SkASSERT(img);
     SkASSERT(doc);
     SkPDFIndirectReference ref = doc->reserveRef();
+    // The soft mask's reference is reserved here, rather than when the image is serialized, so
+    // that object numbers don't depend on the order the executor runs jobs in.
+    SkPDFIndirectReference sMask = is_known_opaque(img) ? SkPDFIndirectReference()
+                                                         : doc->reserveRef();
     if (SkExecutor* executor = doc->executor()) {
         SkRef(img);
+        doc->reserveOutputSlot(ref);
+        if (sMask) {
+            doc->reserveOutputSlot(sMask);
+        }
         doc->incrementJobCount();
-        executor->add([img, encodingQuality, doc, ref]() {
-            serialize_image(img, encodingQuality, doc, ref);
+        executor->add([img, encodingQuality, doc, ref, sMask]() {
+            serialize_image(img, encodingQuality, doc, ref, sMask);
             SkSafeUnref(img);
             doc->signalJobComplete();
         });
         return ref;
     }
-    serialize_image(img, encodingQuality, doc, ref);
+    serialize_image(img, encodingQuality, doc, ref, sMask);
     return ref;
 }
@@ -206,21 +206,62 @@ SkPDFDocument::~SkPDFDocument() {
 }
 
 SkPDFIndirectReference SkPDFDocument::emit(const SkPDFObject& object, SkPDFIndirectReference ref){
-    object.emitObject(this->beginObject(ref));
-    this->endObject();
+    SkWStream* stream = this->beginObject(ref);
+    object.emitObject(stream);
+    this->endObject(stream);
     return ref;
 }
 
+void SkPDFDocument::reserveOutputSlot(SkPDFIndirectReference ref) {
+    SkAutoMutexAcquire autoMutexAcquire(fMutex);
+    fPendingObjects.emplace_back(new PendingObject(ref));
+    fReservedSlots.set(ref.fValue, fPendingObjects.back().get());
+}
+
 SkWStream* SkPDFDocument::beginObject(SkPDFIndirectReference ref) {
     fMutex.acquire();
+    PendingObject* pending = nullptr;
+    if (PendingObject** slot = fReservedSlots.find(ref.fValue)) {
+        pending = *slot;
+        fReservedSlots.remove(ref.fValue);
+    } else if (!fPendingObjects.empty()) {
+        fPendingObjects.emplace_back(new PendingObject(ref));
+        pending = fPendingObjects.back().get();
+    }
+    if (pending && pending != fPendingObjects.front().get()) {
+        // Buffer the object without holding the lock; endObject() writes it out once
+        // everything ahead of it has been written.
+        fMutex.release();
+        return pending;
+    }
+    // Nothing is waiting ahead of this object, so write it straight to the document, holding
+    // the lock until endObject().
+    if (pending) {
+        fPendingObjects.pop_front();
+    }
     begin_indirect_object(&fOffsetMap, ref, this->getStream());
     return this->getStream();
-};
+}
 
-void SkPDFDocument::endObject() {
-    end_indirect_object(this->getStream());
+void SkPDFDocument::endObject(SkWStream* stream) {
+    end_indirect_object(stream);
+    if (stream != this->getStream()) {
+        fMutex.acquire();
+        static_cast<PendingObject*>(stream)->fDone = true;
+    }
+    this->writePendingObjects();
     fMutex.release();
-};
+}
+
+void SkPDFDocument::writePendingObjects() {
+    fMutex.assertHeld();
+    while (!fPendingObjects.empty() && fPendingObjects.front()->fDone) {
+        std::unique_ptr<PendingObject> pending = std::move(fPendingObjects.front());
+        fPendingObjects.pop_front();
+        begin_indirect_object(&fOffsetMap, pending->fRef, this->getStream());
+        pending->writeToAndReset(this->getStream());
+    }
+}
 
 static SkSize operator*(SkISize u, SkScalar s) { return SkSize{u.width() * s, u.height() * s}; }
 static SkSize operator*(SkSize u, SkScalar s) { return SkSize{u.width() * s, u.height() * s}; }
@@ -490,6 +531,7 @@ void SkPDFDocument::onClose(SkWStream* stream) {
     this->waitForJobs();
     {
         SkAutoMutexAcquire autoMutexAcquire(fMutex);
+        SkASSERT(fPendingObjects.empty());
         serialize_footer(fOffsetMap, this->getStream(), fInfoDict, docCatalogRef, fUUID);
     }
 }
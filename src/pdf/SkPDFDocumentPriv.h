@@ -16,6 +16,7 @@
 #include "SkTHash.h"
 
 #include <atomic>
+#include <deque>
 #include <vector>
 #include <memory>
 
@@ -78,7 +79,7 @@ public:
         stream->writeText(" stream\n");
         writeStream(stream);
         stream->writeText("\nendstream");
-        this->endObject();
+        this->endObject(stream);
     }
 
     const SkPDF::Metadata& metadata() const { return fMetadata; }
@@ -92,6 +93,10 @@ public:
     SkExecutor* executor() const { return fExecutor; }
     void incrementJobCount();
     void signalJobComplete();
+    // Holds a place in the output for an object that a job on the executor will emit.  Objects
+    // are written in the order they are emitted or have their places held, so the file is the
+    // same no matter which job finishes first.
+    void reserveOutputSlot(SkPDFIndirectReference);
     size_t currentPageIndex() { return fPages.size(); }
     size_t pageCount() { return fPageRefs.size(); }
 
@@ -131,12 +136,23 @@ private:
     // For tagged PDFs.
     SkPDFTagTree fTagTree;
 
+    // An object that can't be written yet because objects ahead of it are still being serialized.
+    struct PendingObject : public SkDynamicMemoryWStream {
+        explicit PendingObject(SkPDFIndirectReference ref) : fRef(ref) {}
+        SkPDFIndirectReference fRef;
+        bool fDone = false;
+    };
+
     SkMutex fMutex;
     SkSemaphore fSemaphore;
+    // Guarded by fMutex.
+    std::deque<std::unique_ptr<PendingObject>> fPendingObjects;
+    SkTHashMap<int, PendingObject*> fReservedSlots;
 
     void waitForJobs();
     SkWStream* beginObject(SkPDFIndirectReference);
-    void endObject();
+    void endObject(SkWStream*);
+    void writePendingObjects();
 };
 
 #endif  // SkPDFDocumentPriv_DEFINED
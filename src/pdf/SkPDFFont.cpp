@@ -311,24 +311,37 @@ static void emit_subset_type0(const SkPDFFont& font, SkPDFDocument* doc) {
                 if (!SkToBool(metrics.fFlags &
                               SkAdvancedTypefaceMetrics::kNotSubsettable_FontFlag)) {
                     SkASSERT(font.firstGlyphID() == 1);
-                    sk_sp<SkData> subsetFontData = SkPDFSubsetFont(
-                            stream_to_data(std::move(fontAsset)), font.glyphUsage(),
-                            metrics.fFontName.c_str(), ttcIndex);
-                    if (subsetFontData) {
-                        std::unique_ptr<SkPDFDict> tmp = SkPDFMakeDict();
-                        tmp->insertInt("Length1", SkToInt(subsetFontData->size()));
-                        descriptor->insertRef(
-                                "FontFile2",
-                                SkPDFStreamOut(std::move(tmp),
-                                               SkMemoryStream::Make(std::move(subsetFontData)),
-                                               doc, true));
-                        break;
-                    }
-                    // If subsetting fails, fall back to original font data.
-                    fontAsset = face->openStream(&ttcIndex);
-                    SkASSERT(fontAsset);
-                    SkASSERT(fontAsset->getLength() == fontSize);
-                    if (!fontAsset || fontAsset->getLength() == 0) { break; }
+                    // Subsetting is slow, so let it run on the executor with the compression.
+                    // The font lives in the document's font map, which outlives the job.
+                    fontAsset = nullptr;
+                    sk_sp<SkTypeface> typeface = sk_ref_sp(face);
+                    const SkPDFGlyphUse* glyphUsage = &font.glyphUsage();
+                    SkString fontName = metrics.fFontName;
+                    descriptor->insertRef("FontFile2", SkPDFStreamOutDeferred(
+                            nullptr,
+                            [typeface, glyphUsage, fontName](SkPDFDict* dict)
+                                    -> std::unique_ptr<SkStreamAsset> {
+                                int ttcIndex;
+                                std::unique_ptr<SkStreamAsset> fontAsset =
+                                        typeface->openStream(&ttcIndex);
+                                sk_sp<SkData> subsetFontData = SkPDFSubsetFont(
+                                        stream_to_data(std::move(fontAsset)), *glyphUsage,
+                                        fontName.c_str(), ttcIndex);
+                                if (subsetFontData) {
+                                    dict->insertInt("Length1", SkToInt(subsetFontData->size()));
+                                    return SkMemoryStream::Make(std::move(subsetFontData));
+                                }
+                                // If subsetting fails, fall back to original font data.
+                                fontAsset = typeface->openStream(&ttcIndex);
+                                SkASSERT(fontAsset);
+                                if (!fontAsset) {
+                                    fontAsset = skstd::make_unique<SkMemoryStream>();
+                                }
+                                dict->insertInt("Length1", fontAsset->getLength());
+                                return fontAsset;
+                            },
+                            doc, true));
+                    break;
                 }
                 std::unique_ptr<SkPDFDict> tmp = SkPDFMakeDict();
                 tmp->insertInt("Length1", fontSize);
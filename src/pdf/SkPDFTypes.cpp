@@ -472,6 +472,7 @@ SkPDFIndirectReference SkPDFStreamOut(std::unique_ptr<SkPDFDict> dict,
         SkStreamAsset* contentPtr = content.release();
         // Pass ownership of both pointers into a std::function, which should
         // only be executed once.
+        doc->reserveOutputSlot(ref);
         doc->incrementJobCount();
         executor->add([dictPtr, contentPtr, deflate, doc, ref]() {
             serialize_stream(dictPtr, contentPtr, deflate, doc, ref);
@@ -484,3 +485,29 @@ SkPDFIndirectReference SkPDFStreamOut(std::unique_ptr<SkPDFDict> dict,
     serialize_stream(dict.get(), content.get(), deflate, doc, ref);
     return ref;
 }
+
+SkPDFIndirectReference SkPDFStreamOutDeferred(
+        std::unique_ptr<SkPDFDict> dict,
+        std::function<std::unique_ptr<SkStreamAsset>(SkPDFDict*)> makeContent,
+        SkPDFDocument* doc,
+        bool deflate) {
+    SkPDFIndirectReference ref = doc->reserveRef();
+    if (!dict) {
+        dict = SkPDFMakeDict();
+    }
+    if (SkExecutor* executor = doc->executor()) {
+        SkPDFDict* dictPtr = dict.release();
+        doc->reserveOutputSlot(ref);
+        doc->incrementJobCount();
+        executor->add([dictPtr, makeContent, deflate, doc, ref]() {
+            std::unique_ptr<SkStreamAsset> content = makeContent(dictPtr);
+            serialize_stream(dictPtr, content.get(), deflate, doc, ref);
+            delete dictPtr;
+            doc->signalJobComplete();
+        });
+        return ref;
+    }
+    std::unique_ptr<SkStreamAsset> content = makeContent(dict.get());
+    serialize_stream(dict.get(), content.get(), deflate, doc, ref);
+    return ref;
+}
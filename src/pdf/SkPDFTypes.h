@@ -15,6 +15,7 @@
 #include "SkTypes.h"
 #include "SkMakeUnique.h"
 
+#include <functional>
 #include <new>
 #include <type_traits>
 #include <utility>
@@ -201,4 +202,13 @@ SkPDFIndirectReference SkPDFStreamOut(std::unique_ptr<SkPDFDict> dict,
                                       std::unique_ptr<SkStreamAsset> stream,
                                       SkPDFDocument* doc,
                                       bool deflate = kSkPDFDefaultDoDeflate);
+
+/** Like SkPDFStreamOut, but the content is produced by makeContent, which may also add entries
+    to the dictionary.  If the document has an executor, makeContent runs there along with the
+    compression. */
+SkPDFIndirectReference SkPDFStreamOutDeferred(
+        std::unique_ptr<SkPDFDict> dict,
+        std::function<std::unique_ptr<SkStreamAsset>(SkPDFDict*)> makeContent,
+        SkPDFDocument* doc,
+        bool deflate = kSkPDFDefaultDoDeflate);
 #endif
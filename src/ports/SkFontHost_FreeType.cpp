@@ -235,6 +235,9 @@ private:
 
 struct SkFaceRec;
 
+// gFTMutex guards the library and the list of open faces. Each FT_Face is guarded by its own
+// SkFaceRec::fFaceMutex, so scaler contexts on different faces can load and render glyphs
+// concurrently. When both are needed, gFTMutex must be acquired first.
 SK_DECLARE_STATIC_MUTEX(gFTMutex);
 static FreeTypeLibrary* gFTLibrary;
 static SkFaceRec* gFaceRecHead;
@@ -279,6 +282,9 @@ struct SkFaceRec {
     uint32_t fRefCnt;
     uint32_t fFontID;
 
+    // An FT_Face may only be used by one thread at a time; this serializes all use of fFace.
+    SkMutex fFaceMutex;
+
     // FreeType prior to 2.7.1 does not implement retreiving variation design metrics.
     // Cache the variation design metrics used to create the font if the user specifies them.
     SkAutoSTMalloc<4, SkFixed> fAxes;
@@ -462,10 +468,14 @@ public:
         gFTMutex.acquire();
         SkASSERT_RELEASE(ref_ft_library());
         fFaceRec = ref_ft_face(tf);
+        if (fFaceRec) {
+            fFaceRec->fFaceMutex.acquire();
+        }
     }
 
     ~AutoFTAccess() {
         if (fFaceRec) {
+            fFaceRec->fFaceMutex.release();
             unref_ft_face(fFaceRec);
         }
         unref_ft_library();
@@ -531,9 +541,9 @@ private:
     void getBBoxForCurrentGlyph(const SkGlyph* glyph, FT_BBox* bbox,
                                 bool snapToPixelBoundary = false);
     bool getCBoxForLetter(char letter, FT_BBox* bbox);
-    // Caller must lock gFTMutex before calling this function.
+    // Caller must lock fFaceRec->fFaceMutex before calling this function.
     void updateGlyphIfLCD(SkGlyph* glyph);
-    // Caller must lock gFTMutex before calling this function.
+    // Caller must lock fFaceRec->fFaceMutex before calling this function.
     // update FreeType2 glyph slot with glyph emboldened
     void emboldenIfNeeded(FT_Face face, FT_GlyphSlot glyph, SkGlyphID gid);
     bool shouldSubpixelBitmap(const SkGlyph&, const SkMatrix&);
@@ -826,10 +836,12 @@ SkScalerContext_FreeType::SkScalerContext_FreeType(sk_sp<SkTypeface> typeface,
     , fFTSize(nullptr)
     , fStrikeIndex(-1)
 {
-    SkAutoMutexAcquire  ac(gFTMutex);
-    SkASSERT_RELEASE(ref_ft_library());
+    {
+        SkAutoMutexAcquire  ac(gFTMutex);
+        SkASSERT_RELEASE(ref_ft_library());
 
-    fFaceRec.reset(ref_ft_face(this->getTypeface()));
+        fFaceRec.reset(ref_ft_face(this->getTypeface()));
+    }
 
     // load the font file
     if (nullptr == fFaceRec) {
@@ -837,6 +849,8 @@ SkScalerContext_FreeType::SkScalerContext_FreeType(sk_sp<SkTypeface> typeface,
         return;
     }
 
+    SkAutoMutexAcquire  ac(fFaceRec->fFaceMutex);
+
     fLCDIsVert = SkToBool(fRec.fFlags & SkScalerContext::kLCD_Vertical_Flag);
 
     // compute the flags we send to Load_Glyph
@@ -1004,6 +1018,7 @@ SkScalerContext_FreeType::~SkScalerContext_FreeType() {
     SkAutoMutexAcquire  ac(gFTMutex);
 
     if (fFTSize != nullptr) {
+        SkAutoMutexAcquire  faceLock(fFaceRec->fFaceMutex);
         FT_Done_Size(fFTSize);
     }
 
@@ -1016,7 +1031,7 @@ SkScalerContext_FreeType::~SkScalerContext_FreeType() {
     this face with other context (at different sizes).
 */
 FT_Error SkScalerContext_FreeType::setupSize() {
-    gFTMutex.assertHeld();
+    fFaceRec->fFaceMutex.assertHeld();
     FT_Error err = FT_Activate_Size(fFTSize);
     if (err != 0) {
         return err;
@@ -1030,7 +1045,7 @@ unsigned SkScalerContext_FreeType::generateGlyphCount() {
 }
 
 uint16_t SkScalerContext_FreeType::generateCharToGlyph(SkUnichar uni) {
-    SkAutoMutexAcquire  ac(gFTMutex);
+    SkAutoMutexAcquire  ac(fFaceRec->fFaceMutex);
     return SkToU16(FT_Get_Char_Index( fFace, uni ));
 }
 
@@ -1042,7 +1057,7 @@ bool SkScalerContext_FreeType::generateAdvance(SkGlyph* glyph) {
         return false;
     }
 
-    SkAutoMutexAcquire  ac(gFTMutex);
+    SkAutoMutexAcquire  ac(fFaceRec->fFaceMutex);
 
     if (this->setupSize()) {
         glyph->zeroMetrics();
@@ -1147,7 +1162,7 @@ bool SkScalerContext_FreeType::shouldSubpixelBitmap(const SkGlyph& glyph, const
 }
 
 void SkScalerContext_FreeType::generateMetrics(SkGlyph* glyph) {
-    SkAutoMutexAcquire  ac(gFTMutex);
+    SkAutoMutexAcquire  ac(fFaceRec->fFaceMutex);
 
     glyph->fMaskFormat = fRec.fMaskFormat;
 
@@ -1303,7 +1318,7 @@ static void clear_glyph_image(const SkGlyph& glyph) {
 }
 
 void SkScalerContext_FreeType::generateImage(const SkGlyph& glyph) {
-    SkAutoMutexAcquire  ac(gFTMutex);
+    SkAutoMutexAcquire  ac(fFaceRec->fFaceMutex);
 
     if (this->setupSize()) {
         clear_glyph_image(glyph);
@@ -1336,7 +1351,7 @@ void SkScalerContext_FreeType::generateImage(const SkGlyph& glyph) {
 bool SkScalerContext_FreeType::generatePath(SkGlyphID glyphID, SkPath* path) {
     SkASSERT(path);
 
-    SkAutoMutexAcquire  ac(gFTMutex);
+    SkAutoMutexAcquire  ac(fFaceRec->fFaceMutex);
 
     // FT_IS_SCALABLE is documented to mean the face contains outline glyphs.
     if (!FT_IS_SCALABLE(fFace) || this->setupSize()) {
@@ -1377,7 +1392,7 @@ void SkScalerContext_FreeType::generateFontMetrics(SkFontMetrics* metrics) {
         return;
     }
 
-    SkAutoMutexAcquire ac(gFTMutex);
+    SkAutoMutexAcquire ac(fFaceRec->fFaceMutex);
 
     if (this->setupSize()) {
         sk_bzero(metrics, sizeof(*metrics));
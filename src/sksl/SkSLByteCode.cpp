@@ -0,0 +1,196 @@
+/*
+ * Copyright 2018 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#ifndef SKSL_STANDALONE
+
+#include "SkSLByteCode.h"
+
+#include "SkNx.h"
+#include "SkTemplates.h"
+
+#include <cmath>
+#include <cstring>
+
+namespace SkSL {
+
+static constexpr int kLanes = ByteCode::kMaxLanes;
+
+void ByteCode::run(int n, float* args[]) const {
+    SkASSERT(0 < n && n <= kLanes);
+    // We always work on whole Sk4f / Sk4i, so round up; the extra lanes are never active.
+    const int stride = (n + 3) & ~3;
+
+    SkAutoSTMalloc<32 * kLanes, int32_t> storage(fSlotCount * kLanes +
+                                                 (fMaxMaskDepth + 1) * kLanes);
+    int32_t* slots = storage.get();
+    sk_bzero(slots, fSlotCount * kLanes * sizeof(int32_t));
+    auto slot = [slots](int index) { return slots + index * kLanes; };
+
+    for (const Constant& c : fConstants) {
+        Sk4i bits(c.fBits);
+        for (int i = 0; i < stride; i += 4) {
+            bits.store(slot(c.fSlot) + i);
+        }
+    }
+    for (size_t p = 0; p < fParameterSlots.size(); ++p) {
+        memcpy(slot(fParameterSlots[p]), args[p], n * sizeof(float));
+    }
+
+    // The mask stack lives after the slots; mask points at its top.
+    int32_t* mask = slots + fSlotCount * kLanes;
+    for (int i = 0; i < kLanes; ++i) {
+        mask[i] = i < n ? ~0 : 0;
+    }
+
+    #define LANES(body) for (int i = 0; i < stride; i += 4) { body; } break
+
+    #define BINARY_F(expr) {                                              \
+        const float* A = (const float*) slot(inst.fA);                    \
+        const float* B = (const float*) slot(inst.fB);                    \
+        float* D = (float*) slot(inst.fDst);                              \
+        LANES(Sk4f a = Sk4f::Load(A + i); Sk4f b = Sk4f::Load(B + i);     \
+              (expr).store(D + i));                                       \
+    }
+    #define BINARY_I(expr) {                                              \
+        const int32_t* A = slot(inst.fA);                                 \
+        const int32_t* B = slot(inst.fB);                                 \
+        int32_t* D = slot(inst.fDst);                                     \
+        LANES(Sk4i a = Sk4i::Load(A + i); Sk4i b = Sk4i::Load(B + i);     \
+              (expr).store(D + i));                                       \
+    }
+    #define UNARY_F(expr) {                                               \
+        const float* A = (const float*) slot(inst.fA);                    \
+        float* D = (float*) slot(inst.fDst);                              \
+        LANES(Sk4f a = Sk4f::Load(A + i); (expr).store(D + i));           \
+    }
+    #define UNARY_I(expr) {                                               \
+        const int32_t* A = slot(inst.fA);                                 \
+        int32_t* D = slot(inst.fDst);                                     \
+        LANES(Sk4i a = Sk4i::Load(A + i); (expr).store(D + i));           \
+    }
+
+    const Sk4i kTrue(~0);
+    const Instruction* code = fCode.data();
+    const int count = (int) fCode.size();
+    for (int pc = 0; pc < count;) {
+        const Instruction& inst = code[pc++];
+        switch (inst.fOp) {
+            case Op::kAddF: BINARY_F(a + b);
+            case Op::kSubF: BINARY_F(a - b);
+            case Op::kMulF: BINARY_F(a * b);
+            case Op::kDivF: BINARY_F(a / b);
+            case Op::kMinF: BINARY_F(Sk4f::Min(a, b));
+            case Op::kMaxF: BINARY_F(Sk4f::Max(a, b));
+            case Op::kLtF:  BINARY_F(a <  b);
+            case Op::kGtF:  BINARY_F(a >  b);
+            case Op::kLteF: BINARY_F(a <= b);
+            case Op::kGteF: BINARY_F(a >= b);
+            case Op::kEqF:  BINARY_F(a == b);
+            case Op::kNeqF: BINARY_F(a != b);
+
+            case Op::kAddI: BINARY_I(a + b);
+            case Op::kSubI: BINARY_I(a - b);
+            case Op::kMulI: BINARY_I(a * b);
+            case Op::kAnd:  BINARY_I(a & b);
+            case Op::kOr:   BINARY_I(a | b);
+            case Op::kXor:  BINARY_I(a ^ b);
+            case Op::kLtI:  BINARY_I(a < b);
+            case Op::kGtI:  BINARY_I(a > b);
+            case Op::kLteI: BINARY_I((a > b) ^ kTrue);
+            case Op::kGteI: BINARY_I((a < b) ^ kTrue);
+            case Op::kEqI:  BINARY_I(a == b);
+            case Op::kNeqI: BINARY_I((a == b) ^ kTrue);
+            case Op::kDivI: {
+                // There's no vector integer divide. Inactive lanes may hold anything, including
+                // zero or INT_MIN / -1, so they divide by 1 instead.
+                const int32_t* A = slot(inst.fA);
+                const int32_t* B = slot(inst.fB);
+                int32_t* D = slot(inst.fDst);
+                for (int i = 0; i < stride; ++i) {
+                    D[i] = A[i] / (mask[i] ? B[i] : 1);
+                }
+                break;
+            }
+
+            case Op::kNegF:  UNARY_F(-a);
+            case Op::kAbsF:  UNARY_F(a.abs());
+            case Op::kSqrtF: UNARY_F(a.sqrt());
+            case Op::kNegI:  UNARY_I(Sk4i(0) - a);
+            case Op::kNot:   UNARY_I(a ^ kTrue);
+            case Op::kFloatToInt: {
+                const float* A = (const float*) slot(inst.fA);
+                int32_t* D = slot(inst.fDst);
+                LANES(SkNx_cast<int>(Sk4f::Load(A + i)).store(D + i));
+            }
+            case Op::kIntToFloat: {
+                const int32_t* A = slot(inst.fA);
+                float* D = (float*) slot(inst.fDst);
+                LANES(SkNx_cast<float>(Sk4i::Load(A + i)).store(D + i));
+            }
+
+            case Op::kCopy:
+                memcpy(slot(inst.fDst), slot(inst.fA), stride * sizeof(int32_t));
+                break;
+            case Op::kStore: {
+                const int32_t* A = slot(inst.fA);
+                int32_t* D = slot(inst.fDst);
+                LANES(Sk4i::Load(mask + i).thenElse(Sk4i::Load(A + i), Sk4i::Load(D + i))
+                          .store(D + i));
+            }
+            case Op::kSelect: {
+                const int32_t* C = slot(inst.fA);
+                const int32_t* T = slot(inst.fB);
+                int32_t* D = slot(inst.fDst);
+                LANES(Sk4i::Load(C + i).thenElse(Sk4i::Load(T + i), Sk4i::Load(D + i))
+                          .store(D + i));
+            }
+
+            case Op::kMaskPush: {
+                const int32_t* A = slot(inst.fA);
+                const int32_t* saved = mask;
+                mask += kLanes;
+                LANES((Sk4i::Load(saved + i) & Sk4i::Load(A + i)).store(mask + i));
+            }
+            case Op::kMaskElse: {
+                const int32_t* A = slot(inst.fA);
+                const int32_t* saved = mask - kLanes;
+                LANES((Sk4i::Load(saved + i) & (Sk4i::Load(A + i) ^ kTrue)).store(mask + i));
+            }
+            case Op::kMaskPop:
+                mask -= kLanes;
+                break;
+
+            case Op::kJump:
+                pc = inst.fDst;
+                break;
+            case Op::kJumpIfMaskZero: {
+                int32_t any = 0;
+                for (int i = 0; i < stride; ++i) {
+                    any |= mask[i];
+                }
+                if (!any) {
+                    pc = inst.fDst;
+                }
+                break;
+            }
+        }
+    }
+
+    #undef LANES
+    #undef BINARY_F
+    #undef BINARY_I
+    #undef UNARY_F
+    #undef UNARY_I
+
+    for (size_t p = 0; p < fParameterSlots.size(); ++p) {
+        memcpy(args[p], slot(fParameterSlots[p]), n * sizeof(float));
+    }
+}
+
+} // namespace
+
+#endif
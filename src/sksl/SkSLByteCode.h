@@ -0,0 +1,80 @@
+/*
+ * Copyright 2018 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#ifndef SKSL_BYTECODE
+#define SKSL_BYTECODE
+
+#include "SkRasterPipeline.h"
+
+#include <cstdint>
+#include <vector>
+
+namespace SkSL {
+
+/**
+ * A function compiled to linear bytecode by ByteCodeGenerator.
+ *
+ * Every instruction operates on up to kMaxLanes invocations at once. Each slot holds one 32-bit
+ * value (float, int, or bool as 0 / ~0) per lane. Control flow that differs between lanes is
+ * handled with an execution mask: writes to variables only land in active lanes, and branches are
+ * only taken when no lane is active.
+ */
+struct ByteCode {
+    static constexpr int kMaxLanes = SkRasterPipeline_kMaxStride;
+
+    enum class Op : uint8_t {
+        // dst = a op b
+        kAddF, kSubF, kMulF, kDivF,
+        kAddI, kSubI, kMulI, kDivI,
+        kAnd, kOr, kXor,
+        kLtF, kGtF, kLteF, kGteF, kEqF, kNeqF,
+        kLtI, kGtI, kLteI, kGteI, kEqI, kNeqI,
+        kMinF, kMaxF,
+        // dst = op a
+        kNegF, kNegI, kNot, kAbsF, kSqrtF,
+        kFloatToInt, kIntToFloat,
+        // dst = a, in every lane; used for temporaries
+        kCopy,
+        // dst = a, in active lanes only; used for variables
+        kStore,
+        // dst = fA ? fB : fDst, with fA the condition
+        kSelect,
+        // Execution mask: push the current mask and narrow it to (mask & a); switch the top
+        // of the stack to (saved mask & ~a); or restore the saved mask.
+        kMaskPush, kMaskElse, kMaskPop,
+        // Jump to instruction fDst unconditionally, or if no lane is active.
+        kJump, kJumpIfMaskZero,
+    };
+
+    struct Instruction {
+        Op       fOp;
+        uint16_t fDst;
+        uint16_t fA;
+        uint16_t fB;
+    };
+
+    struct Constant {
+        uint16_t fSlot;
+        int32_t  fBits;
+    };
+
+    /**
+     * Runs the function on n lanes. args holds one array of n floats per parameter; parameters
+     * are read from and written back to those arrays.
+     */
+    void run(int n, float* args[]) const;
+
+    std::vector<Instruction> fCode;
+    std::vector<Constant>    fConstants;
+    std::vector<uint16_t>    fParameterSlots;
+    int                      fSlotCount = 0;
+    int                      fMaxMaskDepth = 0;
+};
+
+} // namespace
+
+#endif
@@ -0,0 +1,496 @@
+/*
+ * Copyright 2018 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#ifndef SKSL_STANDALONE
+
+#include "SkSLByteCodeGenerator.h"
+
+#include "ir/SkSLBinaryExpression.h"
+#include "ir/SkSLBlock.h"
+#include "ir/SkSLBoolLiteral.h"
+#include "ir/SkSLConstructor.h"
+#include "ir/SkSLExpressionStatement.h"
+#include "ir/SkSLFloatLiteral.h"
+#include "ir/SkSLForStatement.h"
+#include "ir/SkSLFunctionCall.h"
+#include "ir/SkSLIfStatement.h"
+#include "ir/SkSLIntLiteral.h"
+#include "ir/SkSLPostfixExpression.h"
+#include "ir/SkSLPrefixExpression.h"
+#include "ir/SkSLTernaryExpression.h"
+#include "ir/SkSLVarDeclarations.h"
+#include "ir/SkSLVarDeclarationsStatement.h"
+#include "ir/SkSLVariableReference.h"
+#include "ir/SkSLWhileStatement.h"
+
+#include <cstring>
+
+namespace SkSL {
+
+using Op = ByteCode::Op;
+
+static int32_t float_bits(float f) {
+    int32_t bits;
+    memcpy(&bits, &f, sizeof(bits));
+    return bits;
+}
+
+static bool is_jump(Op op) {
+    return Op::kJump == op || Op::kJumpIfMaskZero == op;
+}
+
+ByteCodeGenerator::TypeKind ByteCodeGenerator::GetTypeKind(const Type& type) {
+    if (type.kind() != Type::kScalar_Kind) {
+        return TypeKind::kUnsupported;
+    }
+    if (type.isFloat()) {
+        return TypeKind::kFloat;
+    }
+    if (type.isSigned()) {
+        return TypeKind::kInt;
+    }
+    return type.name() == "bool" ? TypeKind::kBool : TypeKind::kUnsupported;
+}
+
+std::unique_ptr<ByteCode> ByteCodeGenerator::generate(const FunctionDefinition& f) {
+    std::unique_ptr<ByteCode> result(new ByteCode());
+    fByteCode = result.get();
+    fVariables.clear();
+    fConstants.clear();
+    fNamedSlots = 0;
+    fTempSlots = 0;
+    fMaxTempSlots = 0;
+    fMaskDepth = 0;
+    fFailed = false;
+
+    if (f.fDeclaration.fReturnType.name() != "void") {
+        this->fail();
+    }
+    for (const Variable* param : f.fDeclaration.fParameters) {
+        if (TypeKind::kUnsupported == GetTypeKind(param->fType)) {
+            this->fail();
+        }
+        fByteCode->fParameterSlots.push_back(this->variable(*param));
+    }
+    this->writeStatement(*f.fBody);
+    fByteCode = nullptr;
+
+    if (fFailed || fNamedSlots + fMaxTempSlots >= kTempBit || result->fCode.size() >= kTempBit) {
+        return nullptr;
+    }
+
+    // Now that all variables and constants are known, move the temporaries above them.
+    auto relocate = [this](uint16_t* slot) {
+        if (*slot & kTempBit) {
+            *slot = (*slot & ~kTempBit) + fNamedSlots;
+        }
+    };
+    for (ByteCode::Instruction& inst : result->fCode) {
+        if (!is_jump(inst.fOp)) {
+            relocate(&inst.fDst);
+            relocate(&inst.fA);
+            relocate(&inst.fB);
+        }
+    }
+    result->fSlotCount = fNamedSlots + fMaxTempSlots;
+    return result;
+}
+
+uint16_t ByteCodeGenerator::fail() {
+    fFailed = true;
+    return 0;
+}
+
+uint16_t ByteCodeGenerator::allocTemp() {
+    int result = fTempSlots++;
+    fMaxTempSlots = SkTMax(fMaxTempSlots, fTempSlots);
+    return (uint16_t) (result | kTempBit);
+}
+
+uint16_t ByteCodeGenerator::copyToTemp(uint16_t slot) {
+    if (slot & kTempBit) {
+        return slot;
+    }
+    uint16_t result = this->allocTemp();
+    this->write(Op::kCopy, result, slot);
+    return result;
+}
+
+uint16_t ByteCodeGenerator::constant(int32_t bits) {
+    auto found = fConstants.find(bits);
+    if (found != fConstants.end()) {
+        return found->second;
+    }
+    uint16_t slot = (uint16_t) fNamedSlots++;
+    fConstants[bits] = slot;
+    fByteCode->fConstants.push_back({ slot, bits });
+    return slot;
+}
+
+uint16_t ByteCodeGenerator::variable(const Variable& var) {
+    auto found = fVariables.find(&var);
+    if (found != fVariables.end()) {
+        return found->second;
+    }
+    uint16_t slot = (uint16_t) fNamedSlots++;
+    fVariables[&var] = slot;
+    return slot;
+}
+
+void ByteCodeGenerator::write(Op op, uint16_t dst, uint16_t a, uint16_t b) {
+    fByteCode->fCode.push_back({ op, dst, a, b });
+}
+
+int ByteCodeGenerator::writeJump(Op op) {
+    this->write(op, 0);
+    return (int) fByteCode->fCode.size() - 1;
+}
+
+void ByteCodeGenerator::setJumpTarget(int jump) {
+    fByteCode->fCode[jump].fDst = (uint16_t) fByteCode->fCode.size();
+}
+
+uint16_t ByteCodeGenerator::writeStore(const Expression& lvalue, uint16_t value) {
+    if (Expression::kVariableReference_Kind != lvalue.fKind) {
+        return this->fail();
+    }
+    uint16_t slot = this->variable(((const VariableReference&) lvalue).fVariable);
+    this->write(Op::kStore, slot, value);
+    return slot;
+}
+
+uint16_t ByteCodeGenerator::writeExpression(const Expression& expr) {
+    if (fFailed) {
+        return 0;
+    }
+    if (TypeKind::kUnsupported == GetTypeKind(expr.fType)) {
+        return this->fail();
+    }
+    switch (expr.fKind) {
+        case Expression::kBinary_Kind:
+            return this->writeBinaryExpression((const BinaryExpression&) expr);
+        case Expression::kBoolLiteral_Kind:
+            return this->constant(((const BoolLiteral&) expr).fValue ? ~0 : 0);
+        case Expression::kConstructor_Kind:
+            return this->writeConstructor((const Constructor&) expr);
+        case Expression::kFloatLiteral_Kind:
+            return this->constant(float_bits((float) ((const FloatLiteral&) expr).fValue));
+        case Expression::kFunctionCall_Kind:
+            return this->writeFunctionCall((const FunctionCall&) expr);
+        case Expression::kIntLiteral_Kind:
+            return this->constant((int32_t) ((const IntLiteral&) expr).fValue);
+        case Expression::kPrefix_Kind:
+            return this->writePrefixExpression((const PrefixExpression&) expr);
+        case Expression::kPostfix_Kind:
+            return this->writePostfixExpression((const PostfixExpression&) expr);
+        case Expression::kTernary_Kind:
+            return this->writeTernaryExpression((const TernaryExpression&) expr);
+        case Expression::kVariableReference_Kind:
+            return this->variable(((const VariableReference&) expr).fVariable);
+        default:
+            return this->fail();
+    }
+}
+
+uint16_t ByteCodeGenerator::writeBinaryExpression(const BinaryExpression& b) {
+    const TypeKind kind = GetTypeKind(b.fLeft->fType);
+    const bool isFloat = TypeKind::kFloat == kind;
+
+    switch (b.fOperator) {
+        case Token::EQ:
+            return this->writeStore(*b.fLeft, this->writeExpression(*b.fRight));
+        case Token::LOGICALAND:
+        case Token::LOGICALOR: {
+            // The right side only runs (i.e. only has side effects) in lanes where it would be
+            // evaluated by a scalar implementation.
+            uint16_t left = this->writeExpression(*b.fLeft);
+            uint16_t right;
+            if (b.fRight->hasSideEffects()) {
+                left = this->copyToTemp(left);
+                uint16_t cond = left;
+                if (Token::LOGICALOR == b.fOperator) {
+                    cond = this->allocTemp();
+                    this->write(Op::kNot, cond, left);
+                }
+                this->write(Op::kMaskPush, 0, cond);
+                fByteCode->fMaxMaskDepth = SkTMax(fByteCode->fMaxMaskDepth, ++fMaskDepth);
+                right = this->writeExpression(*b.fRight);
+                this->write(Op::kMaskPop, 0);
+                --fMaskDepth;
+            } else {
+                right = this->writeExpression(*b.fRight);
+            }
+            uint16_t result = this->allocTemp();
+            this->write(Token::LOGICALAND == b.fOperator ? Op::kAnd : Op::kOr, result, left, right);
+            return result;
+        }
+        default:
+            break;
+    }
+
+    Op op;
+    bool compound = false;
+    switch (b.fOperator) {
+        case Token::PLUSEQ:       compound = true; // fall through
+        case Token::PLUS:         op = isFloat ? Op::kAddF : Op::kAddI; break;
+        case Token::MINUSEQ:      compound = true; // fall through
+        case Token::MINUS:        op = isFloat ? Op::kSubF : Op::kSubI; break;
+        case Token::STAREQ:       compound = true; // fall through
+        case Token::STAR:         op = isFloat ? Op::kMulF : Op::kMulI; break;
+        case Token::SLASHEQ:      compound = true; // fall through
+        case Token::SLASH:        op = isFloat ? Op::kDivF : Op::kDivI; break;
+        case Token::BITWISEANDEQ: compound = true; // fall through
+        case Token::BITWISEAND:   op = Op::kAnd; break;
+        case Token::BITWISEOREQ:  compound = true; // fall through
+        case Token::BITWISEOR:    op = Op::kOr;  break;
+        case Token::BITWISEXOREQ: compound = true; // fall through
+        case Token::BITWISEXOR:   // fall through
+        case Token::LOGICALXOR:   op = Op::kXor; break;
+        case Token::LT:           op = isFloat ? Op::kLtF  : Op::kLtI;  break;
+        case Token::GT:           op = isFloat ? Op::kGtF  : Op::kGtI;  break;
+        case Token::LTEQ:         op = isFloat ? Op::kLteF : Op::kLteI; break;
+        case Token::GTEQ:         op = isFloat ? Op::kGteF : Op::kGteI; break;
+        case Token::EQEQ:         op = isFloat ? Op::kEqF  : Op::kEqI;  break;
+        case Token::NEQ:          op = isFloat ? Op::kNeqF : Op::kNeqI; break;
+        default:
+            return this->fail();
+    }
+    if (isFloat && (Op::kAnd == op || Op::kOr == op || Op::kXor == op)) {
+        return this->fail();
+    }
+    uint16_t left = this->writeExpression(*b.fLeft);
+    uint16_t right = this->writeExpression(*b.fRight);
+    uint16_t result = this->allocTemp();
+    this->write(op, result, left, right);
+    if (compound) {
+        return this->writeStore(*b.fLeft, result);
+    }
+    return result;
+}
+
+uint16_t ByteCodeGenerator::writeConstructor(const Constructor& c) {
+    if (c.fArguments.size() != 1) {
+        return this->fail();
+    }
+    const TypeKind from = GetTypeKind(c.fArguments[0]->fType);
+    const TypeKind to = GetTypeKind(c.fType);
+    uint16_t arg = this->writeExpression(*c.fArguments[0]);
+    if (from == to) {
+        return arg;
+    }
+    uint16_t result = this->allocTemp();
+    if (TypeKind::kInt == from && TypeKind::kFloat == to) {
+        this->write(Op::kIntToFloat, result, arg);
+    } else if (TypeKind::kFloat == from && TypeKind::kInt == to) {
+        this->write(Op::kFloatToInt, result, arg);
+    } else {
+        return this->fail();
+    }
+    return result;
+}
+
+uint16_t ByteCodeGenerator::writeFunctionCall(const FunctionCall& c) {
+    const FunctionDeclaration& f = c.fFunction;
+    if (!f.fBuiltin || TypeKind::kFloat != GetTypeKind(c.fType)) {
+        return this->fail();
+    }
+    std::vector<uint16_t> args;
+    for (const auto& arg : c.fArguments) {
+        args.push_back(this->writeExpression(*arg));
+    }
+    uint16_t result = this->allocTemp();
+    if ("abs" == f.fName && 1 == args.size()) {
+        this->write(Op::kAbsF, result, args[0]);
+    } else if ("sqrt" == f.fName && 1 == args.size()) {
+        this->write(Op::kSqrtF, result, args[0]);
+    } else if ("clamp" == f.fName && 3 == args.size()) {
+        this->write(Op::kMaxF, result, args[0], args[1]);
+        this->write(Op::kMinF, result, result, args[2]);
+    } else {
+        return this->fail();
+    }
+    return result;
+}
+
+uint16_t ByteCodeGenerator::writePrefixExpression(const PrefixExpression& p) {
+    const bool isFloat = TypeKind::kFloat == GetTypeKind(p.fType);
+    switch (p.fOperator) {
+        case Token::MINUS: {
+            uint16_t operand = this->writeExpression(*p.fOperand);
+            uint16_t result = this->allocTemp();
+            this->write(isFloat ? Op::kNegF : Op::kNegI, result, operand);
+            return result;
+        }
+        case Token::LOGICALNOT:
+        case Token::BITWISENOT: {
+            if (isFloat) {
+                return this->fail();
+            }
+            uint16_t operand = this->writeExpression(*p.fOperand);
+            uint16_t result = this->allocTemp();
+            this->write(Op::kNot, result, operand);
+            return result;
+        }
+        case Token::PLUSPLUS:
+        case Token::MINUSMINUS: {
+            uint16_t operand = this->writeExpression(*p.fOperand);
+            uint16_t one = isFloat ? this->constant(float_bits(1.0f)) : this->constant(1);
+            uint16_t result = this->allocTemp();
+            if (Token::PLUSPLUS == p.fOperator) {
+                this->write(isFloat ? Op::kAddF : Op::kAddI, result, operand, one);
+            } else {
+                this->write(isFloat ? Op::kSubF : Op::kSubI, result, operand, one);
+            }
+            return this->writeStore(*p.fOperand, result);
+        }
+        default:
+            return this->fail();
+    }
+}
+
+uint16_t ByteCodeGenerator::writePostfixExpression(const PostfixExpression& p) {
+    const bool isFloat = TypeKind::kFloat == GetTypeKind(p.fType);
+    uint16_t operand = this->writeExpression(*p.fOperand);
+    uint16_t result = this->allocTemp();
+    this->write(Op::kCopy, result, operand);
+    uint16_t one = isFloat ? this->constant(float_bits(1.0f)) : this->constant(1);
+    uint16_t updated = this->allocTemp();
+    if (Token::PLUSPLUS == p.fOperator) {
+        this->write(isFloat ? Op::kAddF : Op::kAddI, updated, operand, one);
+    } else {
+        SkASSERT(Token::MINUSMINUS == p.fOperator);
+        this->write(isFloat ? Op::kSubF : Op::kSubI, updated, operand, one);
+    }
+    this->writeStore(*p.fOperand, updated);
+    return result;
+}
+
+uint16_t ByteCodeGenerator::writeTernaryExpression(const TernaryExpression& t) {
+    uint16_t test = this->writeExpression(*t.fTest);
+    uint16_t result = this->allocTemp();
+    if (t.fIfTrue->hasSideEffects() || t.fIfFalse->hasSideEffects()) {
+        test = this->copyToTemp(test);
+        this->write(Op::kMaskPush, 0, test);
+        fByteCode->fMaxMaskDepth = SkTMax(fByteCode->fMaxMaskDepth, ++fMaskDepth);
+        uint16_t ifTrue = this->writeExpression(*t.fIfTrue);
+        this->write(Op::kCopy, result, ifTrue);
+        this->write(Op::kMaskElse, 0, test);
+        uint16_t ifFalse = this->writeExpression(*t.fIfFalse);
+        this->write(Op::kMaskPop, 0);
+        --fMaskDepth;
+        uint16_t selected = this->allocTemp();
+        this->write(Op::kCopy, selected, ifFalse);
+        this->write(Op::kSelect, selected, test, result);
+        return selected;
+    }
+    uint16_t ifTrue = this->writeExpression(*t.fIfTrue);
+    uint16_t ifFalse = this->writeExpression(*t.fIfFalse);
+    this->write(Op::kCopy, result, ifFalse);
+    this->write(Op::kSelect, result, test, ifTrue);
+    return result;
+}
+
+void ByteCodeGenerator::writeLoop(const Expression* test, const Statement& body,
+                                  const Expression* next) {
+    // Lanes drop out of the loop as their test fails; since their variables stop changing, the
+    // test keeps failing for them on later iterations. The loop ends when no lane is left.
+    if (!test) {
+        this->fail();
+        return;
+    }
+    int loop = (int) fByteCode->fCode.size();
+    int savedTemps = fTempSlots;
+    this->write(Op::kMaskPush, 0, this->writeExpression(*test));
+    fByteCode->fMaxMaskDepth = SkTMax(fByteCode->fMaxMaskDepth, ++fMaskDepth);
+    int exit = this->writeJump(Op::kJumpIfMaskZero);
+    fTempSlots = savedTemps;
+    this->writeStatement(body);
+    if (next) {
+        this->writeExpression(*next);
+        fTempSlots = savedTemps;
+    }
+    this->write(Op::kMaskPop, 0);
+    this->write(Op::kJump, (uint16_t) loop);
+    this->setJumpTarget(exit);
+    this->write(Op::kMaskPop, 0);
+    --fMaskDepth;
+}
+
+void ByteCodeGenerator::writeStatement(const Statement& s) {
+    if (fFailed) {
+        return;
+    }
+    // Temporaries only live as long as the statement that computes them.
+    int savedTemps = fTempSlots;
+    switch (s.fKind) {
+        case Statement::kBlock_Kind:
+            for (const auto& child : ((const Block&) s).fStatements) {
+                this->writeStatement(*child);
+            }
+            break;
+        case Statement::kExpression_Kind:
+            this->writeExpression(*((const ExpressionStatement&) s).fExpression);
+            break;
+        case Statement::kFor_Kind: {
+            const ForStatement& f = (const ForStatement&) s;
+            if (f.fInitializer) {
+                this->writeStatement(*f.fInitializer);
+            }
+            this->writeLoop(f.fTest.get(), *f.fStatement, f.fNext.get());
+            break;
+        }
+        case Statement::kIf_Kind: {
+            const IfStatement& i = (const IfStatement&) s;
+            // The branches may change the variables the test depends on, so hold on to its value
+            // for the else.
+            uint16_t test = this->copyToTemp(this->writeExpression(*i.fTest));
+            this->write(Op::kMaskPush, 0, test);
+            fByteCode->fMaxMaskDepth = SkTMax(fByteCode->fMaxMaskDepth, ++fMaskDepth);
+            int skipTrue = this->writeJump(Op::kJumpIfMaskZero);
+            this->writeStatement(*i.fIfTrue);
+            this->setJumpTarget(skipTrue);
+            if (i.fIfFalse) {
+                this->write(Op::kMaskElse, 0, test);
+                int skipFalse = this->writeJump(Op::kJumpIfMaskZero);
+                this->writeStatement(*i.fIfFalse);
+                this->setJumpTarget(skipFalse);
+            }
+            this->write(Op::kMaskPop, 0);
+            --fMaskDepth;
+            break;
+        }
+        case Statement::kNop_Kind:
+            break;
+        case Statement::kVarDeclarations_Kind:
+            for (const auto& decl : ((const VarDeclarationsStatement&) s).fDeclaration->fVars) {
+                const VarDeclaration& v = (const VarDeclaration&) *decl;
+                if (v.fSizes.size() || TypeKind::kUnsupported == GetTypeKind(v.fVar->fType)) {
+                    this->fail();
+                    return;
+                }
+                uint16_t slot = this->variable(*v.fVar);
+                if (v.fValue) {
+                    this->write(Op::kStore, slot, this->writeExpression(*v.fValue));
+                }
+            }
+            break;
+        case Statement::kWhile_Kind: {
+            const WhileStatement& w = (const WhileStatement&) s;
+            this->writeLoop(w.fTest.get(), *w.fStatement, nullptr);
+            break;
+        }
+        default:
+            // return, break, continue, discard, do, switch
+            this->fail();
+            break;
+    }
+    fTempSlots = savedTemps;
+}
+
+} // namespace
+
+#endif
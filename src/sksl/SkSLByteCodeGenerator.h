@@ -0,0 +1,104 @@
+/*
+ * Copyright 2018 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#ifndef SKSL_BYTECODEGENERATOR
+#define SKSL_BYTECODEGENERATOR
+
+#include "SkSLByteCode.h"
+#include "ir/SkSLExpression.h"
+#include "ir/SkSLFunctionDefinition.h"
+#include "ir/SkSLStatement.h"
+
+#include <memory>
+#include <unordered_map>
+
+namespace SkSL {
+
+struct BinaryExpression;
+struct Constructor;
+struct FunctionCall;
+struct PostfixExpression;
+struct PrefixExpression;
+struct TernaryExpression;
+
+/**
+ * Compiles a function to ByteCode. Only the subset of SkSL that pipeline stage callbacks need is
+ * supported: scalar float, int and bool values, arithmetic, comparisons, if, for and while, and
+ * the abs, sqrt and clamp intrinsics. Anything else makes generate() return null, and the caller
+ * is expected to fall back to the tree-walking Interpreter.
+ */
+class ByteCodeGenerator {
+public:
+    std::unique_ptr<ByteCode> generate(const FunctionDefinition& f);
+
+private:
+    enum class TypeKind {
+        kFloat,
+        kInt,
+        kBool,
+        kUnsupported,
+    };
+
+    static TypeKind GetTypeKind(const Type& type);
+
+    // Temporaries are numbered from kTempBit up while generating and are moved above the
+    // variables and constants once we know how many of those there are.
+    static constexpr uint16_t kTempBit = 0x8000;
+
+    uint16_t allocTemp();
+
+    // Returns slot if it is already a temporary, or a temporary holding a copy of it.
+    uint16_t copyToTemp(uint16_t slot);
+
+    uint16_t constant(int32_t bits);
+
+    uint16_t variable(const Variable& var);
+
+    void write(ByteCode::Op op, uint16_t dst, uint16_t a = 0, uint16_t b = 0);
+
+    // Returns the index of the emitted instruction, whose target is patched by setJumpTarget().
+    int writeJump(ByteCode::Op op);
+
+    void setJumpTarget(int jump);
+
+    // Returns the slot holding the value of the expression.
+    uint16_t writeExpression(const Expression& expr);
+
+    uint16_t writeBinaryExpression(const BinaryExpression& b);
+
+    uint16_t writeConstructor(const Constructor& c);
+
+    uint16_t writeFunctionCall(const FunctionCall& c);
+
+    uint16_t writePrefixExpression(const PrefixExpression& p);
+
+    uint16_t writePostfixExpression(const PostfixExpression& p);
+
+    uint16_t writeTernaryExpression(const TernaryExpression& t);
+
+    // Writes a masked store to the variable referenced by lvalue, and returns its slot.
+    uint16_t writeStore(const Expression& lvalue, uint16_t value);
+
+    void writeStatement(const Statement& s);
+
+    void writeLoop(const Expression* test, const Statement& body, const Expression* next);
+
+    uint16_t fail();
+
+    ByteCode* fByteCode = nullptr;
+    std::unordered_map<const Variable*, uint16_t> fVariables;
+    std::unordered_map<int32_t, uint16_t> fConstants;
+    int fNamedSlots = 0;
+    int fTempSlots = 0;
+    int fMaxTempSlots = 0;
+    int fMaskDepth = 0;
+    bool fFailed = false;
+};
+
+} // namespace
+
+#endif
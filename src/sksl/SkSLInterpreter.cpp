@@ -8,7 +8,9 @@
 #ifndef SKSL_STANDALONE
 
 #include "SkSLInterpreter.h"
+#include "SkSLByteCodeGenerator.h"
 #include "ir/SkSLBinaryExpression.h"
+#include "ir/SkSLConstructor.h"
 #include "ir/SkSLExpressionStatement.h"
 #include "ir/SkSLForStatement.h"
 #include "ir/SkSLFunctionCall.h"
@@ -27,6 +29,20 @@
 
 namespace SkSL {
 
+struct Interpreter::CallbackCtx : public SkRasterPipeline_CallbackCtx {
+    Interpreter* fInterpreter;
+    const FunctionDefinition* fFunction;
+    const ByteCode* fByteCode;
+};
+
+Interpreter::Interpreter(std::unique_ptr<Program> program, SkRasterPipeline* pipeline,
+                         std::vector<Value>* stack)
+    : fProgram(std::move(program))
+    , fPipeline(*pipeline)
+    , fStack(*stack) {}
+
+Interpreter::~Interpreter() {}
+
 void Interpreter::run() {
     for (const auto& e : *fProgram) {
         if (ProgramElement::kFunction_Kind == e.fKind) {
@@ -51,10 +67,14 @@ void Interpreter::run(const FunctionDefinition& f) {
         current -= SizeOf(f.fDeclaration.fParameters[i]->fType);
         fVars.back()[f.fDeclaration.fParameters[i]] = current;
     }
+    const size_t stackSize = fStack.size();
     fCurrentIndex.push_back({ f.fBody.get(), 0 });
     while (fCurrentIndex.size()) {
         this->runStatement();
     }
+    // Drop f's locals so the caller finds its arguments back on top of the stack.
+    fStack.resize(stackSize, Value((int) 0xDEADBEEF));
+    fVars.pop_back();
 }
 
 void Interpreter::push(Value value) {
@@ -212,13 +232,24 @@ Interpreter::StackIndex Interpreter::getLValue(const Expression& expr) {
     ABORT("unsupported lvalue");
 }
 
-struct CallbackCtx : public SkRasterPipeline_CallbackCtx {
-    Interpreter* fInterpreter;
-    const FunctionDefinition* fFunction;
-};
-
-static void do_callback(SkRasterPipeline_CallbackCtx* raw, int activePixels) {
+void Interpreter::DoCallback(SkRasterPipeline_CallbackCtx* raw, int activePixels) {
     CallbackCtx& ctx = (CallbackCtx&) *raw;
+    if (ctx.fByteCode) {
+        float r[ByteCode::kMaxLanes], g[ByteCode::kMaxLanes], b[ByteCode::kMaxLanes];
+        for (int i = 0; i < activePixels; ++i) {
+            r[i] = ctx.rgba[i * 4 + 0];
+            g[i] = ctx.rgba[i * 4 + 1];
+            b[i] = ctx.rgba[i * 4 + 2];
+        }
+        float* args[] = { r, g, b };
+        ctx.fByteCode->run(activePixels, args);
+        for (int i = 0; i < activePixels; ++i) {
+            ctx.read_from[i * 4 + 0] = r[i];
+            ctx.read_from[i * 4 + 1] = g[i];
+            ctx.read_from[i * 4 + 2] = b[i];
+        }
+        return;
+    }
     for (int i = 0; i < activePixels; ++i) {
         ctx.fInterpreter->push(Interpreter::Value(ctx.rgba[i * 4 + 0]));
         ctx.fInterpreter->push(Interpreter::Value(ctx.rgba[i * 4 + 1]));
@@ -230,28 +261,45 @@ static void do_callback(SkRasterPipeline_CallbackCtx* raw, int activePixels) {
     }
 }
 
+const ByteCode* Interpreter::byteCode(const FunctionDefinition& f) {
+    auto found = fByteCode.find(&f);
+    if (found == fByteCode.end()) {
+        found = fByteCode.emplace(&f, ByteCodeGenerator().generate(f)).first;
+    }
+    return found->second.get();
+}
+
 void Interpreter::appendStage(const AppendStage& a) {
+    // fArguments[0] is the pipeline itself.
     switch (a.fStage) {
         case SkRasterPipeline::matrix_4x5: {
-            SkASSERT(a.fArguments.size() == 1);
-            StackIndex transpose = evaluate(*a.fArguments[0]).fInt;
+            SkASSERT(a.fArguments.size() == 2);
+            StackIndex transpose = evaluate(*a.fArguments[1]).fInt;
             fPipeline.append(SkRasterPipeline::matrix_4x5, &fStack[transpose]);
             break;
         }
         case SkRasterPipeline::callback: {
-            SkASSERT(a.fArguments.size() == 1);
-            CallbackCtx* ctx = new CallbackCtx();
+            SkASSERT(a.fArguments.size() == 2);
+            SkASSERT(a.fArguments[1]->fKind == Expression::kFunctionReference_Kind);
+            fCallbackContexts.emplace_back(new CallbackCtx());
+            CallbackCtx* ctx = fCallbackContexts.back().get();
             ctx->fInterpreter = this;
-            ctx->fn = do_callback;
+            ctx->fn = DoCallback;
+            ctx->fFunction = nullptr;
             for (const auto& e : *fProgram) {
                 if (ProgramElement::kFunction_Kind == e.fKind) {
                     const FunctionDefinition& f = (const FunctionDefinition&) e;
                     if (&f.fDeclaration ==
-                                      ((const FunctionReference&) *a.fArguments[0]).fFunctions[0]) {
+                                      ((const FunctionReference&) *a.fArguments[1]).fFunctions[0]) {
                         ctx->fFunction = &f;
                     }
                 }
             }
+            SkASSERT(ctx->fFunction);
+            ctx->fByteCode = nullptr;
+            if (fByteCodeEnabled && 3 == ctx->fFunction->fDeclaration.fParameters.size()) {
+                ctx->fByteCode = this->byteCode(*ctx->fFunction);
+            }
             fPipeline.append(SkRasterPipeline::callback, ctx);
             break;
         }
@@ -261,7 +309,22 @@ void Interpreter::appendStage(const AppendStage& a) {
 }
 
 Interpreter::Value Interpreter::call(const FunctionCall& c) {
-    abort();
+    const FunctionDeclaration& f = c.fFunction;
+    if (f.fBuiltin && type_kind(c.fType) == kFloat_TypeKind) {
+        if ("abs" == f.fName && c.fArguments.size() == 1) {
+            return Value(fabsf(this->evaluate(*c.fArguments[0]).fFloat));
+        }
+        if ("sqrt" == f.fName && c.fArguments.size() == 1) {
+            return Value(sqrtf(this->evaluate(*c.fArguments[0]).fFloat));
+        }
+        if ("clamp" == f.fName && c.fArguments.size() == 3) {
+            float x = this->evaluate(*c.fArguments[0]).fFloat;
+            float lo = this->evaluate(*c.fArguments[1]).fFloat;
+            float hi = this->evaluate(*c.fArguments[2]).fFloat;
+            return Value(SkTMin(SkTMax(x, lo), hi));
+        }
+    }
+    ABORT("unsupported function call: %s\n", c.description().c_str());
 }
 
 Interpreter::Value Interpreter::evaluate(const Expression& expr) {
@@ -348,6 +411,8 @@ Interpreter::Value Interpreter::evaluate(const Expression& expr) {
                 case Token::GT:         LOGIC(>)
                 case Token::LTEQ:       LOGIC(<=)
                 case Token::GTEQ:       LOGIC(>=)
+                case Token::EQEQ:       LOGIC(==)
+                case Token::NEQ:        LOGIC(!=)
                 case Token::LOGICALAND: {
                     Value result = this->evaluate(*b.fLeft);
                     if (result.fBool) {
@@ -382,8 +447,25 @@ Interpreter::Value Interpreter::evaluate(const Expression& expr) {
         }
         case Expression::kBoolLiteral_Kind:
             return Value(((const BoolLiteral&) expr).fValue);
-        case Expression::kConstructor_Kind:
+        case Expression::kConstructor_Kind: {
+            const Constructor& c = (const Constructor&) expr;
+            if (c.fArguments.size() != 1) {
+                break;
+            }
+            Value arg = this->evaluate(*c.fArguments[0]);
+            TypeKind from = type_kind(c.fArguments[0]->fType);
+            TypeKind to = type_kind(c.fType);
+            if (from == to) {
+                return arg;
+            }
+            if (from == kInt_TypeKind && to == kFloat_TypeKind) {
+                return Value((float) arg.fInt);
+            }
+            if (from == kFloat_TypeKind && to == kInt_TypeKind) {
+                return Value((int) arg.fFloat);
+            }
             break;
+        }
         case Expression::kIntLiteral_Kind:
             return Value((int) ((const IntLiteral&) expr).fValue);
         case Expression::kFieldAccess_Kind:
@@ -8,6 +8,7 @@
 #ifndef SKSL_INTERPRETER
 #define SKSL_INTERPRETER
 
+#include "SkSLByteCode.h"
 #include "ir/SkSLAppendStage.h"
 #include "ir/SkSLExpression.h"
 #include "ir/SkSLFunctionCall.h"
@@ -15,7 +16,9 @@
 #include "ir/SkSLProgram.h"
 #include "ir/SkSLStatement.h"
 
+#include <memory>
 #include <stack>
+#include <unordered_map>
 
 class SkRasterPipeline;
 
@@ -51,10 +54,18 @@ public:
         kBool_TypeKind
     };
 
-    Interpreter(std::unique_ptr<Program> program, SkRasterPipeline* pipeline, std::vector<Value>* stack)
-    : fProgram(std::move(program))
-    , fPipeline(*pipeline)
-    , fStack(*stack) {}
+    Interpreter(std::unique_ptr<Program> program, SkRasterPipeline* pipeline, std::vector<Value>* stack);
+
+    ~Interpreter();
+
+    /**
+     * Callback stages run as bytecode, several pixels at a time, when their function can be
+     * compiled to it. Disabling this forces the tree-walking path, one pixel at a time.
+     * Must be called before run().
+     */
+    void setByteCodeEnabled(bool enabled) {
+        fByteCodeEnabled = enabled;
+    }
 
     void run();
 
@@ -77,11 +88,21 @@ public:
     Value evaluate(const Expression& expr);
 
 private:
+    struct CallbackCtx;
+
+    static void DoCallback(SkRasterPipeline_CallbackCtx* raw, int activePixels);
+
+    // Returns null if f can't be compiled to bytecode.
+    const ByteCode* byteCode(const FunctionDefinition& f);
+
     std::unique_ptr<Program> fProgram;
     SkRasterPipeline& fPipeline;
     std::vector<StatementIndex> fCurrentIndex;
     std::vector<std::unordered_map<const Variable*, StackIndex>> fVars;
     std::vector<Value> &fStack;
+    std::vector<std::unique_ptr<CallbackCtx>> fCallbackContexts;
+    std::unordered_map<const FunctionDefinition*, std::unique_ptr<ByteCode>> fByteCode;
+    bool fByteCodeEnabled = true;
 };
 
 } // namespace
@@ -10,9 +10,57 @@
 #include "SkCodecImageGenerator.h"
 #include "SkData.h"
 #include "SkImage.h"
+#include "SkResourceCache.h"
+#include "SkTaskGroup.h"
 #include <algorithm>
 
-SkAnimCodecPlayer::SkAnimCodecPlayer(std::unique_ptr<SkCodec> codec) : fCodec(std::move(codec)) {
+namespace {
+static unsigned gKeyframeKeyNamespaceLabel;
+
+struct KeyframeKey : public SkResourceCache::Key {
+    KeyframeKey(uint32_t sharedID, int frameIndex)
+        : fSharedID(sharedID)
+        , fFrameIndex(frameIndex)
+    {
+        const uint64_t tag = SkSetFourByteTag('a', 'n', 'i', 'm');
+        this->init(&gKeyframeKeyNamespaceLabel, (tag << 32) | sharedID,
+                   sizeof(fSharedID) + sizeof(fFrameIndex));
+    }
+
+    uint32_t fSharedID;
+    int32_t  fFrameIndex;
+};
+
+struct KeyframeRec : public SkResourceCache::Rec {
+    KeyframeRec(const KeyframeKey& key, sk_sp<SkImage> image)
+        : fKey(key)
+        , fImage(std::move(image))
+    {}
+
+    KeyframeKey    fKey;
+    sk_sp<SkImage> fImage;
+
+    const Key& getKey() const override { return fKey; }
+    size_t bytesUsed() const override {
+        const size_t bpp = SkColorTypeBytesPerPixel(fImage->colorType());
+        return sizeof(*this) + (size_t)fImage->width() * fImage->height() * bpp;
+    }
+    const char* getCategory() const override { return "anim-keyframe"; }
+
+    static bool Visitor(const SkResourceCache::Rec& baseRec, void* contextImage) {
+        const KeyframeRec& rec = static_cast<const KeyframeRec&>(baseRec);
+        *static_cast<sk_sp<SkImage>*>(contextImage) = rec.fImage;
+        return true;
+    }
+};
+} // namespace
+
+SkAnimCodecPlayer::SkAnimCodecPlayer(std::unique_ptr<SkCodec> codec)
+    : SkAnimCodecPlayer(std::move(codec), Options()) {}
+
+SkAnimCodecPlayer::SkAnimCodecPlayer(std::unique_ptr<SkCodec> codec, const Options& options)
+        : fCodec(std::move(codec))
+        , fOptions(options) {
     fImageInfo = fCodec->getInfo();
     fFrameInfos = fCodec->getFrameInfo();
     fImages.resize(fFrameInfos.size());
@@ -31,20 +79,75 @@ SkAnimCodecPlayer::SkAnimCodecPlayer(std::unique_ptr<SkCodec> codec) : fCodec(st
         fImages.clear();
         fImages.push_back(SkImage::MakeFromGenerator(
                               SkCodecImageGenerator::MakeFromCodec(std::move(fCodec))));
+        return;
+    }
+
+    // Decoding further ahead than we can hold on to would only throw away frames we need.
+    if (fOptions.fFrameBudget > 0) {
+        fOptions.fLookAhead = SkTMin(fOptions.fLookAhead, fOptions.fFrameBudget - 1);
+    }
+    fOptions.fLookAhead = SkTMin(fOptions.fLookAhead, (int)fFrameInfos.size() - 1);
+    if (fOptions.fExecutor && fOptions.fLookAhead > 0) {
+        fLookAheadTasks.reset(new SkTaskGroup(*fOptions.fExecutor));
+        this->lookAhead();
     }
 }
 
-SkAnimCodecPlayer::~SkAnimCodecPlayer() {}
+SkAnimCodecPlayer::~SkAnimCodecPlayer() {
+    if (fLookAheadTasks) {
+        fLookAheadTasks->wait();
+    }
+}
 
 SkISize SkAnimCodecPlayer::dimensions() {
     return { fImageInfo.width(), fImageInfo.height() };
 }
 
-sk_sp<SkImage> SkAnimCodecPlayer::getFrameAt(int index) {
+sk_sp<SkImage> SkAnimCodecPlayer::findFrame(int index) {
+    SkAutoMutexAcquire lock(fImagesMutex);
+    return fImages[index];
+}
+
+void SkAnimCodecPlayer::storeFrame(int index, sk_sp<SkImage> image) {
+    SkAutoMutexAcquire lock(fImagesMutex);
+    if (!fImages[index]) {
+        fImageCount++;
+    }
+    fImages[index] = std::move(image);
+
+    // Over budget, drop the frames that will be shown furthest in the future, never the
+    // current one.
+    const int count = (int)fImages.size();
+    const int curr = fCurrIndex.load();
+    for (int distance = count - 1;
+         fOptions.fFrameBudget > 0 && fImageCount > fOptions.fFrameBudget && distance > 0;
+         distance--) {
+        sk_sp<SkImage>& furthest = fImages[(curr + distance) % count];
+        if (furthest) {
+            furthest.reset();
+            fImageCount--;
+        }
+    }
+}
+
+sk_sp<SkImage> SkAnimCodecPlayer::decodeFrame(int index) {
     SkASSERT((unsigned)index < fFrameInfos.size());
 
-    if (fImages[index]) {
-        return fImages[index];
+    SkAutoMutexAcquire lock(fCodecMutex);
+    // It may have been decoded while we waited for the codec.
+    if (sk_sp<SkImage> image = this->findFrame(index)) {
+        return image;
+    }
+
+    const int requiredFrame = fFrameInfos[index].fRequiredFrame;
+    const bool isShared = fOptions.fSharedID && requiredFrame == SkCodec::kNoFrame;
+    if (isShared) {
+        sk_sp<SkImage> image;
+        if (SkResourceCache::Find(KeyframeKey(fOptions.fSharedID, index),
+                                  KeyframeRec::Visitor, &image)) {
+            this->storeFrame(index, image);
+            return image;
+        }
     }
 
     size_t rb = fImageInfo.minRowBytes();
@@ -54,19 +157,58 @@ sk_sp<SkImage> SkAnimCodecPlayer::getFrameAt(int index) {
     SkCodec::Options opts;
     opts.fFrameIndex = index;
 
-    const int requiredFrame = fFrameInfos[index].fRequiredFrame;
     if (requiredFrame != SkCodec::kNoFrame) {
-        auto requiredImage = fImages[requiredFrame];
+        auto requiredImage = this->findFrame(requiredFrame);
         SkPixmap requiredPM;
         if (requiredImage && requiredImage->peekPixels(&requiredPM)) {
             sk_careful_memcpy(data->writable_data(), requiredPM.addr(), size);
             opts.fPriorFrame = requiredFrame;
         }
     }
-    if (SkCodec::kSuccess == fCodec->getPixels(fImageInfo, data->writable_data(), rb, &opts)) {
-        return fImages[index] = SkImage::MakeRasterData(fImageInfo, std::move(data), rb);
+    if (SkCodec::kSuccess != fCodec->getPixels(fImageInfo, data->writable_data(), rb, &opts)) {
+        return nullptr;
     }
-    return nullptr;
+
+    sk_sp<SkImage> image = SkImage::MakeRasterData(fImageInfo, std::move(data), rb);
+    if (isShared) {
+        SkResourceCache::Add(new KeyframeRec(KeyframeKey(fOptions.fSharedID, index), image));
+    }
+    this->storeFrame(index, image);
+    return image;
+}
+
+sk_sp<SkImage> SkAnimCodecPlayer::getFrameAt(int index) {
+    SkASSERT((unsigned)index < fFrameInfos.size());
+
+    if (sk_sp<SkImage> image = this->findFrame(index)) {
+        return image;
+    }
+    fLateFrames++;
+    return this->decodeFrame(index);
+}
+
+void SkAnimCodecPlayer::lookAhead() {
+    if (!fLookAheadTasks || fLookAheadPending.exchange(true)) {
+        return;
+    }
+    fLookAheadTasks->add([this] {
+        const int count = (int)fFrameInfos.size();
+        for (;;) {
+            const int curr = fCurrIndex.load();
+            for (int i = 1; i <= fOptions.fLookAhead; i++) {
+                const int index = (curr + i) % count;
+                if (!this->findFrame(index)) {
+                    this->decodeFrame(index);
+                }
+            }
+            fLookAheadPending = false;
+            // A seek() while we were pending left its look-ahead to us, so follow the current
+            // frame until it stays put, or until a newer task takes over.
+            if (fCurrIndex.load() == curr || fLookAheadPending.exchange(true)) {
+                break;
+            }
+        }
+    });
 }
 
 sk_sp<SkImage> SkAnimCodecPlayer::getFrame() {
@@ -90,7 +232,9 @@ bool SkAnimCodecPlayer::seek(uint32_t msec) {
                                   });
     int prevIndex = fCurrIndex;
     fCurrIndex = lower - fFrameInfos.begin();
-    return fCurrIndex != prevIndex;
+    if (fCurrIndex != prevIndex) {
+        this->lookAhead();
+        return true;
+    }
+    return false;
 }
-
-
@@ -0,0 +1,311 @@
+/*
+ * Copyright 2018 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "SkPictureSession.h"
+
+#include "SkTypes.h"
+
+#include <string.h>
+
+// Images and nested pictures are written through the serial procs as an Entry header, followed
+// by the encoded image or serialized picture when the reader doesn't have it yet.
+namespace {
+
+enum : uint32_t {
+    kDefine_Tag    = SkSetFourByteTag('s', 'e', 's', 'd'),
+    kReference_Tag = SkSetFourByteTag('s', 'e', 's', 'r'),
+};
+
+struct Header {
+    uint32_t      tag;
+    SkMD5::Digest digest;
+};
+
+sk_sp<SkData> make_entry(uint32_t tag, const SkMD5::Digest& digest, const SkData* payload) {
+    const size_t length = payload ? payload->size() : 0;
+    sk_sp<SkData> data = SkData::MakeUninitialized(sizeof(Header) + length);
+    const Header header = {tag, digest};
+    memcpy(data->writable_data(), &header, sizeof(Header));
+    if (length) {
+        memcpy(SkTAddOffset<void>(data->writable_data(), sizeof(Header)), payload->data(), length);
+    }
+    return data;
+}
+
+bool parse_entry(const void* data, size_t size, Header* header,
+                 const void** payload, size_t* length) {
+    if (size < sizeof(Header)) {
+        return false;
+    }
+    memcpy(header, data, sizeof(Header));
+    if (header->tag != kDefine_Tag && header->tag != kReference_Tag) {
+        return false;
+    }
+    *payload = SkTAddOffset<const void>(data, sizeof(Header));
+    *length  = size - sizeof(Header);
+    return true;
+}
+
+SkMD5::Digest hash(const SkData* data) {
+    SkMD5 md5;
+    md5.write(data->data(), data->size());
+    SkMD5::Digest digest;
+    md5.finish(digest);
+    return digest;
+}
+
+sk_sp<SkData> digest_data(const SkMD5::Digest& digest) {
+    return SkData::MakeWithCopy(&digest, sizeof(digest));
+}
+
+// Drops the entries last used framesToKeep or more frames ago.
+template <typename K, typename V, typename LastUsed>
+void purge_map(SkTHashMap<K, V>* map, int oldest, LastUsed lastUsed) {
+    SkTDArray<K> stale;
+    map->foreach([&](const K& key, V* val) {
+        if (lastUsed(*val) <= oldest) {
+            stale.push_back(key);
+        }
+    });
+    for (const K& key : stale) {
+        map->remove(key);
+    }
+}
+
+}  // namespace
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+SkPictureSessionWriter::SkPictureSessionWriter(int framesToKeep)
+    : fFramesToKeep(framesToKeep)
+    , fFrame(0) {}
+
+sk_sp<SkData> SkPictureSessionWriter::serialize(const SkPicture* frame) {
+    fFrame++;
+    // The frame itself changes every time, so it is always written in full.
+    fSerializing.push_back(frame);
+    SkSerialProcs procs = this->procs();
+    sk_sp<SkData> data = frame->serialize(&procs);
+    fSerializing.pop();
+
+    this->purge();
+    return data;
+}
+
+SkSerialProcs SkPictureSessionWriter::procs() {
+    SkSerialProcs procs;
+    procs.fImageProc   = SerializeImage;
+    procs.fImageCtx    = this;
+    procs.fPictureProc = SerializePicture;
+    procs.fPictureCtx  = this;
+    return procs;
+}
+
+// Writes each image and nested picture as just its hash, so hashing a picture doesn't encode
+// what it contains again, nor touch what the reader is known to have.
+SkSerialProcs SkPictureSessionWriter::hashProcs() {
+    SkSerialProcs procs;
+    procs.fImageProc   = HashImage;
+    procs.fImageCtx    = this;
+    procs.fPictureProc = HashPicture;
+    procs.fPictureCtx  = this;
+    return procs;
+}
+
+bool SkPictureSessionWriter::imageDigest(SkImage* image, SkMD5::Digest* digest,
+                                         sk_sp<SkData>* encoded) {
+    if (Cached* cached = fImageDigests.find(image->uniqueID())) {
+        cached->lastUsed = fFrame;
+        *digest = cached->digest;
+        return true;
+    }
+    sk_sp<SkData> data = image->encodeToData();
+    if (!data) {
+        return false;
+    }
+    *digest = hash(data.get());
+    fImageDigests.set(image->uniqueID(), {*digest, fFrame});
+    if (encoded) {
+        *encoded = std::move(data);
+    }
+    return true;
+}
+
+SkMD5::Digest SkPictureSessionWriter::pictureDigest(SkPicture* picture) {
+    if (Cached* cached = fPictureDigests.find(picture->uniqueID())) {
+        cached->lastUsed = fFrame;
+        return cached->digest;
+    }
+    fSerializing.push_back(picture);
+    SkSerialProcs procs = this->hashProcs();
+    SkMD5::Digest digest = hash(picture->serialize(&procs).get());
+    fSerializing.pop();
+
+    fPictureDigests.set(picture->uniqueID(), {digest, fFrame});
+    return digest;
+}
+
+bool SkPictureSessionWriter::reference(const SkMD5::Digest& digest) {
+    if (int* lastUsed = fSent.find(digest)) {
+        *lastUsed = fFrame;
+        return true;
+    }
+    return false;
+}
+
+void SkPictureSessionWriter::purge() {
+    const int oldest = fFrame - fFramesToKeep;
+    purge_map(&fSent, oldest, [](int lastUsed) { return lastUsed; });
+    purge_map(&fImageDigests,   oldest, [](const Cached& c) { return c.lastUsed; });
+    purge_map(&fPictureDigests, oldest, [](const Cached& c) { return c.lastUsed; });
+}
+
+sk_sp<SkData> SkPictureSessionWriter::SerializeImage(SkImage* image, void* ctx) {
+    auto writer = static_cast<SkPictureSessionWriter*>(ctx);
+
+    SkMD5::Digest digest;
+    sk_sp<SkData> encoded;
+    if (!writer->imageDigest(image, &digest, &encoded)) {
+        return nullptr;
+    }
+    if (writer->reference(digest)) {
+        return make_entry(kReference_Tag, digest, nullptr);
+    }
+    if (!encoded && !(encoded = image->encodeToData())) {
+        return nullptr;
+    }
+    writer->fSent.set(digest, writer->fFrame);
+    return make_entry(kDefine_Tag, digest, encoded.get());
+}
+
+sk_sp<SkData> SkPictureSessionWriter::SerializePicture(SkPicture* picture, void* ctx) {
+    auto writer = static_cast<SkPictureSessionWriter*>(ctx);
+    if (!writer->fSerializing.isEmpty() && writer->fSerializing.top() == picture) {
+        return nullptr;  // We're writing this one in full.
+    }
+
+    const SkMD5::Digest digest = writer->pictureDigest(picture);
+    if (writer->reference(digest)) {
+        return make_entry(kReference_Tag, digest, nullptr);
+    }
+
+    writer->fSerializing.push_back(picture);
+    SkSerialProcs procs = writer->procs();
+    sk_sp<SkData> payload = picture->serialize(&procs);
+    writer->fSerializing.pop();
+
+    // The reader adds this after everything the payload defines, which doesn't matter as long
+    // as nothing is dropped before the frame ends.
+    writer->fSent.set(digest, writer->fFrame);
+    return make_entry(kDefine_Tag, digest, payload.get());
+}
+
+sk_sp<SkData> SkPictureSessionWriter::HashImage(SkImage* image, void* ctx) {
+    SkMD5::Digest digest;
+    if (!static_cast<SkPictureSessionWriter*>(ctx)->imageDigest(image, &digest, nullptr)) {
+        return nullptr;
+    }
+    return digest_data(digest);
+}
+
+sk_sp<SkData> SkPictureSessionWriter::HashPicture(SkPicture* picture, void* ctx) {
+    auto writer = static_cast<SkPictureSessionWriter*>(ctx);
+    if (!writer->fSerializing.isEmpty() && writer->fSerializing.top() == picture) {
+        return nullptr;  // We're hashing this one.
+    }
+    return digest_data(writer->pictureDigest(picture));
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+SkPictureSessionReader::SkPictureSessionReader(int framesToKeep)
+    : fFramesToKeep(framesToKeep)
+    , fFrame(0)
+    , fFailed(false) {}
+
+sk_sp<SkPicture> SkPictureSessionReader::deserialize(const void* data, size_t size) {
+    fFrame++;
+    fFailed = false;
+    SkDeserialProcs procs = this->procs();
+    sk_sp<SkPicture> picture = SkPicture::MakeFromData(data, size, &procs);
+
+    this->purge();
+    return fFailed ? nullptr : picture;
+}
+
+SkDeserialProcs SkPictureSessionReader::procs() {
+    SkDeserialProcs procs;
+    procs.fImageProc   = DeserializeImage;
+    procs.fImageCtx    = this;
+    procs.fPictureProc = DeserializePicture;
+    procs.fPictureCtx  = this;
+    return procs;
+}
+
+void SkPictureSessionReader::purge() {
+    purge_map(&fEntries, fFrame - fFramesToKeep, [](const Entry& e) { return e.lastUsed; });
+}
+
+sk_sp<SkImage> SkPictureSessionReader::DeserializeImage(const void* data, size_t size,
+                                                        void* ctx) {
+    auto reader = static_cast<SkPictureSessionReader*>(ctx);
+
+    Header header;
+    const void* payload;
+    size_t length;
+    if (!parse_entry(data, size, &header, &payload, &length)) {
+        return nullptr;  // The writer couldn't encode this one ahead; SkReadBuffer decodes it.
+    }
+    if (header.tag == kReference_Tag) {
+        Entry* entry = reader->fEntries.find(header.digest);
+        if (!entry || !entry->image) {
+            reader->fFailed = true;
+            return nullptr;
+        }
+        entry->lastUsed = reader->fFrame;
+        return entry->image;
+    }
+
+    sk_sp<SkImage> image = SkImage::MakeFromEncoded(SkData::MakeWithCopy(payload, length));
+    if (!image) {
+        reader->fFailed = true;
+        return nullptr;
+    }
+    reader->fEntries.set(header.digest, {image, nullptr, reader->fFrame});
+    return image;
+}
+
+sk_sp<SkPicture> SkPictureSessionReader::DeserializePicture(const void* data, size_t size,
+                                                            void* ctx) {
+    auto reader = static_cast<SkPictureSessionReader*>(ctx);
+
+    Header header;
+    const void* payload;
+    size_t length;
+    if (!parse_entry(data, size, &header, &payload, &length)) {
+        reader->fFailed = true;
+        return nullptr;
+    }
+    if (header.tag == kReference_Tag) {
+        Entry* entry = reader->fEntries.find(header.digest);
+        if (!entry || !entry->picture) {
+            reader->fFailed = true;
+            return nullptr;
+        }
+        entry->lastUsed = reader->fFrame;
+        return entry->picture;
+    }
+
+    SkDeserialProcs procs = reader->procs();
+    sk_sp<SkPicture> picture = SkPicture::MakeFromData(payload, length, &procs);
+    if (!picture) {
+        reader->fFailed = true;
+        return nullptr;
+    }
+    reader->fEntries.set(header.digest, {nullptr, picture, reader->fFrame});
+    return picture;
+}
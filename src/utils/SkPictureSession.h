@@ -0,0 +1,101 @@
+/*
+ * Copyright 2018 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#ifndef SkPictureSession_DEFINED
+#define SkPictureSession_DEFINED
+
+#include "SkData.h"
+#include "SkImage.h"
+#include "SkMD5.h"
+#include "SkPicture.h"
+#include "SkSerialProcs.h"
+#include "SkTDArray.h"
+#include "SkTHash.h"
+
+/**
+ *  Serializes a sequence of pictures, e.g. one per frame sent to another process, so that the
+ *  images and nested pictures a frame shares with recent frames are written as a reference to
+ *  their content hash instead of in full. Nested pictures that are sent again are referenced
+ *  wholesale, paths, paints and all.
+ *
+ *  The writer only knows what the reader has because the reader sees every frame the writer
+ *  wrote: SkPictureSessionReader must read each frame once, in order, and both must be made with
+ *  the same framesToKeep. Entries neither side has used for that many frames are dropped by both,
+ *  so their dictionaries stay bounded and in step. If the reader fails a frame, start both over.
+ *
+ *  Everything goes through SkSerialProcs, so frames are ordinary serialized pictures that any
+ *  reader can parse, given the session's SkDeserialProcs.
+ */
+class SK_API SkPictureSessionWriter : SkNoncopyable {
+public:
+    explicit SkPictureSessionWriter(int framesToKeep = 8);
+
+    /** Serializes the next frame. */
+    sk_sp<SkData> serialize(const SkPicture* frame);
+
+    /** Number of images and pictures the reader has in its dictionary. */
+    int count() const { return fSent.count(); }
+
+private:
+    struct Cached {
+        SkMD5::Digest digest;
+        int           lastUsed;
+    };
+
+    SkSerialProcs procs();
+    SkSerialProcs hashProcs();
+    bool          imageDigest(SkImage*, SkMD5::Digest*, sk_sp<SkData>* encoded);
+    SkMD5::Digest pictureDigest(SkPicture*);
+    bool          reference(const SkMD5::Digest&);
+    void          purge();
+
+    static sk_sp<SkData> SerializeImage(SkImage*, void* ctx);
+    static sk_sp<SkData> SerializePicture(SkPicture*, void* ctx);
+    static sk_sp<SkData> HashImage(SkImage*, void* ctx);
+    static sk_sp<SkData> HashPicture(SkPicture*, void* ctx);
+
+    const int                              fFramesToKeep;
+    int                                    fFrame;
+    SkTHashMap<SkMD5::Digest, int>         fSent;             // digest -> frame last used
+    SkTHashMap<uint32_t, Cached>           fImageDigests;     // unique ID -> content hash
+    SkTHashMap<uint32_t, Cached>           fPictureDigests;
+    SkTDArray<const SkPicture*>            fSerializing;      // pictures being written in full
+};
+
+/**
+ *  Reads the frames written by an SkPictureSessionWriter.
+ */
+class SK_API SkPictureSessionReader : SkNoncopyable {
+public:
+    explicit SkPictureSessionReader(int framesToKeep = 8);
+
+    /** Deserializes the next frame, or returns nullptr if it was not valid. */
+    sk_sp<SkPicture> deserialize(const void* data, size_t size);
+
+    /** Number of images and pictures in the dictionary. */
+    int count() const { return fEntries.count(); }
+
+private:
+    struct Entry {
+        sk_sp<SkImage>   image;
+        sk_sp<SkPicture> picture;
+        int              lastUsed;
+    };
+
+    SkDeserialProcs procs();
+    void            purge();
+
+    static sk_sp<SkImage>   DeserializeImage(const void* data, size_t size, void* ctx);
+    static sk_sp<SkPicture> DeserializePicture(const void* data, size_t size, void* ctx);
+
+    const int                          fFramesToKeep;
+    int                                fFrame;
+    bool                               fFailed;
+    SkTHashMap<SkMD5::Digest, Entry>   fEntries;
+};
+
+#endif
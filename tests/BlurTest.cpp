@@ -11,24 +11,29 @@
 #include "SkBlurMask.h"
 #include "SkBlurPriv.h"
 #include "SkBlurTypes.h"
+#include "SkBoxBlur.h"
 #include "SkCanvas.h"
 #include "SkColor.h"
 #include "SkColorPriv.h"
 #include "SkDrawLooper.h"
 #include "SkEmbossMaskFilter.h"
+#include "SkExecutor.h"
 #include "SkFloatBits.h"
 #include "SkImageInfo.h"
 #include "SkLayerDrawLooper.h"
 #include "SkMask.h"
+#include "SkMaskBlurFilter.h"
 #include "SkMaskFilter.h"
 #include "SkMaskFilterBase.h"
 #include "SkMath.h"
 #include "SkMathPriv.h"
+#include "SkOpts.h"
 #include "SkPaint.h"
 #include "SkPath.h"
 #include "SkPerlinNoiseShader.h"
 #include "SkPixmap.h"
 #include "SkPoint.h"
+#include "SkRandom.h"
 #include "SkRRect.h"
 #include "SkRectPriv.h"
 #include "SkRefCnt.h"
@@ -42,9 +47,12 @@
 
 #include "GrContextFactory.h"
 
+#include <algorithm>
 #include <math.h>
+#include <memory>
 #include <string.h>
 #include <utility>
+#include <vector>
 
 #define WRITE_CSV 0
 
@@ -742,3 +750,239 @@ DEF_TEST(zero_blur, reporter) {
     bitmap.extractAlpha(&alpha, &paint, nullptr, &offset);
 }
 
+DEF_TEST(BoxBlur_Transpose, reporter) {
+    SkRandom rand;
+    for (int i = 0; i < 50; i++) {
+        const int w = 1 + rand.nextULessThan(40),
+                  h = 1 + rand.nextULessThan(40);
+        uint8_t  src8 [40 * 40], dst8 [40 * 40];
+        uint32_t src32[40 * 40], dst32[40 * 40];
+        for (int j = 0; j < w * h; j++) {
+            src8 [j] = (uint8_t)rand.nextU();
+            src32[j] = rand.nextU();
+        }
+        SkOpts::transpose8 (dst8,  h,                    src8,  w,                    w, h);
+        SkOpts::transpose32(dst32, h * sizeof(uint32_t), src32, w * sizeof(uint32_t), w, h);
+        for (int y = 0; y < h; y++) {
+            for (int x = 0; x < w; x++) {
+                REPORTER_ASSERT(reporter, dst8 [x * h + y] == src8 [y * w + x]);
+                REPORTER_ASSERT(reporter, dst32[x * h + y] == src32[y * w + x]);
+            }
+        }
+    }
+}
+
+// SkOpts::box_blur_columns() slides three sums down each column.  Check it against the kernel
+// those sums add up to: boxes window, window, and window or window + 1 wide.
+DEF_TEST(BoxBlur_Columns, reporter) {
+    const int kWindows[] = { 2, 3, 4, 9, 24, 101, 254, 255 };
+    SkRandom rand;
+    for (bool roundProduct : { false, true })
+    for (int window : kWindows) {
+        const int width = 1 + rand.nextULessThan(80),
+                  srcH  = 1 + rand.nextULessThan(30),
+                  dstH  = 1 + rand.nextULessThan(60),
+                  srcTop = rand.nextULessThan(dstH);
+
+        std::vector<uint32_t> box0(window, 1), box2((window & 1) ? window : window + 1, 1);
+        auto convolve = [](const std::vector<uint32_t>& a, const std::vector<uint32_t>& b) {
+            std::vector<uint32_t> c(a.size() + b.size() - 1, 0);
+            for (size_t i = 0; i < a.size(); i++) {
+                for (size_t j = 0; j < b.size(); j++) {
+                    c[i + j] += a[i] * b[j];
+                }
+            }
+            return c;
+        };
+        const std::vector<uint32_t> kernel = convolve(convolve(box0, box0), box2);
+        const int border = ((int)kernel.size() - 1) / 2;
+
+        uint32_t divisor = 0;
+        for (uint32_t k : kernel) {
+            divisor += k;
+        }
+        const uint32_t weight = (uint32_t)round(1.0 / divisor * (1ull << 32));
+
+        std::vector<uint8_t> src(width * srcH), dst(width * dstH);
+        for (uint8_t& v : src) {
+            v = rand.nextBool() ? 0xFF : (uint8_t)rand.nextU();
+        }
+        for (uint8_t& v : dst) {
+            v = 0xAB;
+        }
+        SkOpts::box_blur_columns(src.data(), width, srcH, srcTop,
+                                 dst.data(), width, dstH, width, window, roundProduct);
+
+        for (int y = 0; y < dstH; y++) {
+            for (int x = 0; x < width; x++) {
+                uint32_t sum = 0;
+                for (int j = 0; j < (int)kernel.size(); j++) {
+                    const int srcY = y - srcTop + border - j;
+                    if (0 <= srcY && srcY < srcH) {
+                        sum += kernel[j] * src[srcY * width + x];
+                    }
+                }
+                const int expected = roundProduct
+                        ? (int)(((uint64_t)sum * weight + (1ull << 31)) >> 32)
+                        : (int)((uint64_t)(sum + (divisor + 1) / 2) * weight >> 32);
+                REPORTER_ASSERT(reporter, dst[y * width + x] == expected,
+                                "window %d (%d, %d): %d != %d",
+                                window, x, y, dst[y * width + x], expected);
+            }
+        }
+    }
+}
+
+// Blurs a few rects into an image with room for a blur border wide, on the executor if any.
+static SkBitmap box_blur_rects(SkColorType ct, const SkBoxBlur& boxBlur, SkIPoint border,
+                               SkExecutor* executor) {
+    SkBitmap src;
+    src.allocPixels(SkImageInfo::Make(150, 100, ct, kPremul_SkAlphaType));
+    src.eraseColor(SK_ColorTRANSPARENT);
+    src.erase(0xFF204080, SkIRect::MakeXYWH(10, 10, 60, 30));
+    src.erase(0x80808080, SkIRect::MakeXYWH(50, 20, 90, 70));
+    src.erase(0xFFFFFFFF, SkIRect::MakeXYWH(100, 5, 3, 90));
+
+    SkBitmap dst;
+    dst.allocPixels(SkImageInfo::Make(src.width()  + 2 * border.x(),
+                                      src.height() + 2 * border.y(), ct, kPremul_SkAlphaType));
+    dst.eraseColor(0x12345678);
+    boxBlur.blur(src.pixmap(), border, dst.pixmap(), executor);
+    return dst;
+}
+
+DEF_TEST(BoxBlur_Downscaled, reporter) {
+    const SkVector kSigmas[] = { {30, 0}, {0, 45}, {40, 40}, {60, 20}, {100, 100} };
+    std::unique_ptr<SkExecutor> pool = SkExecutor::MakeFIFOThreadPool(3);
+
+    for (SkColorType ct : { kAlpha_8_SkColorType, kN32_SkColorType }) {
+        for (SkVector sigma : kSigmas) {
+            const SkBoxBlur exact(sigma.x(), sigma.y(), 0),
+                            fast (sigma.x(), sigma.y());
+            REPORTER_ASSERT(reporter, exact.scale() == SkIPoint::Make(1, 1));
+            REPORTER_ASSERT(reporter, fast .scale() != SkIPoint::Make(1, 1));
+
+            // The downscaled blur reaches a little further.
+            const SkIPoint border = fast.border();
+            const SkBitmap e = box_blur_rects(ct, exact, border, nullptr),
+                           f = box_blur_rects(ct, fast,  border, nullptr),
+                           b = box_blur_rects(ct, fast,  border, pool.get());
+
+            // Bands on the executor are blurred just the same.
+            REPORTER_ASSERT(reporter, 0 == memcmp(f.getPixels(), b.getPixels(),
+                                                  f.computeByteSize()));
+
+            int worst = 0;
+            for (int y = 0; y < e.height(); y++) {
+                auto ePixels = static_cast<const uint8_t*>(e.getAddr(0, y)),
+                     fPixels = static_cast<const uint8_t*>(f.getAddr(0, y));
+                for (int i = 0; i < e.width() * e.bytesPerPixel(); i++) {
+                    worst = SkTMax(worst, SkTAbs(ePixels[i] - fPixels[i]));
+                }
+            }
+            REPORTER_ASSERT(reporter, worst <= SkBoxBlur::kDefaultMaxError,
+                            "sigma (%g, %g): off by %d", sigma.x(), sigma.y(), worst);
+        }
+    }
+}
+
+// SkMaskBlurFilter's blur before SkBoxBlur, for one row or column of an A8 mask: three box passes
+// slid along the src from the front, and the rest of dst filled in from the back.
+static void baseline_blur_line(int window, const uint8_t* src, int srcStride, int srcCount,
+                               uint8_t* dst, int dstStride, int dstCount) {
+    const int border = (window & 1) ? 3 * ((window - 1) / 2) : 3 * (window / 2) - 1,
+              noChangeCount = SkTMax(0, 2 * border + 1 - srcCount);
+    const uint64_t divisor = (window & 1) ? window * window * window
+                                          : window * window * (window + 1);
+    const uint64_t weight = (uint64_t)round(1.0 / divisor * (1ull << 32));
+
+    std::vector<uint32_t> buffer0(window - 1), buffer1(window - 1),
+                          buffer2((window & 1) ? window - 1 : window);
+    uint32_t sum0 = 0, sum1 = 0, sum2 = 0;
+    size_t cursor0 = 0, cursor1 = 0, cursor2 = 0;
+    auto step = [&](uint32_t leadingEdge, uint8_t* out) {
+        sum0 += leadingEdge;
+        sum1 += sum0;
+        sum2 += sum1;
+        *out = (uint8_t)((weight * sum2 + (1ull << 31)) >> 32);
+        sum2 -= buffer2[cursor2];
+        buffer2[cursor2] = sum1;
+        cursor2 = (cursor2 + 1) % buffer2.size();
+        sum1 -= buffer1[cursor1];
+        buffer1[cursor1] = sum0;
+        cursor1 = (cursor1 + 1) % buffer1.size();
+        sum0 -= buffer0[cursor0];
+        buffer0[cursor0] = leadingEdge;
+        cursor0 = (cursor0 + 1) % buffer0.size();
+    };
+
+    int d = 0;
+    for (int i = 0; i < srcCount; i++, d++) {
+        step(src[i * srcStride], dst + d * dstStride);
+    }
+    for (int i = 0; i < noChangeCount; i++, d++) {
+        step(0, dst + d * dstStride);
+    }
+
+    std::fill(buffer0.begin(), buffer0.end(), 0);
+    std::fill(buffer1.begin(), buffer1.end(), 0);
+    std::fill(buffer2.begin(), buffer2.end(), 0);
+    sum0 = sum1 = sum2 = 0;
+    for (int back = dstCount - 1, i = srcCount - 1; back >= d; back--, i--) {
+        step(src[i * srcStride], dst + back * dstStride);
+    }
+}
+
+// Full scale mask blurs must stay bit-identical to SkMaskBlurFilter's original kernel.
+DEF_TEST(BoxBlur_MaskBaseline, reporter) {
+    const SkVector kSigmas[] = { {2, 2}, {2.5f, 7}, {3.7f, 3.7f}, {6, 2.2f}, {11, 11}, {20, 14} };
+    SkRandom rand;
+    for (SkVector sigma : kSigmas) {
+        const SkBoxBlur boxBlur(sigma.x(), sigma.y(), SkBoxBlur::kDefaultMaxError,
+                                SkBoxBlur::Rounding::kProduct);
+        REPORTER_ASSERT(reporter, boxBlur.scale() == SkIPoint::Make(1, 1));
+        auto window = [](double sigma) {
+            return SkTMax(1, (int)floor(sigma * 3 * sqrt(2 * SK_ScalarPI) / 4 + 0.5));
+        };
+        const int windowX = window(sigma.x()),
+                  windowY = window(sigma.y());
+
+        SkMask src;
+        src.fFormat   = SkMask::kA8_Format;
+        src.fBounds   = SkIRect::MakeXYWH(3, 5, 1 + rand.nextULessThan(70),
+                                                1 + rand.nextULessThan(50));
+        src.fRowBytes = src.fBounds.width() + 3;
+        src.fImage    = SkMask::AllocImage(src.computeImageSize());
+        SkAutoMaskFreeImage srcStorage(src.fImage);
+        for (size_t i = 0; i < src.computeImageSize(); i++) {
+            src.fImage[i] = rand.nextBool() ? 0xFF : (uint8_t)rand.nextU();
+        }
+
+        SkMask dst;
+        const SkIPoint border = SkMaskBlurFilter(sigma.x(), sigma.y()).blur(src, &dst);
+        SkAutoMaskFreeImage dstStorage(dst.fImage);
+        REPORTER_ASSERT(reporter, border == boxBlur.border());
+
+        // Blur each row into a column of tmp, then each row of tmp into a column of dst.
+        const int srcW = src.fBounds.width(),
+                  srcH = src.fBounds.height(),
+                  dstW = dst.fBounds.width(),
+                  dstH = dst.fBounds.height();
+        std::vector<uint8_t> tmp(srcH * dstW), expected(dstW * dstH);
+        for (int y = 0; y < srcH; y++) {
+            baseline_blur_line(windowX, src.fImage + y * src.fRowBytes, 1, srcW,
+                               tmp.data() + y, srcH, dstW);
+        }
+        for (int x = 0; x < dstW; x++) {
+            baseline_blur_line(windowY, tmp.data() + x * srcH, 1, srcH,
+                               expected.data() + x, dstW, dstH);
+        }
+
+        int mismatches = 0;
+        for (int y = 0; y < dstH; y++) {
+            mismatches += memcmp(dst.fImage + y * dst.fRowBytes, &expected[y * dstW], dstW) != 0;
+        }
+        REPORTER_ASSERT(reporter, 0 == mismatches, "sigma (%g, %g): %d rows differ",
+                        sigma.x(), sigma.y(), mismatches);
+    }
+}
@@ -13,8 +13,12 @@
 #include "SkCodec.h"
 #include "SkCodecAnimation.h"
 #include "SkData.h"
+#include "SkExecutor.h"
+#include "SkImage.h"
+#include "SkImage_Base.h"
 #include "SkImageInfo.h"
 #include "SkMakeUnique.h"
+#include "SkOpts.h"
 #include "SkRefCnt.h"
 #include "SkSize.h"
 #include "SkString.h"
@@ -484,3 +488,49 @@ DEF_TEST(AnimCodecPlayer, r) {
         REPORTER_ASSERT(r, f1->bounds().size() == test.fSize);
     }
 }
+
+// Decoding ahead on an executor, within a frame budget, and sharing keyframes must not change
+// what each frame looks like.
+DEF_TEST(AnimCodecPlayer_lookAhead, r) {
+    std::unique_ptr<SkExecutor> executor = SkExecutor::MakeFIFOThreadPool(2);
+
+    for (const char* file : { "images/alphabetAnim.gif", "images/flightAnim.gif",
+                              "images/webp-animated.webp" }) {
+        sk_sp<SkData> data = GetResourceAsData(file);
+        if (!data) {
+            continue;
+        }
+        SkAnimCodecPlayer serial(SkCodec::MakeFromData(data));
+
+        SkAnimCodecPlayer::Options options;
+        options.fExecutor = executor.get();
+        options.fLookAhead = 3;
+        options.fFrameBudget = 3;
+        options.fSharedID = SkOpts::hash(data->data(), data->size());
+        SkAnimCodecPlayer ahead(SkCodec::MakeFromData(data), options);
+        SkAnimCodecPlayer shared(SkCodec::MakeFromData(data), options);
+        REPORTER_ASSERT(r, ahead.duration() == serial.duration());
+
+        // Twice around, so that dropped frames have to be decoded again.
+        for (uint32_t msec = 0; msec < 2 * serial.duration(); msec += 10) {
+            serial.seek(msec);
+            ahead.seek(msec);
+            shared.seek(msec);
+            sk_sp<SkImage> expected = serial.getFrame();
+            for (const sk_sp<SkImage>& actual : { ahead.getFrame(), shared.getFrame() }) {
+                SkBitmap a, b;
+                if (!expected || !actual ||
+                    !as_IB(expected)->getROPixels(&a) || !as_IB(actual)->getROPixels(&b)) {
+                    ERRORF(r, "%s: no frame at %u msec", file, msec);
+                    return;
+                }
+                for (int y = 0; y < a.height(); y++) {
+                    if (memcmp(a.getAddr(0, y), b.getAddr(0, y), a.info().minRowBytes())) {
+                        ERRORF(r, "%s: frame mismatch at %u msec, line %d", file, msec, y);
+                        return;
+                    }
+                }
+            }
+        }
+    }
+}
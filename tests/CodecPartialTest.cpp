@@ -154,6 +154,17 @@ DEF_TEST(Codec_partial, r) {
     test_partial(r, "images/color_wheel.gif");
 }
 
+#ifdef SK_HAS_WUFFS_PNG_LIBRARY
+// SkWuffsPngCodec converts each row once, as it arrives, or once the image is complete if it is
+// interlaced. Either way the result must match a decode of the whole file.
+DEF_TEST(Codec_partialWuffsPng, r) {
+    test_partial(r, "images/plane.png");
+    test_partial(r, "images/plane_interlaced.png");
+    test_partial(r, "images/yellow_rose.png");
+    test_partial(r, "images/mandrill_256.png");
+}
+#endif
+
 DEF_TEST(Codec_partialWuffs, r) {
     const char* path = "images/alphabetAnim.gif";
     auto file = GetResourceAsData(path);
@@ -18,6 +18,7 @@
 #include "SkColorSpacePriv.h"
 #include "SkData.h"
 #include "SkEncodedImageFormat.h"
+#include "SkExecutor.h"
 #include "SkFrontBufferedStream.h"
 #include "SkImage.h"
 #include "SkImageGenerator.h"
@@ -28,6 +29,7 @@
 #include "SkMalloc.h"
 #include "SkPixmap.h"
 #include "SkPngChunkReader.h"
+#include "SkPngCodec.h"
 #include "SkPngEncoder.h"
 #include "SkRandom.h"
 #include "SkRect.h"
@@ -40,6 +42,9 @@
 #include "SkTypes.h"
 #include "SkUnPreMultiply.h"
 #include "SkWebpEncoder.h"
+#ifdef SK_HAS_WUFFS_PNG_LIBRARY
+#include "SkWuffsPngCodec.h"
+#endif
 #include "Test.h"
 #include "png.h"
 #include "sk_tool_utils.h"
@@ -1809,3 +1814,179 @@ DEF_TEST(Codec_crbug807324, r) {
         }
     }
 }
+
+// Decoding with an executor must give the same pixels as decoding without one.
+DEF_TEST(Codec_executor, r) {
+    std::unique_ptr<SkExecutor> executor = SkExecutor::MakeFIFOThreadPool(4);
+    const char* files[] = {
+        "images/CMYK.jpg",
+        "images/icc-v2-gbr.jpg",
+        "images/mandrill_h2v1.jpg",
+        "images/grayscale.jpg",
+        "images/color_wheel.webp",
+        "images/webp-color-profile-lossy-alpha.webp",
+    };
+    const struct {
+        SkColorType         fColorType;
+        sk_sp<SkColorSpace> fColorSpace;
+    } dsts[] = {
+        { kN32_SkColorType,       nullptr },
+        { kN32_SkColorType,       SkColorSpace::MakeSRGB() },
+        { kRGBA_F16_SkColorType,  SkColorSpace::MakeSRGBLinear() },
+        { kRGB_565_SkColorType,   SkColorSpace::MakeSRGB() },
+    };
+    for (const char* file : files) {
+        sk_sp<SkData> data(GetResourceAsData(file));
+        if (!data) {
+            continue;
+        }
+        for (const auto& dst : dsts) {
+            SkBitmap bms[2];
+            for (int i = 0; i < 2; i++) {
+                std::unique_ptr<SkCodec> codec(SkCodec::MakeFromData(data));
+                REPORTER_ASSERT(r, codec);
+                if (!codec) {
+                    return;
+                }
+                SkImageInfo info = codec->getInfo().makeColorType(dst.fColorType)
+                                                   .makeColorSpace(dst.fColorSpace);
+                if (kRGB_565_SkColorType == dst.fColorType) {
+                    info = info.makeAlphaType(kOpaque_SkAlphaType);
+                }
+                bms[i].allocPixels(info);
+                SkCodec::Options options;
+                options.fExecutor = i ? executor.get() : nullptr;
+                SkCodec::Result result = codec->getPixels(info, bms[i].getPixels(),
+                                                          bms[i].rowBytes(), &options);
+                if (SkCodec::kInvalidConversion == result) {
+                    break;
+                }
+                REPORTER_ASSERT(r, SkCodec::kSuccess == result);
+            }
+            if (bms[1].drawsNothing()) {
+                continue;
+            }
+            SkMD5::Digest digests[2];
+            md5(bms[0], &digests[0]);
+            md5(bms[1], &digests[1]);
+            REPORTER_ASSERT(r, digests[0] == digests[1], "%s", file);
+        }
+    }
+}
+
+#if defined(SK_HAS_WUFFS_PNG_LIBRARY) && !defined(SK_PNG_DISABLE_TESTS)
+// SkWuffsPngCodec should report the same SkEncodedInfo as SkPngCodec, and decode the same pixels.
+DEF_TEST(Codec_WuffsPng, r) {
+    const char* files[] = {
+        "images/arrow.png",
+        "images/baby_tux.png",
+        "images/color_wheel.png",
+        "images/gamut.png",
+        "images/half-transparent-white-pixel.png",
+        "images/index8.png",
+        "images/mandrill_32.png",
+        "images/plane.png",
+        "images/plane_interlaced.png",
+        "images/randPixels.png",
+        "images/yellow_rose.png",
+    };
+    for (const char* file : files) {
+        sk_sp<SkData> data(GetResourceAsData(file));
+        if (!data) {
+            continue;
+        }
+        SkCodec::Result result;
+        std::unique_ptr<SkCodec> codecs[2] = {
+            SkPngCodec::MakeFromStream(SkMemoryStream::Make(data), &result),
+            SkWuffsPngCodec_MakeFromStream(SkMemoryStream::Make(data), &result),
+        };
+        if (!codecs[0] || !codecs[1]) {
+            ERRORF(r, "Could not create codecs for %s", file);
+            continue;
+        }
+        // getInfo() is made from the SkEncodedInfo, profile and all.
+        REPORTER_ASSERT(r, codecs[0]->getInfo() == codecs[1]->getInfo(), "%s", file);
+
+        SkMD5::Digest digests[2];
+        for (int i = 0; i < 2; i++) {
+            SkBitmap bm;
+            bm.allocPixels(codecs[i]->getInfo().makeColorType(kN32_SkColorType)
+                                               .makeColorSpace(nullptr));
+            result = codecs[i]->getPixels(bm.pixmap());
+            REPORTER_ASSERT(r, SkCodec::kSuccess == result, "%s", file);
+            md5(bm, &digests[i]);
+        }
+        REPORTER_ASSERT(r, digests[0] == digests[1], "%s", file);
+    }
+}
+#endif
+
+#ifndef SK_PNG_DISABLE_TESTS
+// Subsets of a PNG large enough to get an SkPngRegionIndex should decode the same with it as
+// without it.
+DEF_TEST(Codec_PngRegionIndex, r) {
+    SkBitmap bm;
+    bm.allocN32Pixels(1200, 1100);
+    SkRandom random;
+    for (int y = 0; y < bm.height(); y++) {
+        for (int x = 0; x < bm.width(); x++) {
+            *bm.getAddr32(x, y) = SkPackARGB32(0xFF, x & 0xFF, y & 0xFF, random.nextU() & 0x3F);
+        }
+    }
+    SkDynamicMemoryWStream wStream;
+    REPORTER_ASSERT(r, SkPngEncoder::Encode(&wStream, bm.pixmap(), SkPngEncoder::Options()));
+    sk_sp<SkData> data = wStream.detachAsData();
+
+    const SkIRect subsets[] = {
+        SkIRect::MakeXYWH(0, 0, 300, 200),
+        SkIRect::MakeXYWH(100, 500, 512, 300),
+        SkIRect::MakeXYWH(700, 900, 500, 200),
+        SkIRect::MakeXYWH(0, 1097, 1200, 3),
+    };
+    for (const SkIRect& subset : subsets) {
+        for (int sampleSize : { 1, 3 }) {
+            SkMD5::Digest digests[2];
+            for (int i = 0; i < 2; i++) {
+                // Only data in memory can be indexed.
+                std::unique_ptr<SkStream> stream;
+                if (0 == i) {
+                    stream = SkMemoryStream::Make(data);
+                } else {
+                    stream = skstd::make_unique<NotAssetMemStream>(data);
+                }
+                SkCodec::Result result;
+                std::unique_ptr<SkCodec> pngCodec =
+                        SkPngCodec::MakeFromStream(std::move(stream), &result);
+                const SkPngCodec* png = static_cast<const SkPngCodec*>(pngCodec.get());
+                auto codec = SkAndroidCodec::MakeFromCodec(std::move(pngCodec));
+                if (!codec) {
+                    ERRORF(r, "Could not create codec");
+                    return;
+                }
+
+                SkAndroidCodec::AndroidOptions options;
+                SkIRect codecSubset = subset;
+                options.fSubset = &codecSubset;
+                options.fSampleSize = sampleSize;
+                const SkISize size = codec->getSampledSubsetDimensions(sampleSize, subset);
+                SkBitmap dst;
+                dst.allocPixels(codec->getInfo().makeWH(size.width(), size.height())
+                                                .makeColorType(kN32_SkColorType));
+                result = codec->getAndroidPixels(dst.info(), dst.getPixels(), dst.rowBytes(),
+                                                 &options);
+                REPORTER_ASSERT(r, SkCodec::kSuccess == result);
+                md5(dst, &digests[i]);
+
+                // Only subsets below the top can skip rows, and only with the index.
+                const bool indexed = 0 == i && subset.fTop > 0;
+                REPORTER_ASSERT(r, indexed == (png->rowsReadFromIndex() > 0),
+                                "subset (%d, %d, %d, %d) sample %d: %d rows from the index",
+                                subset.fLeft, subset.fTop, subset.fRight, subset.fBottom,
+                                sampleSize, png->rowsReadFromIndex());
+            }
+            REPORTER_ASSERT(r, digests[0] == digests[1], "subset (%d, %d, %d, %d) sample %d",
+                            subset.fLeft, subset.fTop, subset.fRight, subset.fBottom, sampleSize);
+        }
+    }
+}
+#endif
@@ -9,11 +9,14 @@
 #include "Test.h"
 
 #include "SkBitmap.h"
+#include "SkCodec.h"
 #include "SkColorPriv.h"
 #include "SkEncodedImageFormat.h"
+#include "SkExecutor.h"
 #include "SkImage.h"
 #include "SkJpegEncoder.h"
 #include "SkPngEncoder.h"
+#include "SkRandom.h"
 #include "SkStream.h"
 #include "SkWebpEncoder.h"
 
@@ -291,6 +294,95 @@ DEF_TEST(Encode_PngOptions, r) {
     REPORTER_ASSERT(r, almost_equals(bm0, bm2, 0));
 }
 
+static bool decode_png(sk_sp<SkData> data, SkColorType ct, SkBitmap* dst) {
+    std::unique_ptr<SkCodec> codec = SkCodec::MakeFromData(std::move(data));
+    if (!codec) {
+        return false;
+    }
+    SkImageInfo info = codec->getInfo().makeColorType(ct);
+    if (kOpaque_SkAlphaType != info.alphaType()) {
+        info = info.makeAlphaType(kUnpremul_SkAlphaType);
+    }
+    dst->allocPixels(info);
+    return SkCodec::kSuccess == codec->getPixels(dst->pixmap());
+}
+
+// Color spaces may differ, as the encoder writes the source's and the decoder reads sRGB.
+static bool same_pixels(const SkBitmap& a, const SkBitmap& b) {
+    if (a.dimensions() != b.dimensions() || a.colorType() != b.colorType()) {
+        return false;
+    }
+    for (int y = 0; y < a.height(); y++) {
+        if (memcmp(a.getAddr(0, y), b.getAddr(0, y), a.info().minRowBytes())) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Pngs compressed in parallel chunks must decode to exactly what the serial encoder's do.
+DEF_TEST(Encode_PngExecutor, r) {
+    std::unique_ptr<SkExecutor> executor = SkExecutor::MakeFIFOThreadPool(4);
+
+    // Big enough to be split into several chunks, and noisy enough to exercise each filter.
+    SkBitmap noise;
+    noise.allocPixels(SkImageInfo::MakeN32(700, 300, kUnpremul_SkAlphaType));
+    SkRandom rand;
+    for (int y = 0; y < noise.height(); y++) {
+        for (int x = 0; x < noise.width(); x++) {
+            *noise.getAddr32(x, y) = (x * y) % 7 == 0
+                    ? rand.nextU()
+                    : SkPackARGB32NoCheck(0xFF, x & 0xFF, y & 0xFF, (x ^ y) & 0xFF);
+        }
+    }
+
+    SkBitmap srcs[4];
+    srcs[0] = noise;
+    SkAssertResult(GetResourceAsBitmap("images/mandrill_128.png", &srcs[1]));
+    srcs[2].allocPixels(noise.info().makeColorType(kRGBA_F16_SkColorType)
+                                    .makeAlphaType(kOpaque_SkAlphaType));
+    noise.readPixels(srcs[2].pixmap());
+    srcs[3].allocPixels(noise.info().makeColorType(kAlpha_8_SkColorType));
+    noise.readPixels(srcs[3].pixmap());
+
+    const SkPngEncoder::FilterFlag filters[] = {
+        SkPngEncoder::FilterFlag::kAll,
+        SkPngEncoder::FilterFlag::kNone,
+        SkPngEncoder::FilterFlag::kZero,
+        SkPngEncoder::FilterFlag::kSub | SkPngEncoder::FilterFlag::kPaeth,
+    };
+    for (const SkBitmap& src : srcs) {
+        for (SkPngEncoder::FilterFlag filter : filters) {
+            for (int level : { 0, 6 }) {
+                SkPngEncoder::Options options;
+                options.fFilterFlags = filter;
+                options.fZLibLevel = level;
+                SkDynamicMemoryWStream serial, parallel, incremental;
+                REPORTER_ASSERT(r, SkPngEncoder::Encode(&serial, src.pixmap(), options));
+                options.fExecutor = executor.get();
+                REPORTER_ASSERT(r, SkPngEncoder::Encode(&parallel, src.pixmap(), options));
+                auto encoder = SkPngEncoder::Make(&incremental, src.pixmap(), options);
+                REPORTER_ASSERT(r, encoder);
+                for (int y = 0; encoder && y < src.height(); y += 97) {
+                    REPORTER_ASSERT(r, encoder->encodeRows(97));
+                }
+
+                SkBitmap expected, actual, actualIncremental;
+                REPORTER_ASSERT(r, decode_png(serial.detachAsData(), src.colorType(), &expected));
+                REPORTER_ASSERT(r, decode_png(parallel.detachAsData(), src.colorType(),
+                                              &actual));
+                REPORTER_ASSERT(r, decode_png(incremental.detachAsData(), src.colorType(),
+                                              &actualIncremental));
+                // 8-bit sources come back exactly.  F16 ones are written at 16 bits.
+                REPORTER_ASSERT(r, kRGBA_F16_SkColorType == src.colorType() ||
+                                   same_pixels(src, expected));
+                REPORTER_ASSERT(r, same_pixels(expected, actual));
+                REPORTER_ASSERT(r, same_pixels(expected, actualIncremental));
+            }
+        }
+    }
+}
+
 #ifndef SK_BUILD_FOR_GOOGLE3
 DEF_TEST(Encode_WebpQuality, r) {
     SkBitmap bm;
@@ -5,8 +5,12 @@
  * found in the LICENSE file.
  */
 
+#include "SkBitmap.h"
 #include "SkBlitter.h"
+#include "SkCoreBlitters.h"
+#include "SkOpts.h"
 #include "SkPath.h"
+#include "SkRandom.h"
 #include "SkRegion.h"
 #include "SkScan.h"
 #include "Test.h"
@@ -46,3 +50,92 @@ DEF_TEST(FillPathInverse, reporter) {
 
     REPORTER_ASSERT(reporter, blitter.m_blitCount == expected_lines);
 }
+
+DEF_TEST(FillPath_CoverageOpts, reporter) {
+    SkRandom rand;
+    SkAlpha dst[70], src[70], expected[70];
+    for (int count = 0; count <= 70; count++) {
+        for (int i = 0; i < count; i++) {
+            dst[i] = (SkAlpha)rand.nextU();
+            src[i] = (SkAlpha)rand.nextU();
+            expected[i] = SkTMin(0xFF, dst[i] + src[i]);
+        }
+        SkOpts::accumulate_coverage(dst, src, count);
+        REPORTER_ASSERT(reporter, 0 == memcmp(dst, expected, count));
+
+        SkAlpha alpha = (SkAlpha)rand.nextU();
+        for (int i = 0; i < count; i++) {
+            expected[i] = SkTMin(0xFF, dst[i] + alpha);
+        }
+        SkOpts::add_coverage(dst, alpha, count);
+        REPORTER_ASSERT(reporter, 0 == memcmp(dst, expected, count));
+    }
+
+    // Spans of coverage around the snapping thresholds, so that neighboring spans may snap to the
+    // same alpha and have to be merged into one run.
+    const SkAlpha kCoverages[] = { 0, 3, 7, 8, 128, 247, 248, 255 };
+    SkAlpha coverage[70], alphas[70];
+    int16_t runs[70];
+    for (int count = 1; count <= 70; count++) {
+        bool visible = false;
+        for (int x = 0; x < count;) {
+            SkAlpha c = kCoverages[rand.nextULessThan(SK_ARRAY_COUNT(kCoverages))];
+            for (int end = SkTMin(count, x + 1 + (int)rand.nextULessThan(20)); x < end; x++) {
+                coverage[x] = c;
+                expected[x] = c < 8 ? 0 : c > 247 ? 0xFF : c;
+                visible |= expected[x] != 0;
+            }
+        }
+
+        REPORTER_ASSERT(reporter,
+                        visible == SkOpts::coverage_to_runs(alphas, runs, coverage, count));
+        REPORTER_ASSERT(reporter, 0 == memcmp(coverage, expected, count));
+        int x = 0;
+        while (x < count && runs[x] > 0) {
+            for (int i = x; i < x + runs[x]; i++) {
+                REPORTER_ASSERT(reporter, expected[i] == alphas[x]);
+            }
+            x += runs[x];
+            REPORTER_ASSERT(reporter, x == count || alphas[x] != expected[x - 1]);
+        }
+        REPORTER_ASSERT(reporter, x == count);
+    }
+}
+
+// Analytic AA fills concave paths by adding up the coverage of the spans and partial scanlines in
+// each row. Their sum may be a little over 0xFF, and must not wrap around. Supersampling adds up
+// its coverage differently, so compare against it. Both scan converters are called directly, so
+// that this doesn't depend on, or change, which one SkScan::AntiFillPath would pick.
+DEF_TEST(FillPath_AnalyticConcave, reporter) {
+    using FillProc = void (*)(const SkPath&, SkBlitter*, const SkIRect&, const SkIRect&, bool);
+    auto draw = [](const SkPath& path, FillProc fill) {
+        SkBitmap bitmap;
+        bitmap.allocPixels(SkImageInfo::MakeA8(200, 200));
+        bitmap.eraseColor(SK_ColorTRANSPARENT);
+        SkA8_Coverage_Blitter blitter(bitmap.pixmap(), SkPaint());
+        fill(path, &blitter, path.getBounds().roundOut(), bitmap.bounds(), false);
+        return bitmap;
+    };
+
+    SkRandom rand;
+    for (int i = 0; i < 20; i++) {
+        SkPath path;
+        path.setFillType(i % 2 ? SkPath::kEvenOdd_FillType : SkPath::kWinding_FillType);
+        path.moveTo(rand.nextRangeF(0, 200), rand.nextRangeF(0, 200));
+        for (int j = 0; j < 3 + 2 * i; j++) {
+            path.lineTo(rand.nextRangeF(0, 200), rand.nextRangeF(0, 200));
+        }
+
+        SkBitmap expected = draw(path, SkScan::SAAFillPath),
+                 actual   = draw(path, SkScan::AAAFillPath);
+        // The two differ by a fair bit along edges where many of them cross, but coverage that
+        // wrapped around turns whole spans from opaque to clear.
+        int mismatched = 0;
+        for (int y = 0; y < 200; y++) {
+            for (int x = 0; x < 200; x++) {
+                mismatched += SkTAbs(*expected.getAddr8(x, y) - *actual.getAddr8(x, y)) > 128;
+            }
+        }
+        REPORTER_ASSERT(reporter, mismatched < 20, "path %d: %d pixels differ", i, mismatched);
+    }
+}
@@ -7,8 +7,11 @@
 
 #include "SkDiscardableMemory.h"
 #include "SkResourceCache.h"
+#include "SkTaskGroup.h"
 #include "Test.h"
 
+#include <atomic>
+
 namespace {
 static void* gGlobalAddress;
 struct TestingKey : public SkResourceCache::Key {
@@ -150,3 +153,72 @@ DEF_TEST(ImageCache_doubleAdd, r) {
     REPORTER_ASSERT(r, cache.find(key, TestingRec::Visitor, &value));
     REPORTER_ASSERT(r, 2 == value || 3 == value);
 }
+
+namespace {
+static std::atomic<int> gDeletedWhileLocked{0};
+
+// Like the discardable recs: a find() locks the rec, which keeps it from being purged, and once
+// nobody has it locked its memory may be discarded, leaving it stale (fLocks < 0).
+struct LockingRec : public SkResourceCache::Rec {
+    LockingRec(const TestingKey& key) : fKey(key) {}
+    ~LockingRec() override {
+        if (fLocks.load() > 0) {
+            gDeletedWhileLocked++;
+        }
+    }
+
+    TestingKey       fKey;
+    std::atomic<int> fLocks{0};
+
+    const Key& getKey() const override { return fKey; }
+    size_t bytesUsed() const override { return sizeof(*this); }
+    const char* getCategory() const override { return "test_cache"; }
+    bool canBePurged() override { return fLocks.load() <= 0; }
+
+    void postAddInstall(void* payload) override {
+        fLocks++;
+        *static_cast<LockingRec**>(payload) = this;
+    }
+
+    void unlockAndDiscard() {
+        int unlocked = 0;
+        fLocks--;
+        fLocks.compare_exchange_strong(unlocked, -1);
+    }
+
+    static bool Visitor(const SkResourceCache::Rec& baseRec, void* context) {
+        LockingRec* rec = const_cast<LockingRec*>(static_cast<const LockingRec*>(&baseRec));
+        int locks = rec->fLocks.load();
+        do {
+            if (locks < 0) {
+                return false;
+            }
+        } while (!rec->fLocks.compare_exchange_weak(locks, locks + 1));
+        *static_cast<LockingRec**>(context) = rec;
+        return true;
+    }
+};
+}
+
+DEF_TEST(ImageCache_findWhilePurging, r) {
+    // One thread keeps adding a rec, letting it go stale, and purging it, so the next rec is
+    // likely to land at the same address.  The others find it, and must never remove a rec that
+    // is locked, by the adder or by another finder.
+    SkResourceCache cache(4096);
+    const TestingKey key(1);
+    gDeletedWhileLocked = 0;
+
+    SkTaskGroup().batch(4, [&](int threadIndex) {
+        for (int i = 0; i < 20000; i++) {
+            LockingRec* rec = nullptr;
+            if (threadIndex == 0) {
+                cache.add(new LockingRec(key), &rec);
+                rec->unlockAndDiscard();
+                cache.purgeAll();
+            } else if (cache.find(key, LockingRec::Visitor, &rec)) {
+                rec->unlockAndDiscard();
+            }
+        }
+    });
+    REPORTER_ASSERT(r, 0 == gDeletedWhileLocked.load());
+}
@@ -12,6 +12,7 @@
 #include "SkAutoPixmapStorage.h"
 #include "SkBitmap.h"
 #include "SkCanvas.h"
+#include "SkCodec.h"
 #include "SkColorSpacePriv.h"
 #include "SkData.h"
 #include "SkImageEncoder.h"
@@ -22,10 +23,12 @@
 #include "SkPicture.h"
 #include "SkPictureRecorder.h"
 #include "SkRRect.h"
+#include "SkResourceCache.h"
 #include "SkSerialProcs.h"
 #include "SkStream.h"
 #include "SkSurface.h"
 #include "SkUtils.h"
+#include "SkYUVPlanesCache.h"
 #include "Test.h"
 
 #include "Resources.h"
@@ -1373,3 +1376,95 @@ DEF_TEST(Image_nonfinite_dst, reporter) {
     }
 }
 
+
+static int max_diff(const SkPixmap& a, const SkPixmap& b, double* meanDiff) {
+    int maxDiff = 0;
+    double sum = 0;
+    for (int y = 0; y < a.height(); y++) {
+        const uint8_t* pa = (const uint8_t*)a.addr(0, y);
+        const uint8_t* pb = (const uint8_t*)b.addr(0, y);
+        for (int i = 0; i < 4 * a.width(); i++) {
+            int diff = SkTAbs(pa[i] - pb[i]);
+            maxDiff = SkTMax(maxDiff, diff);
+            sum += diff;
+        }
+    }
+    *meanDiff = sum / (4.0 * a.width() * a.height());
+    return maxDiff;
+}
+
+// Lazy jpegs can decode straight to a reduced DCT scale for draws that are small enough.
+DEF_TEST(Image_Lazy_scaledDecode, r) {
+    sk_sp<SkImage> image = SkImage::MakeFromEncoded(
+            GetResourceAsData("images/mandrill_512_q075.jpg"));
+    SkImage_Base* ib = as_IB(image);
+
+    REPORTER_ASSERT(r, ib->scaledDimensions(1.0f) == image->dimensions());
+    REPORTER_ASSERT(r, ib->scaledDimensions(0.5f) == SkISize::Make(256, 256));
+    // Never smaller than asked for.
+    const SkISize size = ib->scaledDimensions(0.3f);
+    REPORTER_ASSERT(r, size.width() >= 154 && size.width() < 512);
+
+    SkBitmap scaled, again, full;
+    const SkISize half = SkISize::Make(256, 256);
+    REPORTER_ASSERT(r, ib->getScaledROPixels(&scaled, half));
+    REPORTER_ASSERT(r, scaled.dimensions() == half);
+    REPORTER_ASSERT(r, ib->getScaledROPixels(&again, half));
+    REPORTER_ASSERT(r, again.getPixels() == scaled.getPixels());
+
+    // Subsets always decode at full size.
+    sk_sp<SkImage> subset = image->makeSubset(SkIRect::MakeWH(256, 256));
+    REPORTER_ASSERT(r, as_IB(subset)->scaledDimensions(0.5f) == subset->dimensions());
+
+    REPORTER_ASSERT(r, ib->getROPixels(&full));
+    SkAutoPixmapStorage expected;
+    expected.alloc(scaled.info());
+    REPORTER_ASSERT(r, full.pixmap().scalePixels(expected, kMedium_SkFilterQuality));
+    double meanDiff;
+    max_diff(scaled.pixmap(), expected, &meanDiff);
+    REPORTER_ASSERT(r, meanDiff < 10, "mean diff %g", meanDiff);
+}
+
+// Raster decodes of lazy jpegs match the codec exactly, and leave no YUV planes behind.  They
+// still match exactly when planes are already cached, e.g. by a texture upload.
+DEF_TEST(Image_Lazy_yuvDecode, r) {
+    sk_sp<SkData> data = GetResourceAsData("images/mandrill_512_q075.jpg");
+    sk_sp<SkImage> image = SkImage::MakeFromEncoded(data);
+
+    std::unique_ptr<SkCodec> codec = SkCodec::MakeFromData(data);
+    SkBitmap expected;
+    expected.allocPixels(codec->getInfo().makeColorType(kN32_SkColorType));
+    REPORTER_ASSERT(r, SkCodec::kSuccess == codec->getPixels(expected.pixmap()));
+
+    SkBitmap bm;
+    double meanDiff;
+    REPORTER_ASSERT(r, as_IB(image)->getROPixels(&bm, SkImage::kDisallow_CachingHint));
+    REPORTER_ASSERT(r, 0 == max_diff(bm.pixmap(), expected.pixmap(), &meanDiff));
+
+    SkYUVPlanesCache::Info info;
+    sk_sp<SkCachedData> planes(SkYUVPlanesCache::FindAndRef(image->uniqueID(), &info));
+    REPORTER_ASSERT(r, !planes);
+
+    REPORTER_ASSERT(r, codec->queryYUV8(&info.fSizeInfo, &info.fColorSpace));
+    size_t totalSize = 0;
+    void* planePtrs[SkYUVASizeInfo::kMaxCount] = {};
+    for (int i = 0; i < 3; ++i) {
+        totalSize += info.fSizeInfo.fWidthBytes[i] * info.fSizeInfo.fSizes[i].height();
+    }
+    planes.reset(SkResourceCache::NewCachedData(totalSize));
+    planePtrs[0] = planes->writable_data();
+    for (int i = 1; i < 3; ++i) {
+        planePtrs[i] = (uint8_t*)planePtrs[i-1] +
+                       info.fSizeInfo.fWidthBytes[i-1] * info.fSizeInfo.fSizes[i-1].height();
+    }
+    REPORTER_ASSERT(r, SkCodec::kSuccess == codec->getYUV8Planes(info.fSizeInfo, planePtrs));
+    for (int i = 0; i < 3; ++i) {
+        info.fYUVAIndices[i] = { i, SkColorChannel::kR };
+    }
+    info.fYUVAIndices[SkYUVAIndex::kA_Index] = { -1, SkColorChannel::kR };
+    SkYUVPlanesCache::Add(image->uniqueID(), planes.get(), &info);
+
+    // Raster decodes must not depend on whether planes happen to be cached.
+    REPORTER_ASSERT(r, as_IB(image)->getROPixels(&bm, SkImage::kDisallow_CachingHint));
+    REPORTER_ASSERT(r, 0 == max_diff(bm.pixmap(), expected.pixmap(), &meanDiff));
+}
@@ -6,7 +6,10 @@
  */
 
 #include "SkBitmap.h"
+#include "SkExecutor.h"
+#include "SkHalf.h"
 #include "SkMipMap.h"
+#include "SkOpts.h"
 #include "SkRandom.h"
 #include "Test.h"
 
@@ -209,3 +212,143 @@ DEF_TEST(MipMap_F16, reporter) {
     bmp.eraseColor(0);
     sk_sp<SkMipMap> mipmap(SkMipMap::Build(bmp, nullptr));
 }
+
+static void fill_random(SkBitmap* bm, SkRandom* rand) {
+    uint8_t* row = (uint8_t*)bm->getPixels();
+    for (int y = 0; y < bm->height(); ++y, row += bm->rowBytes()) {
+        if (bm->colorType() == kRGBA_F16_SkColorType) {
+            // Random bits could be NaN, so stick to halfs made from [0,1) floats.
+            SkHalf* px = (SkHalf*)row;
+            for (int x = 0; x < 4 * bm->width(); ++x) {
+                px[x] = SkFloatToHalf(rand->nextF());
+            }
+        } else {
+            for (size_t x = 0; x < bm->info().minRowBytes(); ++x) {
+                row[x] = rand->nextU() & 0xFF;
+            }
+        }
+    }
+}
+
+static bool levels_match(const SkMipMap* a, const SkMipMap* b) {
+    if (a->countLevels() != b->countLevels()) {
+        return false;
+    }
+    for (int i = 0; i < a->countLevels(); ++i) {
+        SkMipMap::Level la, lb;
+        if (!a->getLevel(i, &la) || !b->getLevel(i, &lb)) {
+            return false;
+        }
+        for (int y = 0; y < la.fPixmap.height(); ++y) {
+            if (memcmp(la.fPixmap.addr(0, y), lb.fPixmap.addr(0, y),
+                       la.fPixmap.info().minRowBytes())) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+// Building lazily or on an executor must produce exactly what a plain build does.
+DEF_TEST(MipMap_BuildModes, reporter) {
+    std::unique_ptr<SkExecutor> executor = SkExecutor::MakeFIFOThreadPool(4);
+    SkRandom rand;
+    const SkColorType colorTypes[] = {
+        kN32_SkColorType, kAlpha_8_SkColorType, kRGBA_F16_SkColorType, kRGB_565_SkColorType,
+    };
+    const SkISize sizes[] = { {1024, 1024}, {1023, 1023}, {1024, 511}, {37, 1}, {1, 40} };
+    for (SkColorType ct : colorTypes) {
+        for (SkISize size : sizes) {
+            SkBitmap bm;
+            bm.allocPixels(SkImageInfo::Make(size.width(), size.height(), ct,
+                                             kPremul_SkAlphaType));
+            fill_random(&bm, &rand);
+
+            sk_sp<SkMipMap> eager(SkMipMap::Build(bm, nullptr));
+            sk_sp<SkMipMap> threaded(SkMipMap::Build(bm, nullptr, executor.get()));
+            sk_sp<SkMipMap> lazy(SkMipMap::BuildLazily(bm, nullptr));
+            REPORTER_ASSERT(reporter, eager && threaded && lazy);
+            if (!eager || !threaded || !lazy) {
+                continue;
+            }
+
+            // Asks for the second level, then fills in the rest through getLevel().
+            REPORTER_ASSERT(reporter, lazy->countLevels() < 2 ||
+                                      lazy->extractLevel(SkSize::Make(0.25f, 0.25f), nullptr));
+            REPORTER_ASSERT(reporter, levels_match(eager.get(), threaded.get()));
+            REPORTER_ASSERT(reporter, levels_match(eager.get(), lazy.get()));
+        }
+    }
+}
+
+// The 2x2 box filter for 8888 averages each channel, rounding down.
+DEF_TEST(MipMap_Box8888, reporter) {
+    SkRandom rand;
+    SkBitmap bm;
+    bm.allocPixels(SkImageInfo::Make(70, 6, kRGBA_8888_SkColorType, kPremul_SkAlphaType));
+    fill_random(&bm, &rand);
+    sk_sp<SkMipMap> mipmap(SkMipMap::Build(bm, nullptr));
+    SkMipMap::Level level;
+    REPORTER_ASSERT(reporter, mipmap && mipmap->getLevel(0, &level));
+    if (!mipmap) {
+        return;
+    }
+    for (int y = 0; y < level.fPixmap.height(); ++y) {
+        for (int x = 0; x < level.fPixmap.width(); ++x) {
+            const uint8_t* s0 = (const uint8_t*)bm.getAddr(2*x, 2*y);
+            const uint8_t* s1 = (const uint8_t*)bm.getAddr(2*x, 2*y + 1);
+            const uint8_t* d  = (const uint8_t*)level.fPixmap.addr(x, y);
+            for (int c = 0; c < 4; ++c) {
+                int expected = (s0[c] + s0[c + 4] + s1[c] + s1[c + 4]) >> 2;
+                REPORTER_ASSERT(reporter, d[c] == expected);
+            }
+        }
+    }
+}
+
+// The SkOpts 2x2 box and 3x3 triangle filters for 8888 and A8 must match the portable filters,
+// per channel: (a + b + c + d) >> 2, and the (1,2,1) x (1,2,1) weighted sum >> 4.
+DEF_TEST(MipMap_DownsampleOpts, reporter) {
+    SkRandom rand;
+    uint8_t src[3 * 4 * 160], dst[4 * 72], expected[4 * 72];
+    for (int bpp : { 4, 1 }) {
+        for (int count = 1; count <= 70; count++) {
+            const size_t srcRB = (2 * count + 1) * bpp + rand.nextULessThan(8) * bpp;
+            for (size_t i = 0; i < 3 * srcRB; i++) {
+                src[i] = (uint8_t)rand.nextU();
+            }
+            auto s = [&](int row, int x, int c) { return (int)src[row * srcRB + x * bpp + c]; };
+
+            const int n = count * bpp;
+            for (int box : { 2, 3 }) {
+                for (int x = 0; x < count; x++) {
+                    for (int c = 0; c < bpp; c++) {
+                        int sum;
+                        if (box == 2) {
+                            sum = (s(0, 2*x, c) + s(0, 2*x + 1, c) +
+                                   s(1, 2*x, c) + s(1, 2*x + 1, c)) >> 2;
+                        } else {
+                            auto column = [&](int col) {
+                                return s(0, col, c) + 2 * s(1, col, c) + s(2, col, c);
+                            };
+                            sum = (column(2*x) + 2 * column(2*x + 1) + column(2*x + 2)) >> 4;
+                        }
+                        expected[x * bpp + c] = (uint8_t)sum;
+                    }
+                }
+                // The bytes past count must be left alone.
+                memset(dst, 0xAB, sizeof(dst));
+                memset(expected + n, 0xAB, sizeof(expected) - n);
+
+                SkOpts::Downsample proc = bpp == 4 ? (box == 2 ? SkOpts::downsample_2_2_8888
+                                                               : SkOpts::downsample_3_3_8888)
+                                                   : (box == 2 ? SkOpts::downsample_2_2_a8
+                                                               : SkOpts::downsample_3_3_a8);
+                proc(dst, src, srcRB, count);
+                REPORTER_ASSERT(reporter, 0 == memcmp(dst, expected, sizeof(dst)),
+                                "%dx%d filter, %d bytes per pixel, count %d",
+                                box, box, bpp, count);
+            }
+        }
+    }
+}
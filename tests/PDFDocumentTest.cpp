@@ -9,6 +9,8 @@
 #include "Resources.h"
 #include "SkCanvas.h"
 #include "SkExecutor.h"
+#include "SkFont.h"
+#include "SkImage.h"
 #include "SkOSFile.h"
 #include "SkOSPath.h"
 #include "SkPDFDocument.h"
@@ -256,3 +258,42 @@ DEF_TEST(SkPDF_abort_jobs, rep) {
     doc->abort();
 }
 
+
+static sk_sp<SkData> make_document_with_images(SkExecutor* executor) {
+    SkBitmap opaque, translucent;
+    opaque.allocN32Pixels(64, 64);
+    opaque.eraseColor(SK_ColorBLUE);
+    translucent.allocN32Pixels(64, 64);
+    translucent.eraseColor(0x4F9643A0);
+    sk_sp<SkImage> encoded = GetResourceAsImage("images/yellow_rose.png");
+
+    SkPDF::Metadata metadata;
+    metadata.fExecutor = executor;
+    SkDynamicMemoryWStream stream;
+    auto doc = SkPDF::MakeDocument(&stream, metadata);
+    for (int i = 0; i < 8; ++i) {
+        SkCanvas* canvas = doc->beginPage(612, 792);
+        opaque.notifyPixelsChanged();
+        translucent.notifyPixelsChanged();
+        canvas->drawBitmap(opaque, 0, 0);
+        canvas->drawBitmap(translucent, 100, 0);
+        if (encoded) {
+            canvas->drawImage(encoded, 0, 100);
+        }
+        canvas->drawString("Hello, World!", 36, 400, SkFont(), SkPaint());
+        doc->endPage();
+    }
+    doc->close();
+    return stream.detachAsData();
+}
+
+// Objects serialized by the executor must come out in the same order as without one.
+DEF_TEST(SkPDF_executor_is_deterministic, r) {
+    REQUIRE_PDF_DOCUMENT(SkPDF_executor_is_deterministic, r);
+    sk_sp<SkData> expected = make_document_with_images(nullptr);
+    std::unique_ptr<SkExecutor> executor = SkExecutor::MakeFIFOThreadPool(4);
+    for (int i = 0; i < 4; ++i) {
+        sk_sp<SkData> actual = make_document_with_images(executor.get());
+        REPORTER_ASSERT(r, actual->equals(expected.get()));
+    }
+}
@@ -8,6 +8,8 @@
 #include "PathOpsExtendedTest.h"
 #include "PathOpsTestCommon.h"
 #include "SkBitmap.h"
+#include "SkExecutor.h"
+#include "SkRandom.h"
 #include "Test.h"
 
 DEF_TEST(PathOpsBuilder, reporter) {
@@ -79,6 +81,126 @@ DEF_TEST(PathOpsBuilder, reporter) {
     REPORTER_ASSERT(reporter, pixelDiff == 0);
 }
 
+// Resolving clusters of touching paths separately must cover the same area as resolving the
+// whole union at once.
+DEF_TEST(PathOpsBuilderClusters, reporter) {
+    std::unique_ptr<SkExecutor> executor = SkExecutor::MakeFIFOThreadPool(4);
+    SkRandom rand;
+    SkOpBuilder serial, clustered, threaded;
+    for (int i = 0; i < 200; ++i) {
+        SkScalar x = rand.nextRangeScalar(0, 400),
+                 y = rand.nextRangeScalar(0, 400),
+                 w = rand.nextRangeScalar(2, 30),
+                 h = rand.nextRangeScalar(2, 30);
+        SkPath path;
+        switch (i % 3) {
+            case 0: path.addRect(x, y, x + w, y + h); break;
+            case 1: path.addOval(SkRect::MakeXYWH(x, y, w, h)); break;
+            case 2:
+                path.moveTo(x, y);
+                path.lineTo(x + w, y + h);
+                path.lineTo(x, y + h);
+                path.lineTo(x + w, y);
+                path.close();
+                break;
+        }
+        serial.add(path, kUnion_SkPathOp);
+        clustered.add(path, kUnion_SkPathOp);
+        threaded.add(path, kUnion_SkPathOp);
+    }
+    // Two squares that only share an edge still merge into one rect.
+    SkPath left, right;
+    left.addRect(500, 0, 510, 10);
+    right.addRect(510, 0, 520, 10);
+    for (SkOpBuilder* builder : { &serial, &clustered, &threaded }) {
+        builder->add(left, kUnion_SkPathOp);
+        builder->add(right, kUnion_SkPathOp);
+    }
+
+    SkPath expected, resultA, resultB;
+    REPORTER_ASSERT(reporter, serial.resolve(&expected));
+    REPORTER_ASSERT(reporter, clustered.resolve(&resultA, nullptr));
+    REPORTER_ASSERT(reporter, threaded.resolve(&resultB, executor.get()));
+    REPORTER_ASSERT(reporter, 0 == comparePaths(reporter, __FUNCTION__, expected, resultA));
+    REPORTER_ASSERT(reporter, 0 == comparePaths(reporter, __FUNCTION__, expected, resultB));
+    REPORTER_ASSERT(reporter, resultA == resultB);
+
+    // Anything other than a union falls back to resolving the operands in order.
+    SkPath hole;
+    hole.addRect(0, 0, 200, 200);
+    clustered.add(expected, kUnion_SkPathOp);
+    clustered.add(hole, kDifference_SkPathOp);
+    serial.add(expected, kUnion_SkPathOp);
+    serial.add(hole, kDifference_SkPathOp);
+    REPORTER_ASSERT(reporter, serial.resolve(&resultA));
+    REPORTER_ASSERT(reporter, clustered.resolve(&resultB, executor.get()));
+    REPORTER_ASSERT(reporter, resultA == resultB);
+}
+
+// The all-union shortcut must not skip a convex path that overlaps an earlier concave one. Their
+// windings need not agree, and this rect used to cancel out the ring of the donut it overlaps.
+DEF_TEST(PathOpsBuilderUnionConvexAfterConcave, reporter) {
+    SkPath donut, rect;
+    donut.addRect(10, 10, 50, 50, SkPath::kCCW_Direction);
+    donut.addRect(20, 20, 40, 40, SkPath::kCW_Direction);
+    rect.addRect(30, 15, 70, 45, SkPath::kCW_Direction);
+    SkPath expected;
+    Op(donut, rect, kUnion_SkPathOp, &expected);
+
+    SkOpBuilder builder;
+    builder.add(donut, kUnion_SkPathOp);
+    builder.add(rect, kUnion_SkPathOp);
+    SkPath result;
+    REPORTER_ASSERT(reporter, builder.resolve(&result));
+    REPORTER_ASSERT(reporter, result.contains(45, 30));
+    REPORTER_ASSERT(reporter, !result.contains(25, 30));
+    REPORTER_ASSERT(reporter, 0 == comparePaths(reporter, __FUNCTION__, expected, result));
+}
+
+// If any cluster fails to resolve, so does the whole union, and like resolve(), it leaves the
+// result as it was. Simplify() gives up on this fuzzed path, which does not touch the rect.
+DEF_TEST(PathOpsBuilderClustersFail, reporter) {
+    SkPath fuzz;
+    fuzz.moveTo(SkBits2Float(0x00000000), SkBits2Float(0x00000000));  // 0, 0
+    fuzz.cubicTo(SkBits2Float(0xbcb63000), SkBits2Float(0xb6b6b6b7), SkBits2Float(0x38b6b6b6), SkBits2Float(0xafb63a5a), SkBits2Float(0xca000087), SkBits2Float(0xe93ae9e9));  // -0.0222397f, -5.44529e-06f, 8.71247e-05f, -3.31471e-10f, -2.09719e+06f, -1.41228e+25f
+    fuzz.quadTo(SkBits2Float(0xb6007fb6), SkBits2Float(0xb69fb6b6), SkBits2Float(0xe9e964b6), SkBits2Float(0xe9e9e9e9));  // -1.91478e-06f, -4.75984e-06f, -3.52694e+25f, -3.5348e+25f
+    fuzz.quadTo(SkBits2Float(0xb6b6b8b7), SkBits2Float(0xb60000b6), SkBits2Float(0xb6b6b6b6), SkBits2Float(0xe9e92064));  // -5.44553e-06f, -1.90739e-06f, -5.44529e-06f, -3.52291e+25f
+    fuzz.quadTo(SkBits2Float(0x000200e9), SkBits2Float(0xe9e9d100), SkBits2Float(0xe93ae9e9), SkBits2Float(0xe964b6e9));  // 1.83997e-40f, -3.53333e+25f, -1.41228e+25f, -1.72812e+25f
+    fuzz.quadTo(SkBits2Float(0x40b6e9e9), SkBits2Float(0xe9b60000), SkBits2Float(0x00b6b8e9), SkBits2Float(0xe9000001));  // 5.71605f, -2.75031e+25f, 1.67804e-38f, -9.67141e+24f
+    fuzz.quadTo(SkBits2Float(0xe9d3b6b2), SkBits2Float(0x40404540), SkBits2Float(0x803d4043), SkBits2Float(0xe9e9e9ff));  // -3.19933e+25f, 3.00423f, -5.62502e-39f, -3.53481e+25f
+    fuzz.cubicTo(SkBits2Float(0x00000000), SkBits2Float(0xe8b3b6b6), SkBits2Float(0xe90a0003), SkBits2Float(0x4040403c), SkBits2Float(0x803d4040), SkBits2Float(0xe9e80900));  // 0, -6.78939e+24f, -1.0427e+25f, 3.00392f, -5.62501e-39f, -3.50642e+25f
+    fuzz.quadTo(SkBits2Float(0xe9e910e9), SkBits2Float(0xe9e93ae9), SkBits2Float(0x0000b6b6), SkBits2Float(0xb6b6aab6));  // -3.52199e+25f, -3.52447e+25f, 6.55443e-41f, -5.4439e-06f
+    fuzz.moveTo(SkBits2Float(0xe9e92064), SkBits2Float(0xe9e9d106));  // -3.52291e+25f, -3.53334e+25f
+    fuzz.quadTo(SkBits2Float(0xe9e93ae9), SkBits2Float(0x0000abb6), SkBits2Float(0xb6b6bdb6), SkBits2Float(0xe92064b6));  // -3.52447e+25f, 6.15983e-41f, -5.44611e-06f, -1.2119e+25f
+    fuzz.quadTo(SkBits2Float(0x0000e9e9), SkBits2Float(0xb6b6b6e9), SkBits2Float(0x05ffff05), SkBits2Float(0xe9ea06e9));  // 8.39112e-41f, -5.44532e-06f, 2.40738e-35f, -3.53652e+25f
+    fuzz.quadTo(SkBits2Float(0xe93ae9e9), SkBits2Float(0x02007fe9), SkBits2Float(0xb8b7b600), SkBits2Float(0xe9e9b6b6));  // -1.41228e+25f, 9.44066e-38f, -8.76002e-05f, -3.53178e+25f
+    fuzz.quadTo(SkBits2Float(0xe9e9e9b6), SkBits2Float(0xedb6b6b6), SkBits2Float(0x5a38a1b6), SkBits2Float(0xe93ae9e9));  // -3.53479e+25f, -7.06839e+27f, 1.29923e+16f, -1.41228e+25f
+    fuzz.quadTo(SkBits2Float(0x0000b6b6), SkBits2Float(0xb6b6b6b6), SkBits2Float(0xe9e9e9b6), SkBits2Float(0xe9e9e954));  // 6.55443e-41f, -5.44529e-06f, -3.53479e+25f, -3.53477e+25f
+    fuzz.quadTo(SkBits2Float(0xb6e9e93a), SkBits2Float(0x375837ff), SkBits2Float(0xceb6b6b6), SkBits2Float(0x0039e94f));  // -6.97109e-06f, 1.28876e-05f, -1.53271e+09f, 5.31832e-39f
+    fuzz.quadTo(SkBits2Float(0xe9e9e9e9), SkBits2Float(0xe9e6e9e9), SkBits2Float(0xb6b641b6), SkBits2Float(0xede9e9e9));  // -3.5348e+25f, -3.48947e+25f, -5.43167e-06f, -9.0491e+27f
+    fuzz.moveTo(SkBits2Float(0xb6b6e9e9), SkBits2Float(0xb6b60000));  // -5.45125e-06f, -5.42402e-06f
+    fuzz.moveTo(SkBits2Float(0xe9b6b6b6), SkBits2Float(0xe9b6b8e9));  // -2.76109e+25f, -2.76122e+25f
+    fuzz.close();
+    fuzz.moveTo(SkBits2Float(0xe9b6b6b6), SkBits2Float(0xe9b6b8e9));  // -2.76109e+25f, -2.76122e+25f
+    fuzz.quadTo(SkBits2Float(0xe93ae9e9), SkBits2Float(0xe964b6e9), SkBits2Float(0x0000203a), SkBits2Float(0xb6000000));  // -1.41228e+25f, -1.72812e+25f, 1.15607e-41f, -1.90735e-06f
+    fuzz.moveTo(SkBits2Float(0x64b6b6b6), SkBits2Float(0xe9e9e900));  // 2.69638e+22f, -3.53475e+25f
+    fuzz.quadTo(SkBits2Float(0xb6b6b6e9), SkBits2Float(0xb6b6b6b6), SkBits2Float(0xe9e9b6ce), SkBits2Float(0xe9e93ae9));  // -5.44532e-06f, -5.44529e-06f, -3.53179e+25f, -3.52447e+25f
+    SkPath rect;
+    rect.addRect(0, 100, 10, 110);
+
+    std::unique_ptr<SkExecutor> executor = SkExecutor::MakeFIFOThreadPool(2);
+    for (SkExecutor* clusterExecutor : { (SkExecutor*)nullptr, executor.get() }) {
+        SkOpBuilder builder;
+        builder.add(fuzz, kUnion_SkPathOp);
+        builder.add(rect, kUnion_SkPathOp);
+        SkPath result;
+        result.addCircle(50, 50, 10);
+        const SkPath original = result;
+        REPORTER_ASSERT(reporter, !builder.resolve(&result, clusterExecutor));
+        REPORTER_ASSERT(reporter, result == original);
+    }
+}
+
 DEF_TEST(BuilderIssue3838, reporter) {
     SkPath path;
     path.moveTo(200, 170);
@@ -14,6 +14,7 @@
 #include "SkClipOpPriv.h"
 #include "SkColor.h"
 #include "SkData.h"
+#include "SkExecutor.h"
 #include "SkFontStyle.h"
 #include "SkImageInfo.h"
 #include "SkMatrix.h"
@@ -35,6 +36,7 @@
 #include "Test.h"
 
 #include <memory>
+#include <vector>
 
 class SkRRect;
 class SkRegion;
@@ -879,3 +881,174 @@ DEF_TEST(Picture_empty_serial, reporter) {
     REPORTER_ASSERT(reporter, pic2);
 }
 
+
+DEF_TEST(Picture_playbackParallel, r) {
+    const int w = 300, h = 200;
+
+    SkRTreeFactory factory;
+    SkPictureRecorder recorder;
+    SkCanvas* c = recorder.beginRecording(SkIntToScalar(w), SkIntToScalar(h), &factory);
+    SkRandom rand;
+    SkPaint paint;
+    for (int i = 0; i < 100; i++) {
+        paint.setColor(rand.nextU() | 0xFF000000);
+        paint.setAntiAlias(rand.nextBool());
+        const SkRect rect = SkRect::MakeXYWH(rand.nextRangeF(-10, w), rand.nextRangeF(-10, h),
+                                             rand.nextRangeF(1, 80), rand.nextRangeF(1, 80));
+        if (i % 2) {
+            c->drawOval(rect, paint);
+        } else {
+            c->drawRect(rect, paint);
+        }
+    }
+    sk_sp<SkPicture> picture = recorder.finishRecordingAsPicture();
+
+    SkTDArray<SkIRect> tiles;
+    for (int y = 0; y < h; y += 64) {
+        for (int x = 0; x < w; x += 64) {
+            tiles.push_back(SkIRect::MakeLTRB(x, y, SkTMin(x + 64, w), SkTMin(y + 64, h)));
+        }
+    }
+
+    // Clipping curves to a tile can move their edges slightly, so we compare against the same
+    // tiles played back one after another rather than against an untiled playback.
+    SkBitmap expected;
+    expected.allocN32Pixels(w, h);
+    expected.eraseColor(SK_ColorWHITE);
+    for (const SkIRect& tile : tiles) {
+        SkPixmap subset;
+        REPORTER_ASSERT(r, expected.pixmap().extractSubset(&subset, tile));
+        auto canvas = SkCanvas::MakeRasterDirect(subset.info(), subset.writable_addr(),
+                                                 subset.rowBytes());
+        canvas->translate(-tile.fLeft, -tile.fTop);
+        picture->playback(canvas.get());
+    }
+
+    SkBitmap actual;
+    actual.allocN32Pixels(w, h);
+    actual.eraseColor(SK_ColorWHITE);
+
+    std::unique_ptr<SkExecutor> executor = SkExecutor::MakeFIFOThreadPool(3);
+    std::vector<std::unique_ptr<SkCanvas>> canvases(tiles.count());
+    picture->playbackParallel(tiles.begin(), tiles.count(), *executor,
+                              [&](int i, const SkIRect& tile) -> SkCanvas* {
+        SkPixmap subset;
+        REPORTER_ASSERT(r, actual.pixmap().extractSubset(&subset, tile));
+        canvases[i] = SkCanvas::MakeRasterDirect(subset.info(), subset.writable_addr(),
+                                                 subset.rowBytes());
+        return canvases[i].get();
+    });
+
+    REPORTER_ASSERT(r, 0 == memcmp(expected.getPixels(), actual.getPixels(),
+                                   expected.computeByteSize()));
+}
+
+#include "Resources.h"
+#include "SkFont.h"
+#include "SkPictureCommon.h"
+#include "SkPictureData.h"
+#include "SkPictureStreamReader.h"
+
+static sk_sp<SkPicture> make_streamed(const SkData* skp, size_t chunkSize) {
+    SkPictureStreamReader reader;
+    for (size_t offset = 0; offset < skp->size(); offset += chunkSize) {
+        if (!reader.append(skp->bytes() + offset, SkTMin(chunkSize, skp->size() - offset))) {
+            return nullptr;
+        }
+    }
+    return reader.finish();
+}
+
+static SkBitmap draw_picture(const SkPicture* picture, const SkIRect& clip) {
+    SkBitmap bitmap;
+    bitmap.allocN32Pixels(clip.width(), clip.height());
+    bitmap.eraseColor(SK_ColorWHITE);
+    SkCanvas canvas(bitmap);
+    canvas.translate(-clip.fLeft, -clip.fTop);
+    canvas.drawPicture(picture);
+    return bitmap;
+}
+
+DEF_TEST(Picture_StreamReader, r) {
+    const SkRect bounds = SkRect::MakeWH(256, 256);
+
+    // Big enough that drawPicture() keeps it as a sub-picture instead of unrolling it.
+    SkPictureRecorder subRecorder;
+    SkCanvas* subCanvas = subRecorder.beginRecording(bounds);
+    subCanvas->drawCircle(32, 32, 20, SkPaint());
+    subCanvas->drawRect(SkRect::MakeXYWH(200, 200, 30, 30), SkPaint());
+    sk_sp<SkPicture> subPicture = subRecorder.finishRecordingAsPicture();
+
+    SkPictureRecorder recorder;
+    SkCanvas* canvas = recorder.beginRecording(bounds);
+    SkRandom rand;
+    SkPaint paint;
+    for (int i = 0; i < 50; i++) {
+        paint.setColor(rand.nextU() | 0xFF000000);
+        canvas->drawRect(SkRect::MakeXYWH(rand.nextRangeF(0, 240), rand.nextRangeF(0, 240),
+                                          rand.nextRangeF(1, 60), rand.nextRangeF(1, 60)), paint);
+    }
+    SkPath path;
+    path.addOval(SkRect::MakeXYWH(100, 10, 80, 40));
+    canvas->drawPath(path, paint);
+    canvas->drawString("streamed", 10, 200, SkFont(), paint);
+    if (sk_sp<SkImage> image = GetResourceAsImage("images/mandrill_128.png")) {
+        canvas->drawImage(image, 120, 120);
+    }
+    canvas->drawPicture(subPicture);
+    sk_sp<SkPicture> picture = recorder.finishRecordingAsPicture();
+    sk_sp<SkData> skp = picture->serialize();
+
+    sk_sp<SkPicture> full = SkPicture::MakeFromData(skp.get());
+    REPORTER_ASSERT(r, full);
+    const SkIRect all  = SkIRect::MakeWH(256, 256),
+                  tile = SkIRect::MakeXYWH(64, 64, 128, 96);
+    SkBitmap expectedAll  = draw_picture(full.get(), all),
+             expectedTile = draw_picture(full.get(), tile);
+
+    // Stream in chunks of various sizes, then all at once in place (chunk size 0).
+    for (size_t chunkSize : { (size_t)1, (size_t)7, (size_t)1000, skp->size(), (size_t)0 }) {
+        sk_sp<SkPicture> streamed = chunkSize ? make_streamed(skp.get(), chunkSize)
+                                              : SkPictureStreamReader::MakeFromData(skp);
+        REPORTER_ASSERT(r, streamed);
+        if (!streamed) {
+            continue;
+        }
+        REPORTER_ASSERT(r, streamed->cullRect() == full->cullRect());
+        REPORTER_ASSERT(r, streamed->approximateOpCount() >= full->approximateOpCount());
+
+        // The tile seeks through the picture's SkRTree, the whole picture plays back directly.
+        SkBitmap actualAll  = draw_picture(streamed.get(), all),
+                 actualTile = draw_picture(streamed.get(), tile);
+        REPORTER_ASSERT(r, 0 == memcmp(expectedAll.getPixels(), actualAll.getPixels(),
+                                       expectedAll.computeByteSize()));
+        REPORTER_ASSERT(r, 0 == memcmp(expectedTile.getPixels(), actualTile.getPixels(),
+                                       expectedTile.computeByteSize()));
+    }
+
+    // A truncated picture never finishes.
+    sk_sp<SkData> truncated = SkData::MakeSubset(skp.get(), 0, skp->size() - 8);
+    REPORTER_ASSERT(r, !make_streamed(truncated.get(), 100));
+
+    // An unknown op is caught as soon as it arrives. The first op follows the header, padding, and
+    // the tag and size of the op section. Its type is in the top byte of its first uint32_t.
+    SkMemoryStream header(skp);
+    SkPictInfo info;
+    uint8_t trailingByte;
+    uint32_t tag, size;
+    REPORTER_ASSERT(r, SkPicture_StreamIsSKP(&header, &info) && header.readU8(&trailingByte) &&
+                       header.readU32(&tag) && header.readU32(&size));
+    if (SK_PICT_PADDING_TAG == tag) {
+        REPORTER_ASSERT(r, header.skip(size) == size &&
+                           header.readU32(&tag) && header.readU32(&size));
+    }
+    REPORTER_ASSERT(r, SK_PICT_READER_TAG == tag);
+    const size_t firstOp = header.getPosition();
+    // The ops are padded to be aligned, so MakeFromData() can reference them in place.
+    REPORTER_ASSERT(r, SkIsAlign4(firstOp));
+    sk_sp<SkData> corrupt = SkData::MakeWithCopy(skp->data(), skp->size());
+    static_cast<uint8_t*>(corrupt->writable_data())[firstOp + 3] = 0xFF;
+    SkPictureStreamReader reader;
+    REPORTER_ASSERT(r, !reader.append(corrupt->data(), firstOp + 4));
+    REPORTER_ASSERT(r, !reader.finish());
+}
@@ -8,6 +8,7 @@
 #include "Test.h"
 #include "RecordTestUtils.h"
 
+#include "SkBitmap.h"
 #include "SkBlurImageFilter.h"
 #include "SkColorFilter.h"
 #include "SkRecord.h"
@@ -427,3 +428,161 @@ DEF_TEST(savelayer_srcmode_alpha, r) {
     do_savelayer_srcmode(r, 0x80FF0000);
 }
 
+
+DEF_TEST(RecordOpts_CoalesceClips, r) {
+    SkRecord record;
+    SkRecorder recorder(&record, W, H);
+
+    recorder.clipRect(SkRect::MakeWH(200, 200));
+    recorder.clipRect(SkRect::MakeXYWH(50, 50, 200, 200));
+    recorder.clipRect(SkRect::MakeXYWH(0, 100, 120, 200));
+    recorder.drawRect(SkRect::MakeWH(300, 300), SkPaint());
+    recorder.clipRect(SkRect::MakeWH(100, 100), true);  // Anti-aliased clips are left alone.
+    recorder.clipRect(SkRect::MakeWH(90, 90));
+
+    SkRecordCoalesceClips(&record);
+
+    assert_type<SkRecords::NoOp>(r, record, 0);
+    assert_type<SkRecords::NoOp>(r, record, 1);
+    auto clip = assert_type<SkRecords::ClipRect>(r, record, 2);
+    REPORTER_ASSERT(r, clip->rect == SkRect::MakeLTRB(50, 100, 120, 200));
+    assert_type<SkRecords::ClipRect>(r, record, 4);
+    assert_type<SkRecords::ClipRect>(r, record, 5);
+}
+
+DEF_TEST(RecordOpts_CullOccludedDraws, r) {
+    SkPaint opaque;
+    SkPaint translucent;
+    translucent.setAlpha(0x80);
+    SkPaint aa;
+    aa.setAntiAlias(true);
+
+    {
+        SkRecord record;
+        SkRecorder recorder(&record, W, H);
+        recorder.drawRect(SkRect::MakeXYWH(10, 10, 50, 50), translucent);   // covered
+        recorder.drawOval(SkRect::MakeXYWH(10, 10, 50, 50), aa);            // bleeds out
+        recorder.drawRect(SkRect::MakeXYWH(90, 90, 50, 50), opaque);        // sticks out
+        recorder.drawRect(SkRect::MakeXYWH(80, 80, 100, 100), translucent); // can't cover it
+        recorder.drawRect(SkRect::MakeWH(100, 100), opaque);
+
+        SkRecordCullOccludedDraws(&record);
+        assert_type<SkRecords::NoOp>(r, record, 0);
+        assert_type<SkRecords::DrawOval>(r, record, 1);
+        assert_type<SkRecords::DrawRect>(r, record, 2);
+        assert_type<SkRecords::DrawRect>(r, record, 3);
+        assert_type<SkRecords::DrawRect>(r, record, 4);
+    }
+    {
+        // Draws under a different matrix or clip aren't compared.
+        SkRecord record;
+        SkRecorder recorder(&record, W, H);
+        recorder.drawRect(SkRect::MakeWH(50, 50), opaque);
+        recorder.translate(10, 10);
+        recorder.drawRect(SkRect::MakeWH(50, 50), opaque);
+        recorder.clipRect(SkRect::MakeWH(20, 20));
+        recorder.drawRect(SkRect::MakeWH(100, 100), opaque);
+
+        SkRecordCullOccludedDraws(&record);
+        REPORTER_ASSERT(r, 3 == count_instances_of_type<SkRecords::DrawRect>(record));
+    }
+    {
+        // An opaque drawPaint covers anything under the same clip.
+        SkRecord record;
+        SkRecorder recorder(&record, W, H);
+        recorder.drawOval(SkRect::MakeWH(50, 50), aa);
+        recorder.drawRect(SkRect::MakeWH(100, 100), translucent);
+        recorder.drawPaint(opaque);
+
+        SkRecordCullOccludedDraws(&record);
+        assert_type<SkRecords::NoOp>(r, record, 0);
+        assert_type<SkRecords::NoOp>(r, record, 1);
+        assert_type<SkRecords::DrawPaint>(r, record, 2);
+    }
+    {
+        // Nothing is culled once the record sets an anti-aliased clip.
+        SkRecord record;
+        SkRecorder recorder(&record, W, H);
+        recorder.drawRect(SkRect::MakeWH(50, 50), opaque);
+        recorder.drawPaint(opaque);
+        recorder.clipRect(SkRect::MakeWH(20, 20), true);
+
+        SkRecordCullOccludedDraws(&record);
+        assert_type<SkRecords::DrawRect>(r, record, 0);
+    }
+}
+
+DEF_TEST(RecordOpts_CullOccludedDraws_Pixels, r) {
+    auto draw = [](SkCanvas* canvas) {
+        SkPaint paint;
+        paint.setColor(SK_ColorBLUE);
+        canvas->drawRect(SkRect::MakeXYWH(2.5f, 3.5f, 10, 10), paint);
+        canvas->clipRect(SkRect::MakeWH(30, 30));
+        canvas->clipRect(SkRect::MakeXYWH(1.4f, 1.6f, 30, 30));
+        paint.setColor(SK_ColorGREEN);
+        canvas->drawRect(SkRect::MakeXYWH(2.5f, 3.5f, 10, 10), paint);
+        paint.setColor(SK_ColorRED);
+        canvas->drawRect(SkRect::MakeXYWH(2.4f, 3.4f, 10.2f, 10.2f), paint);
+    };
+
+    sk_sp<SkSurface> surf0 = SkSurface::MakeRasterN32Premul(40, 40);
+    sk_sp<SkSurface> surf1 = SkSurface::MakeRasterN32Premul(40, 40);
+
+    SkPictureRecorder rec0, rec1;
+    draw(rec0.beginRecording(40, 40));
+    draw(rec1.beginRecording(40, 40));
+    sk_sp<SkPicture> pic0 = rec0.finishRecordingAsPicture();
+    sk_sp<SkPicture> pic1 =
+            rec1.finishRecordingAsPicture(SkPictureRecorder::kOptimizeClipsAndOcclusion_FinishFlag);
+    REPORTER_ASSERT(r, pic1->approximateOpCount() < pic0->approximateOpCount());
+
+    surf0->getCanvas()->drawPicture(pic0);
+    surf1->getCanvas()->drawPicture(pic1);
+    REPORTER_ASSERT(r, is_equal(surf0.get(), surf1.get()));
+}
+
+// A nested picture's backdrop filter sees what was drawn before it, even if a later draw covers it.
+DEF_TEST(RecordOpts_CullOccludedDraws_NestedBackdrop, r) {
+    SkPictureRecorder nestedRecorder;
+    SkCanvas* nestedCanvas = nestedRecorder.beginRecording(100, 100);
+    sk_sp<SkImageFilter> blur = SkBlurImageFilter::Make(4, 4, nullptr);
+    const SkRect layerBounds = SkRect::MakeWH(100, 100);
+    nestedCanvas->saveLayer(SkCanvas::SaveLayerRec(&layerBounds, nullptr, blur.get(), 0));
+    nestedCanvas->restore();
+    sk_sp<SkPicture> nested = nestedRecorder.finishRecordingAsPicture();
+
+    auto draw = [&](SkCanvas* canvas) {
+        SkPaint paint;
+        paint.setColor(SK_ColorBLUE);
+        canvas->drawRect(SkRect::MakeWH(50, 50), paint);
+        canvas->drawPicture(nested);
+        paint.setColor(SK_ColorGREEN);
+        canvas->drawRect(SkRect::MakeWH(50, 50), paint);
+    };
+
+    SkRecord record;
+    SkRecorder recorder(&record, W, H);
+    draw(&recorder);
+    SkRecordCullOccludedDraws(&record);
+    REPORTER_ASSERT(r, 2 == count_instances_of_type<SkRecords::DrawRect>(record));
+    assert_type<SkRecords::DrawPicture>(r, record, 1);
+
+    sk_sp<SkSurface> surf0 = SkSurface::MakeRasterN32Premul(100, 100);
+    sk_sp<SkSurface> surf1 = SkSurface::MakeRasterN32Premul(100, 100);
+
+    SkPictureRecorder rec0, rec1;
+    draw(rec0.beginRecording(100, 100));
+    draw(rec1.beginRecording(100, 100));
+    sk_sp<SkPicture> pic0 = rec0.finishRecordingAsPicture();
+    sk_sp<SkPicture> pic1 =
+            rec1.finishRecordingAsPicture(SkPictureRecorder::kOptimizeClipsAndOcclusion_FinishFlag);
+    surf0->getCanvas()->drawPicture(pic0);
+    surf1->getCanvas()->drawPicture(pic1);
+    SkBitmap bm0, bm1;
+    bm0.allocN32Pixels(100, 100);
+    bm1.allocN32Pixels(100, 100);
+    REPORTER_ASSERT(r, surf0->readPixels(bm0, 0, 0) && surf1->readPixels(bm1, 0, 0));
+    // The blurred blue shows past the green rect.
+    REPORTER_ASSERT(r, 0 != SkColorGetA(bm0.getColor(52, 25)));
+    REPORTER_ASSERT(r, 0 == memcmp(bm0.getPixels(), bm1.getPixels(), bm0.computeByteSize()));
+}
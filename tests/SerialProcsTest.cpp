@@ -12,6 +12,7 @@
 #include "SkImageSource.h"
 #include "SkPicture.h"
 #include "SkPictureRecorder.h"
+#include "SkPictureSession.h"
 #include "SkSerialProcs.h"
 #include "SkSurface.h"
 
@@ -213,3 +214,56 @@ DEF_TEST(serial_typeface, reporter) {
     REPORTER_ASSERT(reporter, counter == 2);
 }
 
+
+DEF_TEST(serial_procs_session, reporter) {
+    auto img = GetResourceAsImage("images/mandrill_128.png");
+    if (!img) {
+        return;
+    }
+    auto sub = make_pic([img](SkCanvas* c) {
+        c->drawImage(img, 0, 0);
+        c->drawColor(0x4000FF00);
+    });
+    auto frame = [img, sub](SkColor color, bool shared) {
+        return make_pic([=](SkCanvas* c) {
+            if (shared) {
+                c->drawPicture(sub);
+                c->drawImage(img, 64, 64);
+            }
+            SkPaint paint;
+            paint.setColor(color);
+            c->drawRect(SkRect::MakeXYWH(16, 16, 32, 32), paint);
+        });
+    };
+
+    SkPictureSessionWriter writer(2);
+    SkPictureSessionReader reader(2);
+    auto roundtrip = [&](sk_sp<SkPicture> pic) -> size_t {
+        sk_sp<SkData> data = writer.serialize(pic.get());
+        sk_sp<SkPicture> copy = reader.deserialize(data->data(), data->size());
+        REPORTER_ASSERT(reporter, copy);
+        if (copy) {
+            REPORTER_ASSERT(reporter, sk_tool_utils::equal_pixels(picture_to_image(pic).get(),
+                                                                  picture_to_image(copy).get()));
+        }
+        REPORTER_ASSERT(reporter, writer.count() == reader.count());
+        return data->size();
+    };
+
+    // The image and sub-picture go over once, then are referenced by their hash.
+    const size_t first = roundtrip(frame(SK_ColorRED, true));
+    REPORTER_ASSERT(reporter, writer.count() == 2);
+    const size_t second = roundtrip(frame(SK_ColorBLUE, true));
+    REPORTER_ASSERT(reporter, second * 4 < first);
+
+    // They're dropped on both sides once unused for two frames, and sent again after that.
+    roundtrip(frame(SK_ColorRED, false));
+    roundtrip(frame(SK_ColorRED, false));
+    REPORTER_ASSERT(reporter, writer.count() == 0);
+    REPORTER_ASSERT(reporter, roundtrip(frame(SK_ColorBLUE, true)) == first);
+
+    // A reader that missed a frame fails rather than drawing the wrong thing.
+    SkPictureSessionReader late(2);
+    sk_sp<SkData> data = writer.serialize(frame(SK_ColorRED, true).get());
+    REPORTER_ASSERT(reporter, !late.deserialize(data->data(), data->size()));
+}
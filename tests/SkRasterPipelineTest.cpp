@@ -6,6 +6,8 @@
  */
 
 #include "SkHalf.h"
+#include "SkOpts.h"
+#include "SkRandom.h"
 #include "SkRasterPipeline.h"
 #include "SkTo.h"
 #include "Test.h"
@@ -202,3 +204,207 @@ DEF_TEST(SkRasterPipeline_lowp_clamp01, r) {
     p.append(SkRasterPipeline::store_8888, &ptr);
     p.run(0,0,1,1);
 }
+
+// Runs p in highp if forced to, otherwise in lowp, and checks which it ran in. Builds that can't
+// make lowp stages (e.g. not compiled by Clang) run everything in highp.
+// Counting is cheap, so we leave it on rather than race another test turning it off.
+static void run_lowp_or_highp(skiatest::Reporter* r, const SkRasterPipeline& p,
+                              int w, int h, bool forceHighp) {
+    gSkCountRasterPipelinePrecision = true;
+    const int lowp  = gSkRasterPipelineLowpCount,
+              highp = gSkRasterPipelineHighpCount;
+
+    gSkForceRasterPipelineHighp = forceHighp;
+    p.run(0,0,w,h);
+    gSkForceRasterPipelineHighp = false;
+
+    if (forceHighp || !SkOpts::just_return_lowp) {
+        REPORTER_ASSERT(r, gSkRasterPipelineHighpCount > highp);
+    } else {
+        REPORTER_ASSERT(r, gSkRasterPipelineLowpCount > lowp, "pipeline did not run in lowp");
+    }
+}
+
+static void expect_close(skiatest::Reporter* r, const uint32_t lowp[], const uint32_t highp[],
+                         int n, int tolerance, const char* name) {
+    for (int i = 0; i < n; i++) {
+        for (int shift = 0; shift < 32; shift += 8) {
+            int l = (lowp [i] >> shift) & 0xff,
+                h = (highp[i] >> shift) & 0xff;
+            if (SkTAbs(l - h) > tolerance) {
+                ERRORF(r, "%s: lowp %08x, highp %08x at %d\n", name, lowp[i], highp[i], i);
+                return;
+            }
+        }
+    }
+}
+
+DEF_TEST(SkRasterPipeline_lowp_sampling, r) {
+    // Filter a small premul image with repeat and mirror tiling, in lowp and in highp.
+    const int kW = 5, kH = 4;
+    uint32_t src[kW*kH];
+    SkRandom rand;
+    for (auto& px : src) {
+        uint32_t a = rand.nextULessThan(256);
+        px = rand.nextULessThan(a+1) << 0
+           | rand.nextULessThan(a+1) << 8
+           | rand.nextULessThan(a+1) << 16
+           | a << 24;
+    }
+
+    SkRasterPipeline_GatherCtx gather = { src, kW, (float)kW, (float)kH };
+    SkRasterPipeline_TileCtx limit_x = { (float)kW, 1.0f/kW },
+                             limit_y = { (float)kH, 1.0f/kH };
+    const float m[] = { 0.37f, 0.11f, -0.05f, 0.41f, -3.1f, 1.7f };  // A 2x3 matrix.
+
+    const int kDstW = 37, kDstH = 9;
+    for (bool bicubic : {false, true}) {
+        uint32_t lowp[kDstW*kDstH], highp[kDstW*kDstH];
+        for (bool force : {false, true}) {
+            SkRasterPipeline_MemoryCtx dst = { force ? highp : lowp, kDstW };
+            SkRasterPipeline_SamplerCtx sampler;
+
+            SkRasterPipeline_<256> p;
+            p.append(SkRasterPipeline::seed_shader);
+            p.append(SkRasterPipeline::matrix_2x3, m);
+            p.append(SkRasterPipeline::save_xy, &sampler);
+
+            auto sample = [&](SkRasterPipeline::StockStage setup_x,
+                              SkRasterPipeline::StockStage setup_y) {
+                p.append(setup_x, &sampler);
+                p.append(setup_y, &sampler);
+                p.append(SkRasterPipeline::repeat_x, &limit_x);
+                p.append(SkRasterPipeline::mirror_y, &limit_y);
+                p.append(SkRasterPipeline::gather_8888, &gather);
+                p.append(SkRasterPipeline::accumulate, &sampler);
+            };
+            if (!bicubic) {
+                for (auto y : {SkRasterPipeline::bilinear_ny, SkRasterPipeline::bilinear_py})
+                for (auto x : {SkRasterPipeline::bilinear_nx, SkRasterPipeline::bilinear_px}) {
+                    sample(x, y);
+                }
+            } else {
+                for (auto y : {SkRasterPipeline::bicubic_n3y, SkRasterPipeline::bicubic_n1y,
+                               SkRasterPipeline::bicubic_p1y, SkRasterPipeline::bicubic_p3y})
+                for (auto x : {SkRasterPipeline::bicubic_n3x, SkRasterPipeline::bicubic_n1x,
+                               SkRasterPipeline::bicubic_p1x, SkRasterPipeline::bicubic_p3x}) {
+                    sample(x, y);
+                }
+            }
+            p.append(SkRasterPipeline::move_dst_src);
+            if (bicubic) {
+                p.append(SkRasterPipeline::clamp_0);
+                p.append(SkRasterPipeline::clamp_a);
+            }
+            p.append(SkRasterPipeline::store_8888, &dst);
+            run_lowp_or_highp(r, p, kDstW, kDstH, force);
+        }
+        expect_close(r, lowp, highp, kDstW*kDstH, 1, bicubic ? "bicubic" : "bilinear");
+    }
+}
+
+DEF_TEST(SkRasterPipeline_lowp_color, r) {
+    // Opaque colors through a color matrix, in lowp and in highp.
+    const int kN = 64;
+    uint32_t src[kN];
+    for (int i = 0; i < kN; i++) {
+        src[i] = (uint32_t)(i*4+0) <<  0
+               | (uint32_t)(i*3+1) <<  8
+               | (uint32_t)(255-i) << 16
+               | 0xffu             << 24;
+    }
+
+    const float m[] = {  // A 4x5 column-major matrix, mixing the color channels a little.
+        0.80f, 0.10f, 0.05f, 0,
+        0.15f, 0.70f, 0.05f, 0,
+        0.05f, 0.10f, 0.90f, 0,
+        0,     0,     0,     1,
+        0.01f, 0.02f, 0,     0,
+    };
+
+    uint32_t lowp[kN], highp[kN];
+    for (bool force : {false, true}) {
+        SkRasterPipeline_MemoryCtx load = { src, 0 },
+                                   dst  = { force ? highp : lowp, 0 };
+
+        SkRasterPipeline_<256> p;
+        p.append(SkRasterPipeline::load_8888, &load);
+        p.append(SkRasterPipeline::unpremul);
+        p.append(SkRasterPipeline::matrix_4x5, m);
+        p.append(SkRasterPipeline::clamp_0);
+        p.append(SkRasterPipeline::clamp_1);
+        p.append(SkRasterPipeline::premul);
+        p.append(SkRasterPipeline::store_8888, &dst);
+        run_lowp_or_highp(r, p, kN, 1, force);
+    }
+    expect_close(r, lowp, highp, kN, 1, "color");
+}
+
+DEF_TEST(SkRasterPipeline_fused, r) {
+    // Each of these pipelines contains sequences SkRasterPipeline fuses into single stages.
+    // Breaking those sequences up with no-op clamp_0 stages should not change the results.
+    // As in run_lowp_or_highp(), counting is left on.
+    gSkCountRasterPipelinePrecision = true;
+    uint32_t src[8*8];
+    for (int i = 0; i < 8*8; i++) {
+        uint32_t a = (i * 37) & 0xff;
+        src[i] = (a/2) << 0 | (a/3) << 8 | (a/4) << 16 | a << 24;
+    }
+    SkRasterPipeline_GatherCtx gather = { src, 8, 8.0f, 8.0f };
+    SkRasterPipeline_MemoryCtx load   = { src, 8 };
+    const float m[] = { 0.5f, 0.25f, -0.25f, 0.5f, 2.0f, 1.0f };  // A 2x3 matrix.
+
+    const int kFusedStages[] = { 2, 1, 1 };
+    for (int test = 0; test < 3; test++) {
+        uint32_t fused[8*8], split[8*8];
+        for (bool breakUp : {false, true}) {
+            uint32_t* dst = breakUp ? split : fused;
+            for (int i = 0; i < 8*8; i++) {
+                dst[i] = 0xff000000 | (uint32_t)(i * 0x010305);
+            }
+            SkRasterPipeline_MemoryCtx dstCtx = { dst, 8 };
+
+            SkRasterPipeline_<256> p;
+            auto maybe_break = [&] {
+                if (breakUp) {
+                    p.append(SkRasterPipeline::clamp_0);
+                }
+            };
+            switch (test) {
+                case 0:  // seed_shader_matrix_2x3, gather_8888_srcover_rgba_8888
+                    p.append(SkRasterPipeline::seed_shader);
+                    maybe_break();
+                    p.append(SkRasterPipeline::matrix_2x3, m);
+                    p.append(SkRasterPipeline::gather_8888, &gather);
+                    maybe_break();
+                    p.append(SkRasterPipeline::srcover_rgba_8888, &dstCtx);
+                    break;
+                case 1:  // load_8888_srcover_rgba_8888
+                    p.append(SkRasterPipeline::load_8888, &load);
+                    maybe_break();
+                    p.append(SkRasterPipeline::srcover_rgba_8888, &dstCtx);
+                    break;
+                case 2:  // load_8888_dst_srcover_store_8888
+                    p.append(SkRasterPipeline::load_8888, &load);
+                    p.append(SkRasterPipeline::load_8888_dst, &dstCtx);
+                    maybe_break();
+                    p.append(SkRasterPipeline::srcover);
+                    p.append(SkRasterPipeline::store_8888, &dstCtx);
+                    break;
+            }
+            const int count = gSkRasterPipelineFusedCount;
+            p.run(0,0,8,8);
+            if (!breakUp) {
+                REPORTER_ASSERT(r, gSkRasterPipelineFusedCount - count >= kFusedStages[test],
+                                "test %d: fused %d stages, want %d", test,
+                                gSkRasterPipelineFusedCount - count, kFusedStages[test]);
+            }
+        }
+        for (int i = 0; i < 8*8; i++) {
+            if (fused[i] != split[i]) {
+                ERRORF(r, "test %d: fused %08x, split %08x at %d\n", test, fused[i], split[i], i);
+                break;
+            }
+        }
+    }
+}
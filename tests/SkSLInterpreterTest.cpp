@@ -0,0 +1,110 @@
+/*
+ * Copyright 2018 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "SkSLCompiler.h"
+#include "SkSLInterpreter.h"
+
+#include "Test.h"
+
+#if SK_SUPPORT_GPU
+
+static constexpr int kWidth = 37;  // deliberately not a multiple of the pipeline stride
+
+// Runs the program's stages over a row of colors, with the callbacks run either as bytecode or
+// by walking the tree.
+static bool run(skiatest::Reporter* r, const char* src, bool byteCode, const float in[],
+                float out[]) {
+    SkSL::Compiler compiler;
+    SkSL::Program::Settings settings;
+    std::unique_ptr<SkSL::Program> program = compiler.convertProgram(
+                                                                 SkSL::Program::kPipelineStage_Kind,
+                                                                 SkSL::String(src), settings);
+    REPORTER_ASSERT(r, program);
+    if (!program) {
+        printf("%s", compiler.errorText().c_str());
+        return false;
+    }
+
+    SkRasterPipeline_<256> p;
+    SkRasterPipeline_MemoryCtx src_ctx = { (void*) in, 0 },
+                               dst_ctx = { (void*) out, 0 };
+    p.append(SkRasterPipeline::load_f32, &src_ctx);
+    std::vector<SkSL::Interpreter::Value> stack;
+    SkSL::Interpreter interpreter(std::move(program), &p, &stack);
+    interpreter.setByteCodeEnabled(byteCode);
+    interpreter.run();
+    p.append(SkRasterPipeline::store_f32, &dst_ctx);
+    p.run(0, 0, kWidth, 1);
+    return true;
+}
+
+static void test(skiatest::Reporter* r, const char* src) {
+    float in[4 * kWidth];
+    for (int i = 0; i < kWidth; ++i) {
+        in[4 * i + 0] = i / (kWidth - 1.0f);
+        in[4 * i + 1] = 1 - i / (kWidth - 1.0f);
+        in[4 * i + 2] = (i % 5) / 4.0f;
+        in[4 * i + 3] = 1;
+    }
+    float walked[4 * kWidth], compiled[4 * kWidth];
+    if (!run(r, src, false, in, walked) || !run(r, src, true, in, compiled)) {
+        return;
+    }
+    for (int i = 0; i < 4 * kWidth; ++i) {
+        REPORTER_ASSERT(r, walked[i] == compiled[i], "%s\npixel %d channel %d: %g vs. %g", src,
+                        i / 4, i % 4, walked[i], compiled[i]);
+    }
+}
+
+DEF_TEST(SkSLInterpreterArithmetic, r) {
+    test(r, "void saturate(inout float r, inout float g, inout float b) {"
+            "    float l = 0.25 * r + 0.5 * g + 0.25 * b;"
+            "    r = clamp(l + (r - l) * 1.5, 0, 1);"
+            "    g = clamp(l + (g - l) * 1.5, 0, 1);"
+            "    b = abs(sqrt(b) - l);"
+            "}"
+            "void appendStages(SkRasterPipeline p) { append(p, saturate); }");
+}
+
+DEF_TEST(SkSLInterpreterBranches, r) {
+    test(r, "void posterize(inout float r, inout float g, inout float b) {"
+            "    if (r > 0.5) { r = 1; } else if (r > 0.25) { r = 0.5; } else { r = 0; }"
+            "    g = g < 0.25 || b == 1 ? 0 : g;"
+            "    if (b > 0.3 && b < 0.7) { b = -b; }"
+            "}"
+            "void appendStages(SkRasterPipeline p) { append(p, posterize); }");
+}
+
+DEF_TEST(SkSLInterpreterLoops, r) {
+    // Each pixel runs the loop a different number of times.
+    test(r, "void steps(inout float r, inout float g, inout float b) {"
+            "    int n = int(r * 8);"
+            "    float acc = 0;"
+            "    for (int i = 0; i < n; i++) {"
+            "        acc += 0.125;"
+            "        g *= 0.75;"
+            "    }"
+            "    r = acc;"
+            "    b = float(n / 3);"
+            "}"
+            "void appendStages(SkRasterPipeline p) { append(p, steps); }");
+}
+
+DEF_TEST(SkSLInterpreterDivide, r) {
+    // Pixels whose divisor is zero skip the divide, so only their lanes are masked off.
+    test(r, "void divide(inout float r, inout float g, inout float b) {"
+            "    int n = int(b * 4);"
+            "    if (n != 0) {"
+            "        r = float(int(g * 100) / n);"
+            "    } else {"
+            "        g = 0;"
+            "    }"
+            "}"
+            "void appendStages(SkRasterPipeline p) { append(p, divide); }");
+}
+
+#endif
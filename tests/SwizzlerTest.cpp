@@ -5,7 +5,10 @@
  * found in the LICENSE file.
  */
 
+#include "SkCodecPriv.h"
+#include "SkColorData.h"
 #include "SkImageInfoPriv.h"
+#include "SkRandom.h"
 #include "SkSwizzle.h"
 #include "SkSwizzler.h"
 #include "Test.h"
@@ -152,3 +155,148 @@ DEF_TEST(PublicSwizzleOpts, r) {
     SkSwapRB(&dst, &src, 1);
     REPORTER_ASSERT(r, dst == 0xFA04B0CE);
 }
+
+// Checks the SIMD paths, and their tails, against the scalar conversions the swizzler uses.
+DEF_TEST(SwizzleOpts_Wide, r) {
+    static const int kCount = 37;
+    SkRandom rand;
+    uint8_t src[kCount * 8];
+    for (uint8_t& byte : src) {
+        byte = rand.nextU();
+    }
+    uint32_t table[256];
+    for (uint32_t& c : table) {
+        c = rand.nextU();
+    }
+
+    uint32_t dst[kCount];
+    uint16_t dst565[kCount];
+
+    SkOpts::RGB16_to_RGB1(dst, src, kCount);
+    for (int i = 0; i < kCount; i++) {
+        const uint8_t* p = src + 6*i;
+        REPORTER_ASSERT(r, dst[i] == SkPackARGB_as_RGBA(0xFF, p[0], p[2], p[4]));
+    }
+    SkOpts::RGB16_to_BGR1(dst, src, kCount);
+    for (int i = 0; i < kCount; i++) {
+        const uint8_t* p = src + 6*i;
+        REPORTER_ASSERT(r, dst[i] == SkPackARGB_as_BGRA(0xFF, p[0], p[2], p[4]));
+    }
+    SkOpts::RGBA16_to_RGBA(dst, src, kCount);
+    for (int i = 0; i < kCount; i++) {
+        const uint8_t* p = src + 8*i;
+        REPORTER_ASSERT(r, dst[i] == SkPackARGB_as_RGBA(p[6], p[0], p[2], p[4]));
+    }
+    SkOpts::RGBA16_to_BGRA(dst, src, kCount);
+    for (int i = 0; i < kCount; i++) {
+        const uint8_t* p = src + 8*i;
+        REPORTER_ASSERT(r, dst[i] == SkPackARGB_as_BGRA(p[6], p[0], p[2], p[4]));
+    }
+    SkOpts::RGBA16_to_rgbA(dst, src, kCount);
+    for (int i = 0; i < kCount; i++) {
+        const uint8_t* p = src + 8*i;
+        REPORTER_ASSERT(r, dst[i] == SkPackARGB_as_RGBA(p[6], SkMulDiv255Round(p[0], p[6]),
+                                                              SkMulDiv255Round(p[2], p[6]),
+                                                              SkMulDiv255Round(p[4], p[6])));
+    }
+    SkOpts::RGBA16_to_bgrA(dst, src, kCount);
+    for (int i = 0; i < kCount; i++) {
+        const uint8_t* p = src + 8*i;
+        REPORTER_ASSERT(r, dst[i] == SkPackARGB_as_BGRA(p[6], SkMulDiv255Round(p[0], p[6]),
+                                                              SkMulDiv255Round(p[2], p[6]),
+                                                              SkMulDiv255Round(p[4], p[6])));
+    }
+
+    SkOpts::RGB_to_565(dst565, src, kCount);
+    for (int i = 0; i < kCount; i++) {
+        const uint8_t* p = src + 3*i;
+        REPORTER_ASSERT(r, dst565[i] == SkPack888ToRGB16(p[0], p[1], p[2]));
+    }
+    SkOpts::BGR_to_565(dst565, src, kCount);
+    for (int i = 0; i < kCount; i++) {
+        const uint8_t* p = src + 3*i;
+        REPORTER_ASSERT(r, dst565[i] == SkPack888ToRGB16(p[2], p[1], p[0]));
+    }
+    SkOpts::RGB16_to_565(dst565, src, kCount);
+    for (int i = 0; i < kCount; i++) {
+        const uint8_t* p = src + 6*i;
+        REPORTER_ASSERT(r, dst565[i] == SkPack888ToRGB16(p[0], p[2], p[4]));
+    }
+
+    SkOpts::index_to_8888(dst, src, kCount, table);
+    for (int i = 0; i < kCount; i++) {
+        REPORTER_ASSERT(r, dst[i] == table[src[i]]);
+    }
+}
+
+// A sampled swizzle must keep exactly the pixels an unsampled swizzle writes at the sample
+// points, whether it runs the optimized functions on gathered pixels or the scalar procs.
+DEF_TEST(SwizzlerSampled, r) {
+    static const int kWidth = 600;   // Sampling by 2 gathers more than one chunk of pixels.
+    SkRandom rand;
+    uint8_t src[kWidth * 8];
+    for (uint8_t& byte : src) {
+        byte = rand.nextU();
+    }
+    SkPMColor table[256];
+    for (SkPMColor& c : table) {
+        c = rand.nextU();
+    }
+
+    struct {
+        SkEncodedInfo::Color color;
+        SkEncodedInfo::Alpha alpha;
+        int                  bitsPerComponent;
+        SkColorType          dstColorType;
+        SkAlphaType          dstAlphaType;
+    } recs[] = {
+        { SkEncodedInfo::kGray_Color,      SkEncodedInfo::kOpaque_Alpha,    8,
+          kN32_SkColorType,      kOpaque_SkAlphaType   },
+        { SkEncodedInfo::kGrayAlpha_Color, SkEncodedInfo::kUnpremul_Alpha,  8,
+          kN32_SkColorType,      kPremul_SkAlphaType   },
+        { SkEncodedInfo::kPalette_Color,   SkEncodedInfo::kOpaque_Alpha,    8,
+          kN32_SkColorType,      kOpaque_SkAlphaType   },
+        { SkEncodedInfo::kRGB_Color,       SkEncodedInfo::kOpaque_Alpha,    8,
+          kRGB_565_SkColorType,  kOpaque_SkAlphaType   },
+        { SkEncodedInfo::kBGR_Color,       SkEncodedInfo::kOpaque_Alpha,    8,
+          kRGBA_8888_SkColorType, kOpaque_SkAlphaType  },
+        { SkEncodedInfo::kRGB_Color,       SkEncodedInfo::kOpaque_Alpha,   16,
+          kBGRA_8888_SkColorType, kOpaque_SkAlphaType  },
+        { SkEncodedInfo::kRGBA_Color,      SkEncodedInfo::kUnpremul_Alpha,  8,
+          kBGRA_8888_SkColorType, kPremul_SkAlphaType  },
+        { SkEncodedInfo::kRGBA_Color,      SkEncodedInfo::kUnpremul_Alpha, 16,
+          kRGBA_8888_SkColorType, kPremul_SkAlphaType  },
+        { SkEncodedInfo::kRGBA_Color,      SkEncodedInfo::kUnpremul_Alpha, 16,
+          kBGRA_8888_SkColorType, kUnpremul_SkAlphaType },
+        { SkEncodedInfo::kInvertedCMYK_Color, SkEncodedInfo::kOpaque_Alpha, 8,
+          kN32_SkColorType,      kOpaque_SkAlphaType   },
+    };
+
+    for (const auto& rec : recs) {
+        SkEncodedInfo info = SkEncodedInfo::Make(kWidth, 1, rec.color, rec.alpha,
+                                                 rec.bitsPerComponent);
+        SkImageInfo dstInfo = SkImageInfo::Make(kWidth, 1, rec.dstColorType, rec.dstAlphaType);
+        const int bpp = dstInfo.bytesPerPixel();
+
+        auto full = SkSwizzler::Make(info, table, dstInfo, SkCodec::Options());
+        REPORTER_ASSERT(r, full);
+        if (!full) {
+            continue;
+        }
+        SkAutoTMalloc<uint8_t> expected(kWidth * bpp);
+        full->swizzle(expected.get(), src);
+
+        for (int sampleX : { 2, 3, 7 }) {
+            auto sampled = SkSwizzler::Make(info, table, dstInfo, SkCodec::Options());
+            const int width = sampled->setSampleX(sampleX);
+            SkAutoTMalloc<uint8_t> actual(width * bpp);
+            sampled->swizzle(actual.get(), src);
+
+            for (int x = 0; x < width; x++) {
+                const int srcX = get_start_coord(sampleX) + x * sampleX;
+                REPORTER_ASSERT(r, !memcmp(actual.get() + x * bpp,
+                                           expected.get() + srcX * bpp, bpp));
+            }
+        }
+    }
+}
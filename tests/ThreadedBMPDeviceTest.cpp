@@ -0,0 +1,195 @@
+/*
+ * Copyright 2018 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "SkCanvas.h"
+#include "SkExecutor.h"
+#include "SkGradientShader.h"
+#include "SkImage.h"
+#include "SkMaskFilter.h"
+#include "SkPath.h"
+#include "SkRRect.h"
+#include "SkRandom.h"
+#include "SkSurface.h"
+#include "SkThreadedBMPDevice.h"
+#include "Test.h"
+
+// Draws a mix of geometry, much of it straddling the threaded device's tile boundaries.
+static void draw_scene(SkCanvas* canvas) {
+    SkRandom rand;
+    SkPaint paint;
+
+    canvas->drawColor(SK_ColorWHITE);
+
+    SkBitmap bitmap;
+    bitmap.allocN32Pixels(37, 23);
+    bitmap.eraseColor(0x8040C020);
+    bitmap.setImmutable();
+    sk_sp<SkImage> image = SkImage::MakeFromBitmap(bitmap);
+
+    const SkPoint pts[] = {{0, 0}, {300, 500}};
+    const SkColor colors[] = {SK_ColorRED, SK_ColorBLUE};
+    sk_sp<SkShader> gradient = SkGradientShader::MakeLinear(pts, colors, nullptr, 2,
+                                                            SkShader::kClamp_TileMode);
+
+    for (int i = 0; i < 200; ++i) {
+        paint.setColor(rand.nextU() | 0x40000000);
+        paint.setAntiAlias(rand.nextBool());
+        paint.setStyle(rand.nextBool() ? SkPaint::kFill_Style : SkPaint::kStroke_Style);
+        paint.setStrokeWidth(rand.nextRangeF(0, 6));
+        paint.setShader(i % 7 == 0 ? gradient : nullptr);
+        paint.setMaskFilter(i % 11 == 0 ? SkMaskFilter::MakeBlur(kNormal_SkBlurStyle, 3)
+                                        : nullptr);
+
+        const SkRect r = SkRect::MakeXYWH(rand.nextRangeF(-20, 300), rand.nextRangeF(-20, 500),
+                                          rand.nextRangeF(1, 200), rand.nextRangeF(1, 200));
+        canvas->save();
+        if (i % 5 == 0) {
+            canvas->clipRRect(SkRRect::MakeOval(r.makeOutset(30, 30)), true);
+        }
+        if (i % 3 == 0) {
+            canvas->rotate(rand.nextRangeF(-30, 30), r.centerX(), r.centerY());
+        }
+        switch (i % 6) {
+            case 0: canvas->drawRect(r, paint); break;
+            case 1: canvas->drawOval(r, paint); break;
+            case 2: canvas->drawRRect(SkRRect::MakeRectXY(r, 8, 8), paint); break;
+            case 3: {
+                SkPath path;
+                path.moveTo(r.fLeft, r.fTop);
+                path.cubicTo(r.fRight, r.fTop, r.fLeft, r.fBottom, r.fRight, r.fBottom);
+                path.lineTo(r.centerX(), r.fTop);
+                canvas->drawPath(path, paint);
+            } break;
+            case 4: canvas->drawImageRect(image, r, &paint); break;
+            case 5: {
+                const SkPoint line[] = {{r.fLeft, r.fTop}, {r.fRight, r.fBottom}};
+                canvas->drawPoints(SkCanvas::kLines_PointMode, 2, line, paint);
+            } break;
+        }
+        canvas->restore();
+    }
+
+    // A layer forces the threaded device to flush and draw serially in the middle of the scene.
+    canvas->saveLayerAlpha(nullptr, 0x80);
+    canvas->drawImage(image, 100, 250);
+    canvas->drawCircle(150, 260, 90, paint);
+    canvas->restore();
+}
+
+DEF_TEST(ThreadedBMPDevice, reporter) {
+    const SkImageInfo info = SkImageInfo::MakeN32Premul(300, 500);
+    std::unique_ptr<SkExecutor> executor = SkExecutor::MakeFIFOThreadPool(4);
+
+    auto serial = SkSurface::MakeRaster(info);
+    draw_scene(serial->getCanvas());
+    SkBitmap expected;
+    expected.allocPixels(info);
+    REPORTER_ASSERT(reporter, serial->readPixels(expected, 0, 0));
+
+    for (int tiles : {0, 1, 3, 7}) {
+        auto threaded = SkSurface::MakeRasterThreaded(info, executor.get(), tiles);
+        REPORTER_ASSERT(reporter, threaded);
+        draw_scene(threaded->getCanvas());
+
+        SkBitmap actual;
+        actual.allocPixels(info);
+        REPORTER_ASSERT(reporter, threaded->readPixels(actual, 0, 0));
+        REPORTER_ASSERT(reporter, 0 == memcmp(expected.getPixels(), actual.getPixels(),
+                                              expected.computeByteSize()),
+                        "tiles = %d", tiles);
+    }
+
+    REPORTER_ASSERT(reporter, !SkSurface::MakeRasterThreaded(info, nullptr));
+}
+
+// Self-intersecting polygons large enough to span several tiles, filled and stroked.
+static void draw_paths(SkCanvas* canvas) {
+    SkRandom rand;
+    SkPaint paint;
+    paint.setAntiAlias(true);
+
+    canvas->drawColor(SK_ColorWHITE);
+    for (int i = 0; i < 60; ++i) {
+        SkPath path;
+        path.setFillType(i % 3 == 0 ? SkPath::kEvenOdd_FillType : SkPath::kWinding_FillType);
+        path.moveTo(rand.nextRangeF(-20, 320), rand.nextRangeF(-20, 520));
+        for (int j = 0; j < 50; ++j) {
+            if (j % 4 == 0) {
+                path.quadTo(rand.nextRangeF(-20, 320), rand.nextRangeF(-20, 520),
+                            rand.nextRangeF(-20, 320), rand.nextRangeF(-20, 520));
+            } else {
+                path.lineTo(rand.nextRangeF(-20, 320), rand.nextRangeF(-20, 520));
+            }
+        }
+        path.close();
+        if (i == 59) {
+            path.toggleInverseFillType();
+        }
+
+        paint.setColor(rand.nextU() | 0x40000000);
+        paint.setStyle(i % 4 == 0 ? SkPaint::kStroke_Style : SkPaint::kFill_Style);
+        paint.setStrokeWidth(rand.nextRangeF(1, 4));
+        canvas->save();
+        if (i % 5 == 0) {
+            canvas->clipRect(SkRect::MakeXYWH(rand.nextRangeF(0, 100), rand.nextRangeF(0, 200),
+                                              200, 300), i % 10 == 0);
+        }
+        canvas->drawPath(path, paint);
+        canvas->restore();
+    }
+}
+
+DEF_TEST(ThreadedBMPDevice_DeltaAA, reporter) {
+    const SkImageInfo info = SkImageInfo::MakeN32Premul(300, 500);
+    const SkSurfaceProps props(0, kUnknown_SkPixelGeometry);
+    std::unique_ptr<SkExecutor> executor = SkExecutor::MakeFIFOThreadPool(4);
+
+    auto draw = [&](void (*drawFn)(SkCanvas*), SkExecutor* executor, int tiles) {
+        SkBitmap bitmap;
+        bitmap.allocPixels(info);
+        SkCanvas canvas(sk_make_sp<SkThreadedBMPDevice>(bitmap, props, executor, tiles,
+                                                        SkThreadedBMPDevice::DeltaAA::kForce));
+        drawFn(&canvas);
+        canvas.flush();
+        return bitmap;
+    };
+
+    for (auto drawFn : {draw_scene, draw_paths}) {
+        // Deltas are built once for all tiles, so no matter how the device is tiled or threaded,
+        // it must draw the same pixels.
+        SkBitmap expected = draw(drawFn, nullptr, 1);
+        for (int tiles : {3, 7}) {
+            for (SkExecutor* e : {(SkExecutor*)nullptr, executor.get()}) {
+                SkBitmap actual = draw(drawFn, e, tiles);
+                REPORTER_ASSERT(reporter, 0 == memcmp(expected.getPixels(), actual.getPixels(),
+                                                      expected.computeByteSize()),
+                                "tiles = %d, threaded = %d", tiles, e != nullptr);
+            }
+        }
+
+        // Delta AA should look much like analytic AA. The two round coverage differently, which
+        // shows most along the edges of thin strokes, so only count large differences.
+        auto serial = SkSurface::MakeRaster(info);
+        drawFn(serial->getCanvas());
+        SkPixmap analytic;
+        REPORTER_ASSERT(reporter, serial->peekPixels(&analytic));
+        int mismatched = 0;
+        for (int y = 0; y < info.height(); ++y) {
+            for (int x = 0; x < info.width(); ++x) {
+                SkColor a = analytic.getColor(x, y),
+                        b = expected.getColor(x, y);
+                int diff = SkTMax(SkTMax(SkTAbs((int)SkColorGetA(a) - (int)SkColorGetA(b)),
+                                         SkTAbs((int)SkColorGetR(a) - (int)SkColorGetR(b))),
+                                  SkTMax(SkTAbs((int)SkColorGetG(a) - (int)SkColorGetG(b)),
+                                         SkTAbs((int)SkColorGetB(a) - (int)SkColorGetB(b))));
+                mismatched += diff > 32;
+            }
+        }
+        REPORTER_ASSERT(reporter, mismatched < info.width() * info.height() / 100,
+                        "%d pixels differ from analytic AA", mismatched);
+    }
+}
@@ -5,12 +5,16 @@
  * found in the LICENSE file.
  */
 
+#include "ProcStats.h"
 #include "SkCommandLineFlags.h"
+#include "SkData.h"
 #include "SkFontDescriptor.h"
 #include "SkPicture.h"
 #include "SkPictureCommon.h"
 #include "SkPictureData.h"
+#include "SkPictureStreamReader.h"
 #include "SkStream.h"
+#include "SkTime.h"
 #include "SkTo.h"
 
 DEFINE_string2(input, i, "", "skp on which to report");
@@ -19,6 +23,8 @@ DEFINE_bool2(cullRect, c, true, "cullRect");
 DEFINE_bool2(flags, f, true, "flags");
 DEFINE_bool2(tags, t, true, "tags");
 DEFINE_bool2(quiet, q, false, "quiet");
+DEFINE_bool2(load, l, false, "load the skp, reporting load time and resident set size");
+DEFINE_bool(mmap, false, "load the skp in place from the mapped file instead of copying it out");
 
 // This tool can print simple information about an SKP but its main use
 // is just to check if an SKP has been truncated during the recording
@@ -31,6 +37,28 @@ static const int kInvalidTag = 3;
 static const int kMissingInput = 4;
 static const int kIOError = 5;
 
+static void report_load(const char* path) {
+    const int rssBefore = sk_tools::getCurrResidentSetSizeMB();
+    const double start = SkTime::GetMSecs();
+
+    sk_sp<SkPicture> picture;
+    if (FLAGS_mmap) {
+        picture = SkPictureStreamReader::MakeFromData(SkData::MakeFromFileName(path));
+    } else if (auto stream = SkStream::MakeFromFile(path)) {
+        picture = SkPicture::MakeFromStream(stream.get());
+    }
+
+    const double elapsed = SkTime::GetMSecs() - start;
+    if (!picture) {
+        SkDebugf("Load failed\n");
+        return;
+    }
+    SkDebugf("Load (%s): %.2fms, %d ops, RSS %dMB -> %dMB, max RSS %dMB\n",
+             FLAGS_mmap ? "mmap" : "copy", elapsed, picture->approximateOpCount(),
+             rssBefore, sk_tools::getCurrResidentSetSizeMB(),
+             sk_tools::getMaxResidentSetSizeMB());
+}
+
 int main(int argc, char** argv) {
     SkCommandLineFlags::SetUsage("Prints information about an skp file");
     SkCommandLineFlags::Parse(argc, argv);
@@ -66,6 +94,10 @@ int main(int argc, char** argv) {
                  info.fCullRect.fRight, info.fCullRect.fBottom);
     }
 
+    if (FLAGS_load && !FLAGS_quiet) {
+        report_load(FLAGS_input[0]);
+    }
+
     bool hasData;
     if (!stream.readBool(&hasData)) { return kTruncatedFile; }
     if (!hasData) {
@@ -105,6 +137,11 @@ int main(int argc, char** argv) {
                 SkDebugf("SK_PICT_READER_TAG %d\n", chunkSize);
             }
             break;
+        case SK_PICT_PADDING_TAG:
+            if (FLAGS_tags && !FLAGS_quiet) {
+                SkDebugf("SK_PICT_PADDING_TAG %d\n", chunkSize);
+            }
+            break;
         case SK_PICT_FACTORY_TAG:
             if (FLAGS_tags && !FLAGS_quiet) {
                 SkDebugf("SK_PICT_FACTORY_TAG %d\n", chunkSize);
@@ -0,0 +1,133 @@
+/*
+ * Copyright 2018 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "SkCommandLineFlags.h"
+#include "SkMultiPictureDocument.h"
+#include "SkOSFile.h"
+#include "SkOSPath.h"
+#include "SkPicture.h"
+#include "SkPictureSession.h"
+#include "SkStream.h"
+#include "SkTime.h"
+
+#include <algorithm>
+#include <vector>
+
+DEFINE_string2(input, i, "", "A directory of .skp frames, played in name order, or an .mskp.");
+DEFINE_int32(framesToKeep, 8, "Drop dictionary entries unused for this many frames.");
+DEFINE_bool2(verbose, v, false, "Print every frame, not just the totals.");
+
+// Serializes a sequence of frames once each on its own and once through an
+// SkPictureSessionWriter, reporting bytes per frame and encode time for both, and checks that
+// SkPictureSessionReader reads every session frame back.
+
+static std::vector<sk_sp<SkPicture>> read_frames(const char* path) {
+    std::vector<sk_sp<SkPicture>> frames;
+    if (sk_isdir(path)) {
+        std::vector<SkString> names;
+        SkOSFile::Iter it(path, "skp");
+        for (SkString name; it.next(&name);) {
+            names.push_back(SkOSPath::Join(path, name.c_str()));
+        }
+        std::sort(names.begin(), names.end(), [](const SkString& a, const SkString& b) {
+            return strcmp(a.c_str(), b.c_str()) < 0;
+        });
+        for (const SkString& name : names) {
+            if (auto stream = SkStream::MakeFromFile(name.c_str())) {
+                if (auto pic = SkPicture::MakeFromStream(stream.get())) {
+                    frames.push_back(std::move(pic));
+                    continue;
+                }
+            }
+            SkDebugf("Could not read %s.\n", name.c_str());
+        }
+        return frames;
+    }
+
+    std::unique_ptr<SkStreamSeekable> stream = SkStream::MakeFromFile(path);
+    if (!stream) {
+        SkDebugf("Could not read %s.\n", path);
+        return frames;
+    }
+    int count = SkMultiPictureDocumentReadPageCount(stream.get());
+    if (count <= 0) {
+        // Not an .mskp; try a single .skp.
+        stream->rewind();
+        if (auto pic = SkPicture::MakeFromStream(stream.get())) {
+            frames.push_back(std::move(pic));
+        }
+        return frames;
+    }
+    std::vector<SkDocumentPage> pages(count);
+    if (!SkMultiPictureDocumentRead(stream.get(), pages.data(), count)) {
+        SkDebugf("Could not read %s.\n", path);
+        return frames;
+    }
+    for (const SkDocumentPage& page : pages) {
+        frames.push_back(page.fPicture);
+    }
+    return frames;
+}
+
+int main(int argc, char** argv) {
+    SkCommandLineFlags::SetUsage("Measures bytes per frame and encode time of session "
+                                 "serialization over a sequence of pictures.");
+    SkCommandLineFlags::Parse(argc, argv);
+
+    if (FLAGS_input.count() != 1) {
+        SkDebugf("Missing input\n");
+        return 1;
+    }
+    std::vector<sk_sp<SkPicture>> frames = read_frames(FLAGS_input[0]);
+    if (frames.empty()) {
+        SkDebugf("No frames\n");
+        return 1;
+    }
+
+    SkPictureSessionWriter writer(FLAGS_framesToKeep);
+    SkPictureSessionReader reader(FLAGS_framesToKeep);
+
+    size_t plainBytes = 0, sessionBytes = 0;
+    double plainMs = 0, sessionMs = 0, readMs = 0;
+    int failed = 0;
+    for (size_t i = 0; i < frames.size(); i++) {
+        double start = SkTime::GetMSecs();
+        sk_sp<SkData> plain = frames[i]->serialize();
+        const double plainFrameMs = SkTime::GetMSecs() - start;
+
+        start = SkTime::GetMSecs();
+        sk_sp<SkData> session = writer.serialize(frames[i].get());
+        const double sessionFrameMs = SkTime::GetMSecs() - start;
+
+        start = SkTime::GetMSecs();
+        if (!reader.deserialize(session->data(), session->size())) {
+            failed++;
+        }
+        readMs += SkTime::GetMSecs() - start;
+
+        if (FLAGS_verbose) {
+            SkDebugf("frame %3zu: %9zu bytes %7.2fms plain, %9zu bytes %7.2fms session, "
+                     "%d in dictionary\n", i, plain->size(), plainFrameMs,
+                     session->size(), sessionFrameMs, writer.count());
+        }
+        plainBytes   += plain->size();
+        sessionBytes += session->size();
+        plainMs      += plainFrameMs;
+        sessionMs    += sessionFrameMs;
+    }
+
+    const double n = frames.size();
+    SkDebugf("%zu frames\n", frames.size());
+    SkDebugf("plain:   %.0f bytes/frame, %.2fms/frame encode\n", plainBytes / n, plainMs / n);
+    SkDebugf("session: %.0f bytes/frame, %.2fms/frame encode, %.2fms/frame decode\n",
+             sessionBytes / n, sessionMs / n, readMs / n);
+    if (failed) {
+        SkDebugf("%d session frames failed to decode\n", failed);
+        return 1;
+    }
+    return 0;
+}